@@ -0,0 +1,72 @@
+/**
+* @file Benchmark.hpp
+* @author Marcus Gugacs
+* @date 16.10.26
+* @copyright Copyright (c) 2026 Marcus Gugacs. All rights reserved.
+*/
+
+#ifndef ATLAS_BENCHMARK_HPP
+#define ATLAS_BENCHMARK_HPP
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+
+namespace fs = std::filesystem;
+
+namespace atlas::bench {
+  /**
+   * @brief Runs the given function a number of times and prints the average duration of one iteration.
+   *
+   * @param a_name Name of the measured case
+   * @param a_iterations Number of iterations to run
+   * @param a_function Function to measure
+   * @return The average duration of one iteration in microseconds
+   */
+  template<typename Function>
+  double Measure(const std::string& a_name, size_t a_iterations, Function&& a_function) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < a_iterations; ++i) {
+      a_function();
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double total_us = std::chrono::duration<double, std::micro>(end - start).count();
+    double per_iteration_us = total_us / static_cast<double>(a_iterations);
+    std::printf("%-40s %10zu iterations %14.3f us/iteration\n", a_name.c_str(), a_iterations, per_iteration_us);
+    return per_iteration_us;
+  }
+
+  /**
+   * @class TemporaryHome
+   * @brief Points HOME at a scratch directory for the lifetime of the object, so benchmarks never touch real data.
+   */
+  class TemporaryHome {
+  private:
+    fs::path m_path;
+    std::string m_previous;
+
+  public:
+    explicit TemporaryHome(const std::string& a_name)
+      : m_path(fs::temp_directory_path() / ("atlas-bench-" + a_name)) {
+      if (const char* home = std::getenv("HOME"))
+        m_previous = home;
+      fs::remove_all(m_path);
+      fs::create_directories(m_path);
+      setenv("HOME", m_path.c_str(), 1);
+    }
+
+    ~TemporaryHome() {
+      if (!m_previous.empty())
+        setenv("HOME", m_previous.c_str(), 1);
+      std::error_code error;
+      fs::remove_all(m_path, error);
+    }
+
+    const fs::path& GetPath() const { return m_path; }
+  };
+}
+
+#endif // ATLAS_BENCHMARK_HPP
@@ -0,0 +1,109 @@
+/**
+* @file BottleBenchmark.cpp
+* @author Marcus Gugacs
+* @date 16.10.26
+* @copyright Copyright (c) 2026 Marcus Gugacs. All rights reserved.
+*/
+
+#include <fstream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <zstd.h>
+
+#include "Benchmark.hpp"
+#include "core/Bottle.hpp"
+
+using namespace atlas;
+
+namespace {
+  constexpr size_t FILE_COUNT = 16;
+  constexpr size_t FILE_SIZE = 8 << 20;
+
+  /**
+   * @brief Writes libraries of loosely compressible data, roughly what a toolchain bottle holds.
+   */
+  std::vector<fs::path> writeTree(const fs::path& a_root) {
+    std::vector<fs::path> files{"lib"};
+    fs::create_directories(a_root / "lib");
+
+    std::mt19937 random(42);
+    std::string contents(FILE_SIZE, '\0');
+    for (size_t i = 0; i < FILE_COUNT; ++i) {
+      for (char& c : contents) {
+        c = static_cast<char>('a' + random() % 16);
+      }
+      fs::path file = fs::path("lib") / ("libmodule" + std::to_string(i) + ".so");
+      std::ofstream(a_root / file, std::ios::binary) << contents;
+      files.push_back(file);
+    }
+    return files;
+  }
+
+  /**
+   * @brief Recompresses a bottle as one frame, as the zstd command line tool writes it.
+   */
+  void writeSingleFrame(const fs::path& a_bottle, const fs::path& a_target) {
+    std::ifstream input(a_bottle, std::ios::binary);
+    std::string compressed((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+
+    std::string tar;
+    ZSTD_DCtx* decompressor = ZSTD_createDCtx();
+    std::vector<char> buffer(ZSTD_DStreamOutSize());
+    ZSTD_inBuffer in{compressed.data(), compressed.size(), 0};
+    while (in.pos < in.size) {
+      ZSTD_outBuffer out{buffer.data(), buffer.size(), 0};
+      ZSTD_decompressStream(decompressor, &out, &in);
+      tar.append(buffer.data(), out.pos);
+    }
+    ZSTD_freeDCtx(decompressor);
+
+    ZSTD_CCtx* compressor = ZSTD_createCCtx();
+    ZSTD_CCtx_setParameter(compressor, ZSTD_c_compressionLevel, Bottle::COMPRESSION_LEVEL);
+    std::ofstream output(a_target, std::ios::binary);
+    ZSTD_inBuffer source{tar.data(), tar.size(), 0};
+    std::vector<char> frame(ZSTD_CStreamOutSize());
+    size_t remaining = 0;
+    do {
+      ZSTD_outBuffer out{frame.data(), frame.size(), 0};
+      remaining = ZSTD_compressStream2(compressor, &out, &source, ZSTD_e_end);
+      output.write(frame.data(), static_cast<std::streamsize>(out.pos));
+    } while (remaining != 0);
+    ZSTD_freeCCtx(compressor);
+  }
+}
+
+int main() {
+  bench::TemporaryHome home("bottle");
+  fs::path source = home.GetPath() / "prefix";
+  std::vector<fs::path> files = writeTree(source);
+  std::printf("bottle with %zu files, %zu bytes, %u hardware threads\n", FILE_COUNT, FILE_COUNT * FILE_SIZE,
+              std::thread::hardware_concurrency());
+
+  fs::path bottle = home.GetPath() / "demo.tar.zst";
+  bench::Measure("create: hash, archive and compress", 1, [&]() {
+    Bottle::Create(bottle, "demo", "1.0", source, files);
+  });
+  fs::path single = home.GetPath() / "single.tar.zst";
+  writeSingleFrame(bottle, single);
+
+  // Frames of a bottle are decoded on all cores, a single frame can only be streamed on one
+  bool success = true;
+  std::vector<fs::path> extracted;
+  bench::Measure("extract: independent frames", 3, [&]() {
+    fs::remove_all(home.GetPath() / "frames");
+    success = Bottle::Extract(bottle, home.GetPath() / "frames", "demo", "1.0", extracted) && success;
+  });
+  bench::Measure("extract: single frame", 3, [&]() {
+    fs::remove_all(home.GetPath() / "stream");
+    success = Bottle::Extract(single, home.GetPath() / "stream", "demo", "1.0", extracted) && success;
+  });
+
+  if (!success || extracted.size() != files.size()) {
+    std::printf("Extraction failed\n");
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,75 @@
+/**
+* @file BuildCacheBenchmark.cpp
+* @author Marcus Gugacs
+* @date 16.10.26
+* @copyright Copyright (c) 2026 Marcus Gugacs. All rights reserved.
+*/
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "Benchmark.hpp"
+#include "core/BuildCache.hpp"
+
+using namespace atlas;
+
+namespace {
+  constexpr size_t DIRECTORY_COUNT = 40;
+  constexpr size_t FILES_PER_DIRECTORY = 50;
+  constexpr size_t FILE_SIZE = 16 * 1024;
+  constexpr char KEY[] = "5c8859204831887618e8bdd7808b24c7d2d2d74e6a6e51d3cb405db54c302b33";
+
+  /**
+   * @brief Writes an install tree shaped like a toolchain, many small headers in nested directories.
+   */
+  std::vector<fs::path> writeTree(const fs::path& a_root) {
+    std::vector<fs::path> files{"include"};
+    std::string contents;
+    for (size_t i = 0; contents.size() < FILE_SIZE; ++i) {
+      contents += "int symbol_" + std::to_string(i) + "(void);\n";
+    }
+
+    for (size_t d = 0; d < DIRECTORY_COUNT; ++d) {
+      fs::path directory = fs::path("include") / ("module" + std::to_string(d));
+      fs::create_directories(a_root / directory);
+      files.push_back(directory);
+      for (size_t f = 0; f < FILES_PER_DIRECTORY; ++f) {
+        fs::path file = directory / ("header" + std::to_string(f) + ".h");
+        std::ofstream(a_root / file) << contents;
+        files.push_back(file);
+      }
+    }
+    return files;
+  }
+}
+
+int main() {
+  bench::TemporaryHome home("build_cache");
+  fs::path source = home.GetPath() / "prefix";
+  std::vector<fs::path> files = writeTree(source);
+  std::printf("install tree with %zu files, %zu bytes\n", DIRECTORY_COUNT * FILES_PER_DIRECTORY,
+              DIRECTORY_COUNT * FILES_PER_DIRECTORY * FILE_SIZE);
+
+  BuildCache cache(home.GetPath() / "builds", 0);
+  bench::Measure("store: archive install tree", 3, [&]() {
+    cache.Store(KEY, source, files);
+  });
+
+  // What a reinstall costs on a hit, compared to copying the tree the install step produced
+  bool success = true;
+  bench::Measure("extract: unpack cached build", 3, [&]() {
+    fs::remove_all(home.GetPath() / "extracted");
+    success = cache.Extract(KEY, home.GetPath() / "extracted") && success;
+  });
+  bench::Measure("copy: recursive copy of the tree", 3, [&]() {
+    fs::remove_all(home.GetPath() / "copied");
+    fs::copy(source, home.GetPath() / "copied", fs::copy_options::recursive);
+  });
+
+  if (!success || !fs::exists(home.GetPath() / "extracted" / "include" / "module0" / "header0.h")) {
+    std::printf("Extraction failed\n");
+    return 1;
+  }
+  return 0;
+}
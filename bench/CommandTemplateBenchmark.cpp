@@ -0,0 +1,103 @@
+/**
+* @file CommandTemplateBenchmark.cpp
+* @author Marcus Gugacs
+* @date 16.10.26
+* @copyright Copyright (c) 2026 Marcus Gugacs. All rights reserved.
+*/
+
+#include <cstring>
+#include <regex>
+#include <string>
+#include <vector>
+
+#include "Benchmark.hpp"
+#include "utils/CommandTemplate.hpp"
+
+using namespace atlas;
+
+namespace {
+  constexpr size_t ITERATIONS = 20000;
+
+  const std::vector<std::string> COMMANDS = {
+    "mkdir -p $PACKAGE_CACHE_DIR/build",
+    "tar -xzf $PACKAGE_CACHE_DIR/source.tar.gz -C $PACKAGE_CACHE_DIR/build --strip-components=1",
+    "cd $PACKAGE_CACHE_DIR/build && ./configure --prefix=$INSTALL_DIR --enable-shared --disable-static",
+    "cd $PACKAGE_CACHE_DIR/build && make -j8",
+    "cd $PACKAGE_CACHE_DIR/build && make install DESTDIR= PREFIX=$INSTALL_DIR",
+    "ln -sf $INSTALL_DIR/bin/tool $HOME/.local/bin/tool",
+    "rm -rf $PACKAGE_CACHE_DIR/build"
+  };
+
+  const std::string CACHE_DIR = "/home/user/.cache/atlas";
+  const std::string INSTALL_DIR = "/home/user/.local/share/atlas";
+
+  /**
+   * @brief Substitutes the variables the way the installer did before commands were compiled.
+   */
+  ntl::String replaceWithRegex(const ntl::String& a_cmd) {
+    ntl::String result = a_cmd;
+    result = std::regex_replace(result.GetCString(), std::regex("\\$PACKAGE_CACHE_DIR"), CACHE_DIR).c_str();
+    result = std::regex_replace(result.GetCString(), std::regex("\\$INSTALL_DIR"), INSTALL_DIR).c_str();
+    return result;
+  }
+}
+
+int main() {
+  CommandVariables variables;
+  variables.Set("PACKAGE_CACHE_DIR", CACHE_DIR);
+  variables.Set("INSTALL_DIR", INSTALL_DIR);
+
+  std::vector<ntl::String> sources;
+  for (const auto& command : COMMANDS) {
+    sources.push_back(command.c_str());
+  }
+
+  std::printf("Substituting %zu commands per iteration\n", COMMANDS.size());
+
+  size_t checksum = 0;
+  double regex_us = bench::Measure("regex", ITERATIONS, [&]() {
+    for (const auto& source : sources) {
+      checksum += replaceWithRegex(source).GetSize();
+    }
+  });
+
+  // Compiling happens once per manifest, rendering once per executed command
+  double compile_us = bench::Measure("compile", ITERATIONS, [&]() {
+    for (const auto& command : COMMANDS) {
+      CommandTemplate compiled(command, variables);
+      checksum += compiled.GetSource().size();
+    }
+  });
+
+  std::vector<CommandTemplate> templates;
+  for (const auto& command : COMMANDS) {
+    templates.emplace_back(command, variables);
+  }
+
+  double render_us = bench::Measure("render", ITERATIONS, [&]() {
+    for (const auto& compiled : templates) {
+      checksum += compiled.Render(variables).GetSize();
+    }
+  });
+
+  std::string buffer;
+  double render_buffer_us = bench::Measure("render (reused buffer)", ITERATIONS, [&]() {
+    for (const auto& compiled : templates) {
+      compiled.Render(variables, buffer);
+      checksum += buffer.size();
+    }
+  });
+
+  // Both engines must agree on every command
+  for (size_t i = 0; i < templates.size(); ++i) {
+    if (std::strcmp(replaceWithRegex(sources[i]).GetCString(), templates[i].Render(variables).GetCString()) != 0) {
+      std::printf("Mismatch for: %s\n", COMMANDS[i].c_str());
+      return 1;
+    }
+  }
+
+  std::printf("%-40s %10.1fx render %10.1fx compile + render (checksum %zu)\n", "speedup over regex",
+              regex_us / render_us, regex_us / (compile_us + render_us), checksum);
+  std::printf("%-40s %10.1fx\n", "speedup with reused buffer", regex_us / render_buffer_us);
+  return 0;
+}
@@ -0,0 +1,116 @@
+/**
+* @file FlatMapBenchmark.cpp
+* @author Marcus Gugacs
+* @date 16.10.26
+* @copyright Copyright (c) 2026 Marcus Gugacs. All rights reserved.
+*/
+
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <data/Map.hpp>
+
+#include "Benchmark.hpp"
+#include "utils/FlatMap.hpp"
+
+using namespace atlas;
+
+namespace {
+  constexpr size_t KEY_COUNT = 50000;
+  constexpr size_t LOOKUPS = 1000000;
+}
+
+int main() {
+  std::mt19937 random(42);
+  std::vector<ntl::String> keys;
+  std::vector<ntl::String> lookups;
+  std::vector<ntl::String> misses;
+  for (size_t i = 0; i < KEY_COUNT; ++i) {
+    keys.push_back(("lib" + std::to_string(random()) + "-" + std::to_string(i)).c_str());
+    misses.push_back(("lib" + std::to_string(random()) + "-missing").c_str());
+  }
+  for (size_t i = 0; i < LOOKUPS; ++i) {
+    lookups.push_back(keys[random() % KEY_COUNT]);
+  }
+
+  std::printf("String keyed maps with %zu keys, %zu lookups\n", KEY_COUNT, LOOKUPS);
+
+  size_t checksum = 0;
+  ntl::Map<ntl::String, size_t> map;
+  bench::Measure("ntl::Map: build", 1, [&]() {
+    for (size_t i = 0; i < keys.size(); ++i) {
+      map[keys[i]] = i;
+    }
+  });
+  // How the index was used: a Find to check the key, then operator[] to get the value
+  bench::Measure("ntl::Map: find and get", 1, [&]() {
+    for (const auto& key : lookups) {
+      if (map.Find(key) != map.end())
+        checksum += map[key];
+    }
+  });
+  bench::Measure("ntl::Map: miss", 1, [&]() {
+    for (size_t i = 0; i < LOOKUPS; ++i) {
+      checksum += map.Find(misses[i % KEY_COUNT]) != map.end();
+    }
+  });
+
+  std::unordered_map<std::string_view, size_t> unordered;
+  bench::Measure("std::unordered_map: build", 1, [&]() {
+    for (size_t i = 0; i < keys.size(); ++i) {
+      unordered[GetKeyView(keys[i])] = i;
+    }
+  });
+  bench::Measure("std::unordered_map: find", 1, [&]() {
+    for (const auto& key : lookups) {
+      auto it = unordered.find(GetKeyView(key));
+      if (it != unordered.end())
+        checksum += it->second;
+    }
+  });
+  bench::Measure("std::unordered_map: miss", 1, [&]() {
+    for (size_t i = 0; i < LOOKUPS; ++i) {
+      checksum += unordered.find(GetKeyView(misses[i % KEY_COUNT])) != unordered.end();
+    }
+  });
+
+  FlatMap<ntl::String, size_t> flat;
+  bench::Measure("FlatMap: build", 1, [&]() {
+    for (size_t i = 0; i < keys.size(); ++i) {
+      flat.Insert(keys[i], i);
+    }
+  });
+  bench::Measure("FlatMap: find", 1, [&]() {
+    for (const auto& key : lookups) {
+      if (const size_t* value = flat.Find(key))
+        checksum += *value;
+    }
+  });
+  bench::Measure("FlatMap: miss", 1, [&]() {
+    for (size_t i = 0; i < LOOKUPS; ++i) {
+      checksum += flat.Contains(misses[i % KEY_COUNT]);
+    }
+  });
+
+  FlatMap<ntl::String, size_t> reserved;
+  bench::Measure("FlatMap: clear, reserve and build", 1, [&]() {
+    reserved.Clear();
+    reserved.Reserve(keys.size());
+    for (size_t i = 0; i < keys.size(); ++i) {
+      reserved.Insert(keys[i], i);
+    }
+  });
+
+  // Every map must have found the same values
+  for (size_t i = 0; i < keys.size(); ++i) {
+    if (*flat.Find(keys[i]) != i || map[keys[i]] != i || flat.Contains(misses[i])) {
+      std::printf("Mismatch for key %zu\n", i);
+      return 1;
+    }
+  }
+
+  std::printf("%-40s %10zu\n", "checksum", checksum);
+  return 0;
+}
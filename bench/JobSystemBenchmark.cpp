@@ -0,0 +1,72 @@
+/**
+* @file JobSystemBenchmark.cpp
+* @author Marcus Gugacs
+* @date 16.10.26
+* @copyright Copyright (c) 2026 Marcus Gugacs. All rights reserved.
+*/
+
+#include <atomic>
+
+#include "Benchmark.hpp"
+#include "core/Logger.hpp"
+#include "utils/JobSystem.hpp"
+
+using namespace atlas;
+
+namespace {
+  constexpr size_t JOB_COUNT = 200000;
+  constexpr size_t ITERATIONS = 5;
+  constexpr size_t THREAD_COUNTS[] = {1, 2, 4, 8, 16, 32, 64};
+
+  std::atomic<size_t> g_counter{0};
+
+  /**
+   * @brief Returns the throughput in million jobs per second for the given time per iteration.
+   */
+  double toThroughput(double a_per_iteration_us) {
+    return static_cast<double>(JOB_COUNT) / a_per_iteration_us;
+  }
+}
+
+int main() {
+  Logger::Instance().Initialize();
+  Logger::Instance().SetMinVerbosity(Verbosity::ERROR);
+
+  std::printf("JobSystem throughput with %zu empty jobs\n", JOB_COUNT);
+
+  for (size_t threads : THREAD_COUNTS) {
+    JobSystem::Instance().Initialize(threads);
+    std::string suffix = " (" + std::to_string(threads) + " threads)";
+
+    // Every job comes from outside the pool and passes through the injection queue
+    double inject_us = bench::Measure("inject" + suffix, ITERATIONS, []() {
+      for (size_t i = 0; i < JOB_COUNT; ++i) {
+        JobSystem::Instance().AddJob([]() {
+          g_counter.fetch_add(1, std::memory_order_relaxed);
+        });
+      }
+      JobSystem::Instance().WaitForJobsToFinish();
+    });
+
+    // One root job per worker fans out from inside the pool, exercising the deques and stealing
+    double spawn_us = bench::Measure("spawn" + suffix, ITERATIONS, [threads]() {
+      for (size_t root = 0; root < threads; ++root) {
+        JobSystem::Instance().AddJob([threads]() {
+          for (size_t i = 0; i < JOB_COUNT / threads; ++i) {
+            JobSystem::Instance().AddJob([]() {
+              g_counter.fetch_add(1, std::memory_order_relaxed);
+            });
+          }
+        });
+      }
+      JobSystem::Instance().WaitForJobsToFinish();
+    });
+
+    std::printf("%-40s %10.2f Mjobs/s inject %10.2f Mjobs/s spawn\n", suffix.c_str() + 1, toThroughput(inject_us),
+                toThroughput(spawn_us));
+
+    JobSystem::Instance().Shutdown();
+  }
+
+  return 0;
+}
@@ -0,0 +1,146 @@
+/**
+* @file JsonReaderBenchmark.cpp
+* @author Marcus Gugacs
+* @date 16.10.26
+* @copyright Copyright (c) 2026 Marcus Gugacs. All rights reserved.
+*/
+
+#include <fstream>
+#include <malloc.h>
+#include <string>
+#include <vector>
+
+#include <json/json.h>
+
+#include "Benchmark.hpp"
+#include "core/PackageIndexCache.hpp"
+#include "utils/JsonReader.hpp"
+
+using namespace atlas;
+
+namespace {
+  constexpr size_t PACKAGE_COUNT = 50000;
+
+  /**
+   * @brief Returns the number of bytes currently allocated on the heap.
+   */
+  size_t allocatedBytes() {
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+  }
+
+  /**
+   * @brief Writes an aggregate packages.json with inline platform sections.
+   */
+  void writeIndex(const fs::path& a_path) {
+    std::ofstream file(a_path);
+    file << "{\"packages\": [\n";
+    for (size_t i = 0; i < PACKAGE_COUNT; ++i) {
+      std::string name = "package" + std::to_string(i);
+      file << (i ? ",\n" : "") << "  {\"name\": \"" << name << "\", \"version\": \"1." << i % 7 << ".0\", "
+           << "\"description\": \"Benchmark package " << i << " with a \\\"quoted\\\" description\", "
+           << "\"dependencies\": [\"package" << i / 2 << " >=1.0\", \"package" << i / 3 << "\"], "
+           << "\"platforms\": {\"linux\": {\"steps\": {\"download\": {\"url\": \"https://example.com/" << name
+           << ".tar.gz\", \"target\": \"" << name << ".tar.gz\"}, \"build\": {\"commands\": [\"make -j4\"]}}}}}";
+    }
+    file << "\n]}\n";
+  }
+
+  /**
+   * @brief Copies the fields the index uses out of a parsed package.
+   */
+  PackageConfig toConfig(const Json::Value& a_package) {
+    PackageConfig config;
+    config.name = a_package["name"].asString().c_str();
+    config.version = a_package["version"].asString().c_str();
+    config.description = a_package["description"].asString().c_str();
+    for (const auto& dependency : a_package["dependencies"]) {
+      config.dependencies.Insert(dependency.asString().c_str());
+    }
+    auto plan = std::make_shared<InstallPlan>();
+    plan->url = a_package["platforms"]["linux"]["steps"]["download"]["url"].asString().c_str();
+    config.plan = plan;
+    return config;
+  }
+}
+
+int main() {
+  bench::TemporaryHome home("json_reader");
+  fs::path index_path = home.GetPath() / "packages.json";
+  writeIndex(index_path);
+  std::printf("packages.json with %zu packages, %zu bytes\n", PACKAGE_COUNT,
+              static_cast<size_t>(fs::file_size(index_path)));
+
+  // The previous path: a DOM of the whole file, then a vector of every package, then the cache
+  size_t dom_bytes = 0;
+  bench::Measure("dom: parse, copy and write", 3, [&]() {
+    size_t before = allocatedBytes();
+    Json::Value root;
+    std::ifstream file(index_path);
+    file >> root;
+
+    std::vector<PackageConfig> configs;
+    for (const auto& package : root["packages"]) {
+      configs.push_back(toConfig(package));
+    }
+    dom_bytes = allocatedBytes() - before;
+    PackageIndexCache::Write(home.GetPath() / "dom.bin", configs);
+  });
+
+  // Packages go from the reader into the cache tables, only the platforms section of one package is a DOM
+  size_t stream_bytes = 0;
+  bench::Measure("stream: read and write", 3, [&]() {
+    size_t before = allocatedBytes();
+    std::ifstream file(index_path, std::ios::binary);
+    JsonReader reader(file);
+    PackageIndexCache::Writer writer;
+
+    reader.Next();
+    while (reader.Next() == JsonReader::Token::Key) {
+      reader.Next();
+      while (reader.Next() == JsonReader::Token::ObjectBegin) {
+        Json::Value package;
+        PackageConfig config;
+        while (reader.Next() == JsonReader::Token::Key) {
+          std::string key = reader.GetString();
+          if (key == "dependencies") {
+            reader.Next();
+            while (reader.Next() == JsonReader::Token::String) {
+              config.dependencies.Insert(reader.GetString().c_str());
+            }
+          } else if (key == "platforms") {
+            reader.ReadValue(package["platforms"]);
+          } else {
+            reader.Next();
+            ntl::String value = reader.GetString().c_str();
+            if (key == "name") {
+              config.name = value;
+            } else if (key == "version") {
+              config.version = value;
+            } else if (key == "description") {
+              config.description = value;
+            }
+          }
+        }
+        auto plan = std::make_shared<InstallPlan>();
+        plan->url = package["platforms"]["linux"]["steps"]["download"]["url"].asString().c_str();
+        config.plan = plan;
+        writer.Add(config);
+      }
+    }
+    stream_bytes = allocatedBytes() - before;
+    writer.Write(home.GetPath() / "stream.bin");
+  });
+
+  std::printf("%-40s %10zu bytes\n", "dom: heap before writing", dom_bytes);
+  std::printf("%-40s %10zu bytes\n", "stream: heap before writing", stream_bytes);
+
+  PackageIndexCache dom;
+  PackageIndexCache stream;
+  if (!dom.Open(home.GetPath() / "dom.bin") || !stream.Open(home.GetPath() / "stream.bin") ||
+      dom.GetPackageCount() != stream.GetPackageCount()) {
+    std::printf("Caches differ\n");
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,112 @@
+/**
+* @file PackageStoreBenchmark.cpp
+* @author Marcus Gugacs
+* @date 16.10.26
+* @copyright Copyright (c) 2026 Marcus Gugacs. All rights reserved.
+*/
+
+#include <malloc.h>
+#include <string>
+#include <vector>
+
+#include <data/Map.hpp>
+
+#include "Benchmark.hpp"
+#include "core/PackageStore.hpp"
+
+using namespace atlas;
+
+namespace {
+  constexpr size_t PACKAGE_COUNT = 100000;
+  constexpr size_t LOOKUPS = 100000;
+
+  /**
+   * @brief Returns the number of bytes currently allocated on the heap.
+   */
+  size_t allocatedBytes() {
+    // Large blocks are mapped separately and not part of the arena statistics
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+  }
+
+  /**
+   * @brief Generates a package that depends on a few of the packages before it.
+   */
+  PackageConfig makePackage(size_t a_index) {
+    PackageConfig config;
+    config.name = ("package" + std::to_string(a_index)).c_str();
+    config.version = ("1." + std::to_string(a_index % 7) + ".0").c_str();
+    config.description = ("Benchmark package number " + std::to_string(a_index) + " with a short description").c_str();
+    config.repository = a_index % 3 ? "core" : "extra";
+    for (size_t i = 1; i <= a_index % 5 && i <= a_index; ++i) {
+      config.dependencies.Insert(("package" + std::to_string(a_index / (i + 1)) + " >=1.0").c_str());
+    }
+    return config;
+  }
+}
+
+int main() {
+  std::vector<PackageConfig> configs;
+  configs.reserve(PACKAGE_COUNT);
+  for (size_t i = 0; i < PACKAGE_COUNT; ++i) {
+    configs.push_back(makePackage(i));
+  }
+
+  std::vector<ntl::String> names;
+  for (size_t i = 0; i < LOOKUPS; ++i) {
+    names.push_back(configs[(i * 7919) % PACKAGE_COUNT].name);
+  }
+
+  std::printf("Package index with %zu packages\n", PACKAGE_COUNT);
+
+  // What the index was before: a map from name to a full copy of every configuration
+  size_t before = allocatedBytes();
+  ntl::Map<ntl::String, PackageConfig> map;
+  bench::Measure("map: build", 1, [&]() {
+    for (const auto& config : configs) {
+      map[config.name] = config;
+    }
+  });
+  size_t map_bytes = allocatedBytes() - before;
+
+  before = allocatedBytes();
+  PackageStore store;
+  bench::Measure("store: build", 1, [&]() {
+    store.Reserve(configs.size());
+    for (const auto& config : configs) {
+      store.Add(config);
+    }
+  });
+  size_t store_bytes = allocatedBytes() - before;
+
+  std::printf("%-40s %10zu bytes\n", "map: heap", map_bytes);
+  std::printf("%-40s %10zu bytes (%zu reported)\n", "store: heap", store_bytes, store.GetMemoryUsage());
+
+  size_t checksum = 0;
+  bench::Measure("map: lookup and copy", 1, [&]() {
+    for (const auto& name : names) {
+      PackageConfig config = map[name];
+      checksum += config.dependencies.GetSize();
+    }
+  });
+
+  bench::Measure("store: lookup and view", 1, [&]() {
+    for (const auto& name : names) {
+      PackageView view;
+      if (store.Find(name.GetCString(), view))
+        checksum += view.GetDependencyCount();
+    }
+  });
+
+  bench::Measure("store: lookup and copy out", 1, [&]() {
+    for (const auto& name : names) {
+      PackageView view;
+      if (store.Find(name.GetCString(), view))
+        checksum += view.ToConfig().dependencies.GetSize();
+    }
+  });
+
+  std::printf("%-40s %10.1fx smaller (checksum %zu)\n", "store vs map", static_cast<double>(map_bytes) /
+              static_cast<double>(store_bytes), checksum);
+  return 0;
+}
@@ -0,0 +1,130 @@
+/**
+* @file SearchBenchmark.cpp
+* @author Marcus Gugacs
+* @date 16.10.26
+* @copyright Copyright (c) 2026 Marcus Gugacs. All rights reserved.
+*/
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Benchmark.hpp"
+#include "core/Logger.hpp"
+#include "core/SearchIndex.hpp"
+
+using namespace atlas;
+
+namespace {
+  constexpr size_t PACKAGE_COUNT = 100000;
+  constexpr size_t ITERATIONS = 1000;
+  constexpr size_t SCAN_ITERATIONS = 10;
+
+  const char* const SYLLABLES[] = {
+    "ba", "co", "da", "fe", "gi", "ho", "ju", "ka", "lo", "mi", "nu", "pa", "qui", "ro", "su", "ta", "vi", "wo",
+    "xe", "zu", "bra", "cli", "dro", "fla", "gro", "plu", "stra", "tri"
+  };
+
+  const char* const WORDS[] = {
+    "library", "tool", "server", "client", "network", "database", "parser", "compiler", "graphics", "audio",
+    "video", "image", "terminal", "editor", "archive", "compression", "encryption", "protocol", "framework",
+    "utility", "bindings", "runtime", "interpreter", "toolkit", "manager", "monitor", "daemon", "driver", "font",
+    "theme", "language", "engine", "renderer", "scheduler", "filesystem", "backup", "proxy", "cache", "logger"
+  };
+
+  const char* const PREFIXES[] = {"lib", "py-", "node-", "", "", "", "go-", "rust-"};
+
+  /**
+   * @brief Generates a package with a pronounceable name and a short description.
+   */
+  PackageConfig makePackage(std::mt19937& a_random, size_t a_index) {
+    constexpr size_t SYLLABLE_COUNT = sizeof(SYLLABLES) / sizeof(SYLLABLES[0]);
+    constexpr size_t WORD_COUNT = sizeof(WORDS) / sizeof(WORDS[0]);
+    constexpr size_t PREFIX_COUNT = sizeof(PREFIXES) / sizeof(PREFIXES[0]);
+
+    std::string name = PREFIXES[a_random() % PREFIX_COUNT];
+    size_t syllables = 2 + a_random() % 3;
+    for (size_t i = 0; i < syllables; ++i) {
+      name += SYLLABLES[a_random() % SYLLABLE_COUNT];
+    }
+    name += std::to_string(a_index);
+
+    std::string description = "A";
+    size_t words = 6 + a_random() % 8;
+    for (size_t i = 0; i < words; ++i) {
+      description += " ";
+      description += WORDS[a_random() % WORD_COUNT];
+    }
+
+    PackageConfig config;
+    config.name = name.c_str();
+    config.version = "1.0.0";
+    config.description = description.c_str();
+    if (a_index > 0 && a_random() % 4 == 0) {
+      config.dependencies.Insert(("lib" + std::string(SYLLABLES[a_index % SYLLABLE_COUNT])).c_str());
+    }
+    return config;
+  }
+}
+
+int main() {
+  Logger::Instance().Initialize();
+  Logger::Instance().SetMinVerbosity(Verbosity::ERROR);
+  bench::TemporaryHome home("search");
+
+  std::mt19937 random(42);
+  std::vector<PackageConfig> configs;
+  configs.reserve(PACKAGE_COUNT);
+  for (size_t i = 0; i < PACKAGE_COUNT; ++i) {
+    configs.push_back(makePackage(random, i));
+  }
+
+  std::string exact_name = configs[PACKAGE_COUNT / 2].name.GetCString();
+  std::string typo_name = exact_name;
+  std::swap(typo_name[1], typo_name[2]);
+
+  fs::path path = home.GetPath() / "bench.search";
+  std::printf("Search over %zu packages\n", PACKAGE_COUNT);
+
+  bench::Measure("build and write", 1, [&]() {
+    SearchIndex::Write(path, configs, 0);
+  });
+  std::printf("%-40s %10ju bytes\n", "index size", static_cast<uintmax_t>(fs::file_size(path)));
+
+  SearchIndex index;
+  bench::Measure("open", 20, [&]() {
+    index.Open(path);
+  });
+
+  std::vector<SearchIndex::Match> matches;
+  const std::pair<std::string, std::string> QUERIES[] = {
+    {"exact name", exact_name},
+    {"name prefix", exact_name.substr(0, exact_name.size() - 2)},
+    {"typo", typo_name},
+    {"description word", "compiler"},
+    {"two terms", "network proxy"},
+    {"case and prefix", "LIBBRA"},
+    {"substring", "strapa"},
+    {"no match", "zzzzqqqq"}
+  };
+  for (const auto& [label, query] : QUERIES) {
+    bench::Measure(label + " (" + query + ")", ITERATIONS, [&]() {
+      index.Search(query, SearchIndex::DEFAULT_LIMIT, matches);
+    });
+    std::printf("%-40s %10zu results, best: %.*s\n", "", matches.size(),
+                matches.empty() ? 0 : static_cast<int>(matches[0].name.size()),
+                matches.empty() ? "" : matches[0].name.data());
+  }
+
+  // What Atlas::Search did before: two case-sensitive substring scans per package
+  size_t found = 0;
+  ntl::String needle = "compiler";
+  bench::Measure("linear scan (compiler)", SCAN_ITERATIONS, [&]() {
+    for (const auto& config : configs) {
+      if (config.name.Find(needle) != -1 || config.description.Find(needle) != -1)
+        ++found;
+    }
+  });
+
+  return found > 0 ? 0 : 1;
+}
@@ -0,0 +1,78 @@
+/**
+* @file StartupBenchmark.cpp
+* @author Marcus Gugacs
+* @date 16.10.26
+* @copyright Copyright (c) 2026 Marcus Gugacs. All rights reserved.
+*/
+
+#include <fstream>
+
+#include "Benchmark.hpp"
+#include "core/Atlas.hpp"
+#include "core/Logger.hpp"
+
+using namespace atlas;
+
+namespace {
+  constexpr size_t PACKAGE_COUNT = 2000;
+  constexpr size_t ITERATIONS = 50;
+
+  /**
+   * @brief Creates a repository with the given number of packages inside the temporary home.
+   */
+  void seedRepository(const fs::path& a_home, size_t a_packages) {
+    fs::path install_dir = a_home / ".local/share/atlas";
+    fs::path repo_dir = a_home / ".cache/atlas/bench";
+    fs::create_directories(install_dir);
+
+    std::ofstream(install_dir / "repositories.json")
+        << R"({"repositories":[{"name":"bench","url":"bench/bench","branch":"main","enabled":true}]})";
+
+    for (size_t i = 0; i < a_packages; ++i) {
+      std::string name = "package" + std::to_string(i);
+      fs::path package_dir = repo_dir / "packages" / name;
+      fs::create_directories(package_dir);
+      std::ofstream(package_dir / "package.json")
+          << R"({"name":")" << name << R"(","version":"1.0.0","description":"Benchmark package )" << i
+          << R"(","dependencies":[]})";
+    }
+  }
+}
+
+int main() {
+  bench::TemporaryHome home("startup");
+  seedRepository(home.GetPath(), PACKAGE_COUNT);
+
+  fs::path index_cache = home.GetPath() / ".cache/atlas/index/bench.bin";
+  Logger::Instance().SetMinVerbosity(Verbosity::ERROR);
+
+  std::printf("Atlas startup with %zu packages\n", PACKAGE_COUNT);
+
+  bench::Measure("help (construct only)", ITERATIONS, []() {
+    Atlas pm("", "", false);
+  });
+
+  bench::Measure("repo-list (repositories)", ITERATIONS, []() {
+    Atlas pm("", "", false);
+    pm.ListRepositories();
+  });
+
+  bench::Measure("info (repositories + index)", ITERATIONS, []() {
+    Atlas pm("", "", false);
+    pm.Info("package1");
+  });
+
+  bench::Measure("search (repositories + index)", ITERATIONS, []() {
+    Atlas pm("", "", false);
+    pm.Search("package1");
+  });
+
+  // What every command paid before: a full tree walk and JSON parse of every package.json
+  bench::Measure("search (cold, no index cache)", ITERATIONS, [&]() {
+    fs::remove(index_cache);
+    Atlas pm("", "", false);
+    pm.Search("package1");
+  });
+
+  return 0;
+}
@@ -7,13 +7,32 @@
 
 #include "Atlas.hpp"
 
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <iterator>
 #include <set>
+#include <sstream>
+#include <unordered_map>
+#include <unordered_set>
+#include <unistd.h>
 
 #include <toml++/toml.hpp>
 
+#include "DependencyResolver.hpp"
 #include "Logger.hpp"
+#include "PackageIndexCache.hpp"
+#include "utils/DownloadManager.hpp"
 #include "utils/JobSystem.hpp"
 #include "utils/Misc.hpp"
+#include "utils/ProcessRunner.hpp"
+#include "utils/Sha256.hpp"
+#include "utils/TaskGraph.hpp"
+#include "utils/Version.hpp"
+#include "utils/ZipStreamExtractor.hpp"
 
 namespace atlas {
   static size_t WriteCallback(void* contents, size_t size, size_t nmemb, void* userp) {
@@ -21,76 +40,189 @@ namespace atlas {
     return size * nmemb;
   }
 
+  static constexpr long HTTP_NOT_MODIFIED = 304;
+  // GitHub truncates the file list of a comparison beyond this
+  static constexpr Json::ArrayIndex MAX_COMPARE_FILES = 300;
+
+  static ntl::String encodeUrlPath(const std::string& a_path) {
+    static constexpr char HEX[] = "0123456789ABCDEF";
+    std::string encoded;
+    for (unsigned char c : a_path) {
+      if (std::isalnum(c) || c == '/' || c == '-' || c == '_' || c == '.' || c == '~') {
+        encoded += static_cast<char>(c);
+      } else {
+        encoded += '%';
+        encoded += HEX[c >> 4];
+        encoded += HEX[c & 0x0f];
+      }
+    }
+    return encoded.c_str();
+  }
+
+  static bool isManifestPath(const fs::path& a_path) {
+    return a_path.filename() == "package.json" || a_path.filename() == "packages.json";
+  }
+
+  // Packages read from a mapped index cache and repository tree parts walked per job when loading the index
+  static constexpr size_t CACHE_CHUNK_SIZE = 4096;
+  static constexpr size_t SCAN_CHUNK_SIZE = 64;
+
+  // Files of a package unlinked per job on removal
+  static constexpr size_t REMOVE_CHUNK_SIZE = 256;
+
+  /**
+   * @brief Splits a repository tree into parts that can be walked independently.
+   *
+   * Files in the top two levels are listed on their own and every directory on the second level is a part,
+   * so the usual packages/<name>/package.json layout yields one part per package.
+   */
+  static void splitTree(const fs::path& a_root, std::vector<fs::path>& a_parts) {
+    std::error_code error;
+    for (const auto& entry : fs::directory_iterator(a_root, error)) {
+      if (!entry.is_directory(error) || entry.is_symlink(error)) {
+        a_parts.push_back(entry.path());
+        continue;
+      }
+      for (const auto& child : fs::directory_iterator(entry.path(), error)) {
+        a_parts.push_back(child.path());
+      }
+    }
+  }
+
+  /**
+   * @brief Looks up a member of a manifest value without tripping JsonCpp's type assertions.
+   *
+   * @return The member, null if the value is not an object or has no such member
+   */
+  static const Json::Value& getMember(const Json::Value& a_value, const char* a_key) {
+    static const Json::Value null;
+    return a_value.isObject() ? a_value[a_key] : null;
+  }
+
+  /**
+   * @brief Reads a manifest scalar as text like Json::Value::asString, null is the empty string.
+   *
+   * @return False if the value is an object or an array
+   */
+  static bool getText(const Json::Value& a_value, ntl::String& a_text) {
+    if (a_value.isObject() || a_value.isArray())
+      return false;
+    a_text = a_value.asString().c_str();
+    return true;
+  }
+
   Atlas::Atlas(const fs::path& a_install, const fs::path& a_cache, bool verbose)
     : m_config(), m_install_dir(m_config.GetPaths().install_dir), m_cache_dir(m_config.GetPaths().cache_dir),
       m_shortcut_dir(m_config.GetPaths().shortcut_dir), m_repo_config_path(m_install_dir / "repositories.json"),
-      m_log_dir(m_install_dir / "logs"), m_repositories(), m_package_index() {
-    JobSystem::Instance().Initialize(m_config.GetNetwork().max_parallel_downloads);
+      m_log_dir(m_install_dir / "logs"), m_repositories(), m_repositories_loaded(false), m_package_index(),
+      m_package_index_loaded(false), m_installed(m_install_dir / "installed.json"),
+      m_download_cache(m_cache_dir / "store", static_cast<uint64_t>(m_config.GetCache().max_size_mb) * 1024 * 1024),
+      m_build_cache(m_cache_dir / "builds",
+                    static_cast<uint64_t>(std::max(m_config.GetCache().max_build_size_mb, 0)) * 1024 * 1024),
+      m_installer_options{{0, 0, LogSink::SyncPolicy::NONE}, {0, 0, 0}, false}, m_run_log_dir() {
+    // Everything else is brought up on first use, see the require* methods
     Logger::Instance().Initialize();
 
-    fs::create_directories(m_install_dir);
-    fs::create_directories(m_cache_dir);
-    fs::create_directories(m_shortcut_dir);
-    fs::create_directories(m_log_dir);
-    loadRepositories();
-    loadPackageIndex();
+    const Config::Log& log = m_config.GetLog();
+    LogSink::Options& log_options = m_installer_options.log;
+    log_options.max_size = static_cast<uint64_t>(std::max(log.max_size_mb, 0)) * 1024 * 1024;
+    log_options.max_files = static_cast<ntl::Size>(std::max(log.max_files, 0));
+    if (!LogSink::ParseSyncPolicy(log.sync, log_options.sync)) {
+      LOG_WARN(ntl::String{"Unknown log sync policy: "} + log.sync.c_str());
+    }
+    Logger::Instance().SetFileOptions(log_options);
+
+    const Config::Build& build = m_config.GetBuild();
+    m_installer_options.limits = {
+      std::max(build.timeout, 0),
+      static_cast<uint64_t>(std::max(build.max_memory_mb, 0)) * 1024 * 1024,
+      static_cast<uint64_t>(std::max(build.max_cpu_seconds, 0))
+    };
+    m_installer_options.bottles = build.bottles;
   }
 
   Atlas::~Atlas() {
-    JobSystem::Instance().WaitForJobsToFinish();
+    if (JobSystem::Instance().IsInitialized()) {
+      JobSystem::Instance().WaitForJobsToFinish();
+    }
+    if (DownloadManager::Instance().IsInitialized()) {
+      DownloadManager::Instance().Shutdown();
+    }
+    if (ProcessRunner::Instance().IsInitialized()) {
+      ProcessRunner::Instance().Shutdown();
+    }
+    if (m_installed.IsLoaded()) {
+      // Installs are recorded by their jobs, write them back in one go
+      m_installed.Commit();
+    }
+    m_animator.reset();
     Logger::Instance().Shutdown();
-    JobSystem::Instance().Shutdown();
+    if (JobSystem::Instance().IsInitialized()) {
+      JobSystem::Instance().Shutdown();
+    }
   }
 
   bool Atlas::AddRepository(const ntl::String& a_name, const ntl::String& a_url, const ntl::String& a_branch) {
-    if (m_repositories.Find(a_name) != m_repositories.end()) {
+    requireRepositories();
+
+    Repository repo{a_name, a_url, a_branch, true};
+    if (!m_repositories.Insert(a_name, repo).second) {
       LOG_ERROR("Repository already exists");
       return false;
     }
-
-    Repository repo{a_name, a_url, a_branch, true};
-    m_repositories[a_name] = repo;
     saveRepositories();
+    invalidatePackageIndex();
     return fetchRepository(repo);
   }
 
   bool Atlas::RemoveRepository(const ntl::String& a_name) {
-    if (m_repositories.Find(a_name) == m_repositories.end()) {
+    requireRepositories();
+
+    if (!m_repositories.Remove(a_name)) {
       LOG_ERROR("Repository not found");
       return false;
     }
-    m_repositories.Remove(a_name);
     fs::remove_all(m_cache_dir / a_name.GetCString());
+    fs::remove(getIndexCachePath(a_name));
+    fs::remove(getSearchIndexPath(a_name));
     saveRepositories();
-    loadPackageIndex();
+    invalidatePackageIndex();
     return true;
   }
 
   bool Atlas::EnableRepository(const ntl::String& a_name) {
-    if (m_repositories.Find(a_name) == m_repositories.end()) {
+    requireRepositories();
+
+    Repository* repo = m_repositories.Find(a_name);
+    if (!repo) {
       LOG_ERROR("Repository '" + a_name + "' not found...");
       return false;
     }
-    m_repositories[a_name].enabled = true;
+    repo->enabled = true;
     saveRepositories();
-    loadPackageIndex();
+    invalidatePackageIndex();
     LOG_MSG("Repository '" + a_name + "' enabled!");
     return true;
   }
 
   bool Atlas::DisableRepository(const ntl::String& a_name) {
-    if (m_repositories.Find(a_name) == m_repositories.end()) {
+    requireRepositories();
+
+    Repository* repo = m_repositories.Find(a_name);
+    if (!repo) {
       LOG_ERROR("Repository '" + a_name + "' not found...");
       return false;
     }
-    m_repositories[a_name].enabled = false;
+    repo->enabled = false;
     saveRepositories();
-    loadPackageIndex();
+    invalidatePackageIndex();
     LOG_MSG("Repository '" + a_name + "' disabled!");
     return true;
   }
 
   void Atlas::ListRepositories() {
+    requireRepositories();
+
     LOG_MSG("Local repositories:");
     for (const auto& [name, repo] : m_repositories) {
       LOG_MSG(name + " (" + (repo.enabled ? "enabled" : "disabled") + ")\n"
@@ -99,193 +231,419 @@ namespace atlas {
   }
 
   bool Atlas::Fetch() {
-    fs::path tempDir = m_cache_dir / "temp";
-    fs::create_directories(tempDir);
+    requireRepositories();
+    requireJobPool();
+    requireDownloads();
 
-    // Schedule repository fetching jobs
+    // Schedule one conditional revision check per repository, unchanged ones are answered with a 304
     m_repositories_lock.StartRead();
     for (const auto& [name, repo] : m_repositories) {
       if (!repo.enabled) {
         continue;
       }
 
-      JobSystem::Instance().AddJob([&, name, repo]() {
-        m_animator.UpdateStatus(name, "Fetching");
-
-        if (!fetchRepository(repo)) {
-          LOG_ERROR("Failed to fetch repository: " + name);
-          m_fetch_data_lock.StartWrite();
-          m_fetch_data.failed_fetchs.Insert(name);
-          m_fetch_data_lock.EndWrite();
-          m_animator.RemovePackage(name);
-          return;
-        }
-
-        m_animator.UpdateStatus(name, "Parsing");
-        fs::path repoPath = m_cache_dir / name.GetCString();
-
-        if (fs::exists(repoPath / "packages.json")) {
-          try {
-            Json::Value root; {
-              std::ifstream index_file(repoPath / "packages.json");
-              index_file >> root;
-            }
-
-            std::vector<PackageConfig> configs;
-            for (const auto& package : root["packages"]) {
-              PackageConfig config{
-                package["name"].asString().c_str(),
-                package["version"].asString().c_str(),
-                package["description"].asString().c_str(),
-                package["build_command"].asString().c_str(),
-                package["install_command"].asString().c_str(),
-                package["uninstall_command"].asString().c_str(),
-                name,
-                ntl::Array<ntl::String>()
-              };
-
-              const Json::Value& deps = package["dependencies"];
-              for (const auto& dep : deps) {
-                config.dependencies.Insert(dep.asString().c_str());
-              }
-              configs.push_back(config);
-            }
-
-            // Add all configs at once to minimize lock time
-            m_package_index_lock.StartWrite();
-            for (const auto& config : configs) {
-              m_package_index[config.name] = config;
-            }
-            m_package_index_lock.EndWrite();
-          } catch (const std::exception& e) {
-            LOG_ERROR("Error parsing package index for " + name + ": " + e.what());
-            m_fetch_data_lock.StartWrite();
-            m_fetch_data.failed_fetchs.Insert(name);
-            m_fetch_data_lock.EndWrite();
-          }
-        }
+      animator().UpdateStatus(name, "Checking");
 
-        m_animator.RemovePackage(name);
-      });
+      DownloadManager::Request request = createRevisionRequest(repo);
+      request.on_complete = [this, repo](const DownloadManager::Result& a_result) {
+        JobSystem::Instance().AddJob([this, repo, a_result]() {
+          updateRepository(repo, a_result);
+        });
+      };
+      DownloadManager::Instance().Submit(std::move(request));
     }
     m_repositories_lock.EndRead();
 
+    // Syncing jobs wait for their own transfers, so waiting for the jobs covers everything
+    DownloadManager::Instance().WaitForTransfers();
     JobSystem::Instance().WaitForJobsToFinish();
 
-    fs::remove_all(tempDir);
+    fs::remove_all(m_cache_dir / "temp");
+
+    m_repositories_lock.StartRead();
+    saveRepositories();
+    m_repositories_lock.EndRead();
 
     m_fetch_data_lock.StartRead();
+    bool changed = !m_fetch_data.successful_fetchs.IsEmpty();
     bool result = m_fetch_data.failed_fetchs.IsEmpty();
     m_fetch_data_lock.EndRead();
 
+    // The freshly written caches are picked up the next time the index is needed
+    if (changed) {
+      invalidatePackageIndex();
+    }
+
     return result;
   }
 
+  bool Atlas::updateRepository(const Repository& a_repo, const DownloadManager::Result& a_result) {
+    const ntl::String& name = a_repo.name;
+
+    auto record = [this, &name](ntl::Array<ntl::String> FetchData::* a_list) {
+      m_fetch_data_lock.StartWrite();
+      (m_fetch_data.*a_list).Insert(name);
+      m_fetch_data_lock.EndWrite();
+      animator().RemovePackage(name);
+    };
+
+    if (!a_result.success) {
+      LOG_ERROR("Failed to check repository " + name + ": " + a_result.error);
+      record(&FetchData::failed_fetchs);
+      return false;
+    }
+
+    // Only sent with an ETag while the cached tree exists, so a 304 means there is nothing to do
+    if (a_result.status == HTTP_NOT_MODIFIED) {
+      record(&FetchData::skipped_fetchs);
+      return true;
+    }
+
+    std::string revision = a_result.body.GetCString();
+    while (!revision.empty() && std::isspace(static_cast<unsigned char>(revision.back())))
+      revision.pop_back();
+
+    if (revision.empty()) {
+      LOG_ERROR("Failed to resolve the revision of repository " + name);
+      record(&FetchData::failed_fetchs);
+      return false;
+    }
+
+    bool changed = !(a_repo.revision == revision.c_str()) || !fs::exists(m_cache_dir / name.GetCString());
+    if (changed) {
+      animator().UpdateStatus(name, "Syncing");
+      if (!syncRepository(a_repo, revision.c_str()) || !indexRepository(name)) {
+        LOG_ERROR("Failed to fetch repository: " + name);
+        record(&FetchData::failed_fetchs);
+        return false;
+      }
+    }
+
+    // Only remembered once the tree matches, a failed sync must not be skipped by the next fetch
+    m_repositories_lock.StartWrite();
+    if (Repository* repo = m_repositories.Find(name)) {
+      repo->etag = a_result.etag;
+      repo->revision = revision.c_str();
+    }
+    m_repositories_lock.EndWrite();
+
+    record(changed ? &FetchData::successful_fetchs : &FetchData::skipped_fetchs);
+    return true;
+  }
+
+  bool Atlas::indexRepository(const ntl::String& a_repo) {
+    animator().UpdateStatus(a_repo, "Parsing");
+    fs::path repoPath = m_cache_dir / a_repo.GetCString();
+    fs::path index_path = repoPath / "packages.json";
+
+    if (!fs::exists(index_path)) {
+      std::vector<PackageConfig> configs = scanRepository(a_repo);
+      animator().UpdateStatus(a_repo, "Indexing");
+      writeIndexCaches(a_repo, configs);
+      return true;
+    }
+
+    // Packages go from the stream straight into the cache tables, neither the file nor a DOM of it is kept
+    std::ifstream index_file(index_path, std::ios::binary);
+    JsonReader reader(index_file);
+    PackageIndexCache::Writer writer;
+
+    auto fail = [&reader, &a_repo](const char* a_message) {
+      const char* reason = reader.GetToken() == JsonReader::Token::Error ? reader.GetError().c_str() : a_message;
+      LOG_ERROR("Error parsing package index for " + a_repo + ": " + reason);
+      return false;
+    };
+
+    if (!index_file || reader.Next() != JsonReader::Token::ObjectBegin)
+      return fail("Expected an object");
+
+    while (reader.Next() == JsonReader::Token::Key) {
+      if (reader.GetString() != "packages") {
+        if (!reader.Skip())
+          return fail("Invalid value");
+        continue;
+      }
+
+      if (reader.Next() != JsonReader::Token::ArrayBegin)
+        return fail("Expected an array of packages");
+
+      while (reader.Next() != JsonReader::Token::ArrayEnd) {
+        PackageConfig config;
+        Json::Value manifest;
+        if (!readPackage(reader, a_repo, config, manifest))
+          return fail("Expected a package object");
+
+        // Indexes may inline the platform sections, otherwise they live in the package's own manifest
+        if (manifest.isMember("platforms")) {
+          config.plan = parseInstallPlan(manifest);
+        } else {
+          std::ifstream manifest_file(repoPath / "packages" / config.name.GetCString() / "package.json");
+          JsonReader manifest_reader(manifest_file);
+          if (manifest_file && manifest_reader.Next() == JsonReader::Token::ObjectBegin) {
+            PackageConfig ignored;
+            if (readPackage(manifest_reader, a_repo, ignored, manifest))
+              config.plan = parseInstallPlan(manifest);
+          }
+        }
+        writer.Add(config);
+      }
+    }
+
+    if (reader.GetToken() != JsonReader::Token::ObjectEnd || reader.Next() != JsonReader::Token::End)
+      return fail("Expected the end of the document");
+
+    // The search index notices the new cache by its checksum and is rebuilt from it on the next search
+    animator().UpdateStatus(a_repo, "Indexing");
+    if (!writer.Write(getIndexCachePath(a_repo))) {
+      LOG_WARN("Failed to write package index cache for " + a_repo);
+    }
+    return true;
+  }
 
   bool Atlas::Install(const ntl::Array<ntl::String>& a_package_names) {
+    requirePackageIndex();
+    requireInstalledDatabase();
+    requireJobPool();
+    requireDownloads();
+
     // Validate all packages exist first
-    m_installer_data_lock.StartWrite();
     for (const auto& name : a_package_names) {
-      if (m_package_index.Find(name) == m_package_index.end()) {
+      if (!m_package_index.Contains(name.GetCString())) {
         LOG_ERROR("Package not found: " + name);
-        m_installer_data_lock.EndWrite();
         return false;
       }
-      m_installer_data.configs.Insert(m_package_index[name]);
     }
-    m_installer_data_lock.EndWrite();
 
-    // Helper function to schedule package and its dependencies
-    std::function<void(const PackageConfig&)> schedulePackage = [&](const PackageConfig& config) {
-      m_installer_data_lock.StartRead();
-      if (m_installer_data.scheduled[config.name] || !m_installer_data.failed_installs.IsEmpty()) {
-        m_installer_data_lock.EndRead();
-        m_installer_data_lock.StartWrite();
-        m_installer_data.skipped_installs.Insert(config.name);
-        m_installer_data_lock.EndWrite();
-        return;
-      }
-      m_installer_data_lock.EndRead();
+    // Pick versions for the requested packages and everything they depend on
+    std::vector<PackageConfig> plan;
+    if (!resolveInstallPlan(a_package_names, plan)) {
+      return false;
+    }
 
-      // First schedule all dependencies
-      m_package_index_lock.StartRead();
-      for (const auto& dep : config.dependencies) {
-        if (m_package_index.Find(dep) == m_package_index.end()) {
-          m_package_index_lock.EndRead();
-          m_installer_data_lock.StartWrite();
-          m_installer_data.failed_installs.Insert(dep);
-          m_installer_data_lock.EndWrite();
-          LOG_ERROR("Unknown dependency " + dep);
-          return;
+    return installPackages(plan);
+  }
+
+  bool Atlas::installPackages(const std::vector<PackageConfig>& a_packages) {
+    requireProcesses();
+    requireInstalledDatabase();
+
+    TaskGraph graph;
+    ntl::Map<ntl::String, size_t> tasks;
+
+    // Installers are created dependencies first, so every build key covers the builds its package links against
+    std::unordered_map<std::string, const PackageConfig*> by_name;
+    for (const auto& config : a_packages) {
+      by_name[config.name.GetCString()] = &config;
+    }
+    std::vector<const PackageConfig*> ordered;
+    std::unordered_set<std::string> visited;
+    std::function<void(const PackageConfig&)> visit = [&](const PackageConfig& a_config) {
+      if (!visited.insert(a_config.name.GetCString()).second)
+        return;
+      for (const auto& dep : a_config.dependencies) {
+        auto dependency = by_name.find(VersionRequirement::GetName(dep).GetCString());
+        if (dependency != by_name.end()) {
+          visit(*dependency->second);
         }
-        schedulePackage(m_package_index[dep]);
       }
-      m_package_index_lock.EndRead();
+      ordered.push_back(&a_config);
+    };
+    for (const auto& config : a_packages) {
+      visit(config);
+    }
 
+    std::unordered_map<std::string, ntl::String> builds;
+    for (const PackageConfig* package : ordered) {
+      const PackageConfig& config = *package;
       m_installer_data_lock.StartWrite();
-      if (!m_installer_data.failed_installs.IsEmpty()) {
+      if (m_installer_data.scheduled[config.name]) {
         m_installer_data.skipped_installs.Insert(config.name);
         m_installer_data_lock.EndWrite();
-        return;
+        continue;
       }
-
       m_installer_data.scheduled[config.name] = true;
       m_installer_data_lock.EndWrite();
 
-      JobSystem::Instance().AddJob([&]() {
-        PackageInstaller installer(m_cache_dir, m_install_dir, m_log_dir, config);
-
-        m_animator.UpdateStatus(config.name, "Downloading");
-        bool success = installer.Download();
-
-        if (success) {
-          m_animator.UpdateStatus(config.name, "Preparing");
-          success = installer.Prepare();
+      BuildCache* build_cache = m_config.GetBuild().cache ? &m_build_cache : nullptr;
+      auto installer = std::make_shared<PackageInstaller>(m_cache_dir, m_install_dir, getPackageLogDir(config),
+                                                            config, &m_download_cache, build_cache,
+                                                            m_installer_options, getDependencyBuilds(config, builds));
+      builds[config.name.GetCString()] = config.version + "#" + installer->GetBuildKey();
+
+      // An upgrade drops the files of the installed version that the new one no longer has
+      InstalledPackage installed;
+      if (m_installed.Get(config.name, installed)) {
+        std::vector<fs::path> previous;
+        for (const auto& file : installed.files) {
+          previous.emplace_back(file.GetCString());
         }
+        installer->SetPreviousFiles(std::move(previous));
+      }
+
+      // Start every transfer right away, downloads do not depend on each other and overlap with the builds
+      bool cached = installer->HasCachedBuild();
+      if (!cached) {
+        installer->StartDownload();
+      }
 
-        if (success) {
-          m_animator.UpdateStatus(config.name, "Building");
-          success = installer.Build();
+      tasks[config.name] = graph.AddTask(config.name, [this, installer, config, cached]() {
+        // A cached build or a bottle replaces the whole pipeline, an unusable one falls back to building
+        bool success = false;
+        if (cached) {
+          animator().UpdateStatus(config.name, "Unpacking");
+          success = installer->InstallCachedBuild();
         }
 
-        if (success) {
-          m_animator.UpdateStatus(config.name, "Installing");
-          success = installer.Install();
+        if (!success && installer->HasBottle()) {
+          animator().UpdateStatus(config.name, "Pouring bottle");
+          success = installer->InstallBottle();
         }
 
-        if (success) {
-          m_animator.UpdateStatus(config.name, "Cleaning");
-          success = installer.Cleanup();
+        if (!success) {
+          success = runInstaller(*installer, config.name);
         }
 
-        m_animator.RemovePackage(config.name);
+        animator().RemovePackage(config.name);
 
         if (!success) {
           LOG_ERROR("Installation failed for " + config.name);
           m_installer_data_lock.StartWrite();
           m_installer_data.failed_installs.Insert(config.name);
           m_installer_data_lock.EndWrite();
-          return;
+          return false;
         }
 
         m_installer_data_lock.StartWrite();
-        recordInstallation(config);
+        m_installer_data.successful_installs.Insert(config.name);
+        recordInstallation(config, installer->GetFiles(), installer->GetBuildKey());
         m_installer_data_lock.EndWrite();
+        return true;
       });
-    };
+    }
 
-    // Schedule all packages and their dependencies
-    for (const auto& config : m_installer_data.configs) {
-      schedulePackage(config);
+    // A package waits for the dependencies installed alongside it, everything else is already present
+    for (const auto& config : a_packages) {
+      if (tasks.Find(config.name) == tasks.end())
+        continue;
+
+      for (const auto& dep : config.dependencies) {
+        ntl::String dependency = VersionRequirement::GetName(dep);
+        if (tasks.Find(dependency) != tasks.end()) {
+          graph.AddDependency(tasks[config.name], tasks[dependency]);
+        }
+      }
     }
 
-    bool result = m_installer_data.failed_installs.IsEmpty();
+    ntl::String cycle;
+    if (!graph.Validate(cycle)) {
+      LOG_ERROR("Dependency cycle between " + cycle);
+      return false;
+    }
 
-    return result;
+    bool success = graph.Run();
+
+    for (size_t i = 0; i < graph.GetTaskCount(); ++i) {
+      if (graph.GetStatus(i) == TaskGraph::Status::Skipped) {
+        LOG_WARN("Skipped " + graph.GetName(i) + " because a dependency failed");
+        m_installer_data_lock.StartWrite();
+        m_installer_data.skipped_installs.Insert(graph.GetName(i));
+        m_installer_data_lock.EndWrite();
+      }
+    }
+
+    std::vector<size_t> critical_path = graph.GetCriticalPath();
+    if (critical_path.size() > 1) {
+      ntl::String path;
+      for (size_t task : critical_path) {
+        int millis = static_cast<int>(graph.GetDuration(task).count() * 1000);
+        path += (path.IsEmpty() ? "" : " -> ") + graph.GetName(task) + " (" + millis + " ms)";
+      }
+      LOG_INFO("Critical path: " + path);
+    }
+
+    if (!m_installed.Commit()) {
+      return false;
+    }
+
+    return success;
+  }
+
+  bool Atlas::runInstaller(PackageInstaller& a_installer, const ntl::String& a_name) {
+    animator().UpdateStatus(a_name, "Downloading");
+    bool success = a_installer.Download();
+
+    if (success) {
+      animator().UpdateStatus(a_name, "Preparing");
+      success = a_installer.Prepare();
+    }
+
+    if (success) {
+      animator().UpdateStatus(a_name, "Building");
+      success = a_installer.Build();
+    }
+
+    if (success) {
+      animator().UpdateStatus(a_name, "Installing");
+      success = a_installer.Install();
+    }
+
+    if (success) {
+      animator().UpdateStatus(a_name, "Cleaning");
+      success = a_installer.Cleanup();
+    }
+
+    return success;
+  }
+
+  bool Atlas::resolveInstallPlan(const ntl::Array<ntl::String>& a_package_names, std::vector<PackageConfig>& a_plan) {
+    DependencyResolver resolver(m_cache_dir / "resolver");
+
+    // Every version any enabled repository offers is a candidate, not just the newest one kept in the index
+    m_repositories_lock.StartRead();
+    for (const auto& [name, repo] : m_repositories) {
+      if (!repo.enabled)
+        continue;
+
+      PackageIndexCache cache;
+      if (cache.Open(getIndexCachePath(name))) {
+        PackageConfig config;
+        for (size_t i = 0; i < cache.GetPackageCount(); ++i) {
+          cache.GetPackage(i, name, config);
+          resolver.AddAvailable(config);
+        }
+        continue;
+      }
+
+      m_package_index_lock.StartRead();
+      for (size_t i = 0; i < m_package_index.GetCount(); ++i) {
+        PackageView package = m_package_index.Get(i);
+        if (std::strcmp(package.GetRepository(), name.GetCString()) == 0) {
+          resolver.AddAvailable(package.ToConfig());
+        }
+      }
+      m_package_index_lock.EndRead();
+    }
+    m_repositories_lock.EndRead();
+
+    for (const auto& name : m_installed.GetPackageNames()) {
+      InstalledPackage installed;
+      if (m_installed.Get(name, installed)) {
+        resolver.AddInstalled(name, installed);
+      }
+    }
+
+    if (!resolver.Resolve(a_package_names, a_plan)) {
+      LOG_ERROR(resolver.GetError());
+      return false;
+    }
+
+    return true;
   }
 
   bool Atlas::Install(const ntl::String& a_package_name) {
-    if (m_package_index.Find(a_package_name) == m_package_index.end()) {
+    requirePackageIndex();
+
+    if (!m_package_index.Contains(a_package_name.GetCString())) {
       LOG_ERROR("Package not found");
       return false;
     }
@@ -293,159 +651,90 @@ namespace atlas {
   }
 
   bool Atlas::Remove(const ntl::String& a_package_name) {
-    if (m_package_index.Find(a_package_name) == m_package_index.end()) {
+    requirePackageIndex();
+
+    PackageView package;
+    if (!m_package_index.Find(a_package_name.GetCString(), package)) {
       LOG_ERROR("Package not found");
       return false;
     }
-    return removePackage(m_package_index[a_package_name]);
+    return removePackage(package.ToConfig());
   }
 
   bool Atlas::Update() {
-    fs::path dbPath = m_install_dir / "installed.json";
-    Json::Value root;
-
-    if (fs::exists(dbPath)) {
-      std::ifstream dbFile(dbPath);
-      dbFile >> root;
-    }
-
-    m_installer_data_lock.StartWrite();
-    for (const auto& [name, config] : m_package_index) {
-      m_installer_data.configs.Insert(config);
-    }
-    m_installer_data_lock.EndWrite();
-
-    // Helper function to schedule package update
-    std::function<void(const PackageConfig&)> scheduleUpdate = [&](const PackageConfig& config) {
-      m_installer_data_lock.StartRead();
-      if (m_installer_data.scheduled[config.name] || !m_installer_data.failed_installs.IsEmpty()) {
-        m_installer_data_lock.EndRead();
-        m_installer_data_lock.StartWrite();
-        m_installer_data.skipped_installs.Insert(config.name);
-        m_installer_data_lock.EndWrite();
-        return;
-      }
-      m_installer_data_lock.EndRead();
-
-      m_installer_data_lock.StartWrite();
-      m_installer_data.scheduled[config.name] = true;
-      m_installer_data_lock.EndWrite();
-
-      JobSystem::Instance().AddJob([&, root]() {
-        if (IsInstalled(config.name)) {
-          ntl::String localVersion = root[config.name.GetCString()]["version"].asString().c_str();
-          bool isLocked = root[config.name.GetCString()]["locked"].asBool();
-
-          if (!isLocked && config.version != localVersion) {
-            LOG_MSG("Updating " + config.name + " from version " + localVersion + " to " + config.version + "...");
-
-            PackageInstaller installer(m_cache_dir, m_install_dir, m_log_dir, config);
-
-            m_animator.UpdateStatus(config.name, "Downloading");
-            bool packageSuccess = installer.Download();
-
-            if (packageSuccess) {
-              m_animator.UpdateStatus(config.name, "Preparing");
-              packageSuccess = installer.Prepare();
-            }
-
-            if (packageSuccess) {
-              m_animator.UpdateStatus(config.name, "Building");
-              packageSuccess = installer.Build();
-            }
-
-            if (packageSuccess) {
-              m_animator.UpdateStatus(config.name, "Installing");
-              packageSuccess = installer.Install();
-            }
-
-            if (packageSuccess) {
-              m_animator.UpdateStatus(config.name, "Cleaning");
-              packageSuccess = installer.Cleanup();
-            }
-
-            m_animator.RemovePackage(config.name);
-
-            if (!packageSuccess) {
-              LOG_ERROR("Update failed for " + config.name);
-              m_installer_data_lock.StartWrite();
-              m_installer_data.failed_installs.Insert(config.name);
-              m_installer_data_lock.EndWrite();
-              return;
-            }
-
-            m_installer_data_lock.StartWrite();
-            m_installer_data.successful_installs.Insert(config.name);
-            recordInstallation(config);
-            m_installer_data_lock.EndWrite();
-          }
-        }
-      });
-    };
+    requirePackageIndex();
+    requireInstalledDatabase();
+    requireJobPool();
+    requireDownloads();
+
+    // Only outdated packages are scheduled, so only they start a download and are copied out of the index
+    std::vector<PackageConfig> outdated;
+    for (size_t i = 0; i < m_package_index.GetCount(); ++i) {
+      PackageView package = m_package_index.Get(i);
+      InstalledPackage installed;
+      if (!m_installed.Get(package.GetName(), installed) || installed.locked ||
+          installed.version == package.GetVersion())
+        continue;
 
-    // Schedule updates for all packages
-    for (const auto& config : m_installer_data.configs) {
-      scheduleUpdate(config);
+      LOG_MSG(ntl::String{"Updating "} + package.GetName() + " from version " + installed.version + " to " +
+              package.GetVersion() + "...");
+      outdated.push_back(package.ToConfig());
     }
 
-    // Wait for all jobs to complete
-    JobSystem::Instance().WaitForJobsToFinish();
+    bool graph_success = installPackages(outdated);
 
     m_installer_data_lock.StartRead();
     if (m_installer_data.successful_installs.IsEmpty()) {
       LOG_WARN("No updates found");
     }
 
-    bool success = m_installer_data.failed_installs.IsEmpty();
+    bool success = graph_success && m_installer_data.failed_installs.IsEmpty();
     m_installer_data_lock.EndRead();
 
     return success;
   }
 
   bool Atlas::Upgrade(const ntl::String& a_package_name) {
-    if (m_package_index.Find(a_package_name) == m_package_index.end()) {
+    requirePackageIndex();
+
+    PackageView package;
+    if (!m_package_index.Find(a_package_name.GetCString(), package)) {
       LOG_ERROR("Package not found");
       return false;
     }
 
-    return upgrade(m_package_index[a_package_name]);
+    return upgrade(package.ToConfig());
   }
 
   bool Atlas::LockPackage(const ntl::String& name) {
-    fs::path dbPath = m_install_dir / "installed.json";
-    Json::Value root;
+    requireInstalledDatabase();
 
-    if (!IsInstalled(name)) {
+    if (!m_installed.SetLocked(name, true)) {
       LOG_ERROR("Package not installed");
       return false;
     }
 
-    if (fs::exists(dbPath)) {
-      std::ifstream dbFile(dbPath);
-      dbFile >> root;
-      root[name.GetCString()]["locked"] = true;
-      std::ofstream outFile(dbPath);
-      outFile << root;
-
-      LOG_MSG("Locked package " + name + "!");
+    if (!m_installed.Commit()) {
+      return false;
     }
 
+    LOG_MSG("Locked package " + name + "!");
     return true;
   }
 
   bool Atlas::UnlockPackage(const ntl::String& name) {
-    fs::path dbPath = m_install_dir / "installed.json";
-    Json::Value root;
+    requireInstalledDatabase();
+
+    if (!m_installed.SetLocked(name, false)) {
+      LOG_ERROR("Package not installed");
+      return false;
+    }
 
-    if (fs::exists(dbPath)) {
-      std::ifstream dbFile(dbPath);
-      dbFile >> root;
-      root[name.GetCString()]["locked"] = false;
-      std::ofstream outFile(dbPath);
-      outFile << root;
-      LOG_MSG("Unlocked package " + name + "!");
+    if (!m_installed.Commit()) {
+      return false;
     }
 
+    LOG_MSG("Unlocked package " + name + "!");
     return true;
   }
 
@@ -455,79 +744,128 @@ namespace atlas {
   }
 
   bool Atlas::KeepPackage(const ntl::String& name) {
-    fs::path dbPath = m_install_dir / "installed.json";
-    Json::Value root;
+    requireInstalledDatabase();
 
-    if (!IsInstalled(name)) {
+    if (!m_installed.SetKeep(name, true)) {
       LOG_ERROR("Package not installed");
       return false;
     }
 
-    if (fs::exists(dbPath)) {
-      std::ifstream dbFile(dbPath);
-      dbFile >> root;
-      root[name.GetCString()]["keep"] = true;
-      std::ofstream outFile(dbPath);
-      outFile << root;
-
-      LOG_MSG("Keeping package " + name + "!");
+    if (!m_installed.Commit()) {
+      return false;
     }
+
+    LOG_MSG("Keeping package " + name + "!");
     return true;
   }
 
   bool Atlas::UnkeepPackage(const ntl::String& name) {
-    fs::path dbPath = m_install_dir / "installed.json";
-    Json::Value root;
+    requireInstalledDatabase();
 
-    if (fs::exists(dbPath)) {
-      std::ifstream dbFile(dbPath);
-      dbFile >> root;
-      root[name.GetCString()]["keep"] = false;
-      std::ofstream outFile(dbPath);
-      outFile << root;
+    if (!m_installed.SetKeep(name, false)) {
+      LOG_ERROR("Package not installed");
+      return false;
+    }
 
-      LOG_MSG("Not keeping package " + name + "!");
+    if (!m_installed.Commit()) {
+      return false;
     }
+
+    LOG_MSG("Not keeping package " + name + "!");
     return true;
   }
 
-  std::vector<ntl::String> Atlas::Search(const ntl::String& a_query) {
-    std::vector<ntl::String> results;
-    std::string str;
-    for (const auto& [name, config] : m_package_index) {
-      if (name.Find(a_query) != -1 || config.description.Find(a_query) != -1) {
-        results.push_back(name);
+  std::vector<ntl::String> Atlas::Search(const ntl::String& a_query, size_t a_limit) {
+    requireRepositories();
+
+    std::vector<ntl::String> repositories;
+    m_repositories_lock.StartRead();
+    for (const auto& [name, repo] : m_repositories) {
+      if (repo.enabled)
+        repositories.push_back(name);
+    }
+    m_repositories_lock.EndRead();
+
+    // Names point into the mapped indexes, so they stay open until the results are merged
+    std::vector<std::unique_ptr<SearchIndex>> indexes;
+    std::unordered_map<std::string_view, float> scores;
+    std::vector<SearchIndex::Match> matches;
+    for (const auto& repo : repositories) {
+      auto index = std::make_unique<SearchIndex>();
+      if (!openSearchIndex(repo, *index))
+        continue;
+
+      index->Search(a_query.GetCString(), a_limit, matches);
+      for (const auto& match : matches) {
+        auto [it, inserted] = scores.emplace(match.name, match.score);
+        if (!inserted)
+          it->second = std::max(it->second, match.score);
       }
+      indexes.push_back(std::move(index));
+    }
+
+    std::vector<std::pair<std::string_view, float>> ranked(scores.begin(), scores.end());
+    std::sort(ranked.begin(), ranked.end(), [](const auto& a_lhs, const auto& a_rhs) {
+      if (a_lhs.second != a_rhs.second)
+        return a_lhs.second > a_rhs.second;
+      return a_lhs.first < a_rhs.first;
+    });
+
+    std::vector<ntl::String> results;
+    for (size_t i = 0; i < ranked.size() && i < a_limit; ++i) {
+      results.emplace_back(std::string(ranked[i].first).c_str());
     }
     return results;
   }
 
+  bool Atlas::CreateBottle(const ntl::String& a_package_name, const fs::path& a_directory) {
+    requirePackageIndex();
+
+    PackageView package;
+    if (!m_package_index.Find(a_package_name.GetCString(), package)) {
+      LOG_ERROR("Package not found");
+      return false;
+    }
+
+    // The cached build was keyed with the dependencies installed at the time
+    requireInstalledDatabase();
+    PackageConfig config = package.ToConfig();
+    PackageInstaller installer(m_cache_dir, m_install_dir, getPackageLogDir(config), config, &m_download_cache,
+                               &m_build_cache, m_installer_options, getDependencyBuilds(config, {}));
+    fs::path bottle;
+    if (!installer.CreateBottle(a_directory, bottle))
+      return false;
+
+    ntl::String digest;
+    if (!Sha256::HashFile(bottle, digest)) {
+      LOG_ERROR(ntl::String{"Failed to read "} + bottle.c_str());
+      return false;
+    }
+    LOG_INFO(ntl::String{"Wrote "} + bottle.c_str() + " (" + HOST_ARCH + ", sha256 " + digest + ")");
+    return true;
+  }
+
   void Atlas::Info(const ntl::String& a_package_name) {
-    if (m_package_index.Find(a_package_name) == m_package_index.end()) {
+    requirePackageIndex();
+
+    PackageView package;
+    if (!m_package_index.Find(a_package_name.GetCString(), package)) {
       LOG_ERROR("Package not found");
       return;
     }
 
-    const auto& config = m_package_index[a_package_name];
-    LOG_MSG("Name: " + config.name + "\n"
-      + "Version: " + config.version + "\n"
-      + "Description: " + config.description + "\n"
-      + "Status: " + (IsInstalled(a_package_name) ? GREEN : RED)
-      + (IsInstalled(a_package_name) ? "Installed" : "Not installed")
+    bool installed = IsInstalled(a_package_name);
+    LOG_MSG(ntl::String{"Name: "} + package.GetName() + "\n"
+      + "Version: " + package.GetVersion() + "\n"
+      + "Description: " + package.GetDescription() + "\n"
+      + "Status: " + (installed ? GREEN : RED)
+      + (installed ? "Installed" : "Not installed")
     );
   }
 
   bool Atlas::IsInstalled(const ntl::String& a_package_name) const {
-    fs::path dbPath = m_install_dir / "installed.json";
-    if (!fs::exists(dbPath)) {
-      return false;
-    }
-
-    Json::Value root;
-    std::ifstream dbFile(dbPath);
-    dbFile >> root;
-
-    return root.isMember(a_package_name.GetCString());
+    requireInstalledDatabase();
+    return m_installed.Contains(a_package_name);
   }
 
   bool Atlas::AtlasSetup() {
@@ -603,6 +941,108 @@ namespace atlas {
   }
 
 
+  void Atlas::requireDirectories() {
+    std::call_once(m_directories_once, [this]() {
+      fs::create_directories(m_install_dir);
+      fs::create_directories(m_cache_dir);
+      fs::create_directories(m_shortcut_dir);
+      fs::create_directories(m_log_dir);
+    });
+  }
+
+  void Atlas::requireRepositories() {
+    if (m_repositories_loaded)
+      return;
+
+    requireDirectories();
+
+    ntl::ScopeLock lock(&m_components_lock);
+    if (!m_repositories_loaded) {
+      loadRepositories();
+      m_repositories_loaded = true;
+    }
+  }
+
+  void Atlas::requirePackageIndex() {
+    if (m_package_index_loaded)
+      return;
+
+    requireRepositories();
+
+    ntl::ScopeLock lock(&m_components_lock);
+    if (!m_package_index_loaded) {
+      loadPackageIndex();
+      m_package_index_loaded = true;
+    }
+  }
+
+  void Atlas::invalidatePackageIndex() {
+    ntl::ScopeLock lock(&m_components_lock);
+    m_package_index_loaded = false;
+  }
+
+  void Atlas::requireInstalledDatabase() const {
+    std::call_once(m_installed_once, [this]() {
+      m_installed.Load();
+    });
+  }
+
+  void Atlas::requireJobPool() {
+    // Transfers run on the download manager, so the workers are sized for builds rather than downloads
+    std::call_once(m_job_pool_once, []() {
+      JobSystem::Instance().Initialize();
+    });
+  }
+
+  void Atlas::requireDownloads() {
+    std::call_once(m_downloads_once, [this]() {
+      DownloadManager::Instance().Initialize(m_config.GetNetwork());
+    });
+  }
+
+  void Atlas::requireProcesses() {
+    std::call_once(m_processes_once, []() {
+      ProcessRunner::Instance().Initialize();
+    });
+  }
+
+  void Atlas::requireRunLogDir() {
+    std::call_once(m_run_log_once, [this]() {
+      std::time_t now = std::time(nullptr);
+      std::tm local{};
+      localtime_r(&now, &local);
+      char timestamp[32];
+      std::strftime(timestamp, sizeof(timestamp), "%Y%m%d-%H%M%S", &local);
+
+      std::string run_id = std::string(timestamp) + "-" + std::to_string(getpid());
+      m_run_log_dir = m_log_dir / run_id;
+
+      std::error_code error;
+      fs::create_directories(m_run_log_dir, error);
+      if (error) {
+        LOG_WARN(ntl::String{"Failed to create log directory "} + m_run_log_dir.c_str());
+        return;
+      }
+
+      // A relative link keeps working if the install directory moves
+      fs::path latest = m_log_dir / "latest";
+      fs::remove(latest, error);
+      fs::create_directory_symlink(run_id, latest, error);
+    });
+  }
+
+  fs::path Atlas::getPackageLogDir(const PackageConfig& a_config) {
+    requireRunLogDir();
+    return m_run_log_dir / a_config.name.GetCString();
+  }
+
+  MultiLoadingAnimation& Atlas::animator() {
+    std::call_once(m_animator_once, [this]() {
+      m_animator = std::make_unique<MultiLoadingAnimation>();
+    });
+    return *m_animator;
+  }
+
   void Atlas::loadRepositories() {
     if (!fs::exists(m_repo_config_path)) {
       return;
@@ -615,7 +1055,8 @@ namespace atlas {
     for (const auto& repo : root["repositories"]) {
       Repository r{
         repo["name"].asString().c_str(), repo["url"].asString().c_str(),
-        repo["branch"].asString().c_str(), repo["enabled"].asBool()
+        repo["branch"].asString().c_str(), repo["enabled"].asBool(),
+        repo["etag"].asString().c_str(), repo["revision"].asString().c_str()
       };
       m_repositories[r.name] = r;
     }
@@ -631,6 +1072,8 @@ namespace atlas {
       repoObj["url"] = repo.url.GetCString();
       repoObj["branch"] = repo.branch.GetCString();
       repoObj["enabled"] = repo.enabled;
+      repoObj["etag"] = repo.etag.GetCString();
+      repoObj["revision"] = repo.revision.GetCString();
       repoArray.append(repoObj);
     }
     root["repositories"] = repoArray;
@@ -640,170 +1083,666 @@ namespace atlas {
   }
 
   void Atlas::loadPackageIndex() {
-    m_package_index.Clear();
+    // Every repository collects its packages on its own, they are merged into the index in one go at the end
+    struct RepositoryLoad {
+      ntl::String name;
+      std::unique_ptr<PackageIndexCache> cache;
+      std::vector<PackageConfig> configs;
+    };
+
+    std::vector<RepositoryLoad> loads;
     for (const auto& [name, repo] : m_repositories) {
-      if (!repo.enabled)
+      if (repo.enabled) {
+        loads.push_back({name, std::make_unique<PackageIndexCache>(), {}});
+      }
+    }
+
+    // Opening validates the whole cache, so the caches are opened side by side before reading them in chunks
+    runParallel(loads.size(), [&](size_t a_index) {
+      RepositoryLoad& load = loads[a_index];
+      if (load.cache->Open(getIndexCachePath(load.name))) {
+        load.configs.resize(load.cache->GetPackageCount());
+      } else {
+        load.cache.reset();
+      }
+    });
+
+    struct Chunk {
+      size_t load;
+      size_t begin;
+      size_t end;
+      std::vector<PackageConfig> configs;
+    };
+
+    // No usable cache (first run, format change or corruption), the repository tree is scanned instead
+    std::vector<Chunk> chunks;
+    std::vector<fs::path> parts;
+    for (size_t i = 0; i < loads.size(); ++i) {
+      if (loads[i].cache) {
+        for (size_t begin = 0; begin < loads[i].configs.size(); begin += CACHE_CHUNK_SIZE) {
+          chunks.push_back({i, begin, std::min(begin + CACHE_CHUNK_SIZE, loads[i].configs.size()), {}});
+        }
         continue;
+      }
 
-      fs::path repoPath = m_cache_dir / name.GetCString();
-      for (const auto& entry : fs::recursive_directory_iterator(repoPath)) {
-        if (entry.path().filename() == "package.json") {
-          Json::Value root;
-          std::ifstream config_file(entry.path());
-          config_file >> root;
-
-          PackageConfig config{
-            root["name"].asString().c_str(),
-            root["version"].asString().c_str(),
-            root["description"].asString().c_str(),
-            root["build_command"].asString().c_str(),
-            root["install_command"].asString().c_str(),
-            root["uninstall_command"].asString().c_str(),
-            name,
-            ntl::Array<ntl::String>()
-          };
-          m_package_index[config.name] = config;
+      size_t first = parts.size();
+      splitTree(m_cache_dir / loads[i].name.GetCString(), parts);
+      for (size_t begin = first; begin < parts.size(); begin += SCAN_CHUNK_SIZE) {
+        chunks.push_back({i, begin, std::min(begin + SCAN_CHUNK_SIZE, parts.size()), {}});
+      }
+    }
+
+    runParallel(chunks.size(), [&](size_t a_index) {
+      Chunk& chunk = chunks[a_index];
+      RepositoryLoad& load = loads[chunk.load];
+      for (size_t i = chunk.begin; i < chunk.end; ++i) {
+        if (load.cache) {
+          load.cache->GetPackage(i, load.name, load.configs[i]);
+        } else {
+          scanTree(parts[i], load.name, chunk.configs);
         }
       }
+    });
+
+    for (auto& chunk : chunks) {
+      std::vector<PackageConfig>& configs = loads[chunk.load].configs;
+      std::move(chunk.configs.begin(), chunk.configs.end(), std::back_inserter(configs));
+    }
+    std::vector<size_t> scanned;
+    for (size_t i = 0; i < loads.size(); ++i) {
+      if (!loads[i].cache && !loads[i].configs.empty()) {
+        scanned.push_back(i);
+      }
+    }
+
+    runParallel(scanned.size(), [&](size_t a_index) {
+      writeIndexCaches(loads[scanned[a_index]].name, loads[scanned[a_index]].configs);
+    });
+
+    size_t count = 0;
+    for (const auto& load : loads) {
+      count += load.configs.size();
     }
+
+    m_package_index_lock.StartWrite();
+    m_package_index.Clear();
+    m_package_index.Reserve(count);
+    for (const auto& load : loads) {
+      for (const auto& config : load.configs) {
+        m_package_index.Add(config);
+      }
+    }
+    m_package_index_lock.EndWrite();
   }
 
-  bool Atlas::fetchRepository(const Repository& a_repo) const {
-    fs::path repoPath = m_cache_dir / a_repo.name.GetCString();
-    fs::path zipPath = m_cache_dir / (a_repo.name + ".zip").GetCString();
+  std::vector<PackageConfig> Atlas::scanRepository(const ntl::String& a_repo) const {
+    std::vector<PackageConfig> configs;
+    std::vector<fs::path> parts;
+    splitTree(m_cache_dir / a_repo.GetCString(), parts);
+    for (const auto& part : parts) {
+      scanTree(part, a_repo, configs);
+    }
+    return configs;
+  }
 
-    CURL* curl = curl_easy_init();
-    if (!curl) {
-      LOG_ERROR("Failed to initialize CURL");
+  void Atlas::scanTree(const fs::path& a_path, const ntl::String& a_repo, std::vector<PackageConfig>& a_configs) {
+    std::error_code error;
+    if (!fs::is_directory(a_path, error)) {
+      if (a_path.filename() == "package.json") {
+        parseManifest(a_path, a_repo, a_configs);
+      }
+      return;
+    }
+
+    for (const auto& entry : fs::recursive_directory_iterator(a_path, error)) {
+      if (entry.path().filename() == "package.json") {
+        parseManifest(entry.path(), a_repo, a_configs);
+      }
+    }
+  }
+
+  bool Atlas::parseManifest(const fs::path& a_path, const ntl::String& a_repo,
+                            std::vector<PackageConfig>& a_configs) {
+    std::ifstream config_file(a_path, std::ios::binary);
+    JsonReader reader(config_file);
+    PackageConfig config;
+    Json::Value manifest;
+    if (!config_file || reader.Next() != JsonReader::Token::ObjectBegin ||
+        !readPackage(reader, a_repo, config, manifest) || reader.Next() != JsonReader::Token::End) {
+      bool malformed = reader.GetToken() == JsonReader::Token::Error;
+      const char* reason = malformed ? reader.GetError().c_str() : "Expected a package object";
+      LOG_WARN(ntl::String{"Skipping invalid manifest "} + a_path.c_str() + ": " + reason);
       return false;
     }
 
-    ntl::String url =
-        "https://api.github.com/repos/" + a_repo.url + "/zipball/" + a_repo.branch;
-    FILE* fp = fopen(zipPath.string().c_str(), "wb");
-    if (!fp) {
-      curl_easy_cleanup(curl);
-      LOG_ERROR("Failed to create zip file");
+    config.plan = parseInstallPlan(manifest);
+    a_configs.push_back(std::move(config));
+    return true;
+  }
+
+  bool Atlas::readPackage(JsonReader& a_reader, const ntl::String& a_repo, PackageConfig& a_config,
+                          Json::Value& a_manifest) {
+    using Token = JsonReader::Token;
+    if (a_reader.GetToken() != Token::ObjectBegin)
       return false;
+
+    // Scalars are taken as text like Json::Value::asString does, null is the empty string
+    auto readString = [&a_reader](ntl::String& a_value) {
+      switch (a_reader.Next()) {
+        case Token::String:
+        case Token::Number:
+          a_value = a_reader.GetString().c_str();
+          return true;
+        case Token::Boolean:
+          a_value = a_reader.GetBool() ? "true" : "false";
+          return true;
+        case Token::Null:
+          a_value = "";
+          return true;
+        default:
+          return false;
+      }
+    };
+    auto readList = [&a_reader, &readString](ntl::Array<ntl::String>& a_values) {
+      Token token = a_reader.Next();
+      if (token == Token::Null)
+        return true;
+      if (token != Token::ArrayBegin)
+        return false;
+      while (true) {
+        ntl::String value;
+        if (!readString(value))
+          return a_reader.GetToken() == Token::ArrayEnd;
+        a_values.Insert(value);
+      }
+    };
+
+    static const std::pair<const char*, ntl::String PackageConfig::*> FIELDS[] = {
+      {"name", &PackageConfig::name},
+      {"version", &PackageConfig::version},
+      {"description", &PackageConfig::description},
+      {"build_command", &PackageConfig::build_command},
+      {"install_command", &PackageConfig::install_command},
+      {"uninstall_command", &PackageConfig::uninstall_command}
+    };
+
+    a_config.repository = a_repo;
+    while (a_reader.Next() == Token::Key) {
+      const std::string& key = a_reader.GetString();
+      bool success;
+      if (key == "dependencies") {
+        success = readList(a_config.dependencies);
+      } else if (key == "conflicts") {
+        success = readList(a_config.conflicts);
+      } else if (key == "platforms") {
+        success = a_reader.ReadValue(a_manifest["platforms"]);
+      } else {
+        auto field = std::find_if(std::begin(FIELDS), std::end(FIELDS), [&key](const auto& a_field) {
+          return key == a_field.first;
+        });
+        success = field != std::end(FIELDS) ? readString(a_config.*(field->second)) : a_reader.Skip();
+      }
+      if (!success)
+        return false;
     }
+    return a_reader.GetToken() == Token::ObjectEnd;
+  }
 
-    struct curl_slist* headers = nullptr;
-    headers = curl_slist_append(headers, "Accept: application/vnd.github+json");
-    headers = curl_slist_append(headers, "User-Agent: Atlas-Package-Manager");
+  void Atlas::runParallel(size_t a_count, const std::function<void(size_t)>& a_function) {
+    // A single piece of work is not worth starting the pool for
+    if (a_count <= 1) {
+      for (size_t i = 0; i < a_count; ++i) {
+        a_function(i);
+      }
+      return;
+    }
 
-    curl_easy_setopt(curl, CURLOPT_URL, url.GetCString());
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, nullptr);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, fp);
-    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+    requireJobPool();
+    for (size_t i = 0; i < a_count; ++i) {
+      JobSystem::Instance().AddJob([&a_function, i]() {
+        a_function(i);
+      });
+    }
+    JobSystem::Instance().WaitForJobsToFinish();
+  }
 
-    CURLcode res = curl_easy_perform(curl);
-    fclose(fp);
-    curl_slist_free_all(headers);
-    curl_easy_cleanup(curl);
+  std::shared_ptr<const InstallPlan> Atlas::parseInstallPlan(const Json::Value& a_manifest) {
+    const Json::Value& platform = getMember(getMember(a_manifest, "platforms"), HOST_PLATFORM);
+    if (!platform.isObject())
+      return nullptr;
+
+    // Runs inside index jobs, a wrongly typed field must drop the plan instead of throwing out of the job
+    auto plan = std::make_shared<InstallPlan>();
+    const Json::Value& steps = getMember(platform, "steps");
+    const Json::Value& download = getMember(steps, "download");
+    if (!getText(getMember(download, "url"), plan->url) || !getText(getMember(download, "target"), plan->target) ||
+        !getText(getMember(download, "sha256"), plan->sha256))
+      return nullptr;
+
+    // Bottles are binaries, only the one built for this machine's architecture is of any use
+    const Json::Value& bottle = getMember(getMember(platform, "bottles"), HOST_ARCH);
+    if (!getText(getMember(bottle, "url"), plan->bottle_url) ||
+        !getText(getMember(bottle, "sha256"), plan->bottle_sha256))
+      return nullptr;
+
+    const Json::Value& writes_prefix = getMember(getMember(steps, "install"), "writes_prefix");
+    if (!writes_prefix.isNull() && !writes_prefix.isBool())
+      return nullptr;
+    plan->writes_prefix = writes_prefix.asBool();
+
+    for (size_t step = 0; step < INSTALL_STEP_COUNT; ++step) {
+      const Json::Value& commands = getMember(getMember(steps, GetStepName(static_cast<InstallStep>(step))), "commands");
+      if (!commands.isNull() && !commands.isArray())
+        return nullptr;
+      for (const auto& command : commands) {
+        ntl::String text;
+        if (!getText(command, text))
+          return nullptr;
+        plan->steps[step].Insert(text);
+      }
+    }
+    return plan;
+  }
+
+  fs::path Atlas::getIndexCachePath(const ntl::String& a_repo) const {
+    return m_cache_dir / "index" / (a_repo + ".bin").GetCString();
+  }
+
+  fs::path Atlas::getSearchIndexPath(const ntl::String& a_repo) const {
+    return m_cache_dir / "index" / (a_repo + ".search").GetCString();
+  }
 
-    if (res != CURLE_OK) {
-      LOG_ERROR(ntl::String{"Download failed: "} + curl_easy_strerror(res));
+  bool Atlas::writeIndexCaches(const ntl::String& a_repo, const std::vector<PackageConfig>& a_configs) const {
+    fs::path index_path = getIndexCachePath(a_repo);
+    uint64_t source = 0;
+    if (!PackageIndexCache::Write(index_path, a_configs) || !PackageIndexCache::ReadChecksum(index_path, source)) {
+      LOG_WARN("Failed to write package index cache for " + a_repo);
       return false;
     }
 
-    if (fs::exists(repoPath)) {
-      fs::remove_all(repoPath);
+    if (!SearchIndex::Write(getSearchIndexPath(a_repo), a_configs, source)) {
+      LOG_WARN("Failed to write search index for " + a_repo);
+      return false;
+    }
+    return true;
+  }
+
+  bool Atlas::openSearchIndex(const ntl::String& a_repo, SearchIndex& a_index) {
+    fs::path index_path = getIndexCachePath(a_repo);
+    uint64_t source = 0;
+    if (!PackageIndexCache::ReadChecksum(index_path, source)) {
+      // Loading the package index rebuilds missing caches from the repository tree
+      requirePackageIndex();
+      if (!PackageIndexCache::ReadChecksum(index_path, source))
+        return false;
     }
-    fs::create_directories(repoPath);
 
-    ntl::String cmd = ntl::String{"unzip -o "} + zipPath.string().c_str() + " -d " + repoPath.string().c_str();
-    int extract_result = ProcessCommand(cmd, m_log_dir.string().c_str() + ntl::String{"/latest.log"},
-                                        m_config.GetCore().verbose);
-    fs::remove(zipPath);
+    fs::path search_path = getSearchIndexPath(a_repo);
+    if (a_index.Open(search_path) && a_index.GetSource() == source)
+      return true;
+
+    // Written by an older version or before the package index changed, rebuild it from the cache
+    PackageIndexCache cache;
+    if (!cache.Open(index_path))
+      return false;
 
-    if (extract_result != 0) {
-      LOG_ERROR("Failed to extract repository");
+    std::vector<PackageConfig> configs(cache.GetPackageCount());
+    for (size_t i = 0; i < configs.size(); ++i) {
+      cache.GetPackage(i, a_repo, configs[i]);
+    }
+    if (!SearchIndex::Write(search_path, configs, source)) {
+      LOG_WARN("Failed to write search index for " + a_repo);
       return false;
     }
+    return a_index.Open(search_path) && a_index.GetSource() == source;
+  }
+
+  bool Atlas::fetchRepository(const Repository& a_repo) {
+    requireDownloads();
+
+    bool success = updateRepository(a_repo, DownloadManager::Instance().Perform(createRevisionRequest(a_repo)));
+    saveRepositories();
+    return success;
+  }
 
-    fs::path nested_dir;
-    for (const auto& entry : fs::directory_iterator(repoPath)) {
-      if (fs::is_directory(entry)) {
-        nested_dir = entry.path();
+  DownloadManager::Request Atlas::createRevisionRequest(const Repository& a_repo) const {
+    ntl::String url = "https://api.github.com/repos/" + a_repo.url + "/commits/" + a_repo.branch;
+
+    // Returns the bare commit id, and conditional requests answered with a 304 do not count against the rate limit
+    ntl::Array<ntl::String> headers;
+    headers.Insert("Accept: application/vnd.github.sha");
+    if (!a_repo.etag.IsEmpty() && fs::exists(m_cache_dir / a_repo.name.GetCString())) {
+      headers.Insert("If-None-Match: " + a_repo.etag);
+    }
+
+    return DownloadManager::Request{url, {}, headers, {}};
+  }
+
+  bool Atlas::syncRepository(const Repository& a_repo, const ntl::String& a_revision) {
+    if (!a_repo.revision.IsEmpty() && fs::exists(m_cache_dir / a_repo.name.GetCString())) {
+      if (applyRepositoryChanges(a_repo, a_revision)) {
+        return true;
+      }
+      LOG_DEBUG("Falling back to a full snapshot of " + a_repo.name);
+    }
+
+    return syncRepositorySnapshot(a_repo, a_revision);
+  }
+
+  bool Atlas::applyRepositoryChanges(const Repository& a_repo, const ntl::String& a_revision) {
+    ntl::Array<ntl::String> headers;
+    headers.Insert("Accept: application/vnd.github+json");
+    DownloadManager::Result comparison = DownloadManager::Instance().Perform({
+      "https://api.github.com/repos/" + a_repo.url + "/compare/" + a_repo.revision + "..." + a_revision, {}, headers, {}
+    });
+    if (!comparison.success)
+      return false;
+
+    Json::Value root;
+    Json::CharReaderBuilder builder;
+    std::string errors;
+    std::istringstream stream(comparison.body.GetCString());
+    if (!Json::parseFromStream(builder, stream, &root, &errors))
+      return false;
+
+    // Diverged histories (force pushes), truncated file lists and anything unexpected need the full snapshot
+    ntl::String status;
+    const Json::Value& files = getMember(root, "files");
+    if (!getText(getMember(root, "status"), status) || (!(status == "ahead") && !(status == "identical")) ||
+        (!files.isArray() && !files.isNull()) || files.size() >= MAX_COMPARE_FILES)
+      return false;
+
+    fs::path repoPath = m_cache_dir / a_repo.name.GetCString();
+
+    struct Change {
+      fs::path target;
+      fs::path temporary;
+      std::shared_future<DownloadManager::Result> download;
+    };
+    std::vector<Change> changes;
+    std::vector<fs::path> removals;
+
+    auto resolve = [&repoPath](const std::string& a_file, fs::path& a_path) {
+      fs::path relative = fs::path(a_file).lexically_normal();
+      if (relative.empty() || relative.is_absolute() || *relative.begin() == "..")
+        return false;
+      a_path = repoPath / relative;
+      return true;
+    };
+
+    bool valid = true;
+    for (const auto& file : files) {
+      ntl::String file_status;
+      ntl::String filename;
+      fs::path path;
+      if (!getText(getMember(file, "status"), file_status) || !getText(getMember(file, "filename"), filename) ||
+          !resolve(filename.GetCString(), path)) {
+        valid = false;
         break;
       }
+
+      if (file_status == "renamed") {
+        ntl::String previous_filename;
+        fs::path previous;
+        if (!getText(getMember(file, "previous_filename"), previous_filename) ||
+            !resolve(previous_filename.GetCString(), previous)) {
+          valid = false;
+          break;
+        }
+        if (isManifestPath(previous)) {
+          removals.push_back(previous);
+        }
+      }
+
+      if (file_status == "removed") {
+        if (isManifestPath(path)) {
+          removals.push_back(path);
+        }
+        continue;
+      }
+
+      // The cached tree only holds what the index and the installers read
+      if (!isManifestPath(path)) {
+        continue;
+      }
+
+      fs::create_directories(path.parent_path());
+      fs::path temporary = path;
+      temporary += ".sync";
+
+      // raw.githubusercontent.com serves file contents without using up API requests
+      ntl::String url = "https://raw.githubusercontent.com/" + a_repo.url + "/" + a_revision + "/" +
+                        encodeUrlPath(filename.GetCString());
+      changes.push_back({path, temporary, DownloadManager::Instance().Submit({url, temporary, {}, {}})});
+    }
+
+    for (const auto& change : changes) {
+      valid = change.download.get().success && valid;
+    }
+
+    if (!valid) {
+      for (const auto& change : changes) {
+        fs::remove(change.temporary);
+      }
+      return false;
+    }
+
+    for (const auto& path : removals) {
+      std::error_code error;
+      fs::remove(path, error);
+      // Drop directories that became empty, e.g. when a package was removed
+      for (fs::path parent = path.parent_path(); parent != repoPath && fs::is_empty(parent, error) && !error;
+           parent = parent.parent_path()) {
+        fs::remove(parent, error);
+      }
+    }
+
+    for (const auto& change : changes) {
+      fs::rename(change.temporary, change.target);
     }
 
-    if (!nested_dir.empty()) {
-      for (const auto& entry : fs::directory_iterator(nested_dir)) {
-        fs::rename(entry.path(), repoPath / entry.path().filename());
+    LOG_DEBUG(ntl::String{"Applied "} + static_cast<int>(files.size()) + " changed files to " + a_repo.name);
+    return true;
+  }
+
+  bool Atlas::syncRepositorySnapshot(const Repository& a_repo, const ntl::String& a_revision) {
+    fs::path stagingPath = m_cache_dir / "temp" / a_repo.name.GetCString();
+    fs::remove_all(stagingPath);
+    fs::create_directories(stagingPath);
+
+    // The archive wraps everything in a directory named after the commit, which is stripped while extracting
+    ZipStreamExtractor extractor(stagingPath, 1, [](const fs::path& a_path) {
+      return isManifestPath(a_path);
+    });
+
+    ntl::Array<ntl::String> headers;
+    headers.Insert("Accept: application/vnd.github+json");
+    DownloadManager::Result result = DownloadManager::Instance().Perform({
+      "https://api.github.com/repos/" + a_repo.url + "/zipball/" + a_revision, {}, headers, {},
+      [&extractor](const char* a_data, size_t a_size) {
+        return extractor.Feed(a_data, a_size);
       }
-      fs::remove_all(nested_dir);
+    });
+
+    if (!result.success || !extractor.Finish()) {
+      const ntl::String& error = extractor.GetError().IsEmpty() ? result.error : extractor.GetError();
+      LOG_ERROR("Failed to extract repository: " + error);
+      fs::remove_all(stagingPath);
+      return false;
     }
 
+    syncTree(stagingPath, m_cache_dir / a_repo.name.GetCString());
+    fs::remove_all(stagingPath);
     return true;
   }
 
-  bool Atlas::removePackage(const PackageConfig& a_config) {
-    PackageInstaller installer(m_cache_dir, m_install_dir, m_log_dir, a_config);
+  void Atlas::syncTree(const fs::path& a_source, const fs::path& a_target) {
+    fs::create_directories(a_target);
 
-    bool success = installer.Uninstall();
+    // Drop what no longer exists first, the second pass moves files out of the source
+    std::vector<fs::path> stale;
+    for (const auto& entry : fs::recursive_directory_iterator(a_target)) {
+      if (!fs::exists(a_source / fs::relative(entry.path(), a_target))) {
+        stale.push_back(entry.path());
+      }
+    }
+    for (const auto& path : stale) {
+      fs::remove_all(path);
+    }
+
+    for (const auto& entry : fs::recursive_directory_iterator(a_source)) {
+      fs::path target = a_target / fs::relative(entry.path(), a_source);
+      if (entry.is_directory()) {
+        if (!fs::is_directory(target)) {
+          fs::remove(target);
+          fs::create_directories(target);
+        }
+        continue;
+      }
+
+      if (fs::is_directory(target)) {
+        fs::remove_all(target);
+      } else if (filesEqual(entry.path(), target)) {
+        continue;
+      }
+      fs::rename(entry.path(), target);
+    }
+  }
+
+  bool Atlas::filesEqual(const fs::path& a_lhs, const fs::path& a_rhs) {
+    std::error_code error;
+    if (!fs::is_regular_file(a_rhs, error) || fs::file_size(a_lhs, error) != fs::file_size(a_rhs, error))
+      return false;
+
+    std::ifstream lhs(a_lhs, std::ios::binary);
+    std::ifstream rhs(a_rhs, std::ios::binary);
+    std::array<char, 1 << 16> lhs_buffer{};
+    std::array<char, 1 << 16> rhs_buffer{};
+    while (lhs && rhs) {
+      lhs.read(lhs_buffer.data(), lhs_buffer.size());
+      rhs.read(rhs_buffer.data(), rhs_buffer.size());
+      if (lhs.gcount() != rhs.gcount() ||
+          std::memcmp(lhs_buffer.data(), rhs_buffer.data(), static_cast<size_t>(lhs.gcount())) != 0)
+        return false;
+    }
+    return lhs.eof() && rhs.eof();
+  }
+
+  bool Atlas::removePackage(const PackageConfig& a_config) {
+    requireInstalledDatabase();
+
+    bool success = false;
+    InstalledPackage installed;
+    if (m_installed.Get(a_config.name, installed) && !installed.files.IsEmpty()) {
+      success = removeFiles(a_config.name, installed.files);
+    } else {
+      // Installed before file manifests were recorded, only the package's own commands know its files
+      requireProcesses();
+      PackageInstaller installer(m_cache_dir, m_install_dir, getPackageLogDir(a_config), a_config, nullptr,
+                                 nullptr, m_installer_options);
+      success = installer.Uninstall();
+    }
 
     if (!success) {
       LOG_ERROR("Removal failed for " + a_config.name);
       return false;
     }
 
-    return true;
+    recordRemoval(a_config);
+    return m_installed.Commit();
   }
 
-  void Atlas::recordInstallation(const PackageConfig& a_config) {
-    Json::Value root;
-    fs::path db_path = m_install_dir / "installed.json";
-
-    if (fs::exists(db_path)) {
-      std::ifstream db_file(db_path);
-      db_file >> root;
+  bool Atlas::removeFiles(const ntl::String& a_name, const ntl::Array<ntl::String>& a_files) {
+    // A file another installed package also lists stays until that package is removed as well
+    std::unordered_set<std::string> shared;
+    for (const auto& name : m_installed.GetPackageNames()) {
+      InstalledPackage other;
+      if (name == a_name || !m_installed.Get(name, other))
+        continue;
+      for (const auto& file : other.files) {
+        shared.insert(file.GetCString());
+      }
     }
 
-    Json::Value package;
-    package["version"] = a_config.version.GetCString();
-    package["install_date"] = getCurrentDateTime().GetCString();
-    package["repository"] = a_config.repository.GetCString();
-    package["locked"] = false;
-    package["keep"] = false;
-
-    root[a_config.name.GetCString()] = package;
+    std::vector<fs::path> files;
+    for (const auto& file : a_files) {
+      if (shared.count(file.GetCString()) == 0) {
+        files.emplace_back(file.GetCString());
+      }
+    }
 
-    std::ofstream db_file(db_path);
-    db_file << root;
+    // Unlinks are independent of each other, directories are only removed once all of them are done
+    std::atomic<size_t> failed{0};
+    runParallel((files.size() + REMOVE_CHUNK_SIZE - 1) / REMOVE_CHUNK_SIZE, [&](size_t a_index) {
+      size_t end = std::min(files.size(), (a_index + 1) * REMOVE_CHUNK_SIZE);
+      for (size_t i = a_index * REMOVE_CHUNK_SIZE; i < end; ++i) {
+        if (unlink((m_install_dir / files[i]).c_str()) != 0 && errno != ENOENT) {
+          LOG_WARN(ntl::String{"Failed to remove "} + (m_install_dir / files[i]).c_str() + ": " +
+                   std::strerror(errno));
+          ++failed;
+        }
+      }
+    });
+    InstallTransaction::RemoveEmptyParents(m_install_dir, files);
+    return failed == 0;
   }
 
-  void Atlas::recordRemoval(const PackageConfig& a_config) {
-    Json::Value root;
-    fs::path db_path = m_install_dir / "installed.json";
+  void Atlas::recordInstallation(const PackageConfig& a_config, const std::vector<fs::path>& a_files,
+                                 const ntl::String& a_build_key) {
+    InstalledPackage package{
+      a_config.version,
+      getCurrentDateTime(),
+      a_config.repository,
+      false,
+      false,
+      ntl::Array<ntl::String>(),
+      ntl::Array<ntl::String>(),
+      a_build_key
+    };
 
-    if (fs::exists(db_path)) {
-      std::ifstream db_file(db_path);
-      db_file >> root;
+    // The database only tracks which packages are needed, the version ranges live in the manifests
+    for (const auto& dep : a_config.dependencies) {
+      package.dependencies.Insert(VersionRequirement::GetName(dep));
+    }
+    for (const fs::path& file : a_files) {
+      package.files.Insert(file.generic_string().c_str());
     }
 
-    root.removeMember(a_config.name.GetCString());
+    m_installed.Put(a_config.name, package);
+  }
+
+  std::vector<ntl::String> Atlas::getDependencyBuilds(
+    const PackageConfig& a_config, const std::unordered_map<std::string, ntl::String>& a_planned) {
+    std::vector<ntl::String> builds;
+    for (const auto& dep : a_config.dependencies) {
+      ntl::String name = VersionRequirement::GetName(dep);
+      auto planned = a_planned.find(name.GetCString());
+      InstalledPackage installed;
+      if (planned != a_planned.end()) {
+        builds.push_back(name + "@" + planned->second);
+      } else if (m_installed.Get(name, installed)) {
+        builds.push_back(name + "@" + installed.version + "#" + installed.build_key);
+      } else {
+        builds.push_back(name + "@missing");
+      }
+    }
+    return builds;
+  }
 
-    std::ofstream db_file(db_path);
-    db_file << root;
+  void Atlas::recordRemoval(const PackageConfig& a_config) {
+    m_installed.Remove(a_config.name);
   }
 
   bool Atlas::upgrade(const PackageConfig& a_config) {
-    bool success = true;
-    fs::path dbPath = m_install_dir / "installed.json";
-    Json::Value root;
+    requireInstalledDatabase();
 
-    if (fs::exists(dbPath)) {
-      std::ifstream dbFile(dbPath);
-      dbFile >> root;
-    }
+    bool success = true;
+    InstalledPackage installed;
 
-    if (IsInstalled(a_config.name)) {
-      ntl::String localVersion = root[a_config.name.GetCString()]["version"].asString().c_str();
+    if (m_installed.Get(a_config.name, installed)) {
+      const ntl::String& localVersion = installed.version;
 
-      if (root[a_config.name.GetCString()]["locked"].asBool()) {
+      if (installed.locked) {
         LOG_MSG("Packege locked for updates " + a_config.name);
         return false;
       }
@@ -837,49 +1776,46 @@ namespace atlas {
   }
 
   void Atlas::cleanupPackages() {
-    fs::path dbPath = m_install_dir / "installed.json";
-    if (!fs::exists(dbPath)) {
-      return;
-    }
+    requireInstalledDatabase();
 
-    Json::Value root;
-    std::ifstream dbFile(dbPath);
-    dbFile >> root;
+    ntl::Array<ntl::String> installed = m_installed.GetPackageNames();
 
     // Create a set of all dependencies
     std::set<ntl::String> allDependencies;
-    for (const auto& packageName : root.getMemberNames()) {
-      const auto& deps = root[packageName]["dependencies"];
-      for (const auto& dep : deps) {
-        allDependencies.insert(dep.asString().c_str());
+    for (const auto& packageName : installed) {
+      InstalledPackage package;
+      if (m_installed.Get(packageName, package)) {
+        for (const auto& dep : package.dependencies) {
+          allDependencies.insert(dep);
+        }
       }
     }
 
     // Check each installed package
-    for (const auto& packageName : root.getMemberNames()) {
+    for (const auto& packageName : installed) {
       // Skip if package is a dependency of another package
-      if (allDependencies.contains(packageName.c_str())) {
+      if (allDependencies.contains(packageName)) {
         continue;
       }
 
       // Skip if package is marked to keep
-      bool keepPackage = root[packageName]["keep"].asBool();
-      if (keepPackage) {
-        LOG_MSG(ntl::String{"Package '"} + packageName.c_str() + "' is marked to keep and will not be removed.");
+      InstalledPackage package;
+      if (!m_installed.Get(packageName, package) || package.keep) {
+        LOG_MSG("Package '" + packageName + "' is marked to keep and will not be removed.");
         continue;
       }
 
-      LOG_MSG(ntl::String{"Package '"} + packageName.c_str() + "' is not required by any other package.");
+      LOG_MSG("Package '" + packageName + "' is not required by any other package.");
       LOG_MSG("Do you want to remove it? (y/n): ");
 
       char response;
       std::cin >> response;
 
       if (std::tolower(response) == 'y') {
-        if (remove(packageName.c_str())) {
-          LOG_MSG(ntl::String{"Successfully removed "} + packageName.c_str());
+        if (Remove(packageName)) {
+          LOG_MSG("Successfully removed " + packageName);
         } else {
-          LOG_MSG(ntl::String{"Failed to remove "} + packageName.c_str());
+          LOG_MSG("Failed to remove " + packageName);
         }
       }
     }
@@ -8,25 +8,38 @@
 #ifndef ATLAS_ATLAS_HPP
 #define ATLAS_ATLAS_HPP
 
+#include <atomic>
 #include <cstdlib>
 #include <curl/curl.h>
 #include <filesystem>
 #include <fstream>
+#include <functional>
 #include <iostream>
 #include <json/json.h>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 
 #include <data/Array.hpp>
 #include <data/String.hpp>
 #include <data/Map.hpp>
 #include <os/Lock.hpp>
 
+#include "core/BuildCache.hpp"
 #include "core/Config.hpp"
+#include "core/DownloadCache.hpp"
+#include "core/InstalledDatabase.hpp"
 #include "core/PackageInstaller.hpp"
+#include "core/PackageStore.hpp"
+#include "core/SearchIndex.hpp"
 #include "pods/FetchData.hpp"
 #include "pods/PackageConfig.hpp"
 #include "pods/Repository.hpp"
 #include "pods/InstallerData.hpp"
+#include "utils/DownloadManager.hpp"
+#include "utils/FlatMap.hpp"
+#include "utils/JsonReader.hpp"
 #include "utils/LoadingAnimation.hpp"
 #include "utils/MultiLoadingAnimation.hpp"
 
@@ -47,14 +60,32 @@ namespace atlas {
     const fs::path m_repo_config_path;
     const fs::path m_log_dir;
 
-    MultiLoadingAnimation m_animator;
+    ntl::Lock m_components_lock;
+    std::once_flag m_directories_once;
+    std::once_flag m_job_pool_once;
+    std::once_flag m_downloads_once;
+    std::once_flag m_processes_once;
+    std::once_flag m_animator_once;
+    std::once_flag m_run_log_once;
+    mutable std::once_flag m_installed_once;
 
-    ntl::Map<ntl::String, Repository> m_repositories;
+    std::unique_ptr<MultiLoadingAnimation> m_animator;
+
+    FlatMap<ntl::String, Repository> m_repositories;
+    std::atomic<bool> m_repositories_loaded;
     ntl::SharedLock m_repositories_lock;
 
-    ntl::Map<ntl::String, PackageConfig> m_package_index;
+    PackageStore m_package_index;
+    std::atomic<bool> m_package_index_loaded;
     ntl::SharedLock m_package_index_lock;
 
+    mutable InstalledDatabase m_installed;
+
+    DownloadCache m_download_cache;
+    BuildCache m_build_cache;
+    PackageInstaller::Options m_installer_options;
+    fs::path m_run_log_dir;
+
     FetchData m_fetch_data;
     ntl::SharedLock m_fetch_data_lock;
 
@@ -65,8 +96,8 @@ namespace atlas {
     /**
      * @brief Constructor for the Atlas class.
      *
-     * Initializes the install directory, cache directory, and shortcut directory.
-     * Also initializes the configuration object.
+     * Initializes the configuration object and the logger only. Directories, repositories, the package index,
+     * the job pool and the animator are brought up lazily by the operations that need them.
      *
      * @param a_install Install directory path
      * @param a_cache Cache directory path
@@ -232,12 +263,26 @@ namespace atlas {
     /**
      * @brief Searches for packages matching a specific query in the atlas package manager.
      *
-     * This method searches the internal map of repositories and returns a list of matching packages.
+     * Queries the search index of every enabled repository, rebuilding indexes that are missing or stale, and
+     * merges their results. Matching is case-insensitive and tolerates prefixes and small typos.
      *
      * @param a_query Search query
-     * @return List of matching package names
+     * @param a_limit Maximum number of results
+     * @return Names of the matching packages, best matches first
+     */
+    std::vector<ntl::String> Search(const ntl::String& a_query, size_t a_limit = SearchIndex::DEFAULT_LIMIT);
+
+    /**
+     * @brief Writes a bottle, a prebuilt binary package, of a package built earlier on this machine.
+     *
+     * The bottle is made from the package's entry in the build cache, so the package has to be installed with
+     * the build cache enabled first. Its sha256 is logged for the package manifest.
+     *
+     * @param a_package_name Name of the package
+     * @param a_directory Directory to write the bottle to
+     * @return Whether the bottle was written
      */
-    std::vector<ntl::String> Search(const ntl::String& a_query);
+    bool CreateBottle(const ntl::String& a_package_name, const fs::path& a_directory);
 
     /**
      * @brief Displays information about one or more packages in the atlas package manager.
@@ -277,6 +322,68 @@ namespace atlas {
     bool AtlasPurge();
 
   private:
+    /**
+     * @brief Creates the install, cache, shortcut and log directories once.
+     */
+    void requireDirectories();
+
+    /**
+     * @brief Loads the repositories on first use.
+     */
+    void requireRepositories();
+
+    /**
+     * @brief Loads the package index (and its repositories) on first use or after it was invalidated.
+     */
+    void requirePackageIndex();
+
+    /**
+     * @brief Marks the package index as stale so the next requirePackageIndex() reloads it.
+     */
+    void invalidatePackageIndex();
+
+    /**
+     * @brief Loads the installed package database on first use.
+     */
+    void requireInstalledDatabase() const;
+
+    /**
+     * @brief Initializes the job system thread pool on first use.
+     */
+    void requireJobPool();
+
+    /**
+     * @brief Starts the download manager's event loop on first use.
+     */
+    void requireDownloads();
+
+    /**
+     * @brief Starts the process runner's event loop on first use.
+     */
+    void requireProcesses();
+
+    /**
+     * @brief Creates the log directory of this run on first use and points the "latest" link at it.
+     *
+     * Every run gets <log_dir>/<run-id>, named after its start time and process id.
+     */
+    void requireRunLogDir();
+
+    /**
+     * @brief Returns the directory receiving the step logs of a package in this run.
+     *
+     * @param a_config Package configuration
+     * @return The package's log directory
+     */
+    fs::path getPackageLogDir(const PackageConfig& a_config);
+
+    /**
+     * @brief Returns the progress animator, starting its render thread on first use.
+     *
+     * @return The multi loading animation
+     */
+    MultiLoadingAnimation& animator();
+
     /**
      * @brief Loads all available repositories into memory for caching.
      */
@@ -289,16 +396,219 @@ namespace atlas {
 
     /**
      * @brief Loads package index data from disk or initializes it if not present.
+     *
+     * Each enabled repository is loaded from its memory-mapped binary index cache. Repositories without a
+     * valid cache are scanned once and their cache is rebuilt. Caches are read in chunks of packages and trees
+     * are walked and parsed in chunks of directories on the job system, every chunk collects its packages on
+     * its own and the index lock is only taken once to merge them.
      */
     void loadPackageIndex();
 
     /**
-     * @brief Fetches data from a specific repository using the FetchData class.
+     * @brief Resolves which packages and versions an install request needs, using the dependency resolver.
+     *
+     * @param a_package_names Names of the requested packages
+     * @param a_plan Packages to install, dependencies first
+     * @return Whether a valid install set was found
+     */
+    bool resolveInstallPlan(const ntl::Array<ntl::String>& a_package_names, std::vector<PackageConfig>& a_plan);
+
+    /**
+     * @brief Installs a set of packages, building each one as soon as the packages it depends on are done.
+     *
+     * Dependencies are only followed between packages of the set. A failed package skips its dependents,
+     * independent packages keep going.
+     *
+     * @param a_packages Packages to install
+     * @return Whether every package was installed
+     */
+    bool installPackages(const std::vector<PackageConfig>& a_packages);
+
+    /**
+     * @brief Runs the steps of a package from download to cleanup, stopping at the first failure.
+     *
+     * @param a_installer Installer of the package
+     * @param a_name Name of the package, shown in the status display
+     * @return Whether every step succeeded
+     */
+    bool runInstaller(PackageInstaller& a_installer, const ntl::String& a_name);
+
+    /**
+     * @brief Walks a repository's cached tree and parses every package.json it contains.
+     *
+     * @param a_repo Name of the repository to scan
+     * @return The parsed package configurations
+     */
+    std::vector<PackageConfig> scanRepository(const ntl::String& a_repo) const;
+
+    /**
+     * @brief Parses a package.json, or every package.json below a directory.
+     *
+     * @param a_path File or directory to scan
+     * @param a_repo Name of the repository the packages belong to
+     * @param a_configs Receives the parsed package configurations
+     */
+    static void scanTree(const fs::path& a_path, const ntl::String& a_repo, std::vector<PackageConfig>& a_configs);
+
+    /**
+     * @brief Parses a single package manifest, skipping it with a warning if it is not valid JSON.
+     *
+     * @param a_path Path of the package.json
+     * @param a_repo Name of the repository the package belongs to
+     * @param a_configs Receives the parsed package configuration
+     * @return True if the manifest was parsed, false otherwise
+     */
+    static bool parseManifest(const fs::path& a_path, const ntl::String& a_repo,
+                              std::vector<PackageConfig>& a_configs);
+
+    /**
+     * @brief Reads the package object starting at the current token of a reader.
+     *
+     * Fields are copied straight into the configuration, only the platforms section is materialized as a member
+     * of the given manifest for parseInstallPlan. Unknown fields are skipped.
+     *
+     * @param a_reader Reader positioned on the package object
+     * @param a_repo Name of the repository the package belongs to
+     * @param a_config Receives the package configuration
+     * @param a_manifest Receives the platforms section, if the package has one
+     * @return True if the package was read, false if it is malformed
+     */
+    static bool readPackage(JsonReader& a_reader, const ntl::String& a_repo, PackageConfig& a_config,
+                            Json::Value& a_manifest);
+
+    /**
+     * @brief Runs a function for every index below a count on the job system and waits for all of them.
+     *
+     * Must not be called from a job, a count of one runs on the calling thread.
+     *
+     * @param a_count Number of calls
+     * @param a_function Function taking the index
+     */
+    void runParallel(size_t a_count, const std::function<void(size_t)>& a_function);
+
+    /**
+     * @brief Extracts the host platform's download and step commands from a package manifest.
+     *
+     * @param a_manifest Parsed package manifest
+     * @return The install plan, nullptr if the manifest has no section for the host platform or it is malformed
+     */
+    static std::shared_ptr<const InstallPlan> parseInstallPlan(const Json::Value& a_manifest);
+
+    /**
+     * @brief Returns the path of the binary package index cache for a repository.
+     *
+     * @param a_repo Name of the repository
+     * @return Path to the index cache file
+     */
+    fs::path getIndexCachePath(const ntl::String& a_repo) const;
+
+    /**
+     * @brief Returns the path of the search index for a repository.
+     *
+     * @param a_repo Name of the repository
+     * @return Path to the search index file
+     */
+    fs::path getSearchIndexPath(const ntl::String& a_repo) const;
+
+    /**
+     * @brief Writes a repository's package index cache and the search index built from it.
+     *
+     * @param a_repo Name of the repository
+     * @param a_configs Packages of the repository
+     * @return True if both files were written, false otherwise
+     */
+    bool writeIndexCaches(const ntl::String& a_repo, const std::vector<PackageConfig>& a_configs) const;
+
+    /**
+     * @brief Opens a repository's search index, rebuilding it from the package index cache if it is stale.
+     *
+     * @param a_repo Name of the repository
+     * @param a_index Index to open
+     * @return True if the index is open and up to date, false otherwise
+     */
+    bool openSearchIndex(const ntl::String& a_repo, SearchIndex& a_index);
+
+    /**
+     * @brief Brings a specific repository up to date, waiting for all transfers to finish.
      *
      * @param a_repo Repository to fetch from
      * @return Whether the operation was successful
      */
-    bool fetchRepository(const Repository& a_repo) const;
+    bool fetchRepository(const Repository& a_repo);
+
+    /**
+     * @brief Creates the conditional request resolving the current revision of a repository's branch.
+     *
+     * @param a_repo Repository to check
+     * @return The request to submit to the download manager
+     */
+    DownloadManager::Request createRevisionRequest(const Repository& a_repo) const;
+
+    /**
+     * @brief Syncs and indexes a repository once its revision check finished, and remembers the new revision.
+     *
+     * @param a_repo Repository that was checked
+     * @param a_result Result of the revision check
+     * @return Whether the operation was successful
+     */
+    bool updateRepository(const Repository& a_repo, const DownloadManager::Result& a_result);
+
+    /**
+     * @brief Parses a repository's packages and rewrites its binary index cache.
+     *
+     * @param a_repo Name of the repository
+     * @return Whether the operation was successful
+     */
+    bool indexRepository(const ntl::String& a_repo);
+
+    /**
+     * @brief Brings a repository's cached tree to the given revision.
+     *
+     * Applies only the changed files if the cached tree is at a known revision, and falls back to a full
+     * snapshot otherwise.
+     *
+     * @param a_repo Repository to sync
+     * @param a_revision Commit to sync to
+     * @return Whether the operation was successful
+     */
+    bool syncRepository(const Repository& a_repo, const ntl::String& a_revision);
+
+    /**
+     * @brief Downloads only the files that changed between the cached and the given revision.
+     *
+     * @param a_repo Repository to sync
+     * @param a_revision Commit to sync to
+     * @return Whether the changes were applied, false if a full snapshot is needed
+     */
+    bool applyRepositoryChanges(const Repository& a_repo, const ntl::String& a_revision);
+
+    /**
+     * @brief Downloads the repository archive at the given revision and syncs the cached tree with it.
+     *
+     * @param a_repo Repository to sync
+     * @param a_revision Commit to sync to
+     * @return Whether the operation was successful
+     */
+    bool syncRepositorySnapshot(const Repository& a_repo, const ntl::String& a_revision);
+
+    /**
+     * @brief Makes the target tree match the source tree, touching only files that differ.
+     *
+     * Files are moved out of the source tree.
+     *
+     * @param a_source Tree to take the files from
+     * @param a_target Tree to update
+     */
+    static void syncTree(const fs::path& a_source, const fs::path& a_target);
+
+    /**
+     * @brief Compares the contents of two files.
+     *
+     * @param a_lhs First file
+     * @param a_rhs Second file
+     * @return Whether both files exist and are identical
+     */
+    static bool filesEqual(const fs::path& a_lhs, const fs::path& a_rhs);
 
     /**
      * @brief Removes one or more packages from the atlas package manager by updating the package index.
@@ -308,12 +618,36 @@ namespace atlas {
      */
     bool removePackage(const PackageConfig& a_config);
 
+    /**
+     * @brief Removes the recorded files of a package from the install directory in parallel.
+     *
+     * Files another installed package also records are kept. Directories left empty are removed afterwards.
+     *
+     * @param a_name Name of the package
+     * @param a_files Files of the package, relative to the install directory
+     * @return Whether every file could be removed
+     */
+    bool removeFiles(const ntl::String& a_name, const ntl::Array<ntl::String>& a_files);
+
     /**
      * @brief Records an installation event for one or more packages in the package index.
      *
      * @param a_config Package configuration to record
+     * @param a_files Files the installation placed, relative to the install directory
+     * @param a_build_key Build cache key of the installed build, empty if it could not be cached
+     */
+    void recordInstallation(const PackageConfig& a_config, const std::vector<fs::path>& a_files,
+                            const ntl::String& a_build_key);
+
+    /**
+     * @brief Identifies the build of every dependency of a package, for its build cache key.
+     *
+     * @param a_config Package configuration
+     * @param a_planned Version and build key of the packages installed in this run, by name
+     * @return `<name>@<version>#<build key>` per dependency, in the order the manifest lists them
      */
-    void recordInstallation(const PackageConfig& a_config);
+    std::vector<ntl::String> getDependencyBuilds(const PackageConfig& a_config,
+                                                 const std::unordered_map<std::string, ntl::String>& a_planned);
 
     /**
      * @brief Records a removal event for one or more packages in the package index.
@@ -0,0 +1,401 @@
+/**
+* @file Bottle.cpp
+* @author Marcus Gugacs
+* @date 16.10.26
+* @copyright Copyright (c) 2026 Marcus Gugacs. All rights reserved.
+*/
+
+#include "Bottle.hpp"
+
+#include <algorithm>
+#include <deque>
+#include <fstream>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <json/json.h>
+#include <zstd.h>
+
+#include "Logger.hpp"
+#include "pods/InstallPlan.hpp"
+#include "utils/Sha256.hpp"
+#include "utils/TarStreamExtractor.hpp"
+#include "utils/TarWriter.hpp"
+
+namespace atlas {
+  namespace {
+    constexpr uint64_t MAX_PARALLEL_FRAME_SIZE = 64 << 20;
+
+    /**
+     * @struct Frame
+     * @brief Location of a zstd frame inside a bottle.
+     */
+    struct Frame {
+      size_t offset;
+      size_t size;
+      size_t content_size;
+    };
+
+    /**
+     * @struct DecodedFrame
+     * @brief Decompressed contents of a frame.
+     */
+    struct DecodedFrame {
+      std::unique_ptr<char[]> data;
+      size_t size;
+      ntl::String error;
+    };
+
+    /**
+     * @brief Decompresses a single frame whose content size is known.
+     */
+    DecodedFrame decodeFrame(const char* a_data, const Frame& a_frame) {
+      DecodedFrame decoded{std::unique_ptr<char[]>(new char[a_frame.content_size]), 0, ""};
+      size_t result = ZSTD_decompress(decoded.data.get(), a_frame.content_size, a_data + a_frame.offset,
+                                      a_frame.size);
+      if (ZSTD_isError(result)) {
+        decoded.error = ZSTD_getErrorName(result);
+      } else {
+        decoded.size = result;
+      }
+      return decoded;
+    }
+
+    /**
+     * @brief Checks whether a frame is a skippable frame.
+     */
+    bool isSkippableFrame(const char* a_data, size_t a_size) {
+      if (a_size < 4)
+        return false;
+      uint32_t magic = static_cast<uint32_t>(static_cast<unsigned char>(a_data[0])) |
+                       static_cast<uint32_t>(static_cast<unsigned char>(a_data[1])) << 8 |
+                       static_cast<uint32_t>(static_cast<unsigned char>(a_data[2])) << 16 |
+                       static_cast<uint32_t>(static_cast<unsigned char>(a_data[3])) << 24;
+      return (magic & ZSTD_MAGIC_SKIPPABLE_MASK) == ZSTD_MAGIC_SKIPPABLE_START;
+    }
+
+    /**
+     * @brief Splits a bottle into its frames.
+     *
+     * @return True if every data frame declares its size and is small enough to decode in one piece
+     */
+    bool findFrames(const char* a_data, size_t a_size, std::vector<Frame>& a_frames) {
+      for (size_t offset = 0; offset < a_size;) {
+        size_t size = ZSTD_findFrameCompressedSize(a_data + offset, a_size - offset);
+        if (ZSTD_isError(size))
+          return false;
+
+        // Skippable frames carry metadata of other tools, e.g. pzstd's frame index
+        if (!isSkippableFrame(a_data + offset, a_size - offset)) {
+          unsigned long long content_size = ZSTD_getFrameContentSize(a_data + offset, a_size - offset);
+          if (content_size == ZSTD_CONTENTSIZE_UNKNOWN || content_size == ZSTD_CONTENTSIZE_ERROR ||
+              content_size > MAX_PARALLEL_FRAME_SIZE)
+            return false;
+          if (content_size > 0) {
+            a_frames.push_back({offset, size, static_cast<size_t>(content_size)});
+          }
+        }
+        offset += size;
+      }
+      return true;
+    }
+
+    /**
+     * @brief Returns the name of an entry type as used in the manifest.
+     */
+    const char* getTypeName(mode_t a_mode) {
+      if (S_ISDIR(a_mode))
+        return "directory";
+      if (S_ISLNK(a_mode))
+        return "link";
+      return "file";
+    }
+  }
+
+  bool Bottle::Create(const fs::path& a_path, const ntl::String& a_name, const ntl::String& a_version,
+                      const fs::path& a_root, const std::vector<fs::path>& a_files) {
+    Json::Value manifest;
+    manifest["format"] = FORMAT_VERSION;
+    manifest["name"] = a_name.GetCString();
+    manifest["version"] = a_version.GetCString();
+    manifest["platform"] = HOST_PLATFORM;
+    manifest["arch"] = HOST_ARCH;
+    Json::Value& files = manifest["files"];
+    files = Json::Value(Json::arrayValue);
+    for (const fs::path& file : a_files) {
+      fs::path path = a_root / file;
+      struct stat info{};
+      if (lstat(path.c_str(), &info) != 0) {
+        LOG_ERROR(ntl::String{"Failed to read "} + path.c_str());
+        return false;
+      }
+      if (!S_ISDIR(info.st_mode) && !S_ISLNK(info.st_mode) && !S_ISREG(info.st_mode))
+        continue;
+
+      Json::Value entry;
+      entry["path"] = file.generic_string();
+      entry["type"] = getTypeName(info.st_mode);
+      if (S_ISREG(info.st_mode)) {
+        ntl::String digest;
+        if (!Sha256::HashFile(path, digest)) {
+          LOG_ERROR(ntl::String{"Failed to read "} + path.c_str());
+          return false;
+        }
+        entry["size"] = static_cast<Json::UInt64>(info.st_size);
+        entry["sha256"] = digest.GetCString();
+      } else if (S_ISLNK(info.st_mode)) {
+        std::error_code error;
+        entry["link"] = fs::read_symlink(path, error).string();
+      }
+      files.append(std::move(entry));
+    }
+
+    Json::StreamWriterBuilder builder;
+    builder["indentation"] = "";
+
+    fs::path temporary = a_path.string() + ".tmp";
+    std::ofstream output(temporary, std::ios::binary | std::ios::trunc);
+    if (!output) {
+      LOG_ERROR(ntl::String{"Failed to create "} + temporary.c_str());
+      return false;
+    }
+
+    std::unique_ptr<ZSTD_CCtx, decltype(&ZSTD_freeCCtx)> context(ZSTD_createCCtx(), &ZSTD_freeCCtx);
+    ZSTD_CCtx_setParameter(context.get(), ZSTD_c_compressionLevel, COMPRESSION_LEVEL);
+    ZSTD_CCtx_setParameter(context.get(), ZSTD_c_checksumFlag, 1);
+
+    // Every FRAME_SIZE bytes of tar stream become a frame of their own that declares its size
+    std::string frame;
+    std::string compressed(ZSTD_compressBound(FRAME_SIZE), '\0');
+    auto flush = [&]() {
+      if (frame.empty())
+        return true;
+      size_t size = ZSTD_compress2(context.get(), compressed.data(), compressed.size(), frame.data(), frame.size());
+      frame.clear();
+      if (ZSTD_isError(size))
+        return false;
+      output.write(compressed.data(), static_cast<std::streamsize>(size));
+      return static_cast<bool>(output);
+    };
+
+    TarWriter writer([&](const void* a_data, size_t a_size) {
+      const auto* data = static_cast<const char*>(a_data);
+      while (a_size > 0) {
+        size_t count = std::min(a_size, FRAME_SIZE - frame.size());
+        frame.append(data, count);
+        data += count;
+        a_size -= count;
+        if (frame.size() == FRAME_SIZE && !flush())
+          return false;
+      }
+      return true;
+    });
+
+    bool success = writer.AddData(MANIFEST_NAME, Json::writeString(builder, manifest), 0644);
+    for (const fs::path& file : a_files) {
+      if (!success)
+        break;
+      success = writer.Add(a_root / file, file.generic_string());
+    }
+    success = success && writer.Finish() && flush();
+    output.close();
+    success = success && output;
+
+    std::error_code error;
+    if (success) {
+      fs::rename(temporary, a_path, error);
+    }
+    if (!success || error) {
+      LOG_ERROR(ntl::String{"Failed to write bottle "} + a_path.c_str() + ": " + writer.GetError());
+      fs::remove(temporary, error);
+      return false;
+    }
+    return true;
+  }
+
+  bool Bottle::Extract(const fs::path& a_path, const fs::path& a_target, const ntl::String& a_name,
+                       const ntl::String& a_version, std::vector<fs::path>& a_files) {
+    int fd = open(a_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+      LOG_ERROR(ntl::String{"Failed to open bottle "} + a_path.c_str());
+      return false;
+    }
+
+    struct stat info{};
+    void* mapping = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && info.st_size > 0) {
+      mapping = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if (mapping == MAP_FAILED) {
+      LOG_ERROR(ntl::String{"Failed to read bottle "} + a_path.c_str());
+      return false;
+    }
+
+    TarStreamExtractor extractor(a_target);
+    extractor.SetManifest(MANIFEST_NAME);
+    extractor.SetHashing(true);
+
+    ntl::String error;
+    bool success = decompress(static_cast<const char*>(mapping), static_cast<size_t>(info.st_size), extractor,
+                              error);
+    munmap(mapping, static_cast<size_t>(info.st_size));
+
+    if (success && !extractor.Finish()) {
+      error = extractor.GetError();
+      success = false;
+    }
+    success = success && verify(extractor, a_name, a_version, error);
+
+    if (!success) {
+      LOG_ERROR(ntl::String{"Invalid bottle "} + a_path.c_str() + ": " + error);
+
+      // Children come after their parents, so removing back to front empties directories first
+      const std::vector<fs::path>& files = extractor.GetFiles();
+      std::error_code remove_error;
+      for (auto it = files.rbegin(); it != files.rend(); ++it) {
+        fs::remove(a_target / *it, remove_error);
+      }
+      return false;
+    }
+
+    a_files = extractor.GetFiles();
+    return true;
+  }
+
+  bool Bottle::decompress(const char* a_data, size_t a_size, TarStreamExtractor& a_extractor,
+                          ntl::String& a_error) {
+    std::vector<Frame> frames;
+    if (findFrames(a_data, a_size, frames) && frames.size() > 1) {
+      // Frames are decoded ahead on worker threads and consumed in order, a bounded window caps the memory
+      size_t window = std::max(std::thread::hardware_concurrency(), 1u) * 2;
+      std::deque<std::future<DecodedFrame>> pending;
+      size_t next = 0;
+      while (next < frames.size() || !pending.empty()) {
+        while (next < frames.size() && pending.size() < window) {
+          const Frame& frame = frames[next++];
+          pending.push_back(std::async(std::launch::async, decodeFrame, a_data, frame));
+        }
+
+        DecodedFrame decoded = pending.front().get();
+        pending.pop_front();
+        if (!decoded.error.IsEmpty()) {
+          a_error = decoded.error;
+          return false;
+        }
+        if (!a_extractor.Feed(decoded.data.get(), decoded.size)) {
+          a_error = a_extractor.GetError();
+          return false;
+        }
+      }
+      return true;
+    }
+
+    // Bottles packed by other tools may consist of one frame of unknown size, they are streamed instead
+    std::unique_ptr<ZSTD_DCtx, decltype(&ZSTD_freeDCtx)> context(ZSTD_createDCtx(), &ZSTD_freeDCtx);
+    std::vector<char> buffer(ZSTD_DStreamOutSize());
+    ZSTD_inBuffer input{a_data, a_size, 0};
+    size_t result = 0;
+    while (input.pos < input.size) {
+      ZSTD_outBuffer output{buffer.data(), buffer.size(), 0};
+      result = ZSTD_decompressStream(context.get(), &output, &input);
+      if (ZSTD_isError(result)) {
+        a_error = ZSTD_getErrorName(result);
+        return false;
+      }
+      if (!a_extractor.Feed(buffer.data(), output.pos)) {
+        a_error = a_extractor.GetError();
+        return false;
+      }
+    }
+
+    if (result != 0) {
+      a_error = "Truncated zstd stream";
+      return false;
+    }
+    return true;
+  }
+
+  bool Bottle::verify(const TarStreamExtractor& a_extractor, const ntl::String& a_name,
+                      const ntl::String& a_version, ntl::String& a_error) {
+    const std::string& contents = a_extractor.GetManifest();
+    Json::Value manifest;
+    std::string parse_error;
+    std::unique_ptr<Json::CharReader> reader(Json::CharReaderBuilder().newCharReader());
+    if (contents.empty() ||
+        !reader->parse(contents.data(), contents.data() + contents.size(), &manifest, &parse_error) ||
+        !manifest.isObject()) {
+      a_error = ntl::String{"Missing or unreadable "} + MANIFEST_NAME;
+      return false;
+    }
+
+    // Bottles come from outside, every member is type checked before JsonCpp's throwing accessors read it
+    const Json::Value& format = manifest["format"];
+    if (!format.isInt()) {
+      a_error = ntl::String{"Invalid format in "} + MANIFEST_NAME;
+      return false;
+    }
+    if (format.asInt() != FORMAT_VERSION) {
+      a_error = ntl::String{"Unsupported bottle format "} + format.asInt();
+      return false;
+    }
+    for (const char* key : {"name", "version", "platform", "arch"}) {
+      if (!manifest[key].isString()) {
+        a_error = ntl::String{"Invalid "} + key + " in " + MANIFEST_NAME;
+        return false;
+      }
+    }
+    if (manifest["name"].asString() != a_name.GetCString() ||
+        manifest["version"].asString() != a_version.GetCString()) {
+      a_error = ntl::String{"Bottle holds "} + manifest["name"].asString().c_str() + " " +
+                manifest["version"].asString().c_str();
+      return false;
+    }
+    if (manifest["platform"].asString() != HOST_PLATFORM || manifest["arch"].asString() != HOST_ARCH) {
+      a_error = ntl::String{"Bottle was built for "} + manifest["platform"].asString().c_str() + " " +
+                manifest["arch"].asString().c_str();
+      return false;
+    }
+
+    // Every file written must be listed with its digest, and every listed file must have been written
+    const Json::Value& files = manifest["files"];
+    if (!files.isArray()) {
+      a_error = ntl::String{"Invalid file list in "} + MANIFEST_NAME;
+      return false;
+    }
+    const std::map<fs::path, ntl::String>& digests = a_extractor.GetDigests();
+    size_t listed = 0;
+    for (const auto& file : files) {
+      if (!file.isObject() || !file["type"].isString() || !file["path"].isString()) {
+        a_error = ntl::String{"Invalid file entry in "} + MANIFEST_NAME;
+        return false;
+      }
+      if (file["type"].asString() != "file")
+        continue;
+
+      auto digest = digests.find(fs::path(file["path"].asString()).lexically_normal());
+      if (digest == digests.end()) {
+        a_error = ntl::String{"Missing file "} + file["path"].asString().c_str();
+        return false;
+      }
+      if (!file["sha256"].isString() || !(digest->second == file["sha256"].asString().c_str())) {
+        a_error = ntl::String{"Checksum mismatch for "} + file["path"].asString().c_str();
+        return false;
+      }
+      ++listed;
+    }
+
+    if (listed != digests.size()) {
+      a_error = "Bottle contains files missing from its manifest";
+      return false;
+    }
+    return true;
+  }
+}
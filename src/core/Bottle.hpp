@@ -0,0 +1,95 @@
+/**
+* @file Bottle.hpp
+* @author Marcus Gugacs
+* @date 16.10.26
+* @copyright Copyright (c) 2026 Marcus Gugacs. All rights reserved.
+*/
+
+#ifndef ATLAS_BOTTLE_HPP
+#define ATLAS_BOTTLE_HPP
+
+#include <cstddef>
+#include <filesystem>
+#include <vector>
+
+#include <data/String.hpp>
+
+namespace fs = std::filesystem;
+
+namespace atlas {
+  class TarStreamExtractor;
+
+  /**
+   * @class Bottle
+   * @brief Reads and writes bottles, prebuilt binary packages.
+   *
+   * A bottle is a zstd compressed tar archive of a package's files relative to the install directory. Its first
+   * entry is a JSON manifest naming the package, version, platform and architecture and listing every file with
+   * its type, size and SHA-256 digest. The tar stream is compressed as a sequence of independent zstd frames of
+   * FRAME_SIZE bytes each, so the archive stays readable by any zstd and tar while frames can be decompressed in
+   * parallel on extraction.
+   */
+  class Bottle {
+  public:
+    static constexpr char MANIFEST_NAME[] = ".atlas-bottle.json";
+    static constexpr int FORMAT_VERSION = 1;
+    static constexpr size_t FRAME_SIZE = 8 << 20;
+    static constexpr int COMPRESSION_LEVEL = 12;
+
+    /**
+     * @brief Writes a bottle of the given files.
+     *
+     * @param a_path Path of the bottle to write
+     * @param a_name Name of the package
+     * @param a_version Version of the package
+     * @param a_root Directory the files are relative to
+     * @param a_files Files, directories and links to include, parents must precede their children
+     * @return True if successful, false otherwise
+     */
+    static bool Create(const fs::path& a_path, const ntl::String& a_name, const ntl::String& a_version,
+                       const fs::path& a_root, const std::vector<fs::path>& a_files);
+
+    /**
+     * @brief Unpacks a bottle into a directory and verifies it against its manifest.
+     *
+     * Frames with a known size are decompressed in parallel and handed to the tar extractor in order, other
+     * bottles are decompressed as a single stream. Files of a bottle that fails verification are removed again.
+     *
+     * @param a_path Path of the bottle
+     * @param a_target Directory to unpack to, usually the install prefix
+     * @param a_name Name of the package the bottle must contain
+     * @param a_version Version of the package the bottle must contain
+     * @param a_files Receives the extracted paths, relative to the target directory
+     * @return True if the bottle was unpacked and matches its manifest, false otherwise
+     */
+    static bool Extract(const fs::path& a_path, const fs::path& a_target, const ntl::String& a_name,
+                        const ntl::String& a_version, std::vector<fs::path>& a_files);
+
+  private:
+    /**
+     * @brief Decompresses a whole bottle into a tar extractor.
+     *
+     * @param a_data Contents of the bottle
+     * @param a_size Size of the bottle in bytes
+     * @param a_extractor Extractor receiving the tar stream
+     * @param a_error Receives a description of a decompression error
+     * @return True if the whole bottle was decompressed, false otherwise
+     */
+    static bool decompress(const char* a_data, size_t a_size, TarStreamExtractor& a_extractor,
+                           ntl::String& a_error);
+
+    /**
+     * @brief Checks the extracted files against the bottle's manifest.
+     *
+     * @param a_extractor Extractor that unpacked the bottle
+     * @param a_name Expected package name
+     * @param a_version Expected package version
+     * @param a_error Receives a description of the mismatch
+     * @return True if the bottle matches, false otherwise
+     */
+    static bool verify(const TarStreamExtractor& a_extractor, const ntl::String& a_name,
+                       const ntl::String& a_version, ntl::String& a_error);
+  };
+}
+
+#endif // ATLAS_BOTTLE_HPP
@@ -0,0 +1,136 @@
+/**
+* @file BuildCache.cpp
+* @author Marcus Gugacs
+* @date 16.10.26
+* @copyright Copyright (c) 2026 Marcus Gugacs. All rights reserved.
+*/
+
+#include "BuildCache.hpp"
+
+#include <string>
+
+#include <unistd.h>
+#include <zlib.h>
+
+#include <os/ScopeLock.hpp>
+
+#include "Logger.hpp"
+#include "utils/LruEviction.hpp"
+#include "utils/TarStreamExtractor.hpp"
+#include "utils/TarWriter.hpp"
+
+namespace atlas {
+  namespace {
+    constexpr char ENTRY_EXTENSION[] = ".tar.gz";
+    constexpr char TEMPORARY_DIR[] = "tmp";
+    constexpr unsigned int BUFFER_SIZE = 256 * 1024;
+  }
+
+  BuildCache::BuildCache(const fs::path& a_root, uint64_t a_max_size)
+    : m_root(a_root), m_max_size(a_max_size), m_evict_lock(), m_temporary_count(0) {
+  }
+
+  bool BuildCache::Contains(const ntl::String& a_key) const {
+    std::error_code error;
+    return fs::is_regular_file(getEntryPath(a_key), error);
+  }
+
+  bool BuildCache::Extract(const ntl::String& a_key, const fs::path& a_target) {
+    fs::path entry = getEntryPath(a_key);
+    gzFile file = gzopen(entry.c_str(), "rb");
+    if (!file)
+      return false;
+    gzbuffer(file, BUFFER_SIZE);
+
+    TarStreamExtractor extractor(a_target);
+    std::vector<char> buffer(BUFFER_SIZE);
+    bool success = true;
+    int count = 0;
+    while ((count = gzread(file, buffer.data(), BUFFER_SIZE)) > 0) {
+      if (!extractor.Feed(buffer.data(), static_cast<size_t>(count))) {
+        success = false;
+        break;
+      }
+    }
+    bool corrupt = count < 0;
+    gzclose(file);
+
+    success = success && !corrupt && extractor.Finish();
+    std::error_code error;
+    if (!success) {
+      LOG_ERROR(ntl::String{"Failed to unpack cached build "} + entry.c_str() + ": " +
+                (corrupt ? ntl::String{"corrupt archive"} : extractor.GetError()));
+      fs::remove(entry, error);
+      return false;
+    }
+
+    LruEviction::Touch(entry);
+    return true;
+  }
+
+  bool BuildCache::Store(const ntl::String& a_key, const fs::path& a_source, const std::vector<fs::path>& a_files) {
+    fs::path temporary = createTemporaryPath();
+    gzFile file = gzopen(temporary.c_str(), "wb");
+    if (!file) {
+      LOG_ERROR(ntl::String{"Failed to create "} + temporary.c_str());
+      return false;
+    }
+    gzbuffer(file, BUFFER_SIZE);
+
+    TarWriter writer([file](const void* a_data, size_t a_size) {
+      return gzwrite(file, a_data, static_cast<unsigned int>(a_size)) == static_cast<int>(a_size);
+    });
+    bool success = true;
+    for (const fs::path& path : a_files) {
+      if (!writer.Add(a_source / path, path.generic_string())) {
+        success = false;
+        break;
+      }
+    }
+    success = success && writer.Finish();
+    success = gzclose(file) == Z_OK && success;
+
+    std::error_code error;
+    if (!success) {
+      LOG_ERROR(ntl::String{"Failed to archive build: "} + writer.GetError());
+      fs::remove(temporary, error);
+      return false;
+    }
+
+    fs::path entry = getEntryPath(a_key);
+    fs::create_directories(entry.parent_path(), error);
+
+    // A concurrent build of the same key may have won the race, both archives hold the same build
+    fs::rename(temporary, entry, error);
+    if (error) {
+      fs::remove(temporary, error);
+      LOG_ERROR(ntl::String{"Failed to add "} + entry.c_str() + " to the build cache");
+      return false;
+    }
+
+    Evict();
+    return true;
+  }
+
+  void BuildCache::Evict() {
+    if (m_max_size == 0)
+      return;
+
+    // Archives still being written are not entries yet
+    ntl::ScopeLock lock(&m_evict_lock);
+    LruEviction::Evict(m_root, m_max_size, TEMPORARY_DIR);
+  }
+
+  fs::path BuildCache::getEntryPath(const ntl::String& a_key) const {
+    std::string key = a_key.GetCString();
+    return m_root / key.substr(0, 2) / (key + ENTRY_EXTENSION);
+  }
+
+  fs::path BuildCache::createTemporaryPath() {
+    fs::path directory = m_root / TEMPORARY_DIR;
+    std::error_code error;
+    fs::create_directories(directory, error);
+
+    return directory / (std::to_string(getpid()) + "." + std::to_string(m_temporary_count++));
+  }
+}
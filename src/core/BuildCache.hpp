@@ -0,0 +1,105 @@
+/**
+* @file BuildCache.hpp
+* @author Marcus Gugacs
+* @date 16.10.26
+* @copyright Copyright (c) 2026 Marcus Gugacs. All rights reserved.
+*/
+
+#ifndef ATLAS_BUILD_CACHE_HPP
+#define ATLAS_BUILD_CACHE_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+#include <data/String.hpp>
+#include <os/Lock.hpp>
+
+namespace fs = std::filesystem;
+
+namespace atlas {
+  /**
+   * @class BuildCache
+   * @brief Store of built packages, keyed by everything that went into the build.
+   *
+   * Each entry is a gzip compressed tar archive of the files a package's install step added to the prefix and
+   * lives under `<root>/<first two digits>/<key>.tar.gz`. Entries are written to a temporary file first and
+   * renamed into place, so a reader never sees a partial archive. Like the download cache, the last modification
+   * time of an entry is refreshed on every hit and used to evict the least recently used entries once the store
+   * grows beyond its size limit.
+   */
+  class BuildCache {
+  private:
+    fs::path m_root;
+    uint64_t m_max_size;
+    ntl::Lock m_evict_lock;
+    std::atomic<uint64_t> m_temporary_count;
+
+  public:
+    /**
+     * @brief Constructor, does not touch the disk.
+     *
+     * @param a_root Directory of the store
+     * @param a_max_size Size limit in bytes, 0 disables eviction
+     */
+    BuildCache(const fs::path& a_root, uint64_t a_max_size);
+
+    BuildCache(const BuildCache&) = delete;
+    BuildCache& operator=(const BuildCache&) = delete;
+
+    /**
+     * @brief Checks whether a build is cached.
+     *
+     * @param a_key Lower case hex key of the build
+     * @return True if an entry exists, false otherwise
+     */
+    bool Contains(const ntl::String& a_key) const;
+
+    /**
+     * @brief Unpacks a cached build into a directory.
+     *
+     * An entry that turns out to be corrupt is removed, so the next install builds the package again.
+     *
+     * @param a_key Lower case hex key of the build
+     * @param a_target Directory to unpack to, usually the install prefix
+     * @return True if the whole entry was unpacked, false otherwise
+     */
+    bool Extract(const ntl::String& a_key, const fs::path& a_target);
+
+    /**
+     * @brief Archives files of a directory as the entry of a build.
+     *
+     * Least recently used entries are evicted afterwards if the store exceeds its size limit.
+     *
+     * @param a_key Lower case hex key of the build
+     * @param a_source Directory the files are relative to
+     * @param a_files Files, directories and links to archive, parents must precede their children
+     * @return True if the entry was added, false otherwise
+     */
+    bool Store(const ntl::String& a_key, const fs::path& a_source, const std::vector<fs::path>& a_files);
+
+    /**
+     * @brief Evicts least recently used entries until the store fits its size limit.
+     */
+    void Evict();
+
+  private:
+    /**
+     * @brief Returns the path of the entry with the given key.
+     *
+     * @param a_key Lower case hex key of the build
+     * @return Path of the entry
+     */
+    fs::path getEntryPath(const ntl::String& a_key) const;
+
+    /**
+     * @brief Returns a unique path inside the store to write a new entry to.
+     *
+     * @return Path of the temporary file
+     */
+    fs::path createTemporaryPath();
+  };
+}
+
+#endif // ATLAS_BUILD_CACHE_HPP
@@ -43,7 +43,27 @@ namespace atlas {
     m_network = {
       .timeout = 30,
       .retries = 3,
-      .max_parallel_downloads = 4
+      .max_parallel_downloads = 4,
+      .max_connections_per_host = 6
+    };
+
+    m_cache = {
+      .max_size_mb = 4096,
+      .max_build_size_mb = 8192
+    };
+
+    m_log = {
+      .max_size_mb = 10,
+      .max_files = 5,
+      .sync = "none"
+    };
+
+    m_build = {
+      .timeout = 0,
+      .max_memory_mb = 0,
+      .max_cpu_seconds = 0,
+      .cache = true,
+      .bottles = true
     };
   }
 
@@ -72,6 +92,40 @@ namespace atlas {
         m_network.retries = *retries;
       if (const auto& parallel = network["max_parallel_downloads"].value<int>())
         m_network.max_parallel_downloads = *parallel;
+      if (const auto& per_host = network["max_connections_per_host"].value<int>())
+        m_network.max_connections_per_host = *per_host;
+    }
+
+    // Load cache settings
+    if (const auto& cache = m_config["cache"]) {
+      if (const auto& max_size = cache["max_size_mb"].value<int>())
+        m_cache.max_size_mb = *max_size;
+      if (const auto& max_build_size = cache["max_build_size_mb"].value<int>())
+        m_cache.max_build_size_mb = *max_build_size;
+    }
+
+    // Load log settings
+    if (const auto& log = m_config["log"]) {
+      if (const auto& max_size = log["max_size_mb"].value<int>())
+        m_log.max_size_mb = *max_size;
+      if (const auto& max_files = log["max_files"].value<int>())
+        m_log.max_files = *max_files;
+      if (const auto& sync = log["sync"].value<std::string>())
+        m_log.sync = *sync;
+    }
+
+    // Load build limits
+    if (const auto& build = m_config["build"]) {
+      if (const auto& timeout = build["timeout"].value<int>())
+        m_build.timeout = *timeout;
+      if (const auto& max_memory = build["max_memory_mb"].value<int>())
+        m_build.max_memory_mb = *max_memory;
+      if (const auto& max_cpu = build["max_cpu_seconds"].value<int>())
+        m_build.max_cpu_seconds = *max_cpu;
+      if (const auto& cache = build["cache"].value<bool>())
+        m_build.cache = *cache;
+      if (const auto& bottles = build["bottles"].value<bool>())
+        m_build.bottles = *bottles;
     }
   }
 
@@ -104,6 +158,38 @@ namespace atlas {
     network.insert("timeout", m_network.timeout);
     network.insert("retries", m_network.retries);
     network.insert("max_parallel_downloads", m_network.max_parallel_downloads);
+    network.insert("max_connections_per_host", m_network.max_connections_per_host);
+
+    // Update cache settings
+    if (!m_config.contains("cache")) {
+      m_config.insert("cache", toml::table{});
+    }
+    auto& cache = *m_config.get("cache")->as_table();
+    cache.clear();
+    cache.insert("max_size_mb", m_cache.max_size_mb);
+    cache.insert("max_build_size_mb", m_cache.max_build_size_mb);
+
+    // Update log settings
+    if (!m_config.contains("log")) {
+      m_config.insert("log", toml::table{});
+    }
+    auto& log = *m_config.get("log")->as_table();
+    log.clear();
+    log.insert("max_size_mb", m_log.max_size_mb);
+    log.insert("max_files", m_log.max_files);
+    log.insert("sync", m_log.sync);
+
+    // Update build limits
+    if (!m_config.contains("build")) {
+      m_config.insert("build", toml::table{});
+    }
+    auto& build = *m_config.get("build")->as_table();
+    build.clear();
+    build.insert("timeout", m_build.timeout);
+    build.insert("max_memory_mb", m_build.max_memory_mb);
+    build.insert("max_cpu_seconds", m_build.max_cpu_seconds);
+    build.insert("cache", m_build.cache);
+    build.insert("bottles", m_build.bottles);
   }
 
   Config::Config(): m_config_path(fs::path(getenv("HOME")) / ".config/atlas/config.toml") {
@@ -181,4 +267,59 @@ namespace atlas {
     m_network.max_parallel_downloads = a_count;
     updateTable();
   }
+
+  void Config::SetMaxConnectionsPerHost(int a_count) {
+    m_network.max_connections_per_host = a_count;
+    updateTable();
+  }
+
+  void Config::SetCacheMaxSize(int a_megabytes) {
+    m_cache.max_size_mb = a_megabytes;
+    updateTable();
+  }
+
+  void Config::SetBuildCacheMaxSize(int a_megabytes) {
+    m_cache.max_build_size_mb = a_megabytes;
+    updateTable();
+  }
+
+  void Config::SetLogMaxSize(int a_megabytes) {
+    m_log.max_size_mb = a_megabytes;
+    updateTable();
+  }
+
+  void Config::SetLogMaxFiles(int a_count) {
+    m_log.max_files = a_count;
+    updateTable();
+  }
+
+  void Config::SetLogSync(const std::string& a_policy) {
+    m_log.sync = a_policy;
+    updateTable();
+  }
+
+  void Config::SetBuildTimeout(int a_seconds) {
+    m_build.timeout = a_seconds;
+    updateTable();
+  }
+
+  void Config::SetBuildMaxMemory(int a_megabytes) {
+    m_build.max_memory_mb = a_megabytes;
+    updateTable();
+  }
+
+  void Config::SetBuildMaxCpuTime(int a_seconds) {
+    m_build.max_cpu_seconds = a_seconds;
+    updateTable();
+  }
+
+  void Config::SetBuildCache(bool a_enabled) {
+    m_build.cache = a_enabled;
+    updateTable();
+  }
+
+  void Config::SetBuildBottles(bool a_enabled) {
+    m_build.bottles = a_enabled;
+    updateTable();
+  }
 }
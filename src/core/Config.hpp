@@ -46,6 +46,38 @@ namespace atlas {
       int timeout;
       int retries;
       int max_parallel_downloads;
+      int max_connections_per_host;
+    };
+
+    /**
+     * @struct Cache
+     * @brief Download and build cache configuration structure.
+     */
+    struct Cache {
+      int max_size_mb;
+      int max_build_size_mb;
+    };
+
+    /**
+     * @struct Log
+     * @brief Log file configuration structure.
+     */
+    struct Log {
+      int max_size_mb;
+      int max_files;
+      std::string sync;
+    };
+
+    /**
+     * @struct Build
+     * @brief Limits applied to the commands of package steps.
+     */
+    struct Build {
+      int timeout;
+      int max_memory_mb;
+      int max_cpu_seconds;
+      bool cache;
+      bool bottles;
     };
 
   private:
@@ -54,6 +86,9 @@ namespace atlas {
     Core m_core;
     Paths m_paths;
     Network m_network;
+    Cache m_cache;
+    Log m_log;
+    Build m_build;
 
   public:
     /**
@@ -105,6 +140,27 @@ namespace atlas {
      */
     const Network& GetNetwork() const { return m_network; }
 
+    /**
+     * @brief Returns the download cache configuration struct.
+     *
+     * @return The download cache configuration struct.
+     */
+    const Cache& GetCache() const { return m_cache; }
+
+    /**
+     * @brief Returns the log file configuration struct.
+     *
+     * @return The log file configuration struct.
+     */
+    const Log& GetLog() const { return m_log; }
+
+    /**
+     * @brief Returns the build limits configuration struct.
+     *
+     * @return The build limits configuration struct.
+     */
+    const Build& GetBuild() const { return m_build; }
+
     // Core setters
     /**
      * @brief Sets the verbose flag to the specified value.
@@ -157,6 +213,86 @@ namespace atlas {
      */
     void SetMaxParallelDownloads(int a_count);
 
+    /**
+     * @brief Sets the maximum number of concurrent connections to a single host.
+     *
+     * @param a_count The new maximum number of connections per host.
+     */
+    void SetMaxConnectionsPerHost(int a_count);
+
+    // Cache setters
+    /**
+     * @brief Sets the size limit of the download cache.
+     *
+     * @param a_megabytes The new size limit (in megabytes), 0 disables the limit.
+     */
+    void SetCacheMaxSize(int a_megabytes);
+
+    /**
+     * @brief Sets the size limit of the build cache.
+     *
+     * @param a_megabytes The new size limit (in megabytes), 0 disables the limit.
+     */
+    void SetBuildCacheMaxSize(int a_megabytes);
+
+    // Log setters
+    /**
+     * @brief Sets the size at which log files are rotated.
+     *
+     * @param a_megabytes The new size limit (in megabytes), 0 disables rotation.
+     */
+    void SetLogMaxSize(int a_megabytes);
+
+    /**
+     * @brief Sets how many rotated log files are kept.
+     *
+     * @param a_count The number of old log files to keep.
+     */
+    void SetLogMaxFiles(int a_count);
+
+    /**
+     * @brief Sets how log files are synced to disk.
+     *
+     * @param a_policy One of "none", "fdatasync" or "direct".
+     */
+    void SetLogSync(const std::string& a_policy);
+
+    // Build setters
+    /**
+     * @brief Sets how long a single package command may run.
+     *
+     * @param a_seconds The time limit (in seconds), 0 disables the limit.
+     */
+    void SetBuildTimeout(int a_seconds);
+
+    /**
+     * @brief Sets the address space limit of package commands.
+     *
+     * @param a_megabytes The memory limit (in megabytes), 0 disables the limit.
+     */
+    void SetBuildMaxMemory(int a_megabytes);
+
+    /**
+     * @brief Sets the CPU time limit of package commands.
+     *
+     * @param a_seconds The CPU time limit (in seconds), 0 disables the limit.
+     */
+    void SetBuildMaxCpuTime(int a_seconds);
+
+    /**
+     * @brief Sets whether built packages are cached and reused.
+     *
+     * @param a_enabled True to reuse cached builds.
+     */
+    void SetBuildCache(bool a_enabled);
+
+    /**
+     * @brief Sets whether prebuilt bottles are preferred over building from source.
+     *
+     * @param a_enabled True to install bottles where packages offer them.
+     */
+    void SetBuildBottles(bool a_enabled);
+
   private:
     /**
      * @brief Expands an absolute path by replacing any environment variables with their actual values.
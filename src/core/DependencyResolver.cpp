@@ -0,0 +1,480 @@
+/**
+* @file DependencyResolver.cpp
+* @author Marcus Gugacs
+* @date 16.10.26
+* @copyright Copyright (c) 2026 Marcus Gugacs. All rights reserved.
+*/
+
+#include "DependencyResolver.hpp"
+
+#include <algorithm>
+#include <deque>
+#include <fstream>
+#include <set>
+#include <sstream>
+
+#include <z3++.h>
+
+#include "Logger.hpp"
+#include "utils/Sha256.hpp"
+#include "utils/Version.hpp"
+
+namespace atlas {
+  namespace {
+    constexpr char CACHE_FORMAT[] = "atlas-resolution 1";
+    constexpr size_t MAX_CACHED_RESOLUTIONS = 64;
+
+    std::string describe(const PackageConfig& a_config) {
+      return std::string(a_config.name.GetCString()) + " " + a_config.version.GetCString();
+    }
+
+    void hashField(Sha256& a_hash, const ntl::String& a_value) {
+      a_hash.Update(a_value.GetCString(), a_value.GetSize());
+      a_hash.Update("\x1f", 1);
+    }
+  }
+
+  DependencyResolver::DependencyResolver(const fs::path& a_cache_dir)
+    : m_cache_dir(a_cache_dir), m_available(), m_installed(), m_error() {
+  }
+
+  void DependencyResolver::AddAvailable(const PackageConfig& a_config) {
+    m_available[a_config.name.GetCString()].push_back(a_config);
+  }
+
+  void DependencyResolver::AddInstalled(const ntl::String& a_name, const InstalledPackage& a_package) {
+    m_installed[a_name.GetCString()] = a_package;
+  }
+
+  bool DependencyResolver::Resolve(const ntl::Array<ntl::String>& a_requests, std::vector<PackageConfig>& a_plan) {
+    m_error = "";
+    a_plan.clear();
+
+    std::map<std::string, Package> packages;
+    collectPackages(a_requests, packages);
+
+    for (const auto& request : a_requests) {
+      const Package& package = packages[request.GetCString()];
+      bool available = std::any_of(package.candidates.begin(), package.candidates.end(),
+                                   [](const Candidate& a_candidate) { return a_candidate.available; });
+      if (!available) {
+        m_error = "Package not found: " + request;
+        return false;
+      }
+    }
+
+    ntl::String key = computeKey(packages);
+    if (loadCachedPlan(key, packages, a_plan)) {
+      LOG_DEBUG("Using cached dependency resolution " + key);
+      return true;
+    }
+
+    std::map<std::string, int> selection;
+    if (!solve(packages, selection) || !orderPlan(packages, selection, a_plan)) {
+      a_plan.clear();
+      return false;
+    }
+
+    storeCachedPlan(key, a_plan);
+    return true;
+  }
+
+  void DependencyResolver::collectPackages(const ntl::Array<ntl::String>& a_requests,
+                                           std::map<std::string, Package>& a_packages) const {
+    std::deque<std::string> queue;
+
+    auto visit = [&](const std::string& a_name) {
+      if (a_packages.contains(a_name))
+        return;
+
+      Package package{{}, -1, false, false};
+      if (auto available = m_available.find(a_name); available != m_available.end()) {
+        for (const auto& config : available->second) {
+          package.candidates.push_back({config, true, 0});
+        }
+      }
+
+      auto installed = m_installed.find(a_name);
+      if (installed != m_installed.end()) {
+        bool offered = std::any_of(package.candidates.begin(), package.candidates.end(),
+                                   [&](const Candidate& a_candidate) {
+                                     return Version::Compare(a_candidate.config.version,
+                                                             installed->second.version) == 0;
+                                   });
+
+        // Installed versions no repository offers anymore can be kept, but never installed again
+        if (!offered) {
+          PackageConfig config{a_name.c_str(), installed->second.version, "", "", "", "",
+                               installed->second.repository, installed->second.dependencies};
+          package.candidates.push_back({config, false, 0});
+        }
+        package.locked = installed->second.locked;
+      }
+
+      // Newest first, so the rank of a candidate is the number of newer versions
+      std::stable_sort(package.candidates.begin(), package.candidates.end(),
+                       [](const Candidate& a_lhs, const Candidate& a_rhs) {
+                         int result = Version::Compare(a_lhs.config.version, a_rhs.config.version);
+                         return result != 0 ? result > 0 : a_lhs.config.repository < a_rhs.config.repository;
+                       });
+      for (size_t i = 0; i < package.candidates.size(); ++i) {
+        bool newer = i > 0 && Version::Compare(package.candidates[i - 1].config.version,
+                                               package.candidates[i].config.version) != 0;
+        package.candidates[i].rank = i == 0 ? 0 : package.candidates[i - 1].rank + (newer ? 1 : 0);
+
+        if (installed != m_installed.end() && package.installed < 0 &&
+            Version::Compare(package.candidates[i].config.version, installed->second.version) == 0) {
+          package.installed = static_cast<int>(i);
+        }
+      }
+
+      a_packages[a_name] = std::move(package);
+      queue.push_back(a_name);
+    };
+
+    for (const auto& request : a_requests) {
+      visit(request.GetCString());
+      a_packages[request.GetCString()].requested = true;
+    }
+    for (const auto& [name, installed] : m_installed) {
+      visit(name);
+    }
+
+    // Conflicts only matter between packages that are part of the problem anyway, so only follow dependencies
+    while (!queue.empty()) {
+      std::string name = std::move(queue.front());
+      queue.pop_front();
+
+      std::vector<std::string> dependencies;
+      for (const auto& candidate : a_packages[name].candidates) {
+        for (const auto& dep : candidate.config.dependencies) {
+          dependencies.emplace_back(VersionRequirement::GetName(dep).GetCString());
+        }
+      }
+      for (const auto& dependency : dependencies) {
+        visit(dependency);
+      }
+    }
+  }
+
+  ntl::String DependencyResolver::computeKey(const std::map<std::string, Package>& a_packages) {
+    Sha256 hash;
+    hash.Update(CACHE_FORMAT, sizeof(CACHE_FORMAT));
+
+    for (const auto& [name, package] : a_packages) {
+      hashField(hash, name.c_str());
+      hashField(hash, ntl::String{""} + package.installed + (package.locked ? "L" : "") +
+                      (package.requested ? "R" : ""));
+      for (const auto& candidate : package.candidates) {
+        hashField(hash, candidate.config.version);
+        hashField(hash, candidate.config.repository);
+        hashField(hash, candidate.available ? "A" : "I");
+        for (const auto& dep : candidate.config.dependencies) {
+          hashField(hash, dep);
+        }
+        hashField(hash, "|");
+        for (const auto& conflict : candidate.config.conflicts) {
+          hashField(hash, conflict);
+        }
+        hashField(hash, "\n");
+      }
+    }
+
+    return hash.Finalize();
+  }
+
+  bool DependencyResolver::solve(const std::map<std::string, Package>& a_packages,
+                                 std::map<std::string, int>& a_selection) {
+    try {
+      z3::context context;
+      z3::optimize optimizer(context);
+
+      std::map<std::string, std::vector<z3::expr>> choices;
+      std::vector<z3::expr> structure;
+      std::vector<std::pair<z3::expr, std::string>> requirements;
+
+      size_t variable_count = 0;
+      for (const auto& [name, package] : a_packages) {
+        std::vector<z3::expr>& variables = choices[name];
+        z3::expr_vector vector(context);
+        for (size_t i = 0; i < package.candidates.size(); ++i) {
+          variables.push_back(context.bool_const(("x" + std::to_string(variable_count++)).c_str()));
+          vector.push_back(variables.back());
+        }
+
+        if (vector.size() > 1) {
+          structure.push_back(z3::atmost(vector, 1));
+        }
+      }
+
+      auto anyOf = [&](const std::string& a_name, auto&& a_accept) {
+        z3::expr_vector options(context);
+        auto package = a_packages.find(a_name);
+        if (package != a_packages.end()) {
+          for (size_t i = 0; i < package->second.candidates.size(); ++i) {
+            if (a_accept(package->second.candidates[i])) {
+              options.push_back(choices[a_name][i]);
+            }
+          }
+        }
+        return options.empty() ? context.bool_val(false) : z3::mk_or(options);
+      };
+
+      for (const auto& [name, package] : a_packages) {
+        const std::vector<z3::expr>& variables = choices[name];
+
+        if (package.requested) {
+          requirements.emplace_back(anyOf(name, [](const Candidate& a_candidate) { return a_candidate.available; }),
+                                    name + " was requested");
+        } else if (package.installed >= 0) {
+          requirements.emplace_back(anyOf(name, [](const Candidate&) { return true; }), name + " is installed");
+        }
+
+        if (package.locked && package.installed >= 0) {
+          requirements.emplace_back(variables[package.installed],
+                                    describe(package.candidates[package.installed].config) + " is locked");
+        }
+
+        for (size_t i = 0; i < package.candidates.size(); ++i) {
+          const Candidate& candidate = package.candidates[i];
+
+          for (const auto& dep : candidate.config.dependencies) {
+            VersionRequirement requirement;
+            if (!VersionRequirement::Parse(dep, requirement)) {
+              requirements.emplace_back(!variables[i], describe(candidate.config) + " has an invalid dependency '" +
+                                                       dep.GetCString() + "'");
+              continue;
+            }
+
+            std::string target = requirement.GetName().GetCString();
+            // Entries recorded for installed packages only know names, missing ones must not block anything
+            if (!candidate.available && (!a_packages.contains(target) || a_packages.at(target).candidates.empty()))
+              continue;
+
+            requirements.emplace_back(z3::implies(variables[i], anyOf(target, [&](const Candidate& a_candidate) {
+              return requirement.Matches(a_candidate.config.version);
+            })), describe(candidate.config) + " requires " + dep.GetCString());
+          }
+
+          for (const auto& conflict : candidate.config.conflicts) {
+            VersionRequirement requirement;
+            if (!VersionRequirement::Parse(conflict, requirement))
+              continue;
+
+            std::string target = requirement.GetName().GetCString();
+            if (target == name)
+              continue;
+
+            requirements.emplace_back(z3::implies(variables[i], !anyOf(target, [&](const Candidate& a_candidate) {
+              return requirement.Matches(a_candidate.config.version);
+            })), describe(candidate.config) + " conflicts with " + conflict.GetCString());
+          }
+        }
+      }
+
+      for (const auto& constraint : structure) {
+        optimizer.add(constraint);
+      }
+      for (const auto& [constraint, description] : requirements) {
+        optimizer.add(constraint);
+      }
+
+      // Touch as little as possible first, then prefer newer versions
+      z3::expr_vector changes(context);
+      z3::expr_vector staleness(context);
+      for (const auto& [name, package] : a_packages) {
+        const std::vector<z3::expr>& variables = choices[name];
+        if (!package.requested) {
+          z3::expr changed = package.installed >= 0 ? !variables[package.installed]
+                                                    : anyOf(name, [](const Candidate&) { return true; });
+          changes.push_back(z3::ite(changed, context.int_val(1), context.int_val(0)));
+        }
+        for (size_t i = 0; i < package.candidates.size(); ++i) {
+          if (package.candidates[i].rank > 0) {
+            z3::expr rank = context.int_val(package.candidates[i].rank);
+            staleness.push_back(z3::ite(variables[i], rank, context.int_val(0)));
+          }
+        }
+      }
+      if (!changes.empty()) {
+        optimizer.minimize(z3::sum(changes));
+      }
+      if (!staleness.empty()) {
+        optimizer.minimize(z3::sum(staleness));
+      }
+
+      z3::check_result result = optimizer.check();
+      if (result == z3::sat) {
+        z3::model model = optimizer.get_model();
+        for (const auto& [name, variables] : choices) {
+          for (size_t i = 0; i < variables.size(); ++i) {
+            if (model.eval(variables[i], true).is_true()) {
+              a_selection[name] = static_cast<int>(i);
+              break;
+            }
+          }
+        }
+        return true;
+      }
+
+      if (result == z3::unknown) {
+        m_error = ntl::String{"Dependency resolution failed: "} + Z3_optimize_get_reason_unknown(context, optimizer);
+        return false;
+      }
+
+      // Track every requirement with its own literal so the unsat core names the ones that clash
+      z3::solver solver(context);
+      z3::expr_vector assumptions(context);
+      std::map<std::string, size_t> indicators;
+      for (const auto& constraint : structure) {
+        solver.add(constraint);
+      }
+      for (size_t i = 0; i < requirements.size(); ++i) {
+        std::string indicator = "r" + std::to_string(i);
+        z3::expr literal = context.bool_const(indicator.c_str());
+        solver.add(z3::implies(literal, requirements[i].first));
+        assumptions.push_back(literal);
+        indicators[indicator] = i;
+      }
+
+      std::string explanation;
+      if (solver.check(assumptions) == z3::unsat) {
+        z3::expr_vector core = solver.unsat_core();
+        for (unsigned i = 0; i < core.size(); ++i) {
+          auto indicator = indicators.find(core[i].decl().name().str());
+          if (indicator != indicators.end()) {
+            explanation += "\n  " + requirements[indicator->second].second;
+          }
+        }
+      }
+
+      m_error = ntl::String{"No valid set of packages satisfies all requirements:"} + explanation.c_str();
+      return false;
+    } catch (const z3::exception& e) {
+      m_error = ntl::String{"Dependency resolution failed: "} + e.msg();
+      return false;
+    }
+  }
+
+  bool DependencyResolver::orderPlan(const std::map<std::string, Package>& a_packages,
+                                     const std::map<std::string, int>& a_selection,
+                                     std::vector<PackageConfig>& a_plan) {
+    // Packages kept at their installed version need no work
+    std::map<std::string, const Candidate*> pending;
+    for (const auto& [name, index] : a_selection) {
+      const Package& package = a_packages.at(name);
+      if (package.requested || index != package.installed) {
+        pending[name] = &package.candidates[index];
+      }
+    }
+
+    std::map<std::string, std::set<std::string>> dependents;
+    std::map<std::string, size_t> blockers;
+    for (const auto& [name, candidate] : pending) {
+      blockers[name];
+      for (const auto& dep : candidate->config.dependencies) {
+        std::string target = VersionRequirement::GetName(dep).GetCString();
+        if (target != name && pending.contains(target) && dependents[target].insert(name).second) {
+          ++blockers[name];
+        }
+      }
+    }
+
+    std::set<std::string> ready;
+    for (const auto& [name, count] : blockers) {
+      if (count == 0) {
+        ready.insert(name);
+      }
+    }
+
+    while (!ready.empty()) {
+      std::string name = *ready.begin();
+      ready.erase(ready.begin());
+      a_plan.push_back(pending[name]->config);
+
+      for (const auto& dependent : dependents[name]) {
+        if (--blockers[dependent] == 0) {
+          ready.insert(dependent);
+        }
+      }
+    }
+
+    if (a_plan.size() != pending.size()) {
+      std::string cycle;
+      for (const auto& [name, count] : blockers) {
+        if (count > 0) {
+          cycle += (cycle.empty() ? "" : ", ") + name;
+        }
+      }
+      m_error = ntl::String{"Dependency cycle between "} + cycle.c_str();
+      return false;
+    }
+
+    return true;
+  }
+
+  bool DependencyResolver::loadCachedPlan(const ntl::String& a_key, const std::map<std::string, Package>& a_packages,
+                                          std::vector<PackageConfig>& a_plan) const {
+    std::ifstream file(m_cache_dir / a_key.GetCString());
+    std::string line;
+    if (!file || !std::getline(file, line) || line != CACHE_FORMAT)
+      return false;
+
+    std::vector<PackageConfig> plan;
+    while (std::getline(file, line)) {
+      std::istringstream fields(line);
+      std::string name, version, repository;
+      if (!std::getline(fields, name, '\t') || !std::getline(fields, version, '\t'))
+        return false;
+      std::getline(fields, repository);
+
+      auto package = a_packages.find(name);
+      if (package == a_packages.end())
+        return false;
+
+      auto candidate = std::find_if(package->second.candidates.begin(), package->second.candidates.end(),
+                                    [&](const Candidate& a_candidate) {
+                                      return a_candidate.available && a_candidate.config.version == version.c_str() &&
+                                             a_candidate.config.repository == repository.c_str();
+                                    });
+      if (candidate == package->second.candidates.end())
+        return false;
+      plan.push_back(candidate->config);
+    }
+
+    a_plan = std::move(plan);
+    return true;
+  }
+
+  void DependencyResolver::storeCachedPlan(const ntl::String& a_key, const std::vector<PackageConfig>& a_plan) const {
+    std::error_code error;
+    fs::create_directories(m_cache_dir, error);
+
+    fs::path path = m_cache_dir / a_key.GetCString();
+    fs::path temp_path = path;
+    temp_path += ".tmp";
+    {
+      std::ofstream file(temp_path);
+      file << CACHE_FORMAT << '\n';
+      for (const auto& config : a_plan) {
+        file << config.name.GetCString() << '\t' << config.version.GetCString() << '\t'
+             << config.repository.GetCString() << '\n';
+      }
+      if (!file)
+        return;
+    }
+    fs::rename(temp_path, path, error);
+
+    std::vector<std::pair<fs::file_time_type, fs::path>> entries;
+    for (const auto& entry : fs::directory_iterator(m_cache_dir, error)) {
+      entries.emplace_back(entry.last_write_time(error), entry.path());
+    }
+    if (entries.size() <= MAX_CACHED_RESOLUTIONS)
+      return;
+
+    std::sort(entries.begin(), entries.end());
+    for (size_t i = 0; i + MAX_CACHED_RESOLUTIONS < entries.size(); ++i) {
+      fs::remove(entries[i].second, error);
+    }
+  }
+}
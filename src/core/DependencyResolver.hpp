@@ -0,0 +1,163 @@
+/**
+* @file DependencyResolver.hpp
+* @author Marcus Gugacs
+* @date 16.10.26
+* @copyright Copyright (c) 2026 Marcus Gugacs. All rights reserved.
+*/
+
+#ifndef ATLAS_DEPENDENCY_RESOLVER_HPP
+#define ATLAS_DEPENDENCY_RESOLVER_HPP
+
+#include <filesystem>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <data/Array.hpp>
+#include <data/String.hpp>
+
+#include "pods/InstalledPackage.hpp"
+#include "pods/PackageConfig.hpp"
+
+namespace fs = std::filesystem;
+
+namespace atlas {
+  /**
+   * @class DependencyResolver
+   * @brief Picks the set of package versions to install using the Z3 optimizer.
+   *
+   * Every available version of every package that can be reached from the request or is already installed
+   * becomes a boolean choice. At most one version per package may be chosen, requested and installed packages
+   * must stay present, dependency ranges must be satisfied and conflicting versions are mutually exclusive.
+   * Among all valid solutions the one changing the fewest installed packages and pulling in the fewest new
+   * ones is preferred, ties are broken towards newer versions.
+   *
+   * Resolutions are cached on disk keyed by a hash of everything the problem was built from, so repeating an
+   * install against the same index and installed state does not invoke the solver again.
+   */
+  class DependencyResolver {
+  private:
+    /**
+     * @struct Candidate
+     * @brief One version of a package the solver may pick.
+     */
+    struct Candidate {
+      PackageConfig config;
+      bool available;
+      int rank;
+    };
+
+    /**
+     * @struct Package
+     * @brief All versions of a package that are part of the problem.
+     */
+    struct Package {
+      std::vector<Candidate> candidates;
+      int installed;
+      bool locked;
+      bool requested;
+    };
+
+    fs::path m_cache_dir;
+    std::map<std::string, std::vector<PackageConfig>> m_available;
+    std::map<std::string, InstalledPackage> m_installed;
+    ntl::String m_error;
+
+  public:
+    /**
+     * @brief Constructor, does not touch the disk.
+     *
+     * @param a_cache_dir Directory to cache resolutions in
+     */
+    explicit DependencyResolver(const fs::path& a_cache_dir);
+
+    /**
+     * @brief Adds a version of a package offered by a repository.
+     *
+     * @param a_config Package configuration of that version
+     */
+    void AddAvailable(const PackageConfig& a_config);
+
+    /**
+     * @brief Adds a package that is currently installed.
+     *
+     * @param a_name Name of the package
+     * @param a_package Installed database entry of the package
+     */
+    void AddInstalled(const ntl::String& a_name, const InstalledPackage& a_package);
+
+    /**
+     * @brief Resolves the packages to install for a request.
+     *
+     * @param a_requests Names of the packages to install, they are installed even if already present
+     * @param a_plan Packages to install, every package comes after the packages it depends on
+     * @return True if a valid install set exists, false otherwise (see GetError())
+     */
+    bool Resolve(const ntl::Array<ntl::String>& a_requests, std::vector<PackageConfig>& a_plan);
+
+    /**
+     * @brief Returns why the last resolution failed.
+     *
+     * @return Description of the problem
+     */
+    const ntl::String& GetError() const { return m_error; }
+
+  private:
+    /**
+     * @brief Collects the requested and installed packages and everything they may depend on.
+     *
+     * @param a_requests Names of the requested packages
+     * @param a_packages Map to fill
+     */
+    void collectPackages(const ntl::Array<ntl::String>& a_requests, std::map<std::string, Package>& a_packages) const;
+
+    /**
+     * @brief Hashes everything a resolution depends on.
+     *
+     * @param a_packages Packages of the problem
+     * @return Hex encoded key
+     */
+    static ntl::String computeKey(const std::map<std::string, Package>& a_packages);
+
+    /**
+     * @brief Encodes the problem for Z3 and picks one candidate per selected package.
+     *
+     * @param a_packages Packages of the problem
+     * @param a_selection Map from package name to the index of the chosen candidate
+     * @return True if the problem is satisfiable, false otherwise
+     */
+    bool solve(const std::map<std::string, Package>& a_packages, std::map<std::string, int>& a_selection);
+
+    /**
+     * @brief Turns a selection into an install plan ordered by dependencies.
+     *
+     * @param a_packages Packages of the problem
+     * @param a_selection Chosen candidate per package
+     * @param a_plan Plan to fill
+     * @return True if successful, false if the packages to install depend on each other in a cycle
+     */
+    bool orderPlan(const std::map<std::string, Package>& a_packages, const std::map<std::string, int>& a_selection,
+                   std::vector<PackageConfig>& a_plan);
+
+    /**
+     * @brief Reads a cached resolution.
+     *
+     * @param a_key Key of the problem
+     * @param a_packages Packages of the problem
+     * @param a_plan Plan to fill
+     * @return True on a hit, false otherwise
+     */
+    bool loadCachedPlan(const ntl::String& a_key, const std::map<std::string, Package>& a_packages,
+                        std::vector<PackageConfig>& a_plan) const;
+
+    /**
+     * @brief Writes a resolution to the cache and drops the oldest cached resolutions.
+     *
+     * @param a_key Key of the problem
+     * @param a_plan Plan to store
+     */
+    void storeCachedPlan(const ntl::String& a_key, const std::vector<PackageConfig>& a_plan) const;
+  };
+}
+
+#endif // ATLAS_DEPENDENCY_RESOLVER_HPP
@@ -0,0 +1,261 @@
+/**
+* @file DownloadCache.cpp
+* @author Marcus Gugacs
+* @date 16.10.26
+* @copyright Copyright (c) 2026 Marcus Gugacs. All rights reserved.
+*/
+
+#include "DownloadCache.hpp"
+
+#include <cctype>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <os/ScopeLock.hpp>
+
+#include "Logger.hpp"
+#include "utils/LruEviction.hpp"
+#include "utils/Sha256.hpp"
+
+namespace atlas {
+  namespace {
+    constexpr char CHECKSUM_PREFIX[] = "sha256:";
+    constexpr char TEMPORARY_DIR[] = "tmp";
+    constexpr char LOCK_SUFFIX[] = ".lock";
+  }
+
+  DownloadCache::DownloadCache(const fs::path& a_root, uint64_t a_max_size)
+    : m_root(a_root), m_max_size(a_max_size), m_evict_lock(), m_in_flight_lock(), m_in_flight(),
+      m_unique_count(0) {
+  }
+
+  bool DownloadCache::ParseChecksum(const ntl::String& a_checksum, ntl::String& a_digest) {
+    std::string checksum = a_checksum.GetCString();
+    if (checksum.rfind(CHECKSUM_PREFIX, 0) == 0) {
+      checksum.erase(0, sizeof(CHECKSUM_PREFIX) - 1);
+    }
+
+    if (checksum.size() != Sha256::DIGEST_SIZE * 2)
+      return false;
+
+    for (char& c : checksum) {
+      if (!std::isxdigit(static_cast<unsigned char>(c)))
+        return false;
+      c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+
+    a_digest = checksum.c_str();
+    return true;
+  }
+
+  bool DownloadCache::Fetch(const ntl::String& a_digest, const fs::path& a_target) {
+    fs::path entry = getEntryPath(a_digest);
+
+    std::error_code error;
+    if (!fs::is_regular_file(entry, error))
+      return false;
+
+    if (!materialize(entry, a_target))
+      return false;
+
+    LruEviction::Touch(entry);
+    return true;
+  }
+
+  std::shared_future<DownloadManager::Result> DownloadCache::Download(const ntl::String& a_digest,
+                                                                      const ntl::String& a_url,
+                                                                      const fs::path& a_target) {
+    std::string digest = a_digest.GetCString();
+    ntl::ScopeLock lock(&m_in_flight_lock);
+    auto started = m_in_flight.find(digest);
+    if (started != m_in_flight.end()) {
+      std::shared_future<DownloadManager::Result> shared = started->second.result;
+      return std::async(std::launch::deferred, [this, shared, a_digest, a_target]() {
+        DownloadManager::Result result = shared.get();
+        if (result.success && !Fetch(a_digest, a_target)) {
+          result = {false, 0, ntl::String{"Failed to place "} + a_target.c_str(), "", ""};
+        }
+        return result;
+      }).share();
+    }
+
+    fs::path directory = m_root / TEMPORARY_DIR;
+    std::error_code error;
+    fs::create_directories(directory, error);
+
+    // Another process downloads to the resumable file, writing to it as well would corrupt both downloads
+    int lock_fd = lockPartial(digest);
+    fs::path partial = lock_fd >= 0 ? directory / digest
+                                    : directory / (digest + "." + std::to_string(getpid()) + "." +
+                                                   std::to_string(m_unique_count++));
+
+    DownloadManager::Request request{a_url, partial, {}, {}};
+    std::shared_future<DownloadManager::Result> transfer = DownloadManager::Instance().Submit(std::move(request));
+    std::shared_future<DownloadManager::Result> result =
+      std::async(std::launch::deferred, [this, transfer, digest, partial, a_digest, a_target]() {
+        DownloadManager::Result result = transfer.get();
+        if (result.success && !Store(partial, a_digest, a_target)) {
+          result = {false, 0, ntl::String{"Failed to store "} + partial.c_str(), "", ""};
+        }
+        endDownload(digest, partial);
+        return result;
+      }).share();
+    m_in_flight[digest] = {result, lock_fd};
+    return result;
+  }
+
+  bool DownloadCache::Store(const fs::path& a_file, const ntl::String& a_digest, const fs::path& a_target) {
+    std::error_code error;
+
+    ntl::String actual;
+    if (!Sha256::HashFile(a_file, actual)) {
+      LOG_ERROR(ntl::String{"Failed to read "} + a_file.c_str());
+      fs::remove(a_file, error);
+      return false;
+    }
+
+    if (!(actual == a_digest)) {
+      LOG_ERROR(ntl::String{"Checksum mismatch, expected "} + a_digest + " but got " + actual);
+      fs::remove(a_file, error);
+      return false;
+    }
+
+    fs::path entry = getEntryPath(a_digest);
+    fs::create_directories(entry.parent_path(), error);
+
+    // Entries are shared through hard links, keep them from being modified in place
+    fs::permissions(a_file, fs::perms::owner_read | fs::perms::group_read | fs::perms::others_read, error);
+
+    // A concurrent install of the same source may have won the race, both files are identical
+    fs::rename(a_file, entry, error);
+    if (error) {
+      fs::remove(a_file, error);
+      LOG_ERROR(ntl::String{"Failed to add "} + entry.c_str() + " to the download cache");
+      return false;
+    }
+
+    bool success = materialize(entry, a_target);
+    Evict();
+    return success;
+  }
+
+  void DownloadCache::Evict() {
+    ntl::ScopeLock lock(&m_evict_lock);
+
+    // Files installs linked to stay intact, only the store's name for them goes away
+    if (m_max_size != 0) {
+      LruEviction::Evict(m_root / "sha256", m_max_size);
+    }
+    expirePartials();
+  }
+
+  fs::path DownloadCache::getEntryPath(const ntl::String& a_digest) const {
+    std::string digest = a_digest.GetCString();
+    return m_root / "sha256" / digest.substr(0, 2) / digest;
+  }
+
+  void DownloadCache::endDownload(const std::string& a_digest, const fs::path& a_partial) {
+    // A failed download to the shared file stays for the next attempt to resume
+    std::error_code error;
+    if (a_partial.filename() != a_digest) {
+      fs::remove(a_partial, error);
+      fs::remove(a_partial.string() + DownloadManager::RESUME_SUFFIX, error);
+    }
+
+    ntl::ScopeLock lock(&m_in_flight_lock);
+    auto started = m_in_flight.find(a_digest);
+    if (started == m_in_flight.end())
+      return;
+    if (started->second.lock_fd >= 0) {
+      close(started->second.lock_fd);
+    }
+    m_in_flight.erase(started);
+  }
+
+  int DownloadCache::lockPartial(const std::string& a_digest) const {
+    fs::path path = m_root / TEMPORARY_DIR / (a_digest + LOCK_SUFFIX);
+    int fd = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0)
+      return -1;
+
+    // The lock file may have been expired between open and flock, a lock on the removed file guards nothing
+    struct stat locked{};
+    struct stat current{};
+    if (flock(fd, LOCK_EX | LOCK_NB) != 0 || fstat(fd, &locked) != 0 || stat(path.c_str(), &current) != 0 ||
+        locked.st_ino != current.st_ino) {
+      close(fd);
+      return -1;
+    }
+    return fd;
+  }
+
+  void DownloadCache::expirePartials() {
+    // Partial files, resume states and lock files grouped by the digest their name starts with
+    std::map<std::string, std::vector<fs::path>> groups;
+    std::map<std::string, fs::file_time_type> last_written;
+    std::error_code error;
+    for (auto it = fs::directory_iterator(m_root / TEMPORARY_DIR, error); !error && it != fs::directory_iterator();
+         it.increment(error)) {
+      std::string name = it->path().filename().string();
+      std::string digest = name.substr(0, Sha256::DIGEST_SIZE * 2);
+      groups[digest].push_back(it->path());
+
+      std::error_code time_error;
+      fs::file_time_type modified = it->last_write_time(time_error);
+      auto newest = last_written.find(digest);
+      if (name != digest + LOCK_SUFFIX && !time_error &&
+          (newest == last_written.end() || newest->second < modified)) {
+        last_written[digest] = modified;
+      }
+    }
+
+    fs::file_time_type expired = fs::file_time_type::clock::now() - PARTIAL_MAX_AGE;
+    for (const auto& [digest, files] : groups) {
+      auto newest = last_written.find(digest);
+      if (newest != last_written.end() && newest->second > expired)
+        continue;
+
+      // A download in progress holds the lock, the lock file goes last so nobody can claim it in between
+      int fd = lockPartial(digest);
+      if (fd < 0)
+        continue;
+      fs::path lock_file = m_root / TEMPORARY_DIR / (digest + LOCK_SUFFIX);
+      for (const fs::path& file : files) {
+        if (file != lock_file) {
+          fs::remove(file, error);
+        }
+      }
+      fs::remove(lock_file, error);
+      close(fd);
+    }
+  }
+
+  bool DownloadCache::materialize(const fs::path& a_entry, const fs::path& a_target) {
+    std::error_code error;
+    if (a_target.has_parent_path()) {
+      fs::create_directories(a_target.parent_path(), error);
+    }
+    fs::remove(a_target, error);
+
+    fs::create_hard_link(a_entry, a_target, error);
+    if (!error)
+      return true;
+
+    error.clear();
+    fs::copy_file(a_entry, a_target, fs::copy_options::overwrite_existing, error);
+    if (error) {
+      LOG_ERROR(ntl::String{"Failed to place "} + a_target.c_str() + ": " + error.message().c_str());
+      return false;
+    }
+
+    // Copies belong to the package, only the store's own entries are read-only
+    fs::permissions(a_target, fs::perms::owner_write, fs::perm_options::add, error);
+    return true;
+  }
+}
@@ -0,0 +1,174 @@
+/**
+* @file DownloadCache.hpp
+* @author Marcus Gugacs
+* @date 16.10.26
+* @copyright Copyright (c) 2026 Marcus Gugacs. All rights reserved.
+*/
+
+#ifndef ATLAS_DOWNLOAD_CACHE_HPP
+#define ATLAS_DOWNLOAD_CACHE_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <future>
+#include <string>
+#include <unordered_map>
+
+#include <data/String.hpp>
+#include <os/Lock.hpp>
+
+#include "utils/DownloadManager.hpp"
+
+namespace fs = std::filesystem;
+
+namespace atlas {
+  /**
+   * @class DownloadCache
+   * @brief Content-addressed store for downloaded package sources.
+   *
+   * Entries live under `<root>/sha256/<first two digits>/<digest>` and are only ever added after their contents
+   * were hashed, so a lookup by digest never needs the network. Entries are read-only and handed out as hard
+   * links where possible. The last modification time of an entry is refreshed on every hit and used to evict
+   * the least recently used entries once the store grows beyond its size limit.
+   *
+   * Downloads into the store are shared per digest. Within a process a second installer of the same source
+   * waits for the first, across processes the resumable partial file is guarded by a file lock and a second
+   * downloader gets a file of its own. Partial files nobody touched for PARTIAL_MAX_AGE are removed on eviction.
+   */
+  class DownloadCache {
+  public:
+    static constexpr std::chrono::hours PARTIAL_MAX_AGE{72};
+
+  private:
+    /**
+     * @struct InFlight
+     * @brief A download into the store started by an installer of this process.
+     */
+    struct InFlight {
+      std::shared_future<DownloadManager::Result> result;
+      int lock_fd;
+    };
+
+    fs::path m_root;
+    uint64_t m_max_size;
+    ntl::Lock m_evict_lock;
+    ntl::Lock m_in_flight_lock;
+    std::unordered_map<std::string, InFlight> m_in_flight;
+    uint64_t m_unique_count;
+
+  public:
+    /**
+     * @brief Constructor, does not touch the disk.
+     *
+     * @param a_root Directory of the store
+     * @param a_max_size Size limit in bytes, 0 disables size based eviction
+     */
+    DownloadCache(const fs::path& a_root, uint64_t a_max_size);
+
+    DownloadCache(const DownloadCache&) = delete;
+    DownloadCache& operator=(const DownloadCache&) = delete;
+
+    /**
+     * @brief Normalizes a checksum declared by a package manifest.
+     *
+     * Accepts an optional "sha256:" prefix and upper case digits.
+     *
+     * @param a_checksum Checksum as declared
+     * @param a_digest Lower case hex digest to fill
+     * @return True if the checksum is a valid SHA-256 digest, false otherwise
+     */
+    static bool ParseChecksum(const ntl::String& a_checksum, ntl::String& a_digest);
+
+    /**
+     * @brief Places the entry with the given digest at the target path if it is cached.
+     *
+     * @param a_digest Lower case hex SHA-256 digest
+     * @param a_target Path to place the file at
+     * @return True on a hit, false if the entry is missing or could not be placed
+     */
+    bool Fetch(const ntl::String& a_digest, const fs::path& a_target);
+
+    /**
+     * @brief Downloads the entry with the given digest and places it at the target path.
+     *
+     * The file is downloaded next to the entries, so Store() moves it into place with a single rename. The
+     * partial file is the same for every attempt, so an interrupted download is resumed by the next one, unless
+     * another process downloads to it, then a unique file is used. A download of the same digest already
+     * started in this process is shared instead of starting a second one. The file is verified and stored by
+     * the first thread waiting on the result, not on the download manager's event loop.
+     *
+     * @param a_digest Lower case hex SHA-256 digest of the entry
+     * @param a_url URL to download from
+     * @param a_target Path to place the file at
+     * @return Future of the download, successful once the entry was stored and placed at the target
+     */
+    std::shared_future<DownloadManager::Result> Download(const ntl::String& a_digest, const ntl::String& a_url,
+                                                         const fs::path& a_target);
+
+    /**
+     * @brief Verifies a downloaded file and moves it into the store.
+     *
+     * The file is removed if it does not match the expected digest. On success it is placed at the target path
+     * and least recently used entries are evicted if the store exceeds its size limit.
+     *
+     * @param a_file Downloaded file
+     * @param a_digest Expected lower case hex SHA-256 digest
+     * @param a_target Path to place the file at
+     * @return True if the file matched and was placed at the target, false otherwise
+     */
+    bool Store(const fs::path& a_file, const ntl::String& a_digest, const fs::path& a_target);
+
+    /**
+     * @brief Evicts least recently used entries until the store fits its size limit.
+     *
+     * Abandoned partial files are removed as well, regardless of the size limit.
+     */
+    void Evict();
+
+  private:
+    /**
+     * @brief Returns the path of the entry with the given digest.
+     *
+     * @param a_digest Lower case hex SHA-256 digest
+     * @return Path of the entry
+     */
+    fs::path getEntryPath(const ntl::String& a_digest) const;
+
+    /**
+     * @brief Ends a download started by Download(), the transfer must have finished.
+     *
+     * A unique partial file is removed together with its resume state.
+     *
+     * @param a_digest Lower case hex SHA-256 digest of the entry
+     * @param a_partial Partial file the entry was downloaded to
+     */
+    void endDownload(const std::string& a_digest, const fs::path& a_partial);
+
+    /**
+     * @brief Takes the file lock guarding the resumable partial file of a digest without waiting.
+     *
+     * @param a_digest Lower case hex SHA-256 digest
+     * @return Descriptor holding the lock, -1 if another descriptor holds it
+     */
+    int lockPartial(const std::string& a_digest) const;
+
+    /**
+     * @brief Removes partial files and resume states that were not written to for PARTIAL_MAX_AGE.
+     *
+     * The caller must hold the eviction lock.
+     */
+    void expirePartials();
+
+    /**
+     * @brief Hard links an entry to the target path, falling back to a copy across file systems.
+     *
+     * @param a_entry Path of the entry
+     * @param a_target Path to place the file at
+     * @return True if successful, false otherwise
+     */
+    static bool materialize(const fs::path& a_entry, const fs::path& a_target);
+  };
+}
+
+#endif // ATLAS_DOWNLOAD_CACHE_HPP
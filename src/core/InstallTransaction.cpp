@@ -0,0 +1,296 @@
+/**
+* @file InstallTransaction.cpp
+* @author Marcus Gugacs
+* @date 16.10.26
+* @copyright Copyright (c) 2026 Marcus Gugacs. All rights reserved.
+*/
+
+#include "InstallTransaction.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <set>
+#include <unordered_set>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "Logger.hpp"
+
+namespace atlas {
+  namespace {
+    /**
+     * @brief Orders paths so that every directory precedes its contents.
+     */
+    void sortParentsFirst(std::vector<fs::path>& a_paths) {
+      std::sort(a_paths.begin(), a_paths.end(), [](const fs::path& a_lhs, const fs::path& a_rhs) {
+        return a_lhs.native() < a_rhs.native();
+      });
+    }
+  }
+
+  InstallTransaction::InstallTransaction(const fs::path& a_prefix, const ntl::String& a_package)
+    : m_prefix(a_prefix), m_staging(a_prefix / STATE_DIR / "staging" / a_package.GetCString()),
+      m_backup(a_prefix / STATE_DIR / "backup" / a_package.GetCString()), m_finished(false) {
+  }
+
+  InstallTransaction::~InstallTransaction() {
+    Rollback();
+  }
+
+  bool InstallTransaction::Begin() {
+    std::error_code error;
+    fs::remove_all(m_staging, error);
+    fs::remove_all(m_backup, error);
+    fs::create_directories(m_staging, error);
+    if (error) {
+      LOG_ERROR(ntl::String{"Failed to create "} + m_staging.c_str() + ": " + error.message().c_str());
+      return false;
+    }
+
+    for (auto it = fs::directory_iterator(m_prefix, error); !error && it != fs::directory_iterator();
+         it.increment(error)) {
+      std::error_code type_error;
+      if (it->path().filename() == STATE_DIR || it->is_symlink(type_error) || !it->is_directory(type_error))
+        continue;
+      if (fs::create_directory(m_staging / it->path().filename(), type_error)) {
+        m_mirrored.insert(it->path().filename().native());
+      }
+    }
+    return true;
+  }
+
+  bool InstallTransaction::Preserve(const std::vector<fs::path>& a_files) {
+    for (const fs::path& file : a_files) {
+      struct stat info{};
+      if (lstat((m_prefix / file).c_str(), &info) != 0 || S_ISDIR(info.st_mode))
+        continue;
+      if (!backUp(file))
+        return false;
+      m_preserved.push_back(file);
+    }
+    return true;
+  }
+
+  bool InstallTransaction::Adopt(const std::vector<fs::path>& a_added, const std::vector<fs::path>& a_modified) {
+    // Modified files stay in the prefix until the commit, other packages and the build cache still read them
+    for (const fs::path& file : a_modified) {
+      fs::path source = m_prefix / file;
+      fs::path target = m_staging / file;
+      std::error_code error;
+      if (!backUp(file))
+        return false;
+      m_replaced.push_back(file);
+
+      fs::create_directories(target.parent_path(), error);
+      if (!error && link(source.c_str(), target.c_str()) != 0) {
+        error = std::error_code(errno, std::generic_category());
+      }
+      if (error) {
+        LOG_ERROR(ntl::String{"Failed to stage "} + source.c_str() + ": " + error.message().c_str());
+        return false;
+      }
+    }
+
+    std::vector<fs::path> directories;
+    for (const fs::path& file : a_added) {
+      fs::path source = m_prefix / file;
+      fs::path target = m_staging / file;
+      struct stat info{};
+      if (lstat(source.c_str(), &info) != 0)
+        continue;
+
+      std::error_code error;
+      if (S_ISDIR(info.st_mode)) {
+        fs::create_directories(target, error);
+        directories.push_back(file);
+      } else {
+        fs::create_directories(target.parent_path(), error);
+        if (!error && rename(source.c_str(), target.c_str()) != 0) {
+          error = std::error_code(errno, std::generic_category());
+        }
+      }
+      if (error) {
+        LOG_ERROR(ntl::String{"Failed to stage "} + source.c_str() + ": " + error.message().c_str());
+        return false;
+      }
+    }
+
+    // Directories the install step created are empty now, the commit creates them again
+    for (auto it = directories.rbegin(); it != directories.rend(); ++it) {
+      rmdir((m_prefix / *it).c_str());
+    }
+    return true;
+  }
+
+  std::vector<fs::path> InstallTransaction::ListStaged() const {
+    std::vector<fs::path> paths;
+    std::error_code error;
+    for (auto it = fs::recursive_directory_iterator(m_staging, error);
+         !error && it != fs::recursive_directory_iterator(); it.increment(error)) {
+      // Mirrored directories nothing was installed to are not part of the package
+      std::error_code empty_error;
+      if (it.depth() == 0 && m_mirrored.count(it->path().filename().native()) != 0 &&
+          fs::is_empty(it->path(), empty_error))
+        continue;
+      paths.push_back(it->path().lexically_relative(m_staging));
+    }
+    sortParentsFirst(paths);
+    return paths;
+  }
+
+  bool InstallTransaction::Commit(const std::vector<fs::path>& a_previous) {
+    if (m_finished)
+      return false;
+
+    for (const fs::path& path : ListStaged()) {
+      if (!place(path)) {
+        Rollback();
+        return false;
+      }
+    }
+
+    // Nothing can fail anymore, files the previous version had and this one lacks are dropped
+    std::unordered_set<std::string> placed;
+    for (const fs::path& file : m_files) {
+      placed.insert(file.generic_string());
+    }
+    std::vector<fs::path> stale;
+    for (const fs::path& file : a_previous) {
+      if (placed.count(file.generic_string()) != 0)
+        continue;
+      if (unlink((m_prefix / file).c_str()) == 0 || errno == ENOENT) {
+        stale.push_back(file);
+      } else {
+        LOG_WARN(ntl::String{"Failed to remove "} + (m_prefix / file).c_str() + ": " + std::strerror(errno));
+      }
+    }
+    RemoveEmptyParents(m_prefix, stale);
+
+    m_finished = true;
+    cleanUp();
+    return true;
+  }
+
+  void InstallTransaction::Rollback() {
+    if (m_finished)
+      return;
+
+    std::unordered_set<std::string> replaced;
+    for (const fs::path& file : m_replaced) {
+      replaced.insert(file.generic_string());
+    }
+    for (auto it = m_files.rbegin(); it != m_files.rend(); ++it) {
+      if (replaced.count(it->generic_string()) == 0) {
+        unlink((m_prefix / *it).c_str());
+      }
+    }
+
+    // A backup is a second link to the replaced file, renaming it back restores the file as it was
+    for (const fs::path& file : m_replaced) {
+      if (rename((m_backup / file).c_str(), (m_prefix / file).c_str()) != 0) {
+        LOG_ERROR(ntl::String{"Failed to restore "} + (m_prefix / file).c_str() + ": " + std::strerror(errno));
+      }
+    }
+    // Preserved files the install commands deleted, the others are still in place
+    for (const fs::path& file : m_preserved) {
+      struct stat info{};
+      if (replaced.count(file.generic_string()) == 0 && lstat((m_prefix / file).c_str(), &info) != 0 &&
+          rename((m_backup / file).c_str(), (m_prefix / file).c_str()) != 0) {
+        LOG_ERROR(ntl::String{"Failed to restore "} + (m_prefix / file).c_str() + ": " + std::strerror(errno));
+      }
+    }
+    for (auto it = m_created_dirs.rbegin(); it != m_created_dirs.rend(); ++it) {
+      rmdir((m_prefix / *it).c_str());
+    }
+
+    m_files.clear();
+    m_replaced.clear();
+    m_preserved.clear();
+    m_backed_up.clear();
+    m_created_dirs.clear();
+    m_finished = true;
+    cleanUp();
+  }
+
+  void InstallTransaction::RemoveEmptyParents(const fs::path& a_prefix, const std::vector<fs::path>& a_files) {
+    std::set<std::string> directories;
+    for (const fs::path& file : a_files) {
+      for (fs::path parent = file.parent_path(); !parent.empty(); parent = parent.parent_path()) {
+        if (!directories.insert(parent.native()).second)
+          break;
+      }
+    }
+
+    // A directory sorts before everything inside it, walking backwards removes children first
+    for (auto it = directories.rbegin(); it != directories.rend(); ++it) {
+      rmdir((a_prefix / *it).c_str());
+    }
+  }
+
+  bool InstallTransaction::place(const fs::path& a_path) {
+    fs::path source = m_staging / a_path;
+    fs::path target = m_prefix / a_path;
+    struct stat info{};
+    if (lstat(source.c_str(), &info) != 0) {
+      LOG_ERROR(ntl::String{"Failed to read "} + source.c_str() + ": " + std::strerror(errno));
+      return false;
+    }
+
+    struct stat existing{};
+    bool exists = lstat(target.c_str(), &existing) == 0;
+    if (exists && S_ISDIR(existing.st_mode) != S_ISDIR(info.st_mode)) {
+      LOG_ERROR(ntl::String{"Cannot install "} + target.c_str() + ", a different kind of file is in the way");
+      return false;
+    }
+
+    if (S_ISDIR(info.st_mode)) {
+      if (exists)
+        return true;
+      if (mkdir(target.c_str(), info.st_mode & 07777) != 0) {
+        LOG_ERROR(ntl::String{"Failed to create "} + target.c_str() + ": " + std::strerror(errno));
+        return false;
+      }
+      m_created_dirs.push_back(a_path);
+      return true;
+    }
+
+    if (exists && m_backed_up.count(a_path.generic_string()) == 0) {
+      if (!backUp(a_path))
+        return false;
+      m_replaced.push_back(a_path);
+    }
+
+    // The rename swaps the file in atomically, readers see either the old or the new version
+    if (rename(source.c_str(), target.c_str()) != 0) {
+      LOG_ERROR(ntl::String{"Failed to install "} + target.c_str() + ": " + std::strerror(errno));
+      return false;
+    }
+    m_files.push_back(a_path);
+    return true;
+  }
+
+  bool InstallTransaction::backUp(const fs::path& a_path) {
+    if (!m_backed_up.insert(a_path.generic_string()).second)
+      return true;
+
+    fs::path source = m_prefix / a_path;
+    fs::path backup = m_backup / a_path;
+    std::error_code error;
+    fs::create_directories(backup.parent_path(), error);
+    if (error || link(source.c_str(), backup.c_str()) != 0) {
+      LOG_ERROR(ntl::String{"Failed to back up "} + source.c_str() + ": " +
+                (error ? error.message().c_str() : std::strerror(errno)));
+      m_backed_up.erase(a_path.generic_string());
+      return false;
+    }
+    return true;
+  }
+
+  void InstallTransaction::cleanUp() {
+    std::error_code error;
+    fs::remove_all(m_staging, error);
+    fs::remove_all(m_backup, error);
+  }
+}
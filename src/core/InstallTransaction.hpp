@@ -0,0 +1,168 @@
+/**
+* @file InstallTransaction.hpp
+* @author Marcus Gugacs
+* @date 16.10.26
+* @copyright Copyright (c) 2026 Marcus Gugacs. All rights reserved.
+*/
+
+#ifndef ATLAS_INSTALL_TRANSACTION_HPP
+#define ATLAS_INSTALL_TRANSACTION_HPP
+
+#include <filesystem>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include <data/String.hpp>
+
+namespace fs = std::filesystem;
+
+namespace atlas {
+  /**
+   * @class InstallTransaction
+   * @brief Stages a package's files next to the install directory and moves them in as one unit.
+   *
+   * Files are first placed in `<prefix>/.atlas/staging/<package>`, on the same file system as the prefix, so
+   * committing them is a rename per file. Files a commit replaces are hard linked to
+   * `<prefix>/.atlas/backup/<package>` first, which lets a failed commit put every replaced file back and remove
+   * every added one. A transaction that is neither committed nor rolled back is rolled back on destruction, so a
+   * failed install never leaves a partial tree in the prefix.
+   */
+  class InstallTransaction {
+  public:
+    static constexpr char STATE_DIR[] = ".atlas";
+
+  private:
+    fs::path m_prefix;
+    fs::path m_staging;
+    fs::path m_backup;
+    std::vector<fs::path> m_files;
+    std::vector<fs::path> m_replaced;
+    std::vector<fs::path> m_preserved;
+    std::vector<fs::path> m_created_dirs;
+    std::unordered_set<std::string> m_backed_up;
+    std::unordered_set<std::string> m_mirrored;
+    bool m_finished;
+
+  public:
+    /**
+     * @brief Constructor, does not touch the disk until Begin() is called.
+     *
+     * @param a_prefix Install directory
+     * @param a_package Name of the package, names the staging directory
+     */
+    InstallTransaction(const fs::path& a_prefix, const ntl::String& a_package);
+
+    /**
+     * @brief Destructor, rolls back an unfinished transaction.
+     */
+    ~InstallTransaction();
+
+    InstallTransaction(const InstallTransaction&) = delete;
+    InstallTransaction& operator=(const InstallTransaction&) = delete;
+
+    /**
+     * @brief Creates an empty staging directory, discarding leftovers of an interrupted run.
+     *
+     * The top level directories of the prefix are mirrored, so commands copying into an existing directory
+     * such as bin/ work unchanged.
+     *
+     * @return True if successful, false otherwise
+     */
+    bool Begin();
+
+    /**
+     * @brief Returns the directory files are staged in.
+     *
+     * @return The staging directory
+     */
+    const fs::path& GetStagingDir() const { return m_staging; }
+
+    /**
+     * @brief Backs up files of the prefix before commands that write to it directly run.
+     *
+     * A backup is a hard link, it keeps a file an install command replaces with a new one, but not the old
+     * contents of a file the command rewrites in place. Files that are missing after a rollback are restored.
+     *
+     * @param a_files Files relative to the prefix, paths that do not exist are skipped
+     * @return True if successful, false otherwise
+     */
+    bool Preserve(const std::vector<fs::path>& a_files);
+
+    /**
+     * @brief Takes files that were written to the prefix directly into the staging directory.
+     *
+     * Lets install commands with a prefix compiled in by an earlier step take part in the transaction. Added
+     * entries are moved, modified files are linked and stay in the prefix, a rollback puts back their backup.
+     *
+     * @param a_added Files, directories and links new to the prefix, parents must precede their children
+     * @param a_modified Files and links that existed before and were written
+     * @return True if successful, false otherwise
+     */
+    bool Adopt(const std::vector<fs::path>& a_added, const std::vector<fs::path>& a_modified);
+
+    /**
+     * @brief Lists the staged files, directories and links.
+     *
+     * Mirrored directories that are still empty are left out.
+     *
+     * @return Paths relative to the staging directory, every directory before its contents
+     */
+    std::vector<fs::path> ListStaged() const;
+
+    /**
+     * @brief Moves the staged files into the prefix.
+     *
+     * Files of the previous version of the package that the new one no longer contains are removed afterwards.
+     * If a file cannot be placed, everything done so far is undone.
+     *
+     * @param a_previous Files of the installed version being replaced, relative to the prefix
+     * @return True if every file was placed, false otherwise
+     */
+    bool Commit(const std::vector<fs::path>& a_previous);
+
+    /**
+     * @brief Discards the staged files and undoes a partial commit.
+     */
+    void Rollback();
+
+    /**
+     * @brief Returns the files and links the commit placed in the prefix.
+     *
+     * @return Paths relative to the prefix, directories are not included
+     */
+    const std::vector<fs::path>& GetFiles() const { return m_files; }
+
+    /**
+     * @brief Removes the now empty parent directories of removed files, deepest first, up to the prefix.
+     *
+     * @param a_prefix Install directory
+     * @param a_files Removed files relative to the prefix
+     */
+    static void RemoveEmptyParents(const fs::path& a_prefix, const std::vector<fs::path>& a_files);
+
+  private:
+    /**
+     * @brief Places a single staged entry in the prefix.
+     *
+     * @param a_path Entry relative to the staging directory
+     * @return True if successful, false otherwise
+     */
+    bool place(const fs::path& a_path);
+
+    /**
+     * @brief Hard links a file of the prefix to the backup directory, once per path.
+     *
+     * @param a_path File relative to the prefix
+     * @return True if successful or already backed up, false otherwise
+     */
+    bool backUp(const fs::path& a_path);
+
+    /**
+     * @brief Removes the staging and backup directories.
+     */
+    void cleanUp();
+  };
+}
+
+#endif // ATLAS_INSTALL_TRANSACTION_HPP
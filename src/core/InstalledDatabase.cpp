@@ -0,0 +1,269 @@
+/**
+* @file InstalledDatabase.cpp
+* @author Marcus Gugacs
+* @date 16.10.26
+* @copyright Copyright (c) 2026 Marcus Gugacs. All rights reserved.
+*/
+
+#include "InstalledDatabase.hpp"
+
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+
+#include "Logger.hpp"
+
+namespace atlas {
+  InstalledDatabase::InstalledDatabase(const fs::path& a_path)
+    : m_path(a_path), m_packages(), m_dirty(), m_lock(), m_loaded(false) {
+  }
+
+  void InstalledDatabase::Load() {
+    Json::Value root;
+    if (!readFile(root)) {
+      LOG_ERROR(ntl::String{"Failed to parse "} + m_path.c_str());
+    }
+
+    m_lock.StartWrite();
+    fromJson(root);
+    m_dirty.Clear();
+    m_loaded = true;
+    m_lock.EndWrite();
+  }
+
+  bool InstalledDatabase::Contains(const ntl::String& a_name) {
+    m_lock.StartRead();
+    bool result = m_packages.Find(a_name) != m_packages.end();
+    m_lock.EndRead();
+    return result;
+  }
+
+  bool InstalledDatabase::Get(const ntl::String& a_name, InstalledPackage& a_package) {
+    m_lock.StartRead();
+    bool result = m_packages.Find(a_name) != m_packages.end();
+    if (result) {
+      a_package = m_packages[a_name];
+    }
+    m_lock.EndRead();
+    return result;
+  }
+
+  ntl::Array<ntl::String> InstalledDatabase::GetPackageNames() {
+    ntl::Array<ntl::String> names;
+    m_lock.StartRead();
+    for (const auto& [name, package] : m_packages) {
+      names.Insert(name);
+    }
+    m_lock.EndRead();
+    return names;
+  }
+
+  void InstalledDatabase::Put(const ntl::String& a_name, const InstalledPackage& a_package) {
+    m_lock.StartWrite();
+    m_packages[a_name] = a_package;
+    m_dirty[a_name] = true;
+    m_lock.EndWrite();
+  }
+
+  bool InstalledDatabase::Remove(const ntl::String& a_name) {
+    m_lock.StartWrite();
+    bool result = m_packages.Find(a_name) != m_packages.end();
+    if (result) {
+      m_packages.Remove(a_name);
+      m_dirty[a_name] = true;
+    }
+    m_lock.EndWrite();
+    return result;
+  }
+
+  bool InstalledDatabase::SetLocked(const ntl::String& a_name, bool a_locked) {
+    m_lock.StartWrite();
+    bool result = m_packages.Find(a_name) != m_packages.end();
+    if (result) {
+      m_packages[a_name].locked = a_locked;
+      m_dirty[a_name] = true;
+    }
+    m_lock.EndWrite();
+    return result;
+  }
+
+  bool InstalledDatabase::SetKeep(const ntl::String& a_name, bool a_keep) {
+    m_lock.StartWrite();
+    bool result = m_packages.Find(a_name) != m_packages.end();
+    if (result) {
+      m_packages[a_name].keep = a_keep;
+      m_dirty[a_name] = true;
+    }
+    m_lock.EndWrite();
+    return result;
+  }
+
+  bool InstalledDatabase::HasChanges() {
+    m_lock.StartRead();
+    bool result = m_dirty.GetSize() > 0;
+    m_lock.EndRead();
+    return result;
+  }
+
+  bool InstalledDatabase::Commit() {
+    m_lock.StartWrite();
+    if (m_dirty.GetSize() == 0) {
+      m_lock.EndWrite();
+      return true;
+    }
+
+    fs::path lock_path = m_path;
+    lock_path += ".lock";
+    int lock_fd = open(lock_path.c_str(), O_CREAT | O_RDWR, 0644);
+    if (lock_fd < 0 || flock(lock_fd, LOCK_EX) != 0) {
+      if (lock_fd >= 0)
+        close(lock_fd);
+      m_lock.EndWrite();
+      LOG_ERROR(ntl::String{"Failed to lock "} + m_path.c_str());
+      return false;
+    }
+
+    // Start from what is on disk now, another process may have committed since we loaded
+    Json::Value root;
+    bool success = readFile(root);
+    if (success) {
+      for (const auto& [name, dirty] : m_dirty) {
+        if (m_packages.Find(name) != m_packages.end()) {
+          root[name.GetCString()] = toJson(m_packages[name]);
+        } else {
+          root.removeMember(name.GetCString());
+        }
+      }
+
+      success = writeFile(root);
+    }
+
+    if (success) {
+      fromJson(root);
+      m_dirty.Clear();
+    }
+
+    flock(lock_fd, LOCK_UN);
+    close(lock_fd);
+    m_lock.EndWrite();
+
+    if (!success) {
+      LOG_ERROR(ntl::String{"Failed to write "} + m_path.c_str());
+    }
+
+    return success;
+  }
+
+  bool InstalledDatabase::readFile(Json::Value& a_root) const {
+    a_root = Json::Value(Json::objectValue);
+    if (!fs::exists(m_path)) {
+      return true;
+    }
+
+    std::ifstream file(m_path);
+    Json::CharReaderBuilder builder;
+    std::string errors;
+    if (!Json::parseFromStream(builder, file, &a_root, &errors)) {
+      a_root = Json::Value(Json::objectValue);
+      return false;
+    }
+    return a_root.isObject();
+  }
+
+  bool InstalledDatabase::writeFile(const Json::Value& a_root) const {
+    fs::path temp_path = m_path;
+    temp_path += ".tmp." + std::to_string(getpid());
+
+    std::ostringstream stream;
+    stream << a_root;
+    std::string data = stream.str();
+
+    int fd = open(temp_path.c_str(), O_CREAT | O_WRONLY | O_TRUNC, 0644);
+    if (fd < 0)
+      return false;
+
+    size_t written = 0;
+    while (written < data.size()) {
+      ssize_t result = write(fd, data.data() + written, data.size() - written);
+      if (result < 0) {
+        close(fd);
+        unlink(temp_path.c_str());
+        return false;
+      }
+      written += static_cast<size_t>(result);
+    }
+
+    if (fsync(fd) != 0) {
+      close(fd);
+      unlink(temp_path.c_str());
+      return false;
+    }
+    close(fd);
+
+    if (rename(temp_path.c_str(), m_path.c_str()) != 0) {
+      unlink(temp_path.c_str());
+      return false;
+    }
+
+    // Persist the rename itself
+    int dir_fd = open(m_path.parent_path().c_str(), O_RDONLY);
+    if (dir_fd >= 0) {
+      fsync(dir_fd);
+      close(dir_fd);
+    }
+
+    return true;
+  }
+
+  void InstalledDatabase::fromJson(const Json::Value& a_root) {
+    m_packages.Clear();
+    for (const auto& name : a_root.getMemberNames()) {
+      const Json::Value& entry = a_root[name];
+      InstalledPackage package{
+        entry["version"].asString().c_str(),
+        entry["install_date"].asString().c_str(),
+        entry["repository"].asString().c_str(),
+        entry["locked"].asBool(),
+        entry["keep"].asBool(),
+        ntl::Array<ntl::String>(),
+        ntl::Array<ntl::String>(),
+        entry["build_key"].asString().c_str()
+      };
+      for (const auto& dep : entry["dependencies"]) {
+        package.dependencies.Insert(dep.asString().c_str());
+      }
+      // Entries written before file manifests existed have none, their removal runs the uninstall commands
+      for (const auto& file : entry["files"]) {
+        package.files.Insert(file.asString().c_str());
+      }
+      m_packages[name.c_str()] = package;
+    }
+  }
+
+  Json::Value InstalledDatabase::toJson(const InstalledPackage& a_package) {
+    Json::Value entry;
+    entry["version"] = a_package.version.GetCString();
+    entry["install_date"] = a_package.install_date.GetCString();
+    entry["repository"] = a_package.repository.GetCString();
+    entry["locked"] = a_package.locked;
+    entry["keep"] = a_package.keep;
+
+    Json::Value dependencies(Json::arrayValue);
+    for (const auto& dep : a_package.dependencies) {
+      dependencies.append(dep.GetCString());
+    }
+    entry["dependencies"] = dependencies;
+
+    Json::Value files(Json::arrayValue);
+    for (const auto& file : a_package.files) {
+      files.append(file.GetCString());
+    }
+    entry["files"] = files;
+    entry["build_key"] = a_package.build_key.GetCString();
+    return entry;
+  }
+}
@@ -0,0 +1,172 @@
+/**
+* @file InstalledDatabase.hpp
+* @author Marcus Gugacs
+* @date 16.10.26
+* @copyright Copyright (c) 2026 Marcus Gugacs. All rights reserved.
+*/
+
+#ifndef ATLAS_INSTALLED_DATABASE_HPP
+#define ATLAS_INSTALLED_DATABASE_HPP
+
+#include <filesystem>
+#include <json/json.h>
+
+#include <data/Array.hpp>
+#include <data/Map.hpp>
+#include <data/String.hpp>
+#include <os/SharedLock.hpp>
+
+#include "pods/InstalledPackage.hpp"
+
+namespace fs = std::filesystem;
+
+namespace atlas {
+  /**
+   * @class InstalledDatabase
+   * @brief In-memory view of installed.json.
+   *
+   * The database is parsed once per process and answers all lookups from memory. Mutations are only
+   * recorded until Commit() merges them into the file on disk under an exclusive file lock and replaces
+   * it atomically, so concurrent atlas processes never lose each other's changes.
+   */
+  class InstalledDatabase {
+  private:
+    fs::path m_path;
+    ntl::Map<ntl::String, InstalledPackage> m_packages;
+    ntl::Map<ntl::String, bool> m_dirty;
+    ntl::SharedLock m_lock;
+    bool m_loaded;
+
+  public:
+    /**
+     * @brief Constructor, does not touch the disk until Load() is called.
+     *
+     * @param a_path Path to installed.json
+     */
+    explicit InstalledDatabase(const fs::path& a_path);
+
+    InstalledDatabase(const InstalledDatabase&) = delete;
+    InstalledDatabase& operator=(const InstalledDatabase&) = delete;
+
+    /**
+     * @brief Parses the database file into memory, discarding any uncommitted changes.
+     */
+    void Load();
+
+    /**
+     * @brief Checks whether the database has been loaded.
+     *
+     * @return True if Load() was called, false otherwise
+     */
+    bool IsLoaded() const { return m_loaded; }
+
+    /**
+     * @brief Checks whether a package is installed.
+     *
+     * @param a_name Name of the package
+     * @return True if the package is installed, false otherwise
+     */
+    bool Contains(const ntl::String& a_name);
+
+    /**
+     * @brief Looks up an installed package.
+     *
+     * @param a_name Name of the package
+     * @param a_package Entry to fill if the package is installed
+     * @return True if the package is installed, false otherwise
+     */
+    bool Get(const ntl::String& a_name, InstalledPackage& a_package);
+
+    /**
+     * @brief Returns the names of all installed packages.
+     *
+     * @return Snapshot of the installed package names
+     */
+    ntl::Array<ntl::String> GetPackageNames();
+
+    /**
+     * @brief Adds or replaces an installed package.
+     *
+     * @param a_name Name of the package
+     * @param a_package Entry to store
+     */
+    void Put(const ntl::String& a_name, const InstalledPackage& a_package);
+
+    /**
+     * @brief Removes an installed package.
+     *
+     * @param a_name Name of the package
+     * @return True if the package was installed, false otherwise
+     */
+    bool Remove(const ntl::String& a_name);
+
+    /**
+     * @brief Sets the locked flag of an installed package.
+     *
+     * @param a_name Name of the package
+     * @param a_locked New value of the flag
+     * @return True if the package is installed, false otherwise
+     */
+    bool SetLocked(const ntl::String& a_name, bool a_locked);
+
+    /**
+     * @brief Sets the keep flag of an installed package.
+     *
+     * @param a_name Name of the package
+     * @param a_keep New value of the flag
+     * @return True if the package is installed, false otherwise
+     */
+    bool SetKeep(const ntl::String& a_name, bool a_keep);
+
+    /**
+     * @brief Checks whether there are uncommitted changes.
+     *
+     * @return True if Commit() has work to do, false otherwise
+     */
+    bool HasChanges();
+
+    /**
+     * @brief Writes all pending changes to disk.
+     *
+     * Takes an exclusive lock on the database, re-reads the file, applies the pending changes on top of it,
+     * writes the result to a temporary file, syncs it and renames it over the original.
+     *
+     * @return True if successful (or nothing to commit), false otherwise
+     */
+    bool Commit();
+
+  private:
+    /**
+     * @brief Reads and parses the database file.
+     *
+     * @param a_root JSON document to fill (empty object if the file does not exist)
+     * @return True if the file is missing or was parsed successfully, false otherwise
+     */
+    bool readFile(Json::Value& a_root) const;
+
+    /**
+     * @brief Atomically replaces the database file with the given document.
+     *
+     * @param a_root JSON document to write
+     * @return True if successful, false otherwise
+     */
+    bool writeFile(const Json::Value& a_root) const;
+
+    /**
+     * @brief Replaces the in-memory packages with the contents of the given document.
+     *
+     * @param a_root JSON document to read from
+     */
+    void fromJson(const Json::Value& a_root);
+
+    /**
+     * @brief Converts an entry to its JSON representation.
+     *
+     * @param a_package Entry to convert
+     * @return The JSON object
+     */
+    static Json::Value toJson(const InstalledPackage& a_package);
+  };
+}
+
+#endif // ATLAS_INSTALLED_DATABASE_HPP
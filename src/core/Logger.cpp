@@ -7,135 +7,327 @@
 
 #include "Logger.hpp"
 
-#include "utils/JobSystem.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <sys/uio.h>
+#include <unistd.h>
+
 #include "utils/Misc.hpp"
 
 namespace atlas {
+  namespace {
+    /**
+     * @brief Writes all of the given buffers, continuing after partial writes and interrupts.
+     * @param a_fd the descriptor to write to
+     * @param a_buffers the buffers to write, modified while writing
+     * @param a_count the number of buffers
+     */
+    void writeAll(int a_fd, iovec* a_buffers, int a_count) {
+      while (a_count > 0) {
+        ssize_t written = writev(a_fd, a_buffers, std::min(a_count, IOV_MAX));
+        if (written < 0) {
+          if (errno == EINTR)
+            continue;
+          return;
+        }
+
+        while (a_count > 0 && static_cast<size_t>(written) >= a_buffers->iov_len) {
+          written -= static_cast<ssize_t>(a_buffers->iov_len);
+          ++a_buffers;
+          --a_count;
+        }
+        if (a_count > 0) {
+          a_buffers->iov_base = static_cast<char*>(a_buffers->iov_base) + written;
+          a_buffers->iov_len -= static_cast<size_t>(written);
+        }
+      }
+    }
+  }
+
   void Logger::Initialize() {
-    m_file.ResetFile();
+    if (m_initialized)
+      return;
+
+    m_file.Open(true);
+    m_running = true;
+    m_writer = std::thread([this]() {
+      run();
+    });
+
+    // Messages logged right before exit must still reach the console
+    static std::once_flag exit_handler;
+    std::call_once(exit_handler, []() {
+      std::atexit([]() {
+        Logger::Instance().Shutdown();
+      });
+    });
 
     m_initialized = true;
   }
 
   void Logger::Shutdown() {
+    if (!m_initialized)
+      return;
+
     m_initialized = false;
+    m_running = false;
+    {
+      ntl::ScopeLock lock(&m_writer_lock);
+      m_writer_wake.Broadcast();
+    }
+    m_writer.join();
 
-    forceFlushBuffer();
+    m_file.Close();
+  }
+
+  void Logger::Flush() {
+    if (!m_initialized)
+      return;
+
+    // Concurrent flushes keep the furthest target, the writer clears it once it flushed past it
+    uint64_t target = m_enqueue_position.load(std::memory_order_acquire);
+    uint64_t requested = m_flush_target.load(std::memory_order_relaxed);
+    while (requested < target && !m_flush_target.compare_exchange_weak(requested, target)) {}
+    wakeWriter();
+
+    m_written_lock.Acquire();
+    while (m_written_position.load(std::memory_order_acquire) < target)
+      m_written_changed.Wait();
+    m_written_lock.Release();
+  }
+
+  void Logger::SetFileOptions(const LogSink::Options& a_options) {
+    m_file.SetOptions(a_options);
   }
 
   void Logger::Msg(const ntl::String& a_message) {
     VERIFY(m_initialized && "Logger must be initialized prior to use")
 
-    JobSystem::Instance().AddJob([a_message]() {
-      Logger::Instance().log(Verbosity::MSG, a_message);
-    });
+    log(Verbosity::MSG, a_message);
   }
 
   void Logger::Debug(const ntl::String& a_message) {
     VERIFY(m_initialized && "Logger must be initialized prior to use")
 
-    JobSystem::Instance().AddJob([a_message]() {
-      Logger::Instance().log(Verbosity::DEBUG, a_message);
-    });
+    log(Verbosity::DEBUG, a_message);
   }
 
   void Logger::Info(const ntl::String& a_message) {
     VERIFY(m_initialized && "Logger must be initialized prior to use")
 
-    JobSystem::Instance().AddJob([a_message]() {
-      Logger::Instance().log(Verbosity::INFO, a_message);
-    });
+    log(Verbosity::INFO, a_message);
   }
 
   void Logger::Warn(const ntl::String& a_message) {
     VERIFY(m_initialized && "Logger must be initialized prior to use")
 
-    JobSystem::Instance().AddJob([a_message]() {
-      Logger::Instance().log(Verbosity::WARN, a_message);
-    });
+    log(Verbosity::WARN, a_message);
   }
 
   void Logger::Error(const ntl::String& a_message) {
     VERIFY(m_initialized && "Logger must be initialized prior to use")
 
-    JobSystem::Instance().AddJob([a_message]() {
-      Logger::Instance().log(Verbosity::ERROR, a_message);
-    });
+    log(Verbosity::ERROR, a_message);
   }
 
   void Logger::Fatal(const ntl::String& a_message) {
     VERIFY(m_initialized && "Logger must be initialized prior to use")
 
-    JobSystem::Instance().AddJob([a_message]() {
-      Logger::Instance().log(Verbosity::FATAL, a_message);
-      std::terminate();
-    });
+    log(Verbosity::FATAL, a_message);
+    Flush();
+    std::terminate();
   }
 
   void Logger::SetMinVerbosity(Verbosity a_verbosity) {
-    m_configuration_lock.StartWrite();
     m_min_verbosity = a_verbosity;
-    m_configuration_lock.EndWrite();
   }
 
   void Logger::SetBufferThreshold(ntl::Size a_threshold) {
-    m_configuration_lock.StartWrite();
-    m_buffer_threshold = a_threshold;
-    m_configuration_lock.EndWrite();
+    m_buffer_threshold = std::max<ntl::Size>(a_threshold, 1);
   }
 
   Verbosity Logger::GetMinVerbosity() {
-    m_configuration_lock.StartRead();
-    auto verbosity = m_min_verbosity;
-    m_configuration_lock.EndRead();
-    return verbosity;
+    return m_min_verbosity;
   }
 
   ntl::Size Logger::GetBufferThreshold() {
-    m_configuration_lock.StartRead();
-    auto threshold = m_buffer_threshold;
-    m_configuration_lock.EndRead();
-    return threshold;
+    return m_buffer_threshold;
   }
 
   Logger::Logger()
     : m_min_verbosity{DEFAULT_MIN_VERBOSITY}, m_buffer_threshold{DEFAULT_BUFFER_THRESHOLD},
-      m_configuration_lock{}, m_logs{1024, false}, m_logs_lock{},
-      m_file{DEFAULT_PATH}, m_initialized{false} {
+      m_ring{new Slot[RING_SIZE]}, m_enqueue_position{0}, m_dequeue_position{0}, m_written_position{0},
+      m_released_position{0}, m_writer{}, m_writer_sleeping{false}, m_writer_lock{}, m_writer_wake{&m_writer_lock},
+      m_written_lock{}, m_written_changed{&m_written_lock}, m_flush_target{0}, m_file{DEFAULT_PATH}, m_batch{},
+      m_prefixes{}, m_running{false}, m_initialized{false} {
+    for (ntl::Size i = 0; i < RING_SIZE; ++i) {
+      m_ring[i].sequence.store(i, std::memory_order_relaxed);
+    }
   }
 
-  void Logger::log(Verbosity a_verbosity, const ntl::String& a_message) {
-    m_configuration_lock.StartRead();
+  Logger::~Logger() {
+    Shutdown();
+  }
 
-    if (a_verbosity < m_min_verbosity) {
-      m_configuration_lock.EndRead();
+  void Logger::log(Verbosity a_verbosity, const ntl::String& a_message) {
+    if (a_verbosity < m_min_verbosity.load(std::memory_order_relaxed))
       return;
+
+    // Overlong messages are cut rather than holding a large part of the ring
+    ntl::Size size = std::min<ntl::Size>(a_message.GetSize(), SLOT_TEXT_SIZE * MAX_SLOTS_PER_MESSAGE);
+    uint64_t slots = std::max<uint64_t>((size + SLOT_TEXT_SIZE - 1) / SLOT_TEXT_SIZE, 1);
+
+    // Claim consecutive slots, a slot at position p is free while its sequence equals p
+    uint64_t position = m_enqueue_position.load(std::memory_order_relaxed);
+    while (true) {
+      int64_t difference = 0;
+      for (uint64_t i = 0; i < slots && difference == 0; ++i) {
+        Slot& slot = m_ring[(position + i) & (RING_SIZE - 1)];
+        difference = static_cast<int64_t>(slot.sequence.load(std::memory_order_acquire) - (position + i));
+      }
+
+      if (difference == 0) {
+        if (m_enqueue_position.compare_exchange_weak(position, position + slots, std::memory_order_relaxed))
+          break;
+      } else {
+        if (difference < 0) {
+          // Ring is full, give the writer a chance to catch up
+          wakeWriter();
+          std::this_thread::yield();
+        }
+        position = m_enqueue_position.load(std::memory_order_relaxed);
+      }
     }
 
-    ntl::String log = getVerbosityPrefix(a_verbosity) + a_message + "\n";
-    auto threshold = m_buffer_threshold;
-    m_configuration_lock.EndRead();
+    const char* text = a_message.GetCString();
+    for (uint64_t i = 0; i < slots; ++i) {
+      Slot& slot = m_ring[(position + i) & (RING_SIZE - 1)];
+      ntl::Size offset = i * SLOT_TEXT_SIZE;
+      slot.verbosity = a_verbosity;
+      slot.length = static_cast<uint32_t>(std::min<ntl::Size>(size - std::min(size, offset), SLOT_TEXT_SIZE));
+      slot.remaining = static_cast<uint32_t>(slots - i - 1);
+      std::memcpy(slot.text, text + offset, slot.length);
+      slot.sequence.store(position + i + 1, std::memory_order_release);
+    }
 
-    std::cout << log;
+    // Pairs with the fence in run(), either the writer sees the message or we see it sleeping
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_writer_sleeping.load(std::memory_order_relaxed)) {
+      wakeWriter();
+    }
+  }
 
-    JobSystem::Instance().AddJob([log, threshold]() {
-      Instance().flushBuffer(log, threshold);
-    });
+  void Logger::wakeWriter() {
+    ntl::ScopeLock lock(&m_writer_lock);
+    m_writer_wake.Broadcast();
   }
 
-  void Logger::forceFlushBuffer() {
-    ntl::ScopeLock lock(&m_logs_lock);
-    m_file.WriteFile(m_logs);
-    m_logs.Clear();
+  void Logger::run() {
+    for (int i = 0; i <= static_cast<int>(Verbosity::FATAL); ++i) {
+      m_prefixes[i] = getVerbosityPrefix(static_cast<Verbosity>(i));
+    }
+
+    while (true) {
+      if (writeBatch())
+        continue;
+
+      if (!m_running) {
+        // Producers that claimed slots before the shutdown finish them shortly
+        if (m_enqueue_position.load(std::memory_order_acquire) == m_dequeue_position)
+          break;
+        std::this_thread::yield();
+        continue;
+      }
+
+      m_writer_lock.Acquire();
+      m_writer_sleeping = true;
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (!hasMessage() && m_running && m_flush_target.load() == 0)
+        m_writer_wake.Wait();
+      m_writer_sleeping = false;
+      m_writer_lock.Release();
+    }
   }
 
-  void Logger::flushBuffer(const ntl::String& a_log, ntl::Size a_threshold) {
-    ntl::ScopeLock lock(&m_logs_lock);
-    m_logs.Insert(a_log);
-    if (m_logs.GetSize() > a_threshold) {
-      m_file.WriteFile(m_logs);
-      m_logs.Clear();
+  bool Logger::writeBatch() {
+    static const char NEWLINE = '\n';
+
+    iovec buffers[IOV_MAX];
+    int count = 0;
+    ntl::Size messages = 0;
+    ntl::Size threshold = m_buffer_threshold.load(std::memory_order_relaxed);
+    uint64_t position = m_dequeue_position;
+
+    while (messages < threshold && hasMessage()) {
+      Slot& first = m_ring[position & (RING_SIZE - 1)];
+      uint64_t slots = first.remaining + 1;
+
+      // The producer publishes its slots one after another, leave the message for the next batch until it is done
+      bool complete = true;
+      for (uint64_t i = 1; i < slots && complete; ++i) {
+        Slot& slot = m_ring[(position + i) & (RING_SIZE - 1)];
+        complete = slot.sequence.load(std::memory_order_acquire) == position + i + 1;
+      }
+      if (!complete || count + static_cast<int>(slots) + 2 > IOV_MAX)
+        break;
+
+      const ntl::String& prefix = m_prefixes[static_cast<int>(first.verbosity)];
+      if (!prefix.IsEmpty()) {
+        buffers[count++] = {const_cast<char*>(prefix.GetCString()), prefix.GetSize()};
+      }
+      for (uint64_t i = 0; i < slots; ++i) {
+        Slot& slot = m_ring[(position + i) & (RING_SIZE - 1)];
+        buffers[count++] = {slot.text, slot.length};
+      }
+      buffers[count++] = {const_cast<char*>(&NEWLINE), 1};
+
+      position += slots;
+      m_dequeue_position = position;
+      ++messages;
+    }
+
+    if (messages > 0) {
+      // One write per batch, the sink only rotates between writes so a line never spans two files. writeAll()
+      // modifies the buffers so it has to come last
+      m_batch.clear();
+      for (int i = 0; i < count; ++i) {
+        m_batch.append(static_cast<const char*>(buffers[i].iov_base), buffers[i].iov_len);
+      }
+      m_file.Write(m_batch.data(), m_batch.size());
+      writeAll(STDOUT_FILENO, buffers, count);
+
+      for (uint64_t i = m_released_position; i < position; ++i) {
+        m_ring[i & (RING_SIZE - 1)].sequence.store(i + RING_SIZE, std::memory_order_release);
+      }
+      m_released_position = position;
     }
+
+    // Waiters only count a message as written once it reached the file as well, partial direct blocks included
+    uint64_t target = m_flush_target.load(std::memory_order_acquire);
+    if (target == 0 || position < target) {
+      if (messages == 0)
+        return false;
+      if (!hasMessage()) {
+        m_file.Flush(false);
+      }
+      return true;
+    }
+
+    m_file.Flush(true);
+    m_flush_target.compare_exchange_strong(target, 0);
+    ntl::ScopeLock lock(&m_written_lock);
+    m_written_position.store(position, std::memory_order_release);
+    m_written_changed.Broadcast();
+    return true;
+  }
+
+  bool Logger::hasMessage() const {
+    const Slot& slot = m_ring[m_dequeue_position & (RING_SIZE - 1)];
+    return slot.sequence.load(std::memory_order_acquire) == m_dequeue_position + 1;
   }
 
   ntl::String Logger::getVerbosityPrefix(Verbosity a_verbosity) {
@@ -8,16 +8,18 @@
 #ifndef ATLAS_LOGGER_HPP
 #define ATLAS_LOGGER_HPP
 
-#include <iostream>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
 
-#include "data/Array.hpp"
 #include "data/Bool.hpp"
-#include "data/Map.hpp"
 #include "data/String.hpp"
 #include "data/Singleton.hpp"
+#include "os/Condition.hpp"
 #include "os/Lock.hpp"
 #include "os/ScopeLock.hpp"
-#include "os/SharedLock.hpp"
 #include "utils/File.hpp"
 
 namespace atlas {
@@ -42,20 +44,52 @@ namespace atlas {
 
   /**
    * @brief Logger class used to handle logging.
+   *
+   * Producers copy their message into a fixed ring of slots and return, claiming slots with a single
+   * compare-and-swap and without allocating. A background writer thread formats the queued messages and writes
+   * them to the console and the log file in batches. Messages longer than one slot occupy consecutive slots.
+   * The log file stays open and is written through a buffer that is flushed whenever the ring runs empty.
    */
   class Logger : public ntl::Singleton<Logger> {
     SINGLETON_IMPL(Logger)
-    static constexpr ntl::Size DEFAULT_BUFFER_THRESHOLD = 64;
+    static constexpr ntl::Size DEFAULT_BUFFER_THRESHOLD = 256;
     static constexpr Verbosity DEFAULT_MIN_VERBOSITY = Verbosity::INFO;
     static constexpr const char* DEFAULT_PATH = "output.log";
+    static constexpr ntl::Size RING_SIZE = 4096;
+    static constexpr ntl::Size SLOT_TEXT_SIZE = 240;
+    static constexpr ntl::Size MAX_SLOTS_PER_MESSAGE = 64;
 
   private:
-    Verbosity m_min_verbosity;
-    ntl::Size m_buffer_threshold;
-    ntl::SharedLock m_configuration_lock;
-    ntl::Array<ntl::String> m_logs;
-    File m_file;
-    ntl::Lock m_logs_lock;
+    /**
+     * @struct Slot
+     * @brief One entry of the ring, the sequence tells whether it is free, written or being read.
+     */
+    struct alignas(64) Slot {
+      std::atomic<uint64_t> sequence;
+      Verbosity verbosity;
+      uint32_t length;
+      uint32_t remaining;
+      char text[SLOT_TEXT_SIZE];
+    };
+
+    std::atomic<Verbosity> m_min_verbosity;
+    std::atomic<ntl::Size> m_buffer_threshold;
+    std::unique_ptr<Slot[]> m_ring;
+    alignas(64) std::atomic<uint64_t> m_enqueue_position;
+    alignas(64) uint64_t m_dequeue_position;
+    std::atomic<uint64_t> m_written_position;
+    uint64_t m_released_position;
+    std::thread m_writer;
+    std::atomic<ntl::Bool> m_writer_sleeping;
+    ntl::Lock m_writer_lock;
+    ntl::Condition m_writer_wake;
+    ntl::Lock m_written_lock;
+    ntl::Condition m_written_changed;
+    std::atomic<uint64_t> m_flush_target;
+    LogSink m_file;
+    std::string m_batch;
+    ntl::String m_prefixes[static_cast<int>(Verbosity::FATAL) + 1];
+    std::atomic<ntl::Bool> m_running;
     std::atomic<ntl::Bool> m_initialized;
 
   public:
@@ -71,15 +105,26 @@ namespace atlas {
     Logger& operator=(const Logger&) = delete;
 
     /**
-     * @brief Initializes the logger.
+     * @brief Initializes the logger and starts its writer thread.
      */
     void Initialize();
 
     /**
-     * @brief Shuts down the logger (makes it unusable until initialized again).
+     * @brief Shuts down the logger (makes it unusable until initialized again), writing every queued message.
      */
     void Shutdown();
 
+    /**
+     * @brief Waits until every message logged before the call has been written, including to the log file.
+     */
+    void Flush();
+
+    /**
+     * @brief Sets the rotation and durability settings of the log file.
+     * @param a_options the log file settings
+     */
+    void SetFileOptions(const LogSink::Options& a_options);
+
     /**
      * @brief Logs a trace message on a given channel.
      * @param a_message a log message
@@ -111,10 +156,10 @@ namespace atlas {
     void Error(const ntl::String& a_message);
 
     /**
-     * @brief Logs a fatal message on a given channel.
+     * @brief Logs a fatal message, waits for it to be written and terminates on the calling thread.
      * @param a_message a log message
      */
-    void Fatal(const ntl::String& a_message);
+    [[noreturn]] void Fatal(const ntl::String& a_message);
 
     /**
      * @brief Sets the minimum verbosity to log.
@@ -123,8 +168,8 @@ namespace atlas {
     void SetMinVerbosity(Verbosity a_verbosity);
 
     /**
-     * @brief Sets the threshold of number of logs when the buffer will be flushed.
-     * @param a_threshold the threshold when to flush the buffer
+     * @brief Sets the maximum number of logs the writer puts into one batch.
+     * @param a_threshold the maximum batch size
      */
     void SetBufferThreshold(ntl::Size a_threshold);
 
@@ -134,7 +179,7 @@ namespace atlas {
     Verbosity GetMinVerbosity();
 
     /**
-     * @brief Gets the current threshold of number of logs when the buffer will be flushed.
+     * @brief Gets the maximum number of logs the writer puts into one batch.
      */
     ntl::Size GetBufferThreshold();
 
@@ -147,26 +192,36 @@ namespace atlas {
     /**
      * @brief Default Destructor
      */
-    ~Logger() = default;
+    ~Logger();
 
     /**
-     * @brief Logs a message using the given arguments.
+     * @brief Copies a message into the ring, waiting for the writer if the ring is full.
      * @param a_verbosity a log verbosity
      * @param a_message a message to log
      */
     void log(Verbosity a_verbosity, const ntl::String& a_message);
 
     /**
-     * @brief Force the buffer to be flushed wheb the given threshold is reached.
+     * @brief Wakes the writer thread if it is waiting for messages.
+     */
+    void wakeWriter();
+
+    /**
+     * @brief Runs the writer thread until the logger shuts down and the ring is empty.
+     */
+    void run();
+
+    /**
+     * @brief Writes the next batch of complete messages and frees their slots.
+     * @return if anything was written or flushed
      */
-    void forceFlushBuffer();
+    bool writeBatch();
 
     /**
-     * @brief Inserts the next log to the buffer and flushed when the given threshold is reached.
-     * @param a_log the log to insert
-     * @param a_threshold the threshold to check for
+     * @brief Checks whether the next message in the ring is completely written by its producer.
+     * @return if the writer can take the next message
      */
-    void flushBuffer(const ntl::String& a_log, ntl::Size a_threshold);
+    bool hasMessage() const;
 
     /**
      * @brief Gets the string prefix for a given verbosity enum.
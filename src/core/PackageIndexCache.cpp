@@ -0,0 +1,335 @@
+/**
+* @file PackageIndexCache.cpp
+* @author Marcus Gugacs
+* @date 16.10.26
+* @copyright Copyright (c) 2026 Marcus Gugacs. All rights reserved.
+*/
+
+#include "PackageIndexCache.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace atlas {
+  namespace {
+    size_t alignUp(size_t a_value) {
+      return (a_value + 3) & ~static_cast<size_t>(3);
+    }
+  }
+
+  PackageIndexCache::PackageIndexCache()
+    : m_mapping(nullptr), m_mapping_size(0), m_header(nullptr), m_string_offsets(nullptr),
+      m_string_data(nullptr), m_records(nullptr), m_lists(nullptr) {
+  }
+
+  PackageIndexCache::~PackageIndexCache() {
+    Close();
+  }
+
+  bool PackageIndexCache::Open(const fs::path& a_path) {
+    Close();
+
+    int fd = open(a_path.c_str(), O_RDONLY);
+    if (fd < 0)
+      return false;
+
+    struct stat info{};
+    if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(Header)) {
+      close(fd);
+      return false;
+    }
+
+    m_mapping_size = static_cast<size_t>(info.st_size);
+    m_mapping = mmap(nullptr, m_mapping_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (m_mapping == MAP_FAILED) {
+      m_mapping = nullptr;
+      m_mapping_size = 0;
+      return false;
+    }
+
+    const auto* base = static_cast<const char*>(m_mapping);
+    m_header = reinterpret_cast<const Header*>(base);
+
+    if (m_header->magic != MAGIC || m_header->version != VERSION) {
+      Close();
+      return false;
+    }
+
+    size_t offsets_size = static_cast<size_t>(m_header->string_count) * sizeof(uint32_t);
+    size_t data_size = alignUp(m_header->string_data_size);
+    size_t records_size = static_cast<size_t>(m_header->record_count) * sizeof(Record);
+    size_t lists_size = static_cast<size_t>(m_header->list_count) * sizeof(uint32_t);
+
+    if (sizeof(Header) + offsets_size + data_size + records_size + lists_size != m_mapping_size) {
+      Close();
+      return false;
+    }
+
+    const char* payload = base + sizeof(Header);
+    if (Checksum(payload, m_mapping_size - sizeof(Header)) != m_header->checksum) {
+      Close();
+      return false;
+    }
+
+    m_string_offsets = reinterpret_cast<const uint32_t*>(payload);
+    m_string_data = payload + offsets_size;
+    m_records = reinterpret_cast<const Record*>(m_string_data + data_size);
+    m_lists = reinterpret_cast<const uint32_t*>(reinterpret_cast<const char*>(m_records) + records_size);
+
+    if (!validate()) {
+      Close();
+      return false;
+    }
+
+#ifdef MADV_WILLNEED
+    madvise(m_mapping, m_mapping_size, MADV_WILLNEED);
+#endif
+
+    return true;
+  }
+
+  void PackageIndexCache::Close() {
+    if (m_mapping) {
+      munmap(m_mapping, m_mapping_size);
+    }
+
+    m_mapping = nullptr;
+    m_mapping_size = 0;
+    m_header = nullptr;
+    m_string_offsets = nullptr;
+    m_string_data = nullptr;
+    m_records = nullptr;
+    m_lists = nullptr;
+  }
+
+  size_t PackageIndexCache::GetPackageCount() const {
+    return m_header ? m_header->record_count : 0;
+  }
+
+  void PackageIndexCache::GetPackage(size_t a_index, const ntl::String& a_repository, PackageConfig& a_config) const {
+    const Record& record = m_records[a_index];
+
+    a_config.name = getString(record.name);
+    a_config.version = getString(record.version);
+    a_config.description = getString(record.description);
+    a_config.build_command = getString(record.build_command);
+    a_config.install_command = getString(record.install_command);
+    a_config.uninstall_command = getString(record.uninstall_command);
+    a_config.repository = a_repository;
+    getList(record.dependency_offset, record.dependency_count, a_config.dependencies);
+    getList(record.conflict_offset, record.conflict_count, a_config.conflicts);
+
+    if (!record.has_plan) {
+      a_config.plan.reset();
+      return;
+    }
+
+    auto plan = std::make_shared<InstallPlan>();
+    plan->url = getString(record.url);
+    plan->target = getString(record.target);
+    plan->sha256 = getString(record.sha256);
+    plan->bottle_url = getString(record.bottle_url);
+    plan->bottle_sha256 = getString(record.bottle_sha256);
+    plan->writes_prefix = record.writes_prefix != 0;
+    for (size_t step = 0; step < INSTALL_STEP_COUNT; ++step) {
+      getList(record.step_offset[step], record.step_count[step], plan->steps[step]);
+    }
+    a_config.plan = std::move(plan);
+  }
+
+  bool PackageIndexCache::Write(const fs::path& a_path, const std::vector<PackageConfig>& a_configs) {
+    Writer writer;
+    for (const auto& config : a_configs) {
+      writer.Add(config);
+    }
+    return writer.Write(a_path);
+  }
+
+  PackageIndexCache::Writer::Writer() : m_strings(), m_records(), m_lists() {}
+
+  void PackageIndexCache::Writer::Add(const PackageConfig& a_config) {
+    Record record{};
+    record.name = intern(a_config.name);
+    record.version = intern(a_config.version);
+    record.description = intern(a_config.description);
+    record.build_command = intern(a_config.build_command);
+    record.install_command = intern(a_config.install_command);
+    record.uninstall_command = intern(a_config.uninstall_command);
+    appendList(a_config.dependencies, record.dependency_offset, record.dependency_count);
+    appendList(a_config.conflicts, record.conflict_offset, record.conflict_count);
+
+    // Plan strings are interned as well, packages built the same way share their commands. Without a plan the
+    // fields stay at id 0, the empty string
+    const InstallPlan* plan = a_config.plan.get();
+    record.has_plan = plan ? 1 : 0;
+    if (plan) {
+      record.url = intern(plan->url);
+      record.target = intern(plan->target);
+      record.sha256 = intern(plan->sha256);
+      record.bottle_url = intern(plan->bottle_url);
+      record.bottle_sha256 = intern(plan->bottle_sha256);
+      record.writes_prefix = plan->writes_prefix ? 1 : 0;
+    }
+    for (size_t step = 0; step < INSTALL_STEP_COUNT; ++step) {
+      if (plan) {
+        appendList(plan->steps[step], record.step_offset[step], record.step_count[step]);
+      } else {
+        record.step_offset[step] = static_cast<uint32_t>(m_lists.size());
+      }
+    }
+    m_records.push_back(record);
+  }
+
+  bool PackageIndexCache::Writer::Write(const fs::path& a_path) const {
+    // Assemble the payload in memory so the checksum can be computed before anything hits the disk
+    std::vector<uint32_t> offsets(m_strings.GetCount());
+    std::string data;
+    for (uint32_t id = 0; id < offsets.size(); ++id) {
+      std::string_view value = m_strings.GetView(id);
+      offsets[id] = static_cast<uint32_t>(data.size());
+      data.append(value);
+      data.push_back('\0');
+    }
+    size_t data_size = data.size();
+    data.resize(alignUp(data_size), '\0');
+
+    std::string payload;
+    payload.reserve(offsets.size() * sizeof(uint32_t) + data.size() + m_records.size() * sizeof(Record) +
+                    m_lists.size() * sizeof(uint32_t));
+    payload.append(reinterpret_cast<const char*>(offsets.data()), offsets.size() * sizeof(uint32_t));
+    payload.append(data);
+    payload.append(reinterpret_cast<const char*>(m_records.data()), m_records.size() * sizeof(Record));
+    payload.append(reinterpret_cast<const char*>(m_lists.data()), m_lists.size() * sizeof(uint32_t));
+
+    Header header{
+      MAGIC,
+      VERSION,
+      Checksum(payload.data(), payload.size()),
+      static_cast<uint32_t>(offsets.size()),
+      static_cast<uint32_t>(data_size),
+      static_cast<uint32_t>(m_records.size()),
+      static_cast<uint32_t>(m_lists.size())
+    };
+
+    try {
+      fs::create_directories(a_path.parent_path());
+      fs::path temp_path = a_path;
+      temp_path += ".tmp";
+
+      {
+        std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+        if (!file)
+          return false;
+        file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+        file.write(payload.data(), static_cast<std::streamsize>(payload.size()));
+        if (!file)
+          return false;
+      }
+
+      fs::rename(temp_path, a_path);
+    } catch (const std::exception&) {
+      return false;
+    }
+
+    return true;
+  }
+
+  void PackageIndexCache::Writer::appendList(const ntl::Array<ntl::String>& a_values, uint32_t& a_offset,
+                                             uint32_t& a_count) {
+    a_offset = static_cast<uint32_t>(m_lists.size());
+    a_count = static_cast<uint32_t>(a_values.GetSize());
+    for (const auto& value : a_values) {
+      m_lists.push_back(intern(value));
+    }
+  }
+
+  uint32_t PackageIndexCache::Writer::intern(const ntl::String& a_value) {
+    return m_strings.Intern({a_value.GetCString(), a_value.GetSize()});
+  }
+
+  const char* PackageIndexCache::getString(uint32_t a_id) const {
+    return m_string_data + m_string_offsets[a_id];
+  }
+
+  bool PackageIndexCache::validate() const {
+    uint32_t string_count = m_header->string_count;
+    uint32_t data_size = m_header->string_data_size;
+
+    if (string_count > 0 && (data_size == 0 || m_string_data[data_size - 1] != '\0'))
+      return false;
+
+    for (uint32_t i = 0; i < string_count; ++i) {
+      if (m_string_offsets[i] >= data_size)
+        return false;
+    }
+
+    for (uint32_t i = 0; i < m_header->record_count; ++i) {
+      const Record& record = m_records[i];
+      if (record.name >= string_count || record.version >= string_count ||
+          record.description >= string_count || record.build_command >= string_count ||
+          record.install_command >= string_count || record.uninstall_command >= string_count ||
+          record.url >= string_count || record.target >= string_count || record.sha256 >= string_count ||
+          record.bottle_url >= string_count || record.bottle_sha256 >= string_count)
+        return false;
+      if (!isValidList(record.dependency_offset, record.dependency_count) ||
+          !isValidList(record.conflict_offset, record.conflict_count))
+        return false;
+      for (size_t step = 0; step < INSTALL_STEP_COUNT; ++step) {
+        if (!isValidList(record.step_offset[step], record.step_count[step]))
+          return false;
+      }
+    }
+
+    for (uint32_t i = 0; i < m_header->list_count; ++i) {
+      if (m_lists[i] >= string_count)
+        return false;
+    }
+
+    return true;
+  }
+
+  void PackageIndexCache::getList(uint32_t a_offset, uint32_t a_count, ntl::Array<ntl::String>& a_values) const {
+    a_values.Clear();
+    for (uint32_t i = 0; i < a_count; ++i) {
+      a_values.Insert(getString(m_lists[a_offset + i]));
+    }
+  }
+
+  bool PackageIndexCache::isValidList(uint32_t a_offset, uint32_t a_count) const {
+    return static_cast<uint64_t>(a_offset) + a_count <= m_header->list_count;
+  }
+
+  bool PackageIndexCache::ReadChecksum(const fs::path& a_path, uint64_t& a_checksum) {
+    int fd = open(a_path.c_str(), O_RDONLY);
+    if (fd < 0)
+      return false;
+
+    Header header{};
+    bool valid = pread(fd, &header, sizeof(Header), 0) == static_cast<ssize_t>(sizeof(Header)) &&
+                 header.magic == MAGIC && header.version == VERSION;
+    close(fd);
+
+    if (valid) {
+      a_checksum = header.checksum;
+    }
+    return valid;
+  }
+
+  uint64_t PackageIndexCache::Checksum(const char* a_data, size_t a_size) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < a_size; ++i) {
+      hash ^= static_cast<unsigned char>(a_data[i]);
+      hash *= 0x100000001b3ULL;
+    }
+    return hash;
+  }
+}
@@ -0,0 +1,258 @@
+/**
+* @file PackageIndexCache.hpp
+* @author Marcus Gugacs
+* @date 16.10.26
+* @copyright Copyright (c) 2026 Marcus Gugacs. All rights reserved.
+*/
+
+#ifndef ATLAS_PACKAGE_INDEX_CACHE_HPP
+#define ATLAS_PACKAGE_INDEX_CACHE_HPP
+
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+#include <data/String.hpp>
+
+#include "pods/PackageConfig.hpp"
+#include "utils/StringPool.hpp"
+
+namespace fs = std::filesystem;
+
+namespace atlas {
+  /**
+   * @class PackageIndexCache
+   * @brief Compact, memory-mapped binary snapshot of a repository's package index.
+   *
+   * The file consists of a fixed header, an interned string table, a flat array of package records
+   * referencing strings by id and a table of string id lists (dependencies, conflicts and step commands).
+   * It is written once per fetch and mapped read-only on startup, so neither loading the index nor
+   * installing a package has to walk the repository tree or parse any JSON.
+   */
+  class PackageIndexCache {
+  public:
+    static constexpr uint32_t MAGIC = 0x494c5441; // "ATLI"
+    static constexpr uint32_t VERSION = 5;
+
+    /**
+     * @struct Header
+     * @brief On-disk header of the index file.
+     */
+    struct Header {
+      uint32_t magic;
+      uint32_t version;
+      uint64_t checksum;
+      uint32_t string_count;
+      uint32_t string_data_size;
+      uint32_t record_count;
+      uint32_t list_count;
+    };
+
+    /**
+     * @struct Record
+     * @brief On-disk representation of a single package.
+     *
+     * Plain fields are string ids, offset and count pairs select a range of the list table. A package without
+     * an install plan stores has_plan = 0 and empty plan fields.
+     */
+    struct Record {
+      uint32_t name;
+      uint32_t version;
+      uint32_t description;
+      uint32_t build_command;
+      uint32_t install_command;
+      uint32_t uninstall_command;
+      uint32_t dependency_offset;
+      uint32_t dependency_count;
+      uint32_t conflict_offset;
+      uint32_t conflict_count;
+      uint32_t has_plan;
+      uint32_t url;
+      uint32_t target;
+      uint32_t sha256;
+      uint32_t bottle_url;
+      uint32_t bottle_sha256;
+      uint32_t writes_prefix;
+      uint32_t step_offset[INSTALL_STEP_COUNT];
+      uint32_t step_count[INSTALL_STEP_COUNT];
+    };
+
+    /**
+     * @class Writer
+     * @brief Collects packages one at a time and serializes them into an index file.
+     *
+     * Every string is interned as soon as its package is added, so a caller streaming packages in only keeps
+     * the compact tables around instead of the packages themselves.
+     */
+    class Writer {
+    private:
+      StringPool m_strings;
+      std::vector<Record> m_records;
+      std::vector<uint32_t> m_lists;
+
+    public:
+      /**
+       * @brief Default constructor, creates a writer without packages.
+       */
+      Writer();
+
+      /**
+       * @brief Adds a package to the index.
+       *
+       * @param a_config Package to add
+       */
+      void Add(const PackageConfig& a_config);
+
+      /**
+       * @brief Returns the number of added packages.
+       *
+       * @return The package count
+       */
+      size_t GetPackageCount() const { return m_records.size(); }
+
+      /**
+       * @brief Writes the added packages to an index file.
+       *
+       * The file is written to a temporary location first and renamed into place afterwards, so readers
+       * never observe a partially written index.
+       *
+       * @param a_path Path to write the index file to
+       * @return True if successful, false otherwise
+       */
+      bool Write(const fs::path& a_path) const;
+
+    private:
+      /**
+       * @brief Appends the ids of a list of strings to the list table.
+       *
+       * @param a_values Strings to append
+       * @param a_offset Receives the position of the first entry
+       * @param a_count Receives the number of entries
+       */
+      void appendList(const ntl::Array<ntl::String>& a_values, uint32_t& a_offset, uint32_t& a_count);
+
+      /**
+       * @brief Interns a string.
+       *
+       * @param a_value String to intern
+       * @return The id of the string
+       */
+      uint32_t intern(const ntl::String& a_value);
+    };
+
+  private:
+    void* m_mapping;
+    size_t m_mapping_size;
+    const Header* m_header;
+    const uint32_t* m_string_offsets;
+    const char* m_string_data;
+    const Record* m_records;
+    const uint32_t* m_lists;
+
+  public:
+    /**
+     * @brief Default constructor, creates a closed cache.
+     */
+    PackageIndexCache();
+
+    /**
+     * @brief Destructor, unmaps the file if it is still open.
+     */
+    ~PackageIndexCache();
+
+    PackageIndexCache(const PackageIndexCache&) = delete;
+    PackageIndexCache& operator=(const PackageIndexCache&) = delete;
+
+    /**
+     * @brief Maps the given index file and validates its header, bounds and checksum.
+     *
+     * @param a_path Path to the index file
+     * @return True if the file was mapped and is valid, false otherwise
+     */
+    bool Open(const fs::path& a_path);
+
+    /**
+     * @brief Unmaps the currently opened file.
+     */
+    void Close();
+
+    /**
+     * @brief Returns the number of packages stored in the opened index.
+     *
+     * @return The package count (zero if closed)
+     */
+    size_t GetPackageCount() const;
+
+    /**
+     * @brief Materializes the package at the given position, including its install plan.
+     *
+     * @param a_index Position of the package in the index
+     * @param a_repository Repository name to assign to the package
+     * @param a_config Package configuration to fill
+     */
+    void GetPackage(size_t a_index, const ntl::String& a_repository, PackageConfig& a_config) const;
+
+    /**
+     * @brief Serializes the given packages into an index file, see Writer.
+     *
+     * @param a_path Path to write the index file to
+     * @param a_configs Packages to store
+     * @return True if successful, false otherwise
+     */
+    static bool Write(const fs::path& a_path, const std::vector<PackageConfig>& a_configs);
+
+    /**
+     * @brief Reads the checksum stored in an index file's header without mapping or validating the file.
+     *
+     * @param a_path Path to the index file
+     * @param a_checksum Receives the checksum
+     * @return True if the file exists and has a header of the current format, false otherwise
+     */
+    static bool ReadChecksum(const fs::path& a_path, uint64_t& a_checksum);
+
+    /**
+     * @brief Computes the 64-bit FNV-1a checksum of the given bytes.
+     *
+     * @param a_data Data to hash
+     * @param a_size Number of bytes
+     * @return The checksum
+     */
+    static uint64_t Checksum(const char* a_data, size_t a_size);
+
+  private:
+    /**
+     * @brief Returns the interned string for the given id.
+     *
+     * @param a_id String id
+     * @return Pointer to the NUL-terminated string inside the mapping
+     */
+    const char* getString(uint32_t a_id) const;
+
+    /**
+     * @brief Validates all string ids and offsets referenced by the mapped file.
+     *
+     * @return True if every reference is in bounds, false otherwise
+     */
+    bool validate() const;
+
+    /**
+     * @brief Copies a range of the list table into an array of strings.
+     *
+     * @param a_offset First entry of the range
+     * @param a_count Number of entries
+     * @param a_values Array to fill, its previous contents are replaced
+     */
+    void getList(uint32_t a_offset, uint32_t a_count, ntl::Array<ntl::String>& a_values) const;
+
+    /**
+     * @brief Checks that a range lies within the list table.
+     *
+     * @param a_offset First entry of the range
+     * @param a_count Number of entries
+     * @return True if the range is in bounds, false otherwise
+     */
+    bool isValidList(uint32_t a_offset, uint32_t a_count) const;
+  };
+}
+
+#endif // ATLAS_PACKAGE_INDEX_CACHE_HPP
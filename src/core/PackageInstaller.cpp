@@ -7,97 +7,543 @@
 
 #include "PackageInstaller.hpp"
 
-#include <curl/curl.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <sys/stat.h>
+#include <sys/utsname.h>
+#include <thread>
+#include <unordered_map>
 
+#include <os/ScopeLock.hpp>
+
+#include "core/Bottle.hpp"
 #include "utils/Misc.hpp"
+#include "utils/Sha256.hpp"
 
 namespace atlas {
+  namespace {
+    constexpr char BUILD_KEY_VERSION[] = "atlas-build-2";
+
+    // Variables that change what a build produces without showing up in its commands
+    constexpr const char* BUILD_ENVIRONMENT[] = {
+      "CC", "CXX", "AR", "LD", "CFLAGS", "CXXFLAGS", "CPPFLAGS", "LDFLAGS", "PKG_CONFIG_PATH"
+    };
+
+    // Variables that differ between runs without changing the build, keyed by name only
+    constexpr const char* RUN_VARIABLES[] = {"LOG_DIR"};
+
+    constexpr InstallStep CACHED_STEPS[] = {InstallStep::PREPARE, InstallStep::BUILD, InstallStep::INSTALL};
+
+    // Atlas' own bookkeeping in the install directory, never part of a package
+    constexpr const char* ATLAS_FILES[] = {"installed.json", "repositories.json", "logs",
+                                           InstallTransaction::STATE_DIR};
+
+    /**
+     * @struct FileState
+     * @brief What tells whether a file in the install directory was written.
+     */
+    struct FileState {
+      ino_t inode;
+      off_t size;
+      int64_t modified_ns;
+      int64_t changed_ns;
+      bool directory;
+    };
+
+    using PrefixSnapshot = std::unordered_map<std::string, FileState>;
+
+    /**
+     * @brief Serializes changes to the install directory, an install step must only see its own package's files.
+     */
+    ntl::Lock& prefixLock() {
+      static ntl::Lock lock;
+      return lock;
+    }
+
+    /**
+     * @brief Records the state of every file in the install directory, without following links.
+     */
+    PrefixSnapshot snapshotPrefix(const fs::path& a_root) {
+      PrefixSnapshot snapshot;
+      std::error_code error;
+      for (auto it = fs::recursive_directory_iterator(a_root, fs::directory_options::skip_permission_denied, error);
+           !error && it != fs::recursive_directory_iterator(); it.increment(error)) {
+        std::string name = it->path().lexically_relative(a_root).generic_string();
+        if (it.depth() == 0 && std::any_of(std::begin(ATLAS_FILES), std::end(ATLAS_FILES),
+                                           [&name](const char* a_file) { return name.rfind(a_file, 0) == 0; })) {
+          it.disable_recursion_pending();
+          continue;
+        }
+
+        struct stat info{};
+        if (lstat(it->path().c_str(), &info) != 0)
+          continue;
+        snapshot[name] = {
+          info.st_ino,
+          info.st_size,
+          static_cast<int64_t>(info.st_mtim.tv_sec) * 1000000000 + info.st_mtim.tv_nsec,
+          static_cast<int64_t>(info.st_ctim.tv_sec) * 1000000000 + info.st_ctim.tv_nsec,
+          S_ISDIR(info.st_mode)
+        };
+      }
+      return snapshot;
+    }
+
+    /**
+     * @brief Lists what was added and what was written between two snapshots, every directory before its contents.
+     */
+    void findChanges(const PrefixSnapshot& a_before, const PrefixSnapshot& a_after, std::vector<fs::path>& a_added,
+                     std::vector<fs::path>& a_modified) {
+      // Directories that existed change whenever a file is added to them, only new ones belong to the package
+      for (const auto& [name, state] : a_after) {
+        auto previous = a_before.find(name);
+        if (previous == a_before.end()) {
+          a_added.emplace_back(name);
+        } else if (!state.directory && (previous->second.inode != state.inode ||
+                                        previous->second.size != state.size ||
+                                        previous->second.modified_ns != state.modified_ns ||
+                                        previous->second.changed_ns != state.changed_ns)) {
+          a_modified.emplace_back(name);
+        }
+      }
+
+      std::sort(a_added.begin(), a_added.end(), [](const fs::path& a_lhs, const fs::path& a_rhs) {
+        return a_lhs.native() < a_rhs.native();
+      });
+    }
+
+    /**
+     * @brief Identifies the executable a command name resolves to on the PATH by its path, size and age.
+     */
+    std::string describeExecutable(const std::string& a_command) {
+      std::string name = a_command.substr(0, a_command.find(' '));
+      std::vector<fs::path> candidates;
+      if (name.find('/') != std::string::npos) {
+        candidates.emplace_back(name);
+      } else if (const char* path = std::getenv("PATH")) {
+        std::string directories = path;
+        for (size_t begin = 0, end = 0; begin <= directories.size(); begin = end + 1) {
+          end = std::min(directories.find(':', begin), directories.size());
+          candidates.push_back(fs::path(directories.substr(begin, end - begin)) / name);
+        }
+      }
+
+      for (const fs::path& candidate : candidates) {
+        struct stat info{};
+        if (stat(candidate.c_str(), &info) != 0 || !S_ISREG(info.st_mode) || access(candidate.c_str(), X_OK) != 0)
+          continue;
+
+        std::error_code error;
+        return fs::canonical(candidate, error).string() + ":" + std::to_string(info.st_size) + ":" +
+               std::to_string(info.st_mtim.tv_sec);
+      }
+      return name + ":missing";
+    }
+  }
+
   PackageInstaller::PackageInstaller(const fs::path& a_cache, const fs::path& a_install, const fs::path& a_log,
-                                     const PackageConfig& a_package_config): m_cache_dir(a_cache),
-                                                                             m_install_dir(a_install),
-                                                                             m_log_dir(a_log) {
-#ifdef __APPLE__
-    m_platform = "macos";
-#else
-          platform = "linux";
-#endif
+                                     const PackageConfig& a_package_config, DownloadCache* a_download_cache,
+                                     BuildCache* a_build_cache, const Options& a_options,
+                                     const std::vector<ntl::String>& a_dependency_builds)
+    : m_cache_dir(a_cache), m_install_dir(a_install), m_log_dir(a_log), m_download_cache(a_download_cache),
+      m_build_cache(a_build_cache), m_options(a_options), m_bottle(false), m_package_name(a_package_config.name),
+      m_package_version(a_package_config.version), m_plan(a_package_config.plan) {
+    defineVariables(a_package_config);
+    compileSteps();
+    computeBuildKey(a_package_config, a_dependency_builds);
+
+    // Unverified binaries are never installed, a bottle without a valid checksum is ignored
+    ntl::String digest;
+    m_bottle = m_options.bottles && m_download_cache && m_plan && !m_plan->bottle_url.IsEmpty() &&
+               DownloadCache::ParseChecksum(m_plan->bottle_sha256, digest);
+  }
+
+  bool PackageInstaller::HasCachedBuild() const {
+    return m_build_cache && !m_build_key.IsEmpty() && m_build_cache->Contains(m_build_key);
+  }
+
+  bool PackageInstaller::InstallCachedBuild() {
+    if (!m_build_cache || m_build_key.IsEmpty())
+      return false;
+
+    LOG_DEBUG(ntl::String{"Using cached build of "} + m_package_name + " " + m_package_version);
+    InstallTransaction transaction(m_install_dir, m_package_name);
+    if (!transaction.Begin() || !m_build_cache->Extract(m_build_key, transaction.GetStagingDir()))
+      return false;
+
+    ntl::ScopeLock lock(&prefixLock());
+    return commit(transaction);
+  }
+
+  void PackageInstaller::StartDownload() {
+    if (m_download.valid())
+      return;
+
+    if (!m_plan) {
+      std::promise<DownloadManager::Result> promise;
+      promise.set_value({false, 0, ntl::String{"No install instructions for "} + HOST_PLATFORM});
+      m_download = promise.get_future().share();
+      return;
+    }
+
+    // A bottle takes the place of the source download
+    const ntl::String& url = m_bottle ? m_plan->bottle_url : m_plan->url;
+    const ntl::String& checksum = m_bottle ? m_plan->bottle_sha256 : m_plan->sha256;
+    m_download_target = m_bottle ? m_cache_dir / "bottles" / getBottleName()
+                                 : fs::path(expandVariables(m_plan->target.GetCString()));
+
+    if (m_download_cache && !checksum.IsEmpty()) {
+      if (!DownloadCache::ParseChecksum(checksum, m_download_digest)) {
+        std::promise<DownloadManager::Result> promise;
+        promise.set_value({false, 0, "Invalid sha256 in package manifest"});
+        m_download = promise.get_future().share();
+        return;
+      }
+
+      if (m_download_cache->Fetch(m_download_digest, m_download_target)) {
+        LOG_DEBUG(ntl::String{"Using cached download for "} + m_download_target.c_str());
+        std::promise<DownloadManager::Result> promise;
+        promise.set_value({true, 0, ""});
+        m_download = promise.get_future().share();
+        return;
+      }
+
+      // Hashing happens on the worker waiting for the download so the event loop never blocks on it
+      m_download = m_download_cache->Download(m_download_digest, expandVariables(url.GetCString()).c_str(),
+                                              m_download_target);
+      return;
+    }
+
+    DownloadManager::Request request{expandVariables(url.GetCString()).c_str(), m_download_target, {}, {}};
+    m_download = DownloadManager::Instance().Submit(std::move(request));
+  }
+
+  bool PackageInstaller::InstallBottle() {
+    if (!m_bottle)
+      return false;
+
+    // Bottles unpack and verify in parallel with other installs, only the commit waits for the install directory
+    InstallTransaction transaction(m_install_dir, m_package_name);
+    bool success = Download() && transaction.Begin();
+    if (success) {
+      std::vector<fs::path> files;
+      success = Bottle::Extract(m_download_target, transaction.GetStagingDir(), m_package_name, m_package_version,
+                                files);
+    }
+    if (success) {
+      ntl::ScopeLock lock(&prefixLock());
+      success = commit(transaction);
+    }
+
+    // The download cache keeps its own copy of the bottle
+    std::error_code error;
+    fs::remove(m_download_target, error);
+
+    if (!success) {
+      LOG_WARN(ntl::String{"Failed to install the bottle of "} + m_package_name + ", building from source");
+      m_bottle = false;
+      m_download = {};
+      m_download_digest = "";
+      m_download_target.clear();
+    }
+    return success;
+  }
+
+  bool PackageInstaller::CreateBottle(const fs::path& a_directory, fs::path& a_path) {
+    if (!HasCachedBuild()) {
+      LOG_ERROR(ntl::String{"No cached build of "} + m_package_name + " " + m_package_version +
+                ", install it with the build cache enabled first");
+      return false;
+    }
 
-    // Load package.json from the package's directory
-    fs::path packageJsonPath = m_cache_dir / a_package_config.repository.GetCString() /
-                               "packages" / a_package_config.name.GetCString() / "package.json";
-    std::ifstream configFile(packageJsonPath);
-    if (configFile.is_open()) {
-      configFile >> m_config;
+    // Bottles list their files, the cached build is unpacked to a scratch directory to enumerate them
+    fs::path staging = m_cache_dir / "bottles" / (getBottleName() + ".staging");
+    std::error_code error;
+    fs::remove_all(staging, error);
+    if (!m_build_cache->Extract(m_build_key, staging))
+      return false;
+
+    std::vector<fs::path> files;
+    for (auto it = fs::recursive_directory_iterator(staging, error);
+         !error && it != fs::recursive_directory_iterator(); it.increment(error)) {
+      files.push_back(it->path().lexically_relative(staging));
     }
+    std::sort(files.begin(), files.end(), [](const fs::path& a_lhs, const fs::path& a_rhs) {
+      return a_lhs.native() < a_rhs.native();
+    });
+
+    fs::create_directories(a_directory, error);
+    a_path = a_directory / getBottleName();
+    bool success = !error && Bottle::Create(a_path, m_package_name, m_package_version, staging, files);
+    fs::remove_all(staging, error);
+    return success;
   }
 
   bool PackageInstaller::Download() {
-    const auto& step = m_config["platforms"][m_platform.GetCString()]["steps"]["download"];
-    return downloadFile(step["url"].asString().c_str(), step["target"].asString().c_str());
+    StartDownload();
+
+    const DownloadManager::Result& result = m_download.get();
+    if (!result.success) {
+      // A resumable partial download stays in the store for the next attempt to continue
+      LOG_ERROR("Download failed: " + result.error);
+      return false;
+    }
+    return true;
   }
 
   bool PackageInstaller::Prepare() {
-    return executeCommands(
-      m_config["platforms"][m_platform.GetCString()]["steps"]["prepare"]["commands"]);
+    return executeCommands(InstallStep::PREPARE);
   }
 
   bool PackageInstaller::Build() {
-    return executeCommands(
-      m_config["platforms"][m_platform.GetCString()]["steps"]["build"]["commands"]);
+    return executeCommands(InstallStep::BUILD);
   }
 
   bool PackageInstaller::Install() {
-    return executeCommands(
-      m_config["platforms"][m_platform.GetCString()]["steps"]["install"]["commands"]);
+    InstallTransaction transaction(m_install_dir, m_package_name);
+    if (!transaction.Begin())
+      return false;
+
+    bool success;
+    if (!m_plan || !m_plan->writes_prefix) {
+      // Commands that honor PREFIX only write to the staging directory, installs run side by side
+      setPrefix(transaction.GetStagingDir());
+      success = executeCommands(InstallStep::INSTALL);
+      setPrefix(m_install_dir);
+    } else {
+      // Held until the changes are staged, files written meanwhile would be adopted by the wrong package
+      ntl::ScopeLock lock(&prefixLock());
+      PrefixSnapshot before = snapshotPrefix(m_install_dir);
+      if (!transaction.Preserve(m_previous_files))
+        return false;
+      setPrefix(transaction.GetStagingDir());
+      success = executeCommands(InstallStep::INSTALL);
+      setPrefix(m_install_dir);
+
+      // Also adopted after a failure, so that the rollback removes or restores them with the rest
+      std::vector<fs::path> added;
+      std::vector<fs::path> modified;
+      findChanges(before, snapshotPrefix(m_install_dir), added, modified);
+      success = transaction.Adopt(added, modified) && success;
+    }
+    if (!success)
+      return false;
+
+    // Only reads the staging directory, other installs may use the install directory while it compresses
+    if (m_build_cache && !m_build_key.IsEmpty()) {
+      captureBuild(transaction);
+    }
+
+    ntl::ScopeLock lock(&prefixLock());
+    return commit(transaction);
   }
 
   bool PackageInstaller::Cleanup() {
-    return executeCommands(
-      m_config["platforms"][m_platform.GetCString()]["steps"]["cleanup"]["commands"]);
+    return executeCommands(InstallStep::CLEANUP);
   }
 
   bool PackageInstaller::Uninstall() {
-    return executeCommands(
-      m_config["platforms"][m_platform.GetCString()]["steps"]["uninstall"]["commands"]);
+    return executeCommands(InstallStep::UNINSTALL);
   }
 
-  bool PackageInstaller::executeCommands(const Json::Value& a_commands) {
-    for (const auto& cmd : a_commands) {
-      ntl::String command = replaceVariables(cmd.asString().c_str());
-      if (ProcessCommand(command, ntl::String{(m_log_dir / "latest.log").c_str()}, false) != 0) {
-        return false;
+  bool PackageInstaller::executeCommands(InstallStep a_step) {
+    const std::vector<CommandTemplate>& commands = m_steps[static_cast<size_t>(a_step)];
+    if (commands.empty())
+      return true;
+    const char* step_name = GetStepName(a_step);
+
+    LogSink log(ntl::String{(m_log_dir / (std::string(step_name) + ".log")).c_str()}, m_options.log);
+    auto started = std::chrono::system_clock::now();
+    auto start = std::chrono::steady_clock::now();
+
+    int exit_code = 0;
+    bool timed_out = false;
+    uint64_t stdout_bytes = 0;
+    uint64_t stderr_bytes = 0;
+    Json::UInt executed = 0;
+    std::string rendered;
+    for (const CommandTemplate& cmd : commands) {
+      cmd.Render(m_variables, rendered);
+      ntl::String command{rendered.c_str()};
+      log.Write("$ " + command + "\n");
+
+      ProcessRunner::Result result{};
+      exit_code = ProcessCommand(command, &log, false, m_options.limits, &result);
+      stdout_bytes += result.stdout_bytes;
+      stderr_bytes += result.stderr_bytes;
+      timed_out = result.timed_out;
+      ++executed;
+
+      if (exit_code != 0) {
+        LOG_ERROR(m_package_name + ": " + step_name + " failed with exit code " + exit_code + ", see " +
+                  (m_log_dir / (std::string(step_name) + ".log")).c_str());
+        break;
       }
     }
-    return true;
+    log.Close();
+
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    std::time_t started_time = std::chrono::system_clock::to_time_t(started);
+    std::tm utc{};
+    gmtime_r(&started_time, &utc);
+    char timestamp[32];
+    std::strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ", &utc);
+
+    Json::Value summary;
+    summary["package"] = m_package_name.GetCString();
+    summary["version"] = m_package_version.GetCString();
+    summary["step"] = step_name;
+    summary["started"] = timestamp;
+    summary["duration_ms"] = static_cast<Json::Int64>(duration.count());
+    summary["commands"] = executed;
+    summary["total_commands"] = static_cast<Json::UInt>(commands.size());
+    summary["exit_code"] = exit_code;
+    summary["timed_out"] = timed_out;
+    summary["stdout_bytes"] = static_cast<Json::UInt64>(stdout_bytes);
+    summary["stderr_bytes"] = static_cast<Json::UInt64>(stderr_bytes);
+    summary["log"] = std::string(step_name) + ".log";
+    writeStepSummary(step_name, summary);
+
+    return exit_code == 0;
   }
 
-  ntl::String PackageInstaller::replaceVariables(const ntl::String& a_cmd) {
-    ntl::String result = a_cmd;
-    result = std::regex_replace(result.GetCString(), std::regex("\\$PACKAGE_CACHE_DIR"), m_cache_dir.string()).c_str();
-    result = std::regex_replace(result.GetCString(), std::regex("\\$INSTALL_DIR"), m_install_dir.string()).c_str();
+  void PackageInstaller::writeStepSummary(const char* a_step, const Json::Value& a_summary) {
+    Json::StreamWriterBuilder builder;
+    builder["indentation"] = "";
+
+    std::ofstream file(m_log_dir / (std::string(a_step) + ".json"), std::ios::trunc);
+    if (!file) {
+      LOG_WARN(ntl::String{"Failed to write step summary for "} + m_package_name + " (" + a_step + ")");
+      return;
+    }
+    file << Json::writeString(builder, a_summary) << "\n";
+  }
+
+  void PackageInstaller::defineVariables(const PackageConfig& a_package_config) {
+    utsname system{};
+    std::string arch = uname(&system) == 0 ? system.machine : "unknown";
+    unsigned int jobs = std::max(std::thread::hardware_concurrency(), 1u);
+
+    m_variables.Set("PACKAGE_CACHE_DIR", m_cache_dir.string());
+    m_variables.Set("INSTALL_DIR", m_install_dir.string());
+    m_variables.Set("PREFIX", m_install_dir.string());
+    m_variables.Set("PACKAGE_NAME", a_package_config.name.GetCString());
+    m_variables.Set("PACKAGE_VERSION", a_package_config.version.GetCString());
+    m_variables.Set("PACKAGE_DIR", (m_cache_dir / a_package_config.repository.GetCString() / "packages" /
+                                    a_package_config.name.GetCString()).string());
+    m_variables.Set("LOG_DIR", m_log_dir.string());
+    m_variables.Set("PLATFORM", HOST_PLATFORM);
+    m_variables.Set("ARCH", std::move(arch));
+    m_variables.Set("JOBS", std::to_string(jobs));
+  }
+
+  void PackageInstaller::compileSteps() {
+    if (!m_plan)
+      return;
+
+    for (size_t step = 0; step < INSTALL_STEP_COUNT; ++step) {
+      const ntl::Array<ntl::String>& commands = m_plan->steps[step];
+      m_steps[step].reserve(commands.GetSize());
+      for (const auto& cmd : commands) {
+        m_steps[step].emplace_back(cmd.GetCString(), m_variables);
+      }
+    }
+  }
+
+  std::string PackageInstaller::expandVariables(const std::string& a_value) const {
+    std::string result;
+    CommandTemplate(a_value, m_variables).Render(m_variables, result);
     return result;
   }
 
-  bool PackageInstaller::downloadFile(const ntl::String& a_url, const ntl::String& a_target) {
-    ntl::String targetPath = replaceVariables(a_target);
-    CURL* curl = curl_easy_init();
-    if (!curl)
-      return false;
+  std::string PackageInstaller::getBottleName() const {
+    return std::string(m_package_name.GetCString()) + "-" + m_package_version.GetCString() + "." + HOST_PLATFORM +
+           "-" + HOST_ARCH + ".tar.zst";
+  }
 
-    FILE* fp = fopen(targetPath.GetCString(), "wb");
-    if (!fp) {
-      curl_easy_cleanup(curl);
-      return false;
+  void PackageInstaller::computeBuildKey(const PackageConfig& a_package_config,
+                                         const std::vector<ntl::String>& a_dependency_builds) {
+    // Without a pinned source the same manifest can build something different every time
+    ntl::String digest;
+    if (!m_build_cache || !m_plan || !DownloadCache::ParseChecksum(m_plan->sha256, digest))
+      return;
+
+    Sha256 hash;
+    auto add = [&hash](const std::string& a_value) {
+      // The terminator keeps adjacent values from running into each other
+      hash.Update(a_value.c_str(), a_value.size() + 1);
+    };
+
+    add(BUILD_KEY_VERSION);
+    add(m_package_name.GetCString());
+    add(m_package_version.GetCString());
+    add(digest.GetCString());
+    for (const auto& dependency : a_package_config.dependencies) {
+      add(dependency.GetCString());
     }
 
-    curl_easy_setopt(curl, CURLOPT_URL, a_url.GetCString());
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, fp);
-    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+    // An upgraded dependency may change the ABI the package links against, its build is part of the key
+    for (const auto& build : a_dependency_builds) {
+      add(build.GetCString());
+    }
 
-    CURLcode res = curl_easy_perform(curl);
-    fclose(fp);
-    curl_easy_cleanup(curl);
+    // Rendered commands cover the platform, architecture and install directory through their variables
+    add(HOST_PLATFORM);
+    size_t arch = 0;
+    add(m_variables.Find("ARCH", arch) ? m_variables.GetValue(arch) : "");
+    add(m_install_dir.string());
+    CommandVariables variables = m_variables;
+    for (const char* name : RUN_VARIABLES) {
+      variables.Set(name, std::string("${") + name + "}");
+    }
+    std::string rendered;
+    for (InstallStep step : CACHED_STEPS) {
+      add(GetStepName(step));
+      for (const CommandTemplate& cmd : m_steps[static_cast<size_t>(step)]) {
+        cmd.Render(variables, rendered);
+        add(rendered);
+      }
+    }
+
+    for (const char* name : BUILD_ENVIRONMENT) {
+      const char* value = std::getenv(name);
+      add(std::string(name) + "=" + (value ? value : ""));
+    }
+    const char* cc = std::getenv("CC");
+    const char* cxx = std::getenv("CXX");
+    add(describeExecutable(cc && *cc ? cc : "cc"));
+    add(describeExecutable(cxx && *cxx ? cxx : "c++"));
+
+    m_build_key = hash.Finalize();
+  }
+
+  void PackageInstaller::setPrefix(const fs::path& a_prefix) {
+    m_variables.Set("INSTALL_DIR", a_prefix.string());
+    m_variables.Set("PREFIX", a_prefix.string());
+  }
 
-    return res == CURLE_OK;
+  void PackageInstaller::captureBuild(const InstallTransaction& a_transaction) {
+    std::vector<fs::path> files = a_transaction.ListStaged();
+
+    // An install that staged no files wrote somewhere else, replaying nothing would not install it
+    const fs::path& staging = a_transaction.GetStagingDir();
+    if (std::all_of(files.begin(), files.end(), [&staging](const fs::path& a_file) {
+          std::error_code error;
+          return fs::is_directory(fs::symlink_status(staging / a_file, error));
+        }))
+      return;
+
+    if (!m_build_cache->Store(m_build_key, staging, files)) {
+      LOG_WARN(ntl::String{"Failed to cache the build of "} + m_package_name);
+    }
+  }
+
+  bool PackageInstaller::commit(InstallTransaction& a_transaction) {
+    if (!a_transaction.Commit(m_previous_files))
+      return false;
+    m_files = a_transaction.GetFiles();
+    return true;
   }
 }
@@ -9,12 +9,24 @@
 #define ATLAS_PACKAGE_INSTALLER_HPP
 
 #include <filesystem>
-#include <regex>
+#include <array>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
 
 #include <data/String.hpp>
 #include <json/json.h>
 
+#include "core/BuildCache.hpp"
+#include "core/DownloadCache.hpp"
+#include "core/InstallTransaction.hpp"
+#include "pods/InstallPlan.hpp"
 #include "pods/PackageConfig.hpp"
+#include "utils/CommandTemplate.hpp"
+#include "utils/DownloadManager.hpp"
+#include "utils/File.hpp"
+#include "utils/ProcessRunner.hpp"
 
 namespace fs = std::filesystem;
 
@@ -23,15 +35,40 @@ namespace atlas {
    * @class PackageInstaller
    * @brief Provides functionality to install a package.
    *
-   * This class is responsible for downloading, building, and installing a package.
+   * This class is responsible for downloading, building, and installing a package. Files are staged by an
+   * InstallTransaction and only moved into the install directory once the package installed completely.
    */
   class PackageInstaller {
+  public:
+    /**
+     * @struct Options
+     * @brief Settings shared by all installers of a run.
+     */
+    struct Options {
+      LogSink::Options log;
+      ProcessRunner::Limits limits;
+      bool bottles;
+    };
+
   private:
     fs::path m_cache_dir;
     fs::path m_install_dir;
     fs::path m_log_dir;
-    Json::Value m_config;
-    ntl::String m_platform;
+    DownloadCache* m_download_cache;
+    BuildCache* m_build_cache;
+    Options m_options;
+    bool m_bottle;
+    ntl::String m_package_name;
+    ntl::String m_package_version;
+    std::shared_ptr<const InstallPlan> m_plan;
+    std::shared_future<DownloadManager::Result> m_download;
+    ntl::String m_download_digest;
+    fs::path m_download_target;
+    CommandVariables m_variables;
+    std::array<std::vector<CommandTemplate>, INSTALL_STEP_COUNT> m_steps;
+    ntl::String m_build_key;
+    std::vector<fs::path> m_previous_files;
+    std::vector<fs::path> m_files;
 
   public:
     /**
@@ -42,16 +79,106 @@ namespace atlas {
      *
      * @param a_cache Cache directory
      * @param a_install Install directory
-     * @param a_log Log directory
-     * @param a_package_config Package configuration
+     * @param a_log Directory receiving the package's step logs
+     * @param a_package_config Package configuration, its install plan provides the download and step commands
+     * @param a_download_cache Store to reuse verified downloads from, nullptr to always download
+     * @param a_build_cache Store to reuse earlier builds from, nullptr to always build
+     * @param a_options Step log settings and command limits
+     * @param a_dependency_builds Version and build key of every dependency the package is built against
      */
     PackageInstaller(const fs::path &a_cache, const fs::path &a_install,
-                     const fs::path &a_log, const PackageConfig &a_package_config);
+                     const fs::path &a_log, const PackageConfig &a_package_config,
+                     DownloadCache* a_download_cache = nullptr, BuildCache* a_build_cache = nullptr,
+                     const Options& a_options = {{0, 0, LogSink::SyncPolicy::NONE}, {0, 0, 0}, false},
+                     const std::vector<ntl::String>& a_dependency_builds = {});
+
+    /**
+     * @brief Checks whether the build cache holds this exact build of the package.
+     *
+     * Only packages with a sha256 for their download are cached, the key covers the source, the builds of the
+     * dependencies, the step commands, the platform, the build environment and the compilers on the PATH.
+     *
+     * @return True if InstallCachedBuild() can replace the whole pipeline, false otherwise
+     */
+    bool HasCachedBuild() const;
+
+    /**
+     * @brief Returns the build cache key of the package.
+     *
+     * @return Lower case hex key, empty if the build cannot be cached
+     */
+    const ntl::String& GetBuildKey() const { return m_build_key; }
+
+    /**
+     * @brief Sets the files of the installed version this install replaces.
+     *
+     * Files the new version no longer contains are removed once it is committed.
+     *
+     * @param a_files Files relative to the install directory
+     */
+    void SetPreviousFiles(std::vector<fs::path> a_files) { m_previous_files = std::move(a_files); }
+
+    /**
+     * @brief Returns the files the install placed in the install directory.
+     *
+     * @return Files and links relative to the install directory, empty until an install succeeded
+     */
+    const std::vector<fs::path>& GetFiles() const { return m_files; }
+
+    /**
+     * @brief Unpacks the cached build of the package into the install directory.
+     *
+     * Replaces Download(), Prepare(), Build(), Install() and Cleanup(). The build is unpacked to the staging
+     * directory and committed from there.
+     *
+     * @return True if successful, false otherwise
+     */
+    bool InstallCachedBuild();
+
+    /**
+     * @brief Checks whether the package will be installed from a bottle.
+     *
+     * Bottles are used if enabled in the options, the manifest offers one for the host architecture with a
+     * sha256 and the installer has a download cache to verify it with.
+     *
+     * @return True if StartDownload() fetches the bottle instead of the source, false otherwise
+     */
+    bool HasBottle() const { return m_bottle; }
+
+    /**
+     * @brief Downloads the package's bottle and unpacks it into the install directory.
+     *
+     * Replaces Download(), Prepare(), Build(), Install() and Cleanup(). The bottle is verified in the staging
+     * directory before anything is committed. If it cannot be installed the installer switches to the source, so
+     * the regular steps can run afterwards.
+     *
+     * @return True if successful, false otherwise
+     */
+    bool InstallBottle();
+
+    /**
+     * @brief Writes a bottle of the package from its cached build.
+     *
+     * @param a_directory Directory to write the bottle to
+     * @param a_path Receives the path of the bottle
+     * @return True if successful, false if the build is not cached or the bottle could not be written
+     */
+    bool CreateBottle(const fs::path& a_directory, fs::path& a_path);
+
+    /**
+     * @brief Queues the package's download on the download manager without waiting for it.
+     *
+     * Lets the transfer run while other packages are still being built. If the manifest declares a sha256 for
+     * the download and the download cache holds it, the file is taken from the cache and no transfer is queued.
+     * Calling it more than once has no effect.
+     */
+    void StartDownload();
 
     /**
      * @brief Downloads the package.
      *
-     * Performs any necessary downloads to obtain the package's dependencies.
+     * Starts the download if StartDownload() was not called yet and waits for it to finish. Downloads with
+     * a declared checksum are verified and added to the download cache before they are placed at their target.
      *
      * @return True if successful, false otherwise
      */
@@ -78,7 +205,12 @@ namespace atlas {
     /**
      * @brief Installs the package.
      *
-     * Performs any necessary installation steps to make the package available on the system.
+     * Runs the install step with PREFIX and INSTALL_DIR pointing to the staging directory, in parallel with other
+     * installs. For a plan with writes_prefix the step runs alone instead, files of the previous version are
+     * backed up before and the files it wrote to the install directory are taken into the staging directory
+     * afterwards. If the step succeeds the staged files are committed, otherwise discarded and the backups
+     * restored. With a build cache,
+     * the staged files are archived as the package's cached build.
      *
      * @return True if successful, false otherwise
      */
@@ -96,7 +228,7 @@ namespace atlas {
     /**
      * @brief Uninstalls the package.
      *
-     * Reverses the installation process to remove the package from the system.
+     * Runs the package's uninstall commands, used for packages installed without a file manifest.
      *
      * @return True if successful, false otherwise
      */
@@ -104,36 +236,83 @@ namespace atlas {
 
   private:
     /**
-     * @brief Executes a sequence of shell commands.
+     * @brief Executes the shell commands of a step.
      *
-     * Runs each command in the specified array and returns true if all commands execute successfully,
-     * or false otherwise.
+     * Runs each command of the step until one fails. Their output goes to <log_dir>/<step>.log and a one line
+     * JSON summary with the duration, exit code and output sizes to <log_dir>/<step>.json.
      *
-     * @param a_commands Array of commands to execute
+     * @param a_step Step to run
      * @return True if successful, false otherwise
      */
-    bool executeCommands(const Json::Value &a_commands);
+    bool executeCommands(InstallStep a_step);
+
+    /**
+     * @brief Writes the JSON summary of a step.
+     *
+     * @param a_step Name of the step
+     * @param a_summary Summary to write
+     */
+    void writeStepSummary(const char* a_step, const Json::Value& a_summary);
+
+    /**
+     * @brief Defines the variables available to the package's commands.
+     *
+     * @param a_package_config Package configuration
+     */
+    void defineVariables(const PackageConfig& a_package_config);
 
     /**
-     * @brief Replaces placeholders in a shell command with actual values.
+     * @brief Compiles the commands of every step of the install plan.
+     */
+    void compileSteps();
+
+    /**
+     * @brief Substitutes variables in a single install plan value.
+     *
+     * @param a_value Value as written in the manifest
+     * @return The value with its variables substituted
+     */
+    std::string expandVariables(const std::string& a_value) const;
+
+    /**
+     * @brief Returns the file name of the package's bottle.
      *
-     * Takes a command string and replaces any placeholders (e.g. ${VARIABLE}) with the actual value of the variable.
+     * @return `<name>-<version>.<platform>-<arch>.tar.zst`
+     */
+    std::string getBottleName() const;
+
+    /**
+     * @brief Computes the build cache key of the package, left empty if the build cannot be cached.
+     *
+     * @param a_package_config Package configuration
+     * @param a_dependency_builds Version and build key of every dependency
+     */
+    void computeBuildKey(const PackageConfig& a_package_config,
+                         const std::vector<ntl::String>& a_dependency_builds);
+
+    /**
+     * @brief Points PREFIX and INSTALL_DIR to a directory.
+     *
+     * @param a_prefix Directory the install commands should install to
+     */
+    void setPrefix(const fs::path& a_prefix);
+
+    /**
+     * @brief Archives the staged files as the package's cached build.
      *
-     * @param a_cmd Command string to modify
-     * @return Modified command string with placeholders replaced
+     * @param a_transaction Transaction holding the staged files
      */
-    ntl::String replaceVariables(const ntl::String &a_cmd);
+    void captureBuild(const InstallTransaction& a_transaction);
 
     /**
-     * @brief Downloads a file from a URL.
+     * @brief Commits the staged files and remembers them as the package's files.
      *
-     * Retrieves a file from the specified URL and saves it to the target location.
+     * The caller must hold the install directory lock.
      *
-     * @param a_url URL of the file to download
-     * @param a_target Target path where the file will be saved
+     * @param a_transaction Transaction holding the staged files
      * @return True if successful, false otherwise
      */
-    bool downloadFile(const ntl::String &a_url, const ntl::String &a_target);
+    bool commit(InstallTransaction& a_transaction);
   };
 }
 
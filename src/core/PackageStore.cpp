@@ -0,0 +1,164 @@
+/**
+* @file PackageStore.cpp
+* @author Marcus Gugacs
+* @date 16.10.26
+* @copyright Copyright (c) 2026 Marcus Gugacs. All rights reserved.
+*/
+
+#include "PackageStore.hpp"
+
+#include "utils/Version.hpp"
+
+namespace atlas {
+  const char* PackageView::GetName() const {
+    return m_store->m_strings.Get(m_store->m_records[m_index].name);
+  }
+
+  const char* PackageView::GetVersion() const {
+    return m_store->m_strings.Get(m_store->m_records[m_index].version);
+  }
+
+  const char* PackageView::GetDescription() const {
+    return m_store->m_strings.Get(m_store->m_records[m_index].description);
+  }
+
+  const char* PackageView::GetRepository() const {
+    return m_store->m_strings.Get(m_store->m_records[m_index].repository);
+  }
+
+  uint32_t PackageView::GetNameId() const {
+    return m_store->m_records[m_index].name;
+  }
+
+  uint32_t PackageView::GetRepositoryId() const {
+    return m_store->m_records[m_index].repository;
+  }
+
+  size_t PackageView::GetDependencyCount() const {
+    return m_store->m_records[m_index].dependency_count;
+  }
+
+  const char* PackageView::GetDependency(size_t a_index) const {
+    return m_store->m_strings.Get(m_store->m_lists[m_store->m_records[m_index].list_offset + a_index]);
+  }
+
+  const std::shared_ptr<const InstallPlan>& PackageView::GetPlan() const {
+    return m_store->m_plans[m_index];
+  }
+
+  PackageConfig PackageView::ToConfig() const {
+    const StringPool& strings = m_store->m_strings;
+    const PackageStore::Record& record = m_store->m_records[m_index];
+
+    PackageConfig config;
+    config.name = strings.Get(record.name);
+    config.version = strings.Get(record.version);
+    config.description = strings.Get(record.description);
+    config.build_command = strings.Get(record.build_command);
+    config.install_command = strings.Get(record.install_command);
+    config.uninstall_command = strings.Get(record.uninstall_command);
+    config.repository = strings.Get(record.repository);
+
+    const uint32_t* list = m_store->m_lists.data() + record.list_offset;
+    for (uint32_t i = 0; i < record.dependency_count; ++i) {
+      config.dependencies.Insert(strings.Get(*list++));
+    }
+    for (uint32_t i = 0; i < record.conflict_count; ++i) {
+      config.conflicts.Insert(strings.Get(*list++));
+    }
+    config.plan = m_store->m_plans[m_index];
+    return config;
+  }
+
+  PackageStore::PackageStore() : m_strings(), m_records(), m_plans(), m_lists(), m_by_name() {}
+
+  bool PackageStore::Add(const PackageConfig& a_config) {
+    uint32_t name = m_strings.Intern({a_config.name.GetCString(), a_config.name.GetSize()});
+    uint32_t index = findRecord(name);
+
+    // Repositories may offer several versions of a package, the store keeps the newest one
+    if (index != NONE && Version::Compare(a_config.version, m_strings.Get(m_records[index].version)) <= 0)
+      return false;
+
+    auto add = [this](const ntl::String& a_string) {
+      return m_strings.Add({a_string.GetCString(), a_string.GetSize()});
+    };
+    auto intern = [this](const ntl::String& a_string) {
+      return m_strings.Intern({a_string.GetCString(), a_string.GetSize()});
+    };
+
+    Record record{
+      name,
+      intern(a_config.version),
+      add(a_config.description),
+      add(a_config.build_command),
+      add(a_config.install_command),
+      add(a_config.uninstall_command),
+      intern(a_config.repository),
+      static_cast<uint32_t>(m_lists.size()),
+      static_cast<uint32_t>(a_config.dependencies.GetSize()),
+      static_cast<uint32_t>(a_config.conflicts.GetSize())
+    };
+    for (const auto& dependency : a_config.dependencies) {
+      m_lists.push_back(intern(dependency));
+    }
+    for (const auto& conflict : a_config.conflicts) {
+      m_lists.push_back(intern(conflict));
+    }
+
+    if (index != NONE) {
+      m_records[index] = record;
+      m_plans[index] = a_config.plan;
+      return true;
+    }
+
+    if (m_by_name.size() <= name)
+      m_by_name.resize(m_strings.GetCount(), NONE);
+    m_by_name[name] = static_cast<uint32_t>(m_records.size());
+    m_records.push_back(record);
+    m_plans.push_back(a_config.plan);
+    return true;
+  }
+
+  bool PackageStore::Find(std::string_view a_name, PackageView& a_view) const {
+    uint32_t name = 0;
+    if (!m_strings.Find(a_name, name))
+      return false;
+
+    uint32_t index = findRecord(name);
+    if (index == NONE)
+      return false;
+
+    a_view = PackageView(this, index);
+    return true;
+  }
+
+  bool PackageStore::Contains(std::string_view a_name) const {
+    PackageView view;
+    return Find(a_name, view);
+  }
+
+  size_t PackageStore::GetMemoryUsage() const {
+    return m_records.capacity() * sizeof(Record) + m_plans.capacity() * sizeof(m_plans[0]) +
+           m_lists.capacity() * sizeof(uint32_t) + m_by_name.capacity() * sizeof(uint32_t) + m_strings.GetMemoryUsage();
+  }
+
+  void PackageStore::Reserve(size_t a_count) {
+    // Every package interns at least its name
+    m_strings.Reserve(a_count);
+    m_records.reserve(a_count);
+    m_plans.reserve(a_count);
+  }
+
+  void PackageStore::Clear() {
+    m_strings.Clear();
+    m_records.clear();
+    m_plans.clear();
+    m_lists.clear();
+    m_by_name.clear();
+  }
+
+  uint32_t PackageStore::findRecord(uint32_t a_name) const {
+    return a_name < m_by_name.size() ? m_by_name[a_name] : NONE;
+  }
+}
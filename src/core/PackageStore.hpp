@@ -0,0 +1,245 @@
+/**
+* @file PackageStore.hpp
+* @author Marcus Gugacs
+* @date 16.10.26
+* @copyright Copyright (c) 2026 Marcus Gugacs. All rights reserved.
+*/
+
+#ifndef ATLAS_PACKAGE_STORE_HPP
+#define ATLAS_PACKAGE_STORE_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include "pods/PackageConfig.hpp"
+#include "utils/StringPool.hpp"
+
+namespace atlas {
+  class PackageStore;
+
+  /**
+   * @class PackageView
+   * @brief Lightweight handle to a package of a PackageStore, cheap to copy and pass by value.
+   *
+   * Strings point into the store's arena and stay valid until the store is cleared.
+   */
+  class PackageView {
+  private:
+    const PackageStore* m_store;
+    uint32_t m_index;
+
+  public:
+    /**
+     * @brief Default constructor, creates a view of no package.
+     */
+    PackageView() : m_store(nullptr), m_index(0) {}
+
+    /**
+     * @brief Constructs a view of a package of a store.
+     *
+     * @param a_store Store holding the package
+     * @param a_index Index of the package
+     */
+    PackageView(const PackageStore* a_store, uint32_t a_index) : m_store(a_store), m_index(a_index) {}
+
+    /**
+     * @brief Returns the name of the package.
+     *
+     * @return The name
+     */
+    const char* GetName() const;
+
+    /**
+     * @brief Returns the version of the package.
+     *
+     * @return The version
+     */
+    const char* GetVersion() const;
+
+    /**
+     * @brief Returns the description of the package.
+     *
+     * @return The description
+     */
+    const char* GetDescription() const;
+
+    /**
+     * @brief Returns the name of the repository offering the package.
+     *
+     * @return The repository name
+     */
+    const char* GetRepository() const;
+
+    /**
+     * @brief Returns the interned id of the package name, equal names have equal ids.
+     *
+     * @return The name id
+     */
+    uint32_t GetNameId() const;
+
+    /**
+     * @brief Returns the interned id of the repository name, equal names have equal ids.
+     *
+     * @return The repository id
+     */
+    uint32_t GetRepositoryId() const;
+
+    /**
+     * @brief Returns the number of dependencies of the package.
+     *
+     * @return The dependency count
+     */
+    size_t GetDependencyCount() const;
+
+    /**
+     * @brief Returns a dependency requirement of the package, e.g. "openssl >=1.1".
+     *
+     * @param a_index Index of the dependency
+     * @return The requirement
+     */
+    const char* GetDependency(size_t a_index) const;
+
+    /**
+     * @brief Returns the install plan of the package.
+     *
+     * @return The shared plan, nullptr if the package has none for the host platform
+     */
+    const std::shared_ptr<const InstallPlan>& GetPlan() const;
+
+    /**
+     * @brief Copies the package into a standalone configuration, for code that outlives the store or modifies it.
+     *
+     * @return The package configuration
+     */
+    PackageConfig ToConfig() const;
+
+    /**
+     * @brief Checks whether the view refers to a package.
+     *
+     * @return True if the view refers to a package, false otherwise
+     */
+    explicit operator bool() const { return m_store != nullptr; }
+  };
+
+  /**
+   * @class PackageStore
+   * @brief The package index: the newest version of every package offered by the enabled repositories.
+   *
+   * Packages are stored as fixed-size records of 32-bit string ids. Names, versions, repositories and
+   * dependency requirements repeat across packages and are interned, descriptions and commands are only
+   * copied into the arena. Lookups by name go through the interned name id, so no key strings are kept
+   * besides the pool's own. The store is not synchronized, callers guard it with a lock.
+   */
+  class PackageStore {
+    friend class PackageView;
+
+  private:
+    /**
+     * @struct Record
+     * @brief A package, every field is an id of the string pool.
+     */
+    struct Record {
+      uint32_t name;
+      uint32_t version;
+      uint32_t description;
+      uint32_t build_command;
+      uint32_t install_command;
+      uint32_t uninstall_command;
+      uint32_t repository;
+      uint32_t list_offset;
+      uint32_t dependency_count;
+      uint32_t conflict_count;
+    };
+
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    StringPool m_strings;
+    std::vector<Record> m_records;
+    std::vector<std::shared_ptr<const InstallPlan>> m_plans;
+    std::vector<uint32_t> m_lists;
+    std::vector<uint32_t> m_by_name;
+
+  public:
+    /**
+     * @brief Default constructor, creates an empty store.
+     */
+    PackageStore();
+
+    PackageStore(const PackageStore&) = delete;
+    PackageStore& operator=(const PackageStore&) = delete;
+
+    /**
+     * @brief Adds a package unless a newer or equal version of it is already stored.
+     *
+     * Replacing a package leaves the strings only it used in the arena until the store is cleared.
+     *
+     * @param a_config Package to add
+     * @return True if the package was added, false if the stored version was kept
+     */
+    bool Add(const PackageConfig& a_config);
+
+    /**
+     * @brief Looks up a package by name.
+     *
+     * @param a_name Name of the package
+     * @param a_view Receives the view of the package
+     * @return True if the package is stored, false otherwise
+     */
+    bool Find(std::string_view a_name, PackageView& a_view) const;
+
+    /**
+     * @brief Checks whether a package is stored.
+     *
+     * @param a_name Name of the package
+     * @return True if the package is stored, false otherwise
+     */
+    bool Contains(std::string_view a_name) const;
+
+    /**
+     * @brief Returns the view of a package by position, packages are kept in the order they were first added.
+     *
+     * @param a_index Position of the package
+     * @return The view of the package
+     */
+    PackageView Get(size_t a_index) const { return {this, static_cast<uint32_t>(a_index)}; }
+
+    /**
+     * @brief Returns the number of stored packages.
+     *
+     * @return The package count
+     */
+    size_t GetCount() const { return m_records.size(); }
+
+    /**
+     * @brief Returns the approximate number of bytes the store occupies.
+     *
+     * @return The size of the records, lists and string pool
+     */
+    size_t GetMemoryUsage() const;
+
+    /**
+     * @brief Reserves room for the given number of packages.
+     *
+     * @param a_count Expected package count
+     */
+    void Reserve(size_t a_count);
+
+    /**
+     * @brief Removes every package.
+     */
+    void Clear();
+
+  private:
+    /**
+     * @brief Looks up the record of a package by the interned id of its name.
+     *
+     * @param a_name Name id
+     * @return Index of the record, NONE if the package is not stored
+     */
+    uint32_t findRecord(uint32_t a_name) const;
+  };
+}
+
+#endif // ATLAS_PACKAGE_STORE_HPP
@@ -0,0 +1,687 @@
+/**
+* @file SearchIndex.cpp
+* @author Marcus Gugacs
+* @date 16.10.26
+* @copyright Copyright (c) 2026 Marcus Gugacs. All rights reserved.
+*/
+
+#include "SearchIndex.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <unordered_map>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "utils/Version.hpp"
+
+namespace atlas {
+  namespace {
+    constexpr size_t MAX_PREFIX_TOKENS = 4096;
+    constexpr size_t MAX_SIMILAR_CANDIDATES = 8192;
+
+    // Scores of a term matching a package's name or description, the better kind of match wins per field
+    constexpr float NAME_EXACT = 40.0f;
+    constexpr float NAME_PREFIX = 20.0f;
+    constexpr float NAME_SUBSTRING = 16.0f;
+    constexpr float NAME_TYPO = 14.0f;
+    constexpr float DESCRIPTION_EXACT = 10.0f;
+    constexpr float DESCRIPTION_PREFIX = 5.0f;
+    constexpr float DESCRIPTION_SUBSTRING = 4.0f;
+    constexpr float DESCRIPTION_TYPO = 4.0f;
+    constexpr float FULL_NAME_BONUS = 100.0f;
+    constexpr float POPULARITY_WEIGHT = 2.0f;
+
+    bool isTokenChar(unsigned char a_char) {
+      // Bytes of multi-byte UTF-8 sequences stay part of the word they appear in
+      return (a_char >= '0' && a_char <= '9') || (a_char >= 'a' && a_char <= 'z') || a_char >= 0x80;
+    }
+
+    std::string toLower(std::string_view a_text) {
+      std::string result(a_text);
+      for (char& c : result) {
+        if (c >= 'A' && c <= 'Z')
+          c = static_cast<char>(c - 'A' + 'a');
+      }
+      return result;
+    }
+
+    /**
+     * @brief Splits lowercased text into its alphanumeric tokens.
+     */
+    template<typename Callback>
+    void forEachToken(std::string_view a_text, Callback&& a_callback) {
+      size_t start = 0;
+      while (start < a_text.size()) {
+        while (start < a_text.size() && !isTokenChar(static_cast<unsigned char>(a_text[start])))
+          ++start;
+        size_t end = start;
+        while (end < a_text.size() && isTokenChar(static_cast<unsigned char>(a_text[end])))
+          ++end;
+        if (end > start)
+          a_callback(a_text.substr(start, end - start));
+        start = end;
+      }
+    }
+
+    uint32_t trigramKey(const char* a_text) {
+      return static_cast<uint32_t>(static_cast<unsigned char>(a_text[0])) << 16 |
+             static_cast<uint32_t>(static_cast<unsigned char>(a_text[1])) << 8 |
+             static_cast<uint32_t>(static_cast<unsigned char>(a_text[2]));
+    }
+
+    uint32_t maxEdits(size_t a_length) {
+      return a_length >= 8 ? 2 : a_length >= 4 ? 1 : 0;
+    }
+
+    /**
+     * @brief Optimal string alignment distance, giving up as soon as it exceeds a_limit.
+     *
+     * Only the band of cells within a_limit of the diagonal can stay below the limit, everything else is skipped.
+     *
+     * @param a_rows Buffer for the rows of the distance matrix
+     * @return The distance, a_limit + 1 if it is larger than a_limit
+     */
+    uint32_t editDistance(std::string_view a_lhs, std::string_view a_rhs, uint32_t a_limit,
+                          std::vector<uint32_t>& a_rows) {
+      size_t columns = a_rhs.size() + 1;
+      uint32_t outside = a_limit + 1;
+      a_rows.assign(columns * 3, outside);
+      uint32_t* previous2 = a_rows.data();
+      uint32_t* previous = previous2 + columns;
+      uint32_t* current = previous + columns;
+      for (size_t j = 0; j < columns && j <= a_limit; ++j) {
+        previous[j] = static_cast<uint32_t>(j);
+      }
+
+      for (size_t i = 1; i <= a_lhs.size(); ++i) {
+        size_t low = i > a_limit ? i - a_limit : 1;
+        size_t high = std::min(columns - 1, i + a_limit);
+        std::fill(current, current + columns, outside);
+        current[0] = i <= a_limit ? static_cast<uint32_t>(i) : outside;
+
+        uint32_t row_min = current[0];
+        for (size_t j = low; j <= high; ++j) {
+          uint32_t cost = a_lhs[i - 1] == a_rhs[j - 1] ? 0 : 1;
+          uint32_t value = std::min({previous[j] + 1, current[j - 1] + 1, previous[j - 1] + cost});
+          if (i > 1 && j > 1 && a_lhs[i - 1] == a_rhs[j - 2] && a_lhs[i - 2] == a_rhs[j - 1])
+            value = std::min(value, previous2[j - 2] + 1);
+          current[j] = std::min(value, outside);
+          row_min = std::min(row_min, current[j]);
+        }
+        if (row_min > a_limit)
+          return outside;
+
+        uint32_t* recycled = previous2;
+        previous2 = previous;
+        previous = current;
+        current = recycled;
+      }
+      return std::min(previous[columns - 1], outside);
+    }
+
+    template<typename T>
+    void appendArray(std::string& a_payload, const std::vector<T>& a_values) {
+      a_payload.append(reinterpret_cast<const char*>(a_values.data()), a_values.size() * sizeof(T));
+    }
+
+    /**
+     * @brief Per package state while a query is evaluated, only valid if query matches the current query.
+     */
+    struct Candidate {
+      float total;
+      float name;
+      float description;
+      uint32_t terms;
+      uint32_t query;
+    };
+
+    /**
+     * @brief Scratch space of the calling thread, reused across queries so it never has to be cleared.
+     */
+    struct Scratch {
+      std::vector<Candidate> candidates;
+      std::vector<uint64_t> allowed;
+      std::vector<uint32_t> matched;
+      std::vector<std::pair<float, uint32_t>> results;
+      std::vector<std::pair<uint32_t, uint32_t>> similar;
+      uint32_t query = 0;
+    };
+
+    thread_local Scratch t_scratch;
+  }
+
+  SearchIndex::SearchIndex()
+    : m_mapping(nullptr), m_mapping_size(0), m_header(nullptr), m_documents(nullptr), m_tokens(nullptr),
+      m_postings(nullptr), m_trigrams(nullptr), m_references(nullptr), m_string_data(nullptr) {
+  }
+
+  SearchIndex::~SearchIndex() {
+    Close();
+  }
+
+  bool SearchIndex::Open(const fs::path& a_path) {
+    Close();
+
+    int fd = open(a_path.c_str(), O_RDONLY);
+    if (fd < 0)
+      return false;
+
+    struct stat info{};
+    if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(Header)) {
+      close(fd);
+      return false;
+    }
+
+    m_mapping_size = static_cast<size_t>(info.st_size);
+    m_mapping = mmap(nullptr, m_mapping_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (m_mapping == MAP_FAILED) {
+      m_mapping = nullptr;
+      m_mapping_size = 0;
+      return false;
+    }
+
+    const auto* base = static_cast<const char*>(m_mapping);
+    m_header = reinterpret_cast<const Header*>(base);
+
+    if (m_header->magic != MAGIC || m_header->version != VERSION) {
+      Close();
+      return false;
+    }
+
+    size_t documents_size = static_cast<size_t>(m_header->document_count) * sizeof(Document);
+    size_t tokens_size = static_cast<size_t>(m_header->token_count) * sizeof(Token);
+    size_t postings_size = static_cast<size_t>(m_header->posting_count) * sizeof(uint32_t);
+    size_t trigrams_size = static_cast<size_t>(m_header->trigram_count) * sizeof(Trigram);
+    size_t references_size = static_cast<size_t>(m_header->reference_count) * sizeof(uint32_t);
+
+    if (sizeof(Header) + documents_size + tokens_size + postings_size + trigrams_size + references_size +
+        m_header->string_data_size != m_mapping_size) {
+      Close();
+      return false;
+    }
+
+    const char* payload = base + sizeof(Header);
+
+    m_documents = reinterpret_cast<const Document*>(payload);
+    m_tokens = reinterpret_cast<const Token*>(payload + documents_size);
+    m_postings = reinterpret_cast<const uint32_t*>(payload + documents_size + tokens_size);
+    m_trigrams = reinterpret_cast<const Trigram*>(payload + documents_size + tokens_size + postings_size);
+    m_references = reinterpret_cast<const uint32_t*>(
+      payload + documents_size + tokens_size + postings_size + trigrams_size);
+    m_string_data = payload + documents_size + tokens_size + postings_size + trigrams_size + references_size;
+
+    if (!validate()) {
+      Close();
+      return false;
+    }
+
+    return true;
+  }
+
+  void SearchIndex::Close() {
+    if (m_mapping) {
+      munmap(m_mapping, m_mapping_size);
+    }
+
+    m_mapping = nullptr;
+    m_mapping_size = 0;
+    m_header = nullptr;
+    m_documents = nullptr;
+    m_tokens = nullptr;
+    m_postings = nullptr;
+    m_trigrams = nullptr;
+    m_references = nullptr;
+    m_string_data = nullptr;
+  }
+
+  void SearchIndex::Search(std::string_view a_query, size_t a_limit, std::vector<Match>& a_matches) const {
+    a_matches.clear();
+    if (!m_header || a_limit == 0)
+      return;
+
+    size_t first = a_query.find_first_not_of(" \t\n");
+    size_t last = a_query.find_last_not_of(" \t\n");
+    std::string query = first == std::string_view::npos ? "" : toLower(a_query.substr(first, last - first + 1));
+    std::vector<std::string_view> terms;
+    forEachToken(query, [&](std::string_view a_term) {
+      if (std::find(terms.begin(), terms.end(), a_term) == terms.end())
+        terms.push_back(a_term);
+    });
+    if (terms.empty())
+      return;
+
+    // The term prefixing the fewest tokens goes first, later terms then only look up packages it matched
+    std::vector<std::pair<uint32_t, std::string_view>> ordered;
+    for (std::string_view term : terms) {
+      ordered.emplace_back(prefixEnd(term) - lowerBound(term), term);
+    }
+    std::stable_sort(ordered.begin(), ordered.end(), [](const auto& a_lhs, const auto& a_rhs) {
+      return a_lhs.first < a_rhs.first;
+    });
+    for (size_t i = 0; i < ordered.size(); ++i) {
+      terms[i] = ordered[i].second;
+    }
+
+    Scratch& scratch = t_scratch;
+    if (scratch.candidates.size() < m_header->document_count)
+      scratch.candidates.resize(m_header->document_count, Candidate{0.0f, 0.0f, 0.0f, 0, 0});
+    if (++scratch.query == 0) {
+      std::fill(scratch.candidates.begin(), scratch.candidates.end(), Candidate{0.0f, 0.0f, 0.0f, 0, 0});
+      scratch.query = 1;
+    }
+
+    uint32_t query_id = scratch.query;
+    std::vector<Candidate>& candidates = scratch.candidates;
+    std::vector<uint64_t>& allowed = scratch.allowed;
+    std::vector<uint32_t>& matched = scratch.matched;
+    allowed.assign((m_header->document_count + 63) / 64, 0);
+
+    // A package stays a candidate only while it matched every term so far, so each term narrows the set
+    for (uint32_t term_index = 0; term_index < terms.size(); ++term_index) {
+      std::string_view term = terms[term_index];
+      matched.clear();
+
+      auto record = [&](uint32_t a_token, float a_name_score, float a_description_score) {
+        const Token& token = m_tokens[a_token];
+        for (uint32_t i = 0; i < token.posting_count; ++i) {
+          uint32_t posting = m_postings[token.posting_offset + i];
+          uint32_t document = posting >> FIELD_BITS;
+          if (document >= m_header->document_count)
+            continue;
+
+          if (term_index != 0 && !(allowed[document / 64] >> (document % 64) & 1))
+            continue;
+
+          Candidate& candidate = candidates[document];
+          if (candidate.query != query_id)
+            candidate = {0.0f, 0.0f, 0.0f, 0, query_id};
+
+          if (candidate.name == 0.0f && candidate.description == 0.0f)
+            matched.push_back(document);
+          if (posting & NAME)
+            candidate.name = std::max(candidate.name, a_name_score);
+          if (posting & DESCRIPTION)
+            candidate.description = std::max(candidate.description, a_description_score);
+        }
+      };
+
+      // Exact and prefix matches are a contiguous run of the sorted dictionary
+      size_t expanded = 0;
+      for (uint32_t token = lowerBound(term); token < m_header->token_count && expanded < MAX_PREFIX_TOKENS;
+           ++token, ++expanded) {
+        std::string_view text = getToken(token);
+        if (!text.starts_with(term))
+          break;
+
+        if (text.size() == term.size()) {
+          record(token, NAME_EXACT, DESCRIPTION_EXACT);
+        } else {
+          float coverage = static_cast<float>(term.size()) / static_cast<float>(text.size());
+          record(token, NAME_PREFIX * (0.5f + 0.5f * coverage), DESCRIPTION_PREFIX * (0.5f + 0.5f * coverage));
+        }
+      }
+
+      // Substrings are looked for while the term does not fill the result yet, typos only if nothing matched
+      if (matched.size() < a_limit && term.size() >= 3) {
+        findSimilar(term, matched.empty() ? maxEdits(term.size()) : 0, scratch.similar);
+        for (const auto& [token, distance] : scratch.similar) {
+          if (distance == 0) {
+            record(token, NAME_SUBSTRING, DESCRIPTION_SUBSTRING);
+          } else {
+            float penalty = static_cast<float>(distance - 1);
+            record(token, NAME_TYPO - 4.0f * penalty, DESCRIPTION_TYPO - penalty);
+          }
+        }
+      }
+
+      std::fill(allowed.begin(), allowed.end(), 0);
+      for (uint32_t document : matched) {
+        Candidate& candidate = candidates[document];
+        candidate.total += candidate.name + candidate.description;
+        candidate.name = 0.0f;
+        candidate.description = 0.0f;
+        candidate.terms = term_index + 1;
+        allowed[document / 64] |= uint64_t{1} << (document % 64);
+      }
+    }
+
+    // A query naming a package outright puts that package first
+    uint32_t full_name = lowerBound(query);
+    if (full_name < m_header->token_count && getToken(full_name) == query) {
+      const Token& token = m_tokens[full_name];
+      for (uint32_t i = 0; i < token.posting_count; ++i) {
+        uint32_t posting = m_postings[token.posting_offset + i];
+        uint32_t document = posting >> FIELD_BITS;
+        if ((posting & FULL_NAME) && document < m_header->document_count &&
+            (allowed[document / 64] >> (document % 64) & 1))
+          candidates[document].total += FULL_NAME_BONUS;
+      }
+    }
+
+    std::vector<std::pair<float, uint32_t>>& results = scratch.results;
+    results.clear();
+    for (uint32_t document : matched) {
+      float score = candidates[document].total;
+      if (uint32_t popularity = m_documents[document].popularity)
+        score += POPULARITY_WEIGHT * std::log2(1.0f + static_cast<float>(popularity));
+      results.emplace_back(score, document);
+    }
+
+    auto better = [&](const std::pair<float, uint32_t>& a_lhs, const std::pair<float, uint32_t>& a_rhs) {
+      if (a_lhs.first != a_rhs.first)
+        return a_lhs.first > a_rhs.first;
+      if (m_documents[a_lhs.second].name_length != m_documents[a_rhs.second].name_length)
+        return m_documents[a_lhs.second].name_length < m_documents[a_rhs.second].name_length;
+      return a_lhs.second < a_rhs.second;
+    };
+    auto count = static_cast<std::ptrdiff_t>(std::min(a_limit, results.size()));
+    if (count < static_cast<std::ptrdiff_t>(results.size()))
+      std::nth_element(results.begin(), results.begin() + count, results.end(), better);
+    std::sort(results.begin(), results.begin() + count, better);
+
+    a_matches.reserve(static_cast<size_t>(count));
+    for (auto it = results.begin(); it != results.begin() + count; ++it) {
+      const Document& document = m_documents[it->second];
+      a_matches.push_back({std::string_view(m_string_data + document.name_offset, document.name_length), it->first});
+    }
+  }
+
+  bool SearchIndex::Write(const fs::path& a_path, const std::vector<PackageConfig>& a_configs, uint64_t a_source) {
+    // One document per package name, described by its newest version
+    std::unordered_map<std::string, size_t> newest;
+    for (size_t i = 0; i < a_configs.size(); ++i) {
+      auto [it, inserted] = newest.emplace(a_configs[i].name.GetCString(), i);
+      if (!inserted && Version::Compare(a_configs[i].version, a_configs[it->second].version) > 0)
+        it->second = i;
+    }
+
+    std::vector<std::pair<std::string, const PackageConfig*>> packages;
+    packages.reserve(newest.size());
+    for (const auto& [name, index] : newest) {
+      packages.emplace_back(name, &a_configs[index]);
+    }
+    std::sort(packages.begin(), packages.end(), [](const auto& a_lhs, const auto& a_rhs) {
+      return a_lhs.first < a_rhs.first;
+    });
+
+    // Popularity is the number of packages in the repository depending on a package
+    std::unordered_map<std::string, uint32_t> dependents;
+    for (const auto& [name, config] : packages) {
+      for (const auto& dependency : config->dependencies) {
+        ++dependents[VersionRequirement::GetName(dependency).GetCString()];
+      }
+    }
+
+    std::string strings;
+    std::vector<Document> documents;
+    std::unordered_map<std::string, uint32_t> token_ids;
+    std::vector<std::string> token_texts;
+    std::vector<std::vector<uint32_t>> token_postings;
+    std::vector<std::pair<uint32_t, uint32_t>> occurrences;
+    documents.reserve(packages.size());
+
+    for (const auto& [name, config] : packages) {
+      auto document = static_cast<uint32_t>(documents.size());
+      auto popularity = dependents.find(name);
+      documents.push_back({
+        static_cast<uint32_t>(strings.size()),
+        static_cast<uint32_t>(name.size()),
+        popularity == dependents.end() ? 0 : popularity->second
+      });
+      strings.append(name);
+
+      occurrences.clear();
+      auto addToken = [&](std::string_view a_token, uint32_t a_fields) {
+        auto [it, inserted] = token_ids.emplace(a_token, static_cast<uint32_t>(token_texts.size()));
+        if (inserted) {
+          token_texts.emplace_back(a_token);
+          token_postings.emplace_back();
+        }
+        occurrences.emplace_back(it->second, a_fields);
+      };
+
+      std::string lowered_name = toLower(name);
+      addToken(lowered_name, NAME | FULL_NAME);
+      forEachToken(lowered_name, [&](std::string_view a_token) { addToken(a_token, NAME); });
+      forEachToken(toLower(config->description.GetCString()), [&](std::string_view a_token) {
+        addToken(a_token, DESCRIPTION);
+      });
+
+      // Merge repeated tokens of a package into one posting carrying all fields they appeared in
+      std::sort(occurrences.begin(), occurrences.end());
+      for (size_t i = 0; i < occurrences.size();) {
+        uint32_t token = occurrences[i].first;
+        uint32_t fields = 0;
+        for (; i < occurrences.size() && occurrences[i].first == token; ++i) {
+          fields |= occurrences[i].second;
+        }
+        token_postings[token].push_back(document << FIELD_BITS | fields);
+      }
+    }
+
+    std::vector<uint32_t> order(token_texts.size());
+    for (uint32_t i = 0; i < order.size(); ++i) {
+      order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&](uint32_t a_lhs, uint32_t a_rhs) {
+      return token_texts[a_lhs] < token_texts[a_rhs];
+    });
+
+    std::vector<Token> tokens;
+    std::vector<uint32_t> postings;
+    std::unordered_map<uint32_t, std::vector<uint32_t>> trigram_tokens;
+    tokens.reserve(order.size());
+    for (uint32_t id : order) {
+      const std::string& text = token_texts[id];
+      auto token = static_cast<uint32_t>(tokens.size());
+      tokens.push_back({
+        static_cast<uint32_t>(strings.size()),
+        static_cast<uint32_t>(text.size()),
+        static_cast<uint32_t>(postings.size()),
+        static_cast<uint32_t>(token_postings[id].size())
+      });
+      strings.append(text);
+      postings.insert(postings.end(), token_postings[id].begin(), token_postings[id].end());
+
+      for (size_t i = 0; i + 3 <= text.size(); ++i) {
+        std::vector<uint32_t>& list = trigram_tokens[trigramKey(text.data() + i)];
+        if (list.empty() || list.back() != token)
+          list.push_back(token);
+      }
+    }
+
+    std::vector<Trigram> trigrams;
+    std::vector<uint32_t> references;
+    trigrams.reserve(trigram_tokens.size());
+    for (const auto& [key, list] : trigram_tokens) {
+      trigrams.push_back({key, 0, static_cast<uint32_t>(list.size())});
+    }
+    std::sort(trigrams.begin(), trigrams.end(), [](const Trigram& a_lhs, const Trigram& a_rhs) {
+      return a_lhs.key < a_rhs.key;
+    });
+    for (Trigram& trigram : trigrams) {
+      const std::vector<uint32_t>& list = trigram_tokens[trigram.key];
+      trigram.reference_offset = static_cast<uint32_t>(references.size());
+      references.insert(references.end(), list.begin(), list.end());
+    }
+
+    std::string payload;
+    payload.reserve(documents.size() * sizeof(Document) + tokens.size() * sizeof(Token) +
+                    postings.size() * sizeof(uint32_t) + trigrams.size() * sizeof(Trigram) +
+                    references.size() * sizeof(uint32_t) + strings.size());
+    appendArray(payload, documents);
+    appendArray(payload, tokens);
+    appendArray(payload, postings);
+    appendArray(payload, trigrams);
+    appendArray(payload, references);
+    payload.append(strings);
+
+    Header header{
+      MAGIC,
+      VERSION,
+      a_source,
+      static_cast<uint32_t>(documents.size()),
+      static_cast<uint32_t>(tokens.size()),
+      static_cast<uint32_t>(postings.size()),
+      static_cast<uint32_t>(trigrams.size()),
+      static_cast<uint32_t>(references.size()),
+      static_cast<uint32_t>(strings.size())
+    };
+
+    try {
+      fs::create_directories(a_path.parent_path());
+      fs::path temp_path = a_path;
+      temp_path += ".tmp";
+
+      {
+        std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+        if (!file)
+          return false;
+        file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+        file.write(payload.data(), static_cast<std::streamsize>(payload.size()));
+        if (!file)
+          return false;
+      }
+
+      fs::rename(temp_path, a_path);
+    } catch (const std::exception&) {
+      return false;
+    }
+
+    return true;
+  }
+
+  std::string_view SearchIndex::getToken(uint32_t a_token) const {
+    const Token& token = m_tokens[a_token];
+    return {m_string_data + token.text_offset, token.text_length};
+  }
+
+  uint32_t SearchIndex::lowerBound(std::string_view a_text) const {
+    uint32_t low = 0;
+    uint32_t high = m_header->token_count;
+    while (low < high) {
+      uint32_t middle = low + (high - low) / 2;
+      if (getToken(middle) < a_text) {
+        low = middle + 1;
+      } else {
+        high = middle;
+      }
+    }
+    return low;
+  }
+
+  uint32_t SearchIndex::prefixEnd(std::string_view a_prefix) const {
+    // The first string after every string starting with the prefix drops trailing 0xff bytes and bumps the last
+    std::string next(a_prefix);
+    while (!next.empty() && static_cast<unsigned char>(next.back()) == 0xff)
+      next.pop_back();
+    if (next.empty())
+      return m_header->token_count;
+    next.back() = static_cast<char>(static_cast<unsigned char>(next.back()) + 1);
+    return lowerBound(next);
+  }
+
+  const uint32_t* SearchIndex::findTrigram(uint32_t a_key, uint32_t& a_count) const {
+    const Trigram* end = m_trigrams + m_header->trigram_count;
+    const Trigram* it = std::lower_bound(m_trigrams, end, a_key, [](const Trigram& a_trigram, uint32_t a_value) {
+      return a_trigram.key < a_value;
+    });
+    if (it == end || it->key != a_key) {
+      a_count = 0;
+      return nullptr;
+    }
+    a_count = it->reference_count;
+    return m_references + it->reference_offset;
+  }
+
+  void SearchIndex::findSimilar(std::string_view a_term, uint32_t a_max_edits,
+                                std::vector<std::pair<uint32_t, uint32_t>>& a_tokens) const {
+    a_tokens.clear();
+
+    struct List {
+      const uint32_t* tokens;
+      uint32_t count;
+    };
+
+    std::vector<List> lists;
+    bool complete = true;
+    for (size_t i = 0; i + 3 <= a_term.size(); ++i) {
+      List list{nullptr, 0};
+      list.tokens = findTrigram(trigramKey(a_term.data() + i), list.count);
+      complete &= list.count > 0;
+      lists.push_back(list);
+    }
+    std::sort(lists.begin(), lists.end(), [](const List& a_lhs, const List& a_rhs) {
+      return a_lhs.count < a_rhs.count;
+    });
+
+    // Every substring match is in each list, typos destroy at most three trigrams per edit
+    size_t used = a_max_edits == 0 ? 1 : std::min(lists.size(), static_cast<size_t>(3 * a_max_edits + 1));
+    if (a_max_edits == 0 && !complete)
+      return;
+
+    std::vector<uint32_t> rows;
+    std::vector<uint32_t> candidates;
+    for (size_t i = 0; i < used && candidates.size() < MAX_SIMILAR_CANDIDATES; ++i) {
+      size_t count = std::min<size_t>(lists[i].count, MAX_SIMILAR_CANDIDATES - candidates.size());
+      candidates.insert(candidates.end(), lists[i].tokens, lists[i].tokens + count);
+    }
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+    for (uint32_t token : candidates) {
+      if (token >= m_header->token_count)
+        continue;
+
+      std::string_view text = getToken(token);
+      if (text.starts_with(a_term))
+        continue;
+
+      if (text.find(a_term) != std::string_view::npos) {
+        a_tokens.emplace_back(token, 0);
+        continue;
+      }
+
+      size_t difference = text.size() > a_term.size() ? text.size() - a_term.size() : a_term.size() - text.size();
+      if (a_max_edits == 0 || difference > a_max_edits)
+        continue;
+
+      uint32_t distance = editDistance(a_term, text, a_max_edits, rows);
+      if (distance <= a_max_edits)
+        a_tokens.emplace_back(token, distance);
+    }
+  }
+
+  bool SearchIndex::validate() const {
+    uint32_t string_size = m_header->string_data_size;
+    auto isValidRange = [](uint64_t a_offset, uint64_t a_count, uint64_t a_size) {
+      return a_offset + a_count <= a_size;
+    };
+
+    for (uint32_t i = 0; i < m_header->document_count; ++i) {
+      if (!isValidRange(m_documents[i].name_offset, m_documents[i].name_length, string_size))
+        return false;
+    }
+
+    for (uint32_t i = 0; i < m_header->token_count; ++i) {
+      const Token& token = m_tokens[i];
+      if (!isValidRange(token.text_offset, token.text_length, string_size) ||
+          !isValidRange(token.posting_offset, token.posting_count, m_header->posting_count))
+        return false;
+    }
+
+    for (uint32_t i = 0; i < m_header->trigram_count; ++i) {
+      if (!isValidRange(m_trigrams[i].reference_offset, m_trigrams[i].reference_count, m_header->reference_count))
+        return false;
+    }
+
+    return true;
+  }
+}
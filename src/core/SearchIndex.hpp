@@ -0,0 +1,244 @@
+/**
+* @file SearchIndex.hpp
+* @author Marcus Gugacs
+* @date 16.10.26
+* @copyright Copyright (c) 2026 Marcus Gugacs. All rights reserved.
+*/
+
+#ifndef ATLAS_SEARCH_INDEX_HPP
+#define ATLAS_SEARCH_INDEX_HPP
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "pods/PackageConfig.hpp"
+
+namespace fs = std::filesystem;
+
+namespace atlas {
+  /**
+   * @class SearchIndex
+   * @brief Memory-mapped inverted index over the names and descriptions of a repository's packages.
+   *
+   * Names and descriptions are lowercased and split into alphanumeric tokens. A sorted token dictionary maps
+   * every token to the packages containing it, which answers exact and prefix queries with a binary search. A
+   * trigram table maps to the tokens containing each trigram and serves substring and typo-tolerant queries.
+   * Results are ranked by where and how well each query term matched, with a bonus for packages other packages
+   * depend on.
+   *
+   * The file is written next to the package index cache whenever that is rebuilt and records the checksum of
+   * the cache it was built from, so a stale index can be detected without reading the package index. Being a
+   * derived cache it carries no checksum of its own, opening it only validates the tables that are small enough
+   * to check up front and ids from the posting and trigram lists are checked where they are used.
+   */
+  class SearchIndex {
+  public:
+    static constexpr uint32_t MAGIC = 0x534c5441; // "ATLS"
+    static constexpr uint32_t VERSION = 1;
+    static constexpr size_t DEFAULT_LIMIT = 50;
+
+    /**
+     * @struct Match
+     * @brief A package found by a query, the name points into the mapped file.
+     */
+    struct Match {
+      std::string_view name;
+      float score;
+    };
+
+    /**
+     * @struct Header
+     * @brief On-disk header of the index file.
+     */
+    struct Header {
+      uint32_t magic;
+      uint32_t version;
+      uint64_t source;
+      uint32_t document_count;
+      uint32_t token_count;
+      uint32_t posting_count;
+      uint32_t trigram_count;
+      uint32_t reference_count;
+      uint32_t string_data_size;
+    };
+
+    /**
+     * @struct Document
+     * @brief A package, its name is a range of the string data.
+     */
+    struct Document {
+      uint32_t name_offset;
+      uint32_t name_length;
+      uint32_t popularity;
+    };
+
+    /**
+     * @struct Token
+     * @brief An entry of the sorted token dictionary and the range of its postings.
+     */
+    struct Token {
+      uint32_t text_offset;
+      uint32_t text_length;
+      uint32_t posting_offset;
+      uint32_t posting_count;
+    };
+
+    /**
+     * @struct Trigram
+     * @brief Three bytes packed into a key and the range of token ids containing them.
+     */
+    struct Trigram {
+      uint32_t key;
+      uint32_t reference_offset;
+      uint32_t reference_count;
+    };
+
+    /**
+     * @brief Where a token occurs in a package. A posting packs the package id above FIELD_BITS with these flags.
+     */
+    enum Field : uint32_t {
+      NAME = 1,
+      DESCRIPTION = 2,
+      FULL_NAME = 4
+    };
+
+    static constexpr uint32_t FIELD_BITS = 3;
+
+  private:
+    void* m_mapping;
+    size_t m_mapping_size;
+    const Header* m_header;
+    const Document* m_documents;
+    const Token* m_tokens;
+    const uint32_t* m_postings;
+    const Trigram* m_trigrams;
+    const uint32_t* m_references;
+    const char* m_string_data;
+
+  public:
+    /**
+     * @brief Default constructor, creates a closed index.
+     */
+    SearchIndex();
+
+    /**
+     * @brief Destructor, unmaps the file if it is still open.
+     */
+    ~SearchIndex();
+
+    SearchIndex(const SearchIndex&) = delete;
+    SearchIndex& operator=(const SearchIndex&) = delete;
+
+    /**
+     * @brief Maps the given index file and validates its header and bounds.
+     *
+     * @param a_path Path to the index file
+     * @return True if the file was mapped and is valid, false otherwise
+     */
+    bool Open(const fs::path& a_path);
+
+    /**
+     * @brief Unmaps the currently opened file.
+     */
+    void Close();
+
+    /**
+     * @brief Returns the checksum of the package index cache the index was built from.
+     *
+     * @return The checksum (zero if closed)
+     */
+    uint64_t GetSource() const { return m_header ? m_header->source : 0; }
+
+    /**
+     * @brief Returns the number of packages in the opened index.
+     *
+     * @return The package count (zero if closed)
+     */
+    size_t GetDocumentCount() const { return m_header ? m_header->document_count : 0; }
+
+    /**
+     * @brief Finds the packages matching every term of a query, best matches first.
+     *
+     * Terms match case-insensitively as a whole token, a token prefix or a substring, and with up to one typo
+     * (two for terms of eight or more characters) if they match nothing else. Prefix expansion is capped, so a
+     * very short term only considers the first tokens in dictionary order it prefixes.
+     *
+     * @param a_query Query of one or more whitespace or punctuation separated terms
+     * @param a_limit Maximum number of matches to return
+     * @param a_matches Receives the matches, its previous contents are replaced
+     */
+    void Search(std::string_view a_query, size_t a_limit, std::vector<Match>& a_matches) const;
+
+    /**
+     * @brief Builds the index for the given packages and writes it to a file.
+     *
+     * If a package is listed in several versions, the newest one is indexed. The file is written to a temporary
+     * location first and renamed into place afterwards.
+     *
+     * @param a_path Path to write the index file to
+     * @param a_configs Packages to index
+     * @param a_source Checksum of the package index cache the packages were taken from
+     * @return True if successful, false otherwise
+     */
+    static bool Write(const fs::path& a_path, const std::vector<PackageConfig>& a_configs, uint64_t a_source);
+
+  private:
+    /**
+     * @brief Returns the text of a token.
+     *
+     * @param a_token Token id
+     * @return View of the token inside the mapping
+     */
+    std::string_view getToken(uint32_t a_token) const;
+
+    /**
+     * @brief Returns the first token that is not less than the given text.
+     *
+     * @param a_text Text to look up
+     * @return Token id, the token count if every token is less
+     */
+    uint32_t lowerBound(std::string_view a_text) const;
+
+    /**
+     * @brief Returns the first token after all tokens starting with the given prefix.
+     *
+     * @param a_prefix Prefix to look up
+     * @return Token id, the token count if no token follows them
+     */
+    uint32_t prefixEnd(std::string_view a_prefix) const;
+
+    /**
+     * @brief Returns the token ids containing a trigram.
+     *
+     * @param a_key Packed trigram
+     * @param a_count Receives the number of token ids
+     * @return Pointer to the first token id, nullptr if no token contains the trigram
+     */
+    const uint32_t* findTrigram(uint32_t a_key, uint32_t& a_count) const;
+
+    /**
+     * @brief Collects tokens containing the term, either as a substring or within the given edit distance.
+     *
+     * Candidates come from the rarest trigrams of the term. A token within a_max_edits edits of the term keeps
+     * at least one of its 3 * a_max_edits + 1 trigrams, so looking at those lists finds every such token.
+     *
+     * @param a_term Lowercased term of at least three characters
+     * @param a_max_edits Maximum edit distance, zero to only collect tokens containing the term
+     * @param a_tokens Receives pairs of token id and edit distance
+     */
+    void findSimilar(std::string_view a_term, uint32_t a_max_edits,
+                     std::vector<std::pair<uint32_t, uint32_t>>& a_tokens) const;
+
+    /**
+     * @brief Validates the ranges referenced by the documents, tokens and trigrams.
+     *
+     * @return True if every reference is in bounds, false otherwise
+     */
+    bool validate() const;
+  };
+}
+
+#endif // ATLAS_SEARCH_INDEX_HPP
@@ -32,6 +32,8 @@ struct Command {
 };
 
 void printHelp(const char* progName) {
+  // Errors explaining why the help is shown go out before it
+  Logger::Instance().Flush();
   std::cout << "\n🔧 " << CYAN << progName << RESET << " - Package Manager\n\n"
       << YELLOW << "Usage:" << RESET << " " << progName << " <command> [args]\n\n"
       << YELLOW << "Repository Management:" << RESET << "\n"
@@ -46,7 +48,8 @@ void printHelp(const char* progName) {
       << "  update                     Update all packages\n"
       << "  upgrade <package>          Upgrade specific package\n"
       << "  search <query>             Search for packages\n"
-      << "  info <package>             Show package details\n\n"
+      << "  info <package>             Show package details\n"
+      << "  bottle <package> <dir>     Write a prebuilt bottle of a built package\n\n"
       << YELLOW << "Package Management:" << RESET << "\n"
       << "  lock <package>             Prevent package updates\n"
       << "  unlock <package>           Allow package updates\n"
@@ -162,6 +165,7 @@ const std::map<ntl::String, Command> COMMANDS = {
       "Search for packages", 1,
       [](atlas::Atlas& pm, const auto& args) {
         auto results = pm.Search(args[0]);
+        Logger::Instance().Flush();
         for (const auto& result : results) std::cout << result << "\n";
         return true;
       }
@@ -176,6 +180,12 @@ const std::map<ntl::String, Command> COMMANDS = {
       }
     }
   },
+  {
+    "bottle", {
+      "Write a prebuilt bottle of a package", 2,
+      [](atlas::Atlas& pm, const auto& args) { return pm.CreateBottle(args[0], args[1].GetCString()); }
+    }
+  },
   {
     "self-setup", {
       "Setup atlas to be globally accessible", 0,
@@ -191,12 +201,10 @@ const std::map<ntl::String, Command> COMMANDS = {
 };
 
 int main(int argc, char* argv[]) {
-  const char* homeDir = getenv("HOME");
-
-  atlas::Atlas pm(fs::path(homeDir) / ".local/share/atlas",
-                  fs::path(homeDir) / ".cache/atlas",
-                  hasVerboseFlag(argc, argv));
+  // Only the logger is needed up front, everything else is built once a command asks for it
+  Logger::Instance().Initialize();
 
+  const char* homeDir = getenv("HOME");
   if (!homeDir) {
     LOG_ERROR("HOME environment variable not set");
     return 1;
@@ -230,6 +238,10 @@ int main(int argc, char* argv[]) {
     return 1;
   }
 
+  atlas::Atlas pm(fs::path(homeDir) / ".local/share/atlas",
+                  fs::path(homeDir) / ".cache/atlas",
+                  hasVerboseFlag(argc, argv));
+
   try {
     ntl::Array<ntl::String> args{};
     for (int i = 2; i < argc; i++) {
@@ -0,0 +1,80 @@
+/**
+* @file InstallPlan.hpp
+* @author Marcus Gugacs
+* @date 16.10.26
+* @copyright Copyright (c) 2026 Marcus Gugacs. All rights reserved.
+*/
+
+#ifndef ATLAS_INSTALL_PLAN_HPP
+#define ATLAS_INSTALL_PLAN_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include <data/Array.hpp>
+#include <data/String.hpp>
+
+namespace atlas {
+#ifdef __APPLE__
+  constexpr const char* HOST_PLATFORM = "macos";
+#else
+  constexpr const char* HOST_PLATFORM = "linux";
+#endif
+
+#if defined(__x86_64__)
+  constexpr const char* HOST_ARCH = "x86_64";
+#elif defined(__aarch64__) && defined(__APPLE__)
+  constexpr const char* HOST_ARCH = "arm64";
+#elif defined(__aarch64__)
+  constexpr const char* HOST_ARCH = "aarch64";
+#else
+  constexpr const char* HOST_ARCH = "unknown";
+#endif
+
+  /**
+   * @enum InstallStep
+   * @brief The command steps of a package manifest, in the order they run during an installation.
+   */
+  enum class InstallStep : uint8_t {
+    PREPARE,
+    BUILD,
+    INSTALL,
+    CLEANUP,
+    UNINSTALL
+  };
+
+  constexpr size_t INSTALL_STEP_COUNT = 5;
+
+  /**
+   * @brief Returns the name of a step as used in package manifests and step logs.
+   *
+   * @param a_step The step
+   * @return The name of the step
+   */
+  constexpr const char* GetStepName(InstallStep a_step) {
+    constexpr const char* NAMES[INSTALL_STEP_COUNT] = {"prepare", "build", "install", "cleanup", "uninstall"};
+    return NAMES[static_cast<size_t>(a_step)];
+  }
+
+  /**
+   * @struct InstallPlan
+   * @brief What installing a package on the host platform takes, extracted from its manifest at index time.
+   *
+   * Strings are stored as written in the manifest, variables are substituted by the installer. The bottle is
+   * the prebuilt binary package for the host architecture, empty if the manifest offers none. A package whose
+   * install commands ignore PREFIX, e.g. because an earlier step compiled the install directory in, sets
+   * writes_prefix, its install step then runs alone and its changes to the install directory are adopted.
+   */
+  struct InstallPlan {
+    ntl::String url;
+    ntl::String target;
+    ntl::String sha256;
+    ntl::String bottle_url;
+    ntl::String bottle_sha256;
+    bool writes_prefix;
+    std::array<ntl::Array<ntl::String>, INSTALL_STEP_COUNT> steps;
+  };
+}
+
+#endif // ATLAS_INSTALL_PLAN_HPP
@@ -0,0 +1,32 @@
+/**
+* @file InstalledPackage.hpp
+* @author Marcus Gugacs
+* @date 16.10.26
+* @copyright Copyright (c) 2026 Marcus Gugacs. All rights reserved.
+*/
+
+#ifndef ATLAS_INSTALLED_PACKAGE_HPP
+#define ATLAS_INSTALLED_PACKAGE_HPP
+
+#include <data/Array.hpp>
+#include <data/String.hpp>
+
+namespace atlas {
+  /**
+   * @struct InstalledPackage
+   *
+   * @brief This struct represents a single entry of the installed package database.
+   */
+  struct InstalledPackage {
+    ntl::String version;
+    ntl::String install_date;
+    ntl::String repository;
+    bool locked;
+    bool keep;
+    ntl::Array<ntl::String> dependencies;
+    ntl::Array<ntl::String> files; ///< Files and links the package placed, relative to the install directory
+    ntl::String build_key; ///< Build cache key of the installed build, empty if it could not be cached
+  };
+}
+
+#endif // ATLAS_INSTALLED_PACKAGE_HPP
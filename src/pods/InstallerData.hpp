@@ -8,9 +8,9 @@
 #ifndef ATLAS_INSTALLER_DATA_HPP
 #define ATLAS_INSTALLER_DATA_HPP
 
+#include <data/Array.hpp>
 #include <data/Map.hpp>
-
-#include "pods/PackageConfig.hpp"
+#include <data/String.hpp>
 
 namespace atlas {
   /**
@@ -19,7 +19,6 @@ namespace atlas {
    * This struct holds the data required for installing a package.
    */
   struct InstallerData {
-    ntl::Array<PackageConfig> configs;
     ntl::Array<ntl::String> successful_installs;
     ntl::Array<ntl::String> skipped_installs;
     ntl::Array<ntl::String> failed_installs;
@@ -8,9 +8,13 @@
 #ifndef ATLAS_PACKAGE_CONFIG_HPP
 #define ATLAS_PACKAGE_CONFIG_HPP
 
+#include <memory>
+
 #include <data/Array.hpp>
 #include <data/String.hpp>
 
+#include "pods/InstallPlan.hpp"
+
 namespace atlas {
   /**
    * @struct PackageConfig
@@ -18,7 +22,8 @@ namespace atlas {
    *
    * This struct holds metadata about a package, such as its name, version,
    * dependencies, and other relevant details. It is intended to be used by
-   * the Atlas package manager to manage and install packages.
+   * the Atlas package manager to manage and install packages. The install plan is shared between
+   * copies and missing for packages that are not offered by any repository.
    */
   struct PackageConfig {
     ntl::String name;
@@ -29,6 +34,8 @@ namespace atlas {
     ntl::String uninstall_command;
     ntl::String repository;
     ntl::Array<ntl::String> dependencies;
+    ntl::Array<ntl::String> conflicts;
+    std::shared_ptr<const InstallPlan> plan;
   };
 }
 
@@ -24,6 +24,8 @@ namespace atlas {
     ntl::String url;
     ntl::String branch;
     bool enabled;
+    ntl::String etag;
+    ntl::String revision;
   };
 }
 
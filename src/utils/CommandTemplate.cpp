@@ -0,0 +1,127 @@
+/**
+* @file CommandTemplate.cpp
+* @author Marcus Gugacs
+* @date 16.10.26
+* @copyright Copyright (c) 2026 Marcus Gugacs. All rights reserved.
+*/
+
+#include "CommandTemplate.hpp"
+
+namespace atlas {
+  namespace {
+    bool isNameStart(char a_char) {
+      return (a_char >= 'A' && a_char <= 'Z') || (a_char >= 'a' && a_char <= 'z') || a_char == '_';
+    }
+
+    bool isNameChar(char a_char) {
+      return isNameStart(a_char) || (a_char >= '0' && a_char <= '9');
+    }
+  }
+
+  size_t CommandVariables::Set(std::string_view a_name, std::string a_value) {
+    size_t index;
+    if (Find(a_name, index)) {
+      m_values[index] = std::move(a_value);
+      return index;
+    }
+
+    m_names.emplace_back(a_name);
+    m_values.push_back(std::move(a_value));
+    return m_values.size() - 1;
+  }
+
+  bool CommandVariables::Find(std::string_view a_name, size_t& a_index) const {
+    // Only a handful of variables exist, a linear scan beats hashing here and only runs while compiling
+    for (size_t i = 0; i < m_names.size(); ++i) {
+      if (m_names[i] == a_name) {
+        a_index = i;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  CommandTemplate::CommandTemplate(std::string a_source, const CommandVariables& a_variables)
+    : m_source(std::move(a_source)), m_tokens(), m_literal_size(0) {
+    const std::string& source = m_source;
+    size_t literal_start = 0;
+    size_t i = 0;
+
+    while (i < source.size()) {
+      if (source[i] != '$') {
+        ++i;
+        continue;
+      }
+
+      bool braced = i + 1 < source.size() && source[i + 1] == '{';
+      size_t name_start = i + (braced ? 2 : 1);
+      size_t name_end = name_start;
+      if (name_end < source.size() && isNameStart(source[name_end])) {
+        while (name_end < source.size() && isNameChar(source[name_end]))
+          ++name_end;
+      }
+
+      size_t reference_end = name_end;
+      if (braced) {
+        if (name_end >= source.size() || source[name_end] != '}') {
+          ++i;
+          continue;
+        }
+        ++reference_end;
+      }
+
+      size_t index;
+      if (name_end == name_start ||
+          !a_variables.Find(std::string_view(source).substr(name_start, name_end - name_start), index)) {
+        i = reference_end > i + 1 ? reference_end : i + 1;
+        continue;
+      }
+
+      addLiteral(literal_start, i - literal_start);
+      m_tokens.push_back({0, 0, static_cast<uint32_t>(index)});
+      i = reference_end;
+      literal_start = i;
+    }
+
+    addLiteral(literal_start, source.size() - literal_start);
+  }
+
+  void CommandTemplate::Render(const CommandVariables& a_variables, std::string& a_result) const {
+    size_t size = m_literal_size;
+    for (const Token& token : m_tokens) {
+      if (token.variable != LITERAL)
+        size += a_variables.GetValue(token.variable).size();
+    }
+
+    a_result.clear();
+    a_result.reserve(size);
+    for (const Token& token : m_tokens) {
+      if (token.variable == LITERAL) {
+        a_result.append(m_source, token.offset, token.length);
+      } else {
+        a_result.append(a_variables.GetValue(token.variable));
+      }
+    }
+  }
+
+  ntl::String CommandTemplate::Render(const CommandVariables& a_variables) const {
+    std::string result;
+    Render(a_variables, result);
+    return ntl::String{result.c_str()};
+  }
+
+  void CommandTemplate::addLiteral(size_t a_offset, size_t a_length) {
+    if (a_length == 0)
+      return;
+
+    m_literal_size += a_length;
+    if (!m_tokens.empty()) {
+      Token& last = m_tokens.back();
+      if (last.variable == LITERAL && last.offset + last.length == a_offset) {
+        last.length += static_cast<uint32_t>(a_length);
+        return;
+      }
+    }
+    m_tokens.push_back({static_cast<uint32_t>(a_offset), static_cast<uint32_t>(a_length), LITERAL});
+  }
+}
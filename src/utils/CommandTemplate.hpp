@@ -0,0 +1,141 @@
+/**
+* @file CommandTemplate.hpp
+* @author Marcus Gugacs
+* @date 16.10.26
+* @copyright Copyright (c) 2026 Marcus Gugacs. All rights reserved.
+*/
+
+#ifndef ATLAS_COMMAND_TEMPLATE_HPP
+#define ATLAS_COMMAND_TEMPLATE_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <data/String.hpp>
+
+namespace atlas {
+  /**
+   * @class CommandVariables
+   * @brief Named values that can be substituted into command templates.
+   *
+   * Every variable gets a stable index when it is first set. Templates resolve names to these indices when they
+   * are compiled, so rendering never looks a name up again. Values may change between renders.
+   */
+  class CommandVariables {
+  private:
+    std::vector<std::string> m_names;
+    std::vector<std::string> m_values;
+
+  public:
+    /**
+     * @brief Defines a variable or changes its value.
+     *
+     * @param a_name Name of the variable without the leading '$'
+     * @param a_value Value to substitute
+     * @return The index of the variable
+     */
+    size_t Set(std::string_view a_name, std::string a_value);
+
+    /**
+     * @brief Looks up the index of a variable.
+     *
+     * @param a_name Name of the variable without the leading '$'
+     * @param a_index Receives the index of the variable
+     * @return True if the variable is defined, false otherwise
+     */
+    bool Find(std::string_view a_name, size_t& a_index) const;
+
+    /**
+     * @brief Returns the value of a variable.
+     *
+     * @param a_index Index returned by Set() or Find()
+     * @return The value of the variable
+     */
+    const std::string& GetValue(size_t a_index) const { return m_values[a_index]; }
+
+    /**
+     * @brief Returns the number of defined variables.
+     *
+     * @return The number of variables
+     */
+    size_t GetCount() const { return m_values.size(); }
+  };
+
+  /**
+   * @class CommandTemplate
+   * @brief A command string compiled into literal and variable tokens.
+   *
+   * References are written as $NAME or ${NAME}, where NAME consists of letters, digits and underscores. Only
+   * variables defined at compile time are substituted. Every other reference is kept as it is, so the shell still
+   * expands environment variables such as $HOME. Rendering is a single pass over the tokens into a buffer sized
+   * up front.
+   */
+  class CommandTemplate {
+  private:
+    static constexpr uint32_t LITERAL = UINT32_MAX;
+
+    /**
+     * @struct Token
+     * @brief A run of literal source text or a reference to a variable.
+     */
+    struct Token {
+      uint32_t offset;
+      uint32_t length;
+      uint32_t variable;
+    };
+
+    std::string m_source;
+    std::vector<Token> m_tokens;
+    size_t m_literal_size;
+
+  public:
+    /**
+     * @brief Constructs an empty template.
+     */
+    CommandTemplate() : m_source(), m_tokens(), m_literal_size(0) {}
+
+    /**
+     * @brief Compiles a command.
+     *
+     * @param a_source Command containing variable references
+     * @param a_variables Variables the references are resolved against, rendering must use the same set
+     */
+    CommandTemplate(std::string a_source, const CommandVariables& a_variables);
+
+    /**
+     * @brief Substitutes the current values of the variables.
+     *
+     * @param a_variables Variables the template was compiled against
+     * @param a_result String to store the command in, its previous contents are replaced
+     */
+    void Render(const CommandVariables& a_variables, std::string& a_result) const;
+
+    /**
+     * @brief Substitutes the current values of the variables.
+     *
+     * @param a_variables Variables the template was compiled against
+     * @return The command
+     */
+    ntl::String Render(const CommandVariables& a_variables) const;
+
+    /**
+     * @brief Returns the command as written in the manifest.
+     *
+     * @return The uncompiled command
+     */
+    const std::string& GetSource() const { return m_source; }
+
+  private:
+    /**
+     * @brief Appends a literal token, merging it with a directly preceding literal.
+     *
+     * @param a_offset Start of the literal in the source
+     * @param a_length Length of the literal
+     */
+    void addLiteral(size_t a_offset, size_t a_length);
+  };
+}
+
+#endif // ATLAS_COMMAND_TEMPLATE_HPP
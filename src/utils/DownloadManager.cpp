@@ -0,0 +1,720 @@
+/**
+* @file DownloadManager.cpp
+* @author Marcus Gugacs
+* @date 16.10.26
+* @copyright Copyright (c) 2026 Marcus Gugacs. All rights reserved.
+*/
+
+#include "DownloadManager.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string_view>
+#include <strings.h>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <json/json.h>
+
+#include "core/Assert.hpp"
+#include "os/ScopeLock.hpp"
+
+using namespace ntl;
+
+namespace atlas {
+  namespace {
+    constexpr int POLL_TIMEOUT_MS = 1000;
+    constexpr long LOW_SPEED_LIMIT = 1; // bytes per second
+    constexpr uint64_t UNKNOWN_SIZE = UINT64_MAX;
+    constexpr int RETRY_DELAY_MS = 500;
+    constexpr int MAX_RETRY_DELAY_MS = 30000;
+    constexpr auto STATE_INTERVAL = std::chrono::seconds(1);
+
+    /**
+     * @brief Checks whether a URL is fetched over HTTP, the only protocol downloads are split for.
+     */
+    bool isHttp(const char* a_url) {
+      return strncasecmp(a_url, "http://", 7) == 0 || strncasecmp(a_url, "https://", 8) == 0;
+    }
+
+    /**
+     * @brief Extracts the value of a header line if it has the given name.
+     */
+    bool readHeader(std::string_view a_line, std::string_view a_name, std::string& a_value) {
+      if (a_line.size() <= a_name.size() || strncasecmp(a_line.data(), a_name.data(), a_name.size()) != 0)
+        return false;
+
+      a_line.remove_prefix(a_name.size());
+      while (!a_line.empty() && (a_line.front() == ' ' || a_line.front() == '\t'))
+        a_line.remove_prefix(1);
+      while (!a_line.empty() && (a_line.back() == '\r' || a_line.back() == '\n' || a_line.back() == ' '))
+        a_line.remove_suffix(1);
+      a_value = a_line;
+      return true;
+    }
+
+    /**
+     * @brief Parses a `Content-Range: bytes <first>-<last>/<total>` value.
+     */
+    bool parseContentRange(const std::string& a_value, uint64_t& a_first, uint64_t& a_total) {
+      uint64_t last = 0;
+      return std::sscanf(a_value.c_str(), "bytes %" SCNu64 "-%" SCNu64 "/%" SCNu64, &a_first, &last,
+                         &a_total) == 3 && a_first <= last && last < a_total;
+    }
+
+    /**
+     * @brief Reserves the blocks of a file up front, so a full disk fails the download before it starts.
+     */
+    bool preallocate(int a_fd, uint64_t a_size) {
+#ifdef __linux__
+      if (fallocate(a_fd, 0, 0, static_cast<off_t>(a_size)) == 0)
+        return true;
+      if (errno != EOPNOTSUPP && errno != ENOSYS)
+        return false;
+#endif
+      // File systems without preallocation get a sparse file of the final size
+      return ftruncate(a_fd, static_cast<off_t>(a_size)) == 0;
+    }
+
+    /**
+     * @brief Returns the path the resume state of a download is kept at.
+     */
+    fs::path getStatePath(const fs::path& a_target) {
+      return a_target.string() + DownloadManager::RESUME_SUFFIX;
+    }
+  }
+
+  void DownloadManager::Initialize(const Config::Network& a_network) {
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+
+    m_network = a_network;
+    m_multi = curl_multi_init();
+    curl_multi_setopt(m_multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+    curl_multi_setopt(m_multi, CURLMOPT_MAX_HOST_CONNECTIONS, static_cast<long>(m_network.max_connections_per_host));
+    curl_multi_setopt(m_multi, CURLMOPT_MAX_TOTAL_CONNECTIONS, static_cast<long>(m_network.max_parallel_downloads));
+
+    m_active_transfers = 0;
+    m_running = true;
+    m_initialized = true;
+    m_loop = std::thread(&DownloadManager::run, this);
+  }
+
+  void DownloadManager::Shutdown() {
+    if (!m_initialized)
+      return;
+
+    m_running = false;
+    curl_multi_wakeup(m_multi);
+    if (m_loop.joinable()) {
+      m_loop.join();
+    }
+
+    curl_multi_cleanup(m_multi);
+    m_multi = nullptr;
+    m_initialized = false;
+    curl_global_cleanup();
+  }
+
+  std::shared_future<DownloadManager::Result> DownloadManager::Submit(Request a_request) {
+    VERIFY(m_initialized && "DownloadManager must be initialized prior to use")
+
+    std::shared_future<Result> result;
+    ++m_active_transfers;
+    if (!a_request.target.empty() && !a_request.on_data) {
+      auto* download = new Download{std::move(a_request), {}, -1, UNKNOWN_SIZE, {}, {}, {}, {}, 0, false, false,
+                                    false, {}, {}};
+      result = download->promise.get_future().share();
+      ScopeLock lock(&m_pending_lock);
+      m_pending_downloads.push_back(download);
+    } else {
+      auto* transfer = new Transfer{std::move(a_request), nullptr, nullptr, nullptr, {}, {}, {}, {}};
+      result = transfer->promise.get_future().share();
+      ScopeLock lock(&m_pending_lock);
+      m_pending.push_back(transfer);
+    }
+    curl_multi_wakeup(m_multi);
+
+    return result;
+  }
+
+  DownloadManager::Result DownloadManager::Perform(Request a_request) {
+    return Submit(std::move(a_request)).get();
+  }
+
+  void DownloadManager::WaitForTransfers() {
+    VERIFY(m_initialized && "DownloadManager must be initialized prior to use")
+
+    m_pending_lock.Acquire();
+    while (m_active_transfers > 0)
+      m_transfers_changed.Wait();
+    m_pending_lock.Release();
+  }
+
+  void DownloadManager::run() {
+    while (m_running) {
+      startPending();
+      scheduleChunks();
+
+      int still_running = 0;
+      curl_multi_perform(m_multi, &still_running);
+
+      int queued = 0;
+      while (CURLMsg* message = curl_multi_info_read(m_multi, &queued)) {
+        if (message->msg != CURLMSG_DONE)
+          continue;
+
+        Transfer* transfer = nullptr;
+        curl_easy_getinfo(message->easy_handle, CURLINFO_PRIVATE, &transfer);
+        finish(transfer, message->data.result);
+      }
+
+      // A finished chunk frees a connection for the next one right away
+      int timeout = m_reschedule ? 0 : getRetryDelay();
+      m_reschedule = false;
+      curl_multi_poll(m_multi, nullptr, 0, timeout, nullptr);
+    }
+
+    // Abort everything that is still queued or running
+    startPending();
+    std::vector<Transfer*> remaining = m_transfers;
+    for (Transfer* transfer : remaining) {
+      finish(transfer, CURLE_ABORTED_BY_CALLBACK);
+    }
+
+    // Downloads waiting for a retry have no transfer left to abort
+    std::vector<Download*> downloads = m_downloads;
+    for (Download* download : downloads) {
+      if (!download->failed) {
+        download->failed = true;
+        download->result.error = curl_easy_strerror(CURLE_ABORTED_BY_CALLBACK);
+      }
+      completeDownload(download);
+    }
+  }
+
+  void DownloadManager::startPending() {
+    std::vector<Transfer*> pending;
+    std::vector<Download*> downloads;
+    {
+      ScopeLock lock(&m_pending_lock);
+      pending.swap(m_pending);
+      downloads.swap(m_pending_downloads);
+    }
+
+    // Chunks are started by scheduleChunks(), a download that cannot be opened is completed there as well
+    for (Download* download : downloads) {
+      if (!openDownload(download)) {
+        download->failed = true;
+        download->result.error = ntl::String{"Failed to open "} + download->request.target.c_str() + ": " +
+                                 std::strerror(errno);
+      }
+      m_downloads.push_back(download);
+    }
+
+    for (Transfer* transfer : pending) {
+      transfer->handle = curl_easy_init();
+      if (!transfer->request.target.empty()) {
+        transfer->file = fopen(transfer->request.target.c_str(), "wb");
+      }
+      if (!transfer->handle || (!transfer->file && !transfer->request.target.empty())) {
+        finish(transfer, CURLE_WRITE_ERROR);
+        continue;
+      }
+
+      setupTransfer(transfer, transfer->request.url.GetCString(), transfer->request.headers);
+      curl_multi_add_handle(m_multi, transfer->handle);
+      m_transfers.push_back(transfer);
+    }
+  }
+
+  void DownloadManager::setupTransfer(Transfer* a_transfer, const char* a_url,
+                                      const ntl::Array<ntl::String>& a_headers) {
+    for (const auto& header : a_headers) {
+      a_transfer->headers = curl_slist_append(a_transfer->headers, header.GetCString());
+    }
+
+    CURL* handle = a_transfer->handle;
+    curl_easy_setopt(handle, CURLOPT_URL, a_url);
+    curl_easy_setopt(handle, CURLOPT_PRIVATE, a_transfer);
+    curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, &DownloadManager::writeCallback);
+    curl_easy_setopt(handle, CURLOPT_WRITEDATA, a_transfer);
+    curl_easy_setopt(handle, CURLOPT_HEADERFUNCTION, &DownloadManager::headerCallback);
+    curl_easy_setopt(handle, CURLOPT_HEADERDATA, a_transfer);
+    curl_easy_setopt(handle, CURLOPT_ERRORBUFFER, a_transfer->error);
+    curl_easy_setopt(handle, CURLOPT_HTTPHEADER, a_transfer->headers);
+    curl_easy_setopt(handle, CURLOPT_USERAGENT, "Atlas-Package-Manager");
+    curl_easy_setopt(handle, CURLOPT_FOLLOWLOCATION, 1L);
+    curl_easy_setopt(handle, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+    curl_easy_setopt(handle, CURLOPT_PIPEWAIT, 1L);
+    curl_easy_setopt(handle, CURLOPT_CONNECTTIMEOUT, static_cast<long>(m_network.timeout));
+    // Abort stalled transfers instead of capping the total time of large downloads
+    curl_easy_setopt(handle, CURLOPT_LOW_SPEED_LIMIT, LOW_SPEED_LIMIT);
+    curl_easy_setopt(handle, CURLOPT_LOW_SPEED_TIME, static_cast<long>(m_network.timeout));
+  }
+
+  bool DownloadManager::openDownload(Download* a_download) {
+    const fs::path& target = a_download->request.target;
+    a_download->fd = open(target.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (a_download->fd < 0)
+      return false;
+
+    // Progress of an earlier attempt only counts for the same URL and a target that still has its full size
+    Json::Value state;
+    std::ifstream input(getStatePath(target));
+    struct stat info{};
+    if (!input || !Json::parseFromStream(Json::CharReaderBuilder(), input, &state, nullptr) || !state.isObject() ||
+        state["url"].asString() != a_download->request.url.GetCString() || !state["size"].isUInt64() ||
+        !state["validator"].isString() || state["validator"].asString().empty() ||
+        fstat(a_download->fd, &info) != 0 || static_cast<uint64_t>(info.st_size) != state["size"].asUInt64())
+      return resetDownload(a_download);
+
+    uint64_t size = state["size"].asUInt64();
+    std::vector<Chunk> chunks;
+    for (const auto& chunk : state["chunks"]) {
+      if (!chunk.isArray() || chunk.size() != 3 || !chunk[0].isUInt64() || !chunk[1].isUInt64() ||
+          !chunk[2].isUInt64())
+        return resetDownload(a_download);
+
+      uint64_t offset = chunk[0].asUInt64();
+      uint64_t end = chunk[1].asUInt64();
+      uint64_t received = chunk[2].asUInt64();
+      if (offset >= end || end > size || received > end - offset)
+        return resetDownload(a_download);
+      chunks.push_back({offset, end, received, 0, {}, false});
+    }
+    if (chunks.empty())
+      return resetDownload(a_download);
+
+    a_download->size = size;
+    a_download->validator = state["validator"].asString();
+    a_download->etag = state["etag"].asString();
+    a_download->chunks = std::move(chunks);
+    return true;
+  }
+
+  bool DownloadManager::resetDownload(Download* a_download) {
+    std::error_code error;
+    fs::remove(getStatePath(a_download->request.target), error);
+
+    // Over HTTP the first chunk is requested as a range, the response tells the size and whether ranges work
+    a_download->size = UNKNOWN_SIZE;
+    a_download->location.clear();
+    a_download->validator.clear();
+    a_download->etag.clear();
+    a_download->chunks = {{0, isHttp(a_download->request.url.GetCString()) ? CHUNK_SIZE : UNKNOWN_SIZE, 0, 0, {},
+                           false}};
+    return ftruncate(a_download->fd, 0) == 0;
+  }
+
+  void DownloadManager::scheduleChunks() {
+    auto now = std::chrono::steady_clock::now();
+    size_t connections = static_cast<size_t>(std::max(m_network.max_connections_per_host, 1));
+
+    std::vector<Download*> downloads = m_downloads;
+    for (Download* download : downloads) {
+      if (download->failed || download->stale) {
+        // The other chunks of a download that cannot finish like this are wasted bandwidth
+        std::vector<Transfer*> transfers = m_transfers;
+        for (Transfer* transfer : transfers) {
+          if (transfer->download == download) {
+            finishChunk(transfer, CURLE_ABORTED_BY_CALLBACK);
+          }
+        }
+
+        // The remote file changed, what was downloaded so far is of no use
+        if (download->stale && !download->failed) {
+          download->stale = false;
+          if (download->restarted || !resetDownload(download)) {
+            download->failed = true;
+            download->result.error = "Remote file changed during the download";
+          }
+          download->restarted = true;
+          m_reschedule = true;
+        }
+        if (download->failed) {
+          completeDownload(download);
+        }
+        continue;
+      }
+
+      bool complete = true;
+      for (size_t i = 0; i < download->chunks.size(); ++i) {
+        const Chunk& chunk = download->chunks[i];
+        if (chunk.end != UNKNOWN_SIZE && chunk.received == chunk.end - chunk.offset)
+          continue;
+
+        complete = false;
+        if (!chunk.running && chunk.retry_at <= now && download->running < connections) {
+          startChunk(download, i);
+        }
+      }
+
+      if (complete && download->running == 0) {
+        completeDownload(download);
+      } else if (now - download->saved >= STATE_INTERVAL) {
+        saveState(download);
+      }
+    }
+  }
+
+  void DownloadManager::startChunk(Download* a_download, size_t a_chunk) {
+    auto* transfer = new Transfer{{}, curl_easy_init(), nullptr, nullptr, {}, {}, {}, {}, a_download, a_chunk,
+                                  false, false, {}, {}};
+    if (!transfer->handle) {
+      delete transfer;
+      a_download->failed = true;
+      a_download->result.error = curl_easy_strerror(CURLE_OUT_OF_MEMORY);
+      return;
+    }
+
+    Chunk& chunk = a_download->chunks[a_chunk];
+    chunk.running = true;
+    ++a_download->running;
+
+    // A changed file must not be mixed with what was already downloaded, it is sent in full instead
+    if (!a_download->validator.empty()) {
+      transfer->headers = curl_slist_append(transfer->headers, ("If-Range: " + a_download->validator).c_str());
+    }
+
+    const char* url = a_download->location.empty() ? a_download->request.url.GetCString()
+                                                   : a_download->location.c_str();
+    setupTransfer(transfer, url, a_download->request.headers);
+    if (chunk.end != UNKNOWN_SIZE) {
+      std::string range = std::to_string(chunk.offset + chunk.received) + "-" + std::to_string(chunk.end - 1);
+      curl_easy_setopt(transfer->handle, CURLOPT_RANGE, range.c_str());
+    } else {
+      chunk.received = 0;
+    }
+
+    // Multiplexed streams would share a single connection's throughput, chunks get connections of their own
+    if (a_download->size != UNKNOWN_SIZE) {
+      curl_easy_setopt(transfer->handle, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_1_1);
+      curl_easy_setopt(transfer->handle, CURLOPT_PIPEWAIT, 0L);
+    }
+
+    curl_multi_add_handle(m_multi, transfer->handle);
+    m_transfers.push_back(transfer);
+  }
+
+  bool DownloadManager::splitDownload(Download* a_download, uint64_t a_size) {
+    if (!preallocate(a_download->fd, a_size))
+      return false;
+
+    a_download->size = a_size;
+    a_download->chunks[0].end = std::min(CHUNK_SIZE, a_size);
+    for (uint64_t offset = CHUNK_SIZE; offset < a_size; offset += CHUNK_SIZE) {
+      a_download->chunks.push_back({offset, std::min(offset + CHUNK_SIZE, a_size), 0, 0, {}, false});
+    }
+    return true;
+  }
+
+  void DownloadManager::completeDownload(Download* a_download) {
+    Result result = a_download->result;
+    if (!a_download->failed) {
+      result = {true, 200, "", a_download->etag.c_str(), ""};
+      if (ftruncate(a_download->fd, static_cast<off_t>(a_download->size)) != 0) {
+        result = {false, 0, ntl::String{"Failed to write "} + a_download->request.target.c_str(), "", ""};
+      }
+    }
+    if (a_download->fd >= 0 && close(a_download->fd) != 0 && result.success) {
+      result = {false, 0, ntl::String{"Failed to write "} + a_download->request.target.c_str(), "", ""};
+    }
+
+    // A download that cannot be resumed leaves nothing behind
+    std::error_code error;
+    if (result.success) {
+      fs::remove(getStatePath(a_download->request.target), error);
+    } else if (!saveState(a_download)) {
+      fs::remove(getStatePath(a_download->request.target), error);
+      fs::remove(a_download->request.target, error);
+    }
+
+    if (a_download->request.on_complete) {
+      a_download->request.on_complete(result);
+    }
+    a_download->promise.set_value(result);
+    std::erase(m_downloads, a_download);
+    delete a_download;
+
+    m_pending_lock.Acquire();
+    --m_active_transfers;
+    m_transfers_changed.Broadcast();
+    m_pending_lock.Release();
+  }
+
+  bool DownloadManager::saveState(Download* a_download) {
+    a_download->saved = std::chrono::steady_clock::now();
+    if (a_download->size == UNKNOWN_SIZE || a_download->chunks.size() < 2 || a_download->validator.empty())
+      return false;
+
+    Json::Value state;
+    state["url"] = a_download->request.url.GetCString();
+    state["size"] = static_cast<Json::UInt64>(a_download->size);
+    state["validator"] = a_download->validator;
+    state["etag"] = a_download->etag;
+    Json::Value& chunks = state["chunks"];
+    chunks = Json::Value(Json::arrayValue);
+    for (const Chunk& chunk : a_download->chunks) {
+      Json::Value entry(Json::arrayValue);
+      entry.append(static_cast<Json::UInt64>(chunk.offset));
+      entry.append(static_cast<Json::UInt64>(chunk.end));
+      entry.append(static_cast<Json::UInt64>(chunk.received));
+      chunks.append(std::move(entry));
+    }
+
+    Json::StreamWriterBuilder builder;
+    builder["indentation"] = "";
+
+    // Written aside and renamed, an interrupted write must not lose the previous state
+    fs::path path = getStatePath(a_download->request.target);
+    fs::path temporary = path.string() + ".tmp";
+    std::ofstream output(temporary, std::ios::trunc);
+    output << Json::writeString(builder, state);
+    output.close();
+
+    std::error_code error;
+    if (output) {
+      fs::rename(temporary, path, error);
+    }
+    if (!output || error) {
+      fs::remove(temporary, error);
+      return false;
+    }
+    return true;
+  }
+
+  int DownloadManager::getRetryDelay() const {
+    auto now = std::chrono::steady_clock::now();
+    int delay = POLL_TIMEOUT_MS;
+    for (const Download* download : m_downloads) {
+      for (const Chunk& chunk : download->chunks) {
+        if (chunk.running || chunk.retry_at <= now)
+          continue;
+        auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(chunk.retry_at - now).count() + 1;
+        delay = std::min(delay, static_cast<int>(wait));
+      }
+    }
+    return delay;
+  }
+
+  void DownloadManager::finish(Transfer* a_transfer, CURLcode a_code) {
+    if (a_transfer->download) {
+      finishChunk(a_transfer, a_code);
+      return;
+    }
+
+    Result result{a_code == CURLE_OK, 0, "", a_transfer->etag.c_str(), a_transfer->body.c_str()};
+
+    std::erase(m_transfers, a_transfer);
+
+    if (a_transfer->handle) {
+      curl_easy_getinfo(a_transfer->handle, CURLINFO_RESPONSE_CODE, &result.status);
+      curl_multi_remove_handle(m_multi, a_transfer->handle);
+      curl_easy_cleanup(a_transfer->handle);
+    }
+
+    if (a_transfer->file) {
+      if (fclose(a_transfer->file) != 0 && result.success) {
+        result.success = false;
+        a_code = CURLE_WRITE_ERROR;
+      }
+    }
+
+    curl_slist_free_all(a_transfer->headers);
+
+    if (a_code != CURLE_OK) {
+      result.error = a_transfer->error[0] != '\0' ? a_transfer->error : curl_easy_strerror(a_code);
+    } else if (result.status >= 400) {
+      result.success = false;
+      result.error = ntl::String{"HTTP status "} + static_cast<int>(result.status);
+    }
+
+    if (a_transfer->request.on_complete) {
+      a_transfer->request.on_complete(result);
+    }
+    a_transfer->promise.set_value(result);
+    delete a_transfer;
+
+    m_pending_lock.Acquire();
+    --m_active_transfers;
+    m_transfers_changed.Broadcast();
+    m_pending_lock.Release();
+  }
+
+  void DownloadManager::finishChunk(Transfer* a_transfer, CURLcode a_code) {
+    Download* download = a_transfer->download;
+    Chunk& chunk = download->chunks[a_transfer->chunk];
+    long status = 0;
+    curl_easy_getinfo(a_transfer->handle, CURLINFO_RESPONSE_CODE, &status);
+    ntl::String error = a_transfer->error[0] != '\0' ? a_transfer->error : curl_easy_strerror(a_code);
+    bool fatal = a_transfer->fatal;
+    releaseHandle(a_transfer);
+    delete a_transfer;
+
+    chunk.running = false;
+    --download->running;
+    m_reschedule = true;
+    if (download->failed || download->stale)
+      return;
+
+    bool success = a_code == CURLE_OK && status < 300;
+    if (success && chunk.end == UNKNOWN_SIZE) {
+      // Without ranges the only transfer delivers the whole file
+      chunk.end = chunk.received;
+      download->size = chunk.received;
+    } else if (status == 416 && download->size == UNKNOWN_SIZE) {
+      // An empty file has no range to request
+      chunk.end = 0;
+      download->size = 0;
+      return;
+    }
+    if (success && chunk.received == chunk.end - chunk.offset)
+      return;
+
+    // Connection problems, server errors and short responses are worth another try, the chunk resumes
+    bool transient = !fatal && a_code != CURLE_ABORTED_BY_CALLBACK &&
+                     (a_code != CURLE_OK || status < 300 || status == 408 || status == 429 || status >= 500);
+    if (transient && chunk.failures < m_network.retries) {
+      int delay = std::min(RETRY_DELAY_MS << std::min(chunk.failures, 16), MAX_RETRY_DELAY_MS);
+      ++chunk.failures;
+      chunk.retry_at = std::chrono::steady_clock::now() + std::chrono::milliseconds(delay);
+      return;
+    }
+
+    download->failed = true;
+    download->result.status = status;
+    if (a_code != CURLE_OK) {
+      download->result.error = error;
+    } else if (status >= 300) {
+      download->result.error = ntl::String{"HTTP status "} + static_cast<int>(status);
+    } else {
+      download->result.error = "Incomplete response";
+    }
+  }
+
+  void DownloadManager::releaseHandle(Transfer* a_transfer) {
+    std::erase(m_transfers, a_transfer);
+    if (a_transfer->handle) {
+      curl_multi_remove_handle(m_multi, a_transfer->handle);
+      curl_easy_cleanup(a_transfer->handle);
+    }
+    curl_slist_free_all(a_transfer->headers);
+  }
+
+  size_t DownloadManager::writeCallback(char* a_data, size_t a_size, size_t a_count, void* a_user) {
+    auto* transfer = static_cast<Transfer*>(a_user);
+    size_t size = a_size * a_count;
+
+    if (transfer->download)
+      return writeChunk(transfer, a_data, size);
+
+    if (transfer->request.on_data) {
+      long status = 0;
+      curl_easy_getinfo(transfer->handle, CURLINFO_RESPONSE_CODE, &status);
+      // Error pages are not what the consumer expects to parse
+      if (status < 300) {
+        return transfer->request.on_data(a_data, size) ? size : 0;
+      }
+    }
+
+    if (!transfer->file) {
+      transfer->body.append(a_data, size);
+      return size;
+    }
+    return fwrite(a_data, 1, size, transfer->file);
+  }
+
+  size_t DownloadManager::writeChunk(Transfer* a_transfer, const char* a_data, size_t a_size) {
+    Download* download = a_transfer->download;
+    if (!a_transfer->checked) {
+      long status = 0;
+      curl_easy_getinfo(a_transfer->handle, CURLINFO_RESPONSE_CODE, &status);
+      // Error pages are discarded, finishChunk() reports the status
+      if (status >= 300)
+        return a_size;
+
+      const Chunk& chunk = download->chunks[a_transfer->chunk];
+      bool probe = download->size == UNKNOWN_SIZE;
+      uint64_t first = 0;
+      uint64_t total = 0;
+      if (status == 206) {
+        if (!parseContentRange(a_transfer->content_range, first, total) || first != chunk.offset + chunk.received)
+          return 0;
+
+        if (probe) {
+          // Later chunks go straight to where redirects led, validated against the version seen here
+          char* location = nullptr;
+          curl_easy_getinfo(a_transfer->handle, CURLINFO_EFFECTIVE_URL, &location);
+          download->location = location ? location : "";
+          download->etag = a_transfer->etag;
+          download->validator = !a_transfer->etag.empty() ? a_transfer->etag : a_transfer->last_modified;
+          if (!splitDownload(download, total)) {
+            a_transfer->fatal = true;
+            return 0;
+          }
+        } else if (total != download->size) {
+          download->stale = true;
+          return 0;
+        }
+      } else if (probe || chunk.end == UNKNOWN_SIZE) {
+        // The server ignores ranges or the protocol has none, the whole file arrives on this transfer
+        download->chunks[a_transfer->chunk].end = UNKNOWN_SIZE;
+        download->chunks[a_transfer->chunk].received = 0;
+        download->etag = a_transfer->etag;
+        curl_off_t length = -1;
+        curl_easy_getinfo(a_transfer->handle, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &length);
+        if (length > 0 && !preallocate(download->fd, static_cast<uint64_t>(length))) {
+          a_transfer->fatal = true;
+          return 0;
+        }
+      } else {
+        // A full response to a range request means the file changed since the download started
+        download->stale = true;
+        return 0;
+      }
+      a_transfer->checked = true;
+    }
+
+    Chunk& chunk = download->chunks[a_transfer->chunk];
+    uint64_t position = chunk.offset + chunk.received;
+    if (chunk.end != UNKNOWN_SIZE && a_size > chunk.end - position)
+      return 0;
+
+    for (size_t written = 0; written < a_size;) {
+      ssize_t result = pwrite(download->fd, a_data + written, a_size - written,
+                              static_cast<off_t>(position + written));
+      if (result < 0) {
+        if (errno == EINTR)
+          continue;
+        a_transfer->fatal = true;
+        return 0;
+      }
+      written += static_cast<size_t>(result);
+    }
+    chunk.received += a_size;
+    return a_size;
+  }
+
+  size_t DownloadManager::headerCallback(char* a_data, size_t a_size, size_t a_count, void* a_user) {
+    auto* transfer = static_cast<Transfer*>(a_user);
+    std::string_view line(a_data, a_size * a_count);
+
+    // A new status line starts the headers of the next response when redirects are followed
+    if (line.starts_with("HTTP/")) {
+      transfer->etag.clear();
+      transfer->last_modified.clear();
+      transfer->content_range.clear();
+    } else if (!readHeader(line, "etag:", transfer->etag) &&
+               !readHeader(line, "last-modified:", transfer->last_modified)) {
+      readHeader(line, "content-range:", transfer->content_range);
+    }
+
+    return a_size * a_count;
+  }
+}
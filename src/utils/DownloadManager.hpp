@@ -0,0 +1,321 @@
+/**
+* @file DownloadManager.hpp
+* @author Marcus Gugacs
+* @date 16.10.26
+* @copyright Copyright (c) 2026 Marcus Gugacs. All rights reserved.
+*/
+
+#ifndef ATLAS_DOWNLOAD_MANAGER_HPP
+#define ATLAS_DOWNLOAD_MANAGER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <curl/curl.h>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "data/Array.hpp"
+#include "data/Singleton.hpp"
+#include "data/String.hpp"
+#include "os/Condition.hpp"
+#include "os/Lock.hpp"
+
+#include "core/Config.hpp"
+
+namespace fs = std::filesystem;
+
+namespace atlas {
+  /**
+   * @brief DownloadManager class driving all transfers from a single thread using the curl multi interface.
+   *
+   * Transfers share one connection cache, so connections to the same host are reused and HTTP/2 streams are
+   * multiplexed over a single connection where possible. Concurrency is capped per host and in total using
+   * the network configuration, independently of the number of job system workers.
+   *
+   * Downloads to a file are fetched as byte ranges of CHUNK_SIZE bytes over up to max_connections_per_host
+   * connections and written with pwrite into a preallocated file. Every chunk is retried up to
+   * Config::Network::retries times with exponential backoff. Progress of downloads larger than one chunk is
+   * persisted to `<target>.resume`, so a failed or interrupted download of the same URL to the same target
+   * continues where it stopped, provided the server sends an ETag or Last-Modified to validate it with.
+   */
+  class DownloadManager : public ntl::Singleton<DownloadManager> {
+    SINGLETON_IMPL(DownloadManager)
+
+  public:
+    static constexpr uint64_t CHUNK_SIZE = 8 << 20;
+    static constexpr char RESUME_SUFFIX[] = ".resume";
+
+    /**
+     * @struct Result
+     * @brief Outcome of a single transfer.
+     */
+    struct Result {
+      bool success;
+      long status;
+      ntl::String error;
+      ntl::String etag;
+      ntl::String body;
+    };
+
+    /**
+     * @struct Request
+     * @brief Description of a single transfer.
+     *
+     * If no target is set the response body is kept in memory and returned in Result::body, which is meant
+     * for small API responses. A data callback receives the body of a successful response as it arrives
+     * instead, it runs on the event loop thread and fails the transfer by returning false. Requests with a
+     * target and without a data callback are downloaded in chunks, a failed download keeps its partial target
+     * if it can be resumed and removes it otherwise.
+     */
+    struct Request {
+      ntl::String url;
+      fs::path target;
+      ntl::Array<ntl::String> headers;
+      std::function<void(const Result&)> on_complete;
+      std::function<bool(const char*, size_t)> on_data;
+    };
+
+  private:
+    struct Download;
+
+    /**
+     * @struct Transfer
+     * @brief State of a transfer owned by the event loop.
+     *
+     * Transfers fetching a chunk of a download belong to it and leave the request and promise unused.
+     */
+    struct Transfer {
+      Request request;
+      CURL* handle;
+      FILE* file;
+      curl_slist* headers;
+      std::string body;
+      std::string etag;
+      std::promise<Result> promise;
+      char error[CURL_ERROR_SIZE];
+      Download* download;
+      size_t chunk;
+      bool checked;
+      bool fatal;
+      std::string last_modified;
+      std::string content_range;
+    };
+
+    /**
+     * @struct Chunk
+     * @brief Byte range of a download, end is UNKNOWN_SIZE while the server's support for ranges is unknown.
+     */
+    struct Chunk {
+      uint64_t offset;
+      uint64_t end;
+      uint64_t received;
+      int failures;
+      std::chrono::steady_clock::time_point retry_at;
+      bool running;
+    };
+
+    /**
+     * @struct Download
+     * @brief State of a download to a file, fetched by one transfer per chunk.
+     */
+    struct Download {
+      Request request;
+      std::promise<Result> promise;
+      int fd;
+      uint64_t size;
+      std::string location;
+      std::string validator;
+      std::string etag;
+      std::vector<Chunk> chunks;
+      size_t running;
+      bool failed;
+      bool stale;
+      bool restarted;
+      Result result;
+      std::chrono::steady_clock::time_point saved;
+    };
+
+    CURLM* m_multi;
+    std::thread m_loop;
+    std::vector<Transfer*> m_transfers;
+    std::vector<Transfer*> m_pending;
+    std::vector<Download*> m_downloads;
+    std::vector<Download*> m_pending_downloads;
+    bool m_reschedule;
+    ntl::Lock m_pending_lock;
+    ntl::Condition m_transfers_changed;
+    Config::Network m_network;
+    std::atomic<ntl::Bool> m_initialized;
+    std::atomic<ntl::Bool> m_running;
+    std::atomic<int> m_active_transfers;
+
+  public:
+    /**
+     * @brief Initializes the download manager and starts its event loop.
+     * @param a_network the network configuration providing timeouts and connection limits
+     */
+    void Initialize(const Config::Network& a_network);
+
+    /**
+     * @brief Stops the event loop, aborting all transfers that are still running.
+     */
+    void Shutdown();
+
+    /**
+     * @brief Queues a transfer.
+     *
+     * The completion callback of the request is invoked on the event loop thread and must not block.
+     *
+     * @param a_request the transfer to queue
+     * @return a future receiving the result of the transfer
+     */
+    std::shared_future<Result> Submit(Request a_request);
+
+    /**
+     * @brief Queues a transfer and waits for it to complete.
+     * @param a_request the transfer to perform
+     * @return the result of the transfer
+     */
+    Result Perform(Request a_request);
+
+    /**
+     * @brief Waits until no transfers are queued or running.
+     */
+    void WaitForTransfers();
+
+    /**
+     * @brief Checks whether the event loop has been started.
+     * @return if the download manager is ready to accept transfers
+     */
+    ntl::Bool IsInitialized() const { return m_initialized; }
+
+  private:
+    /**
+     * @brief Default Constructor.
+     */
+    DownloadManager()
+      : Singleton{}, m_multi{nullptr}, m_loop{}, m_transfers{}, m_pending{}, m_downloads{}, m_pending_downloads{},
+        m_reschedule{false}, m_pending_lock{},
+        m_transfers_changed{&m_pending_lock}, m_network{}, m_initialized{false}, m_running{false},
+        m_active_transfers{0} {}
+
+    /**
+     * @brief Default Destructor.
+     */
+    ~DownloadManager() {}
+
+    /**
+     * @brief Runs the event loop until the download manager is shut down.
+     */
+    void run();
+
+    /**
+     * @brief Creates the easy handles of all queued transfers and adds them to the multi handle.
+     */
+    void startPending();
+
+    /**
+     * @brief Sets the options shared by every transfer on its easy handle.
+     * @param a_transfer the transfer to set up
+     * @param a_url the URL to fetch
+     * @param a_headers additional request headers
+     */
+    void setupTransfer(Transfer* a_transfer, const char* a_url, const ntl::Array<ntl::String>& a_headers);
+
+    /**
+     * @brief Opens the target of a download and restores its progress from an earlier attempt.
+     * @param a_download the download to open
+     * @return if the target could be opened
+     */
+    bool openDownload(Download* a_download);
+
+    /**
+     * @brief Starts the chunks that are due, completes downloads that are done or failed.
+     */
+    void scheduleChunks();
+
+    /**
+     * @brief Starts a transfer fetching the remaining bytes of a chunk.
+     * @param a_download the download the chunk belongs to
+     * @param a_chunk index of the chunk
+     */
+    void startChunk(Download* a_download, size_t a_chunk);
+
+    /**
+     * @brief Splits a download into chunks once its size is known and preallocates its target.
+     * @param a_download the download to split
+     * @param a_size size of the file in bytes
+     * @return if the target could be preallocated
+     */
+    static bool splitDownload(Download* a_download, uint64_t a_size);
+
+    /**
+     * @brief Empties the target of a download and starts it over with a request probing the server.
+     * @param a_download the download to reset
+     * @return if the target could be truncated
+     */
+    static bool resetDownload(Download* a_download);
+
+    /**
+     * @brief Completes a download, releases its resources and keeps or removes its partial target.
+     * @param a_download the finished download
+     */
+    void completeDownload(Download* a_download);
+
+    /**
+     * @brief Writes the progress of a download next to its target, if it can be resumed.
+     * @param a_download the download to persist
+     * @return if the state was written, false if the download cannot be resumed
+     */
+    bool saveState(Download* a_download);
+
+    /**
+     * @brief Returns the time until the next chunk is due for a retry.
+     * @return milliseconds to wait at most, POLL_TIMEOUT_MS if no retry is pending
+     */
+    int getRetryDelay() const;
+
+    /**
+     * @brief Completes a finished transfer and releases its resources.
+     * @param a_transfer the finished transfer
+     * @param a_code the curl result of the transfer
+     */
+    void finish(Transfer* a_transfer, CURLcode a_code);
+
+    /**
+     * @brief Records the outcome of a chunk transfer, scheduling a retry or failing its download.
+     * @param a_transfer the finished chunk transfer
+     * @param a_code the curl result of the transfer
+     */
+    void finishChunk(Transfer* a_transfer, CURLcode a_code);
+
+    /**
+     * @brief Releases the easy handle and headers of a transfer and removes it from the running transfers.
+     * @param a_transfer the transfer to release
+     */
+    void releaseHandle(Transfer* a_transfer);
+
+    /**
+     * @brief Checks the response of a chunk transfer and writes its data at the chunk's position.
+     * @return the number of bytes consumed, anything else fails the transfer
+     */
+    static size_t writeChunk(Transfer* a_transfer, const char* a_data, size_t a_size);
+
+    /**
+     * @brief curl write callback storing received data in the target file.
+     */
+    static size_t writeCallback(char* a_data, size_t a_size, size_t a_count, void* a_user);
+
+    /**
+     * @brief curl header callback remembering the ETag of the final response.
+     */
+    static size_t headerCallback(char* a_data, size_t a_size, size_t a_count, void* a_user);
+  };
+}
+
+#endif // ATLAS_DOWNLOAD_MANAGER_HPP
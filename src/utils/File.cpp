@@ -7,27 +7,49 @@
 
 #include "File.hpp"
 
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "os/ScopeLock.hpp"
+
 namespace atlas {
   File::File(const ntl::String& a_filepath)
     : m_filepath{a_filepath} { }
 
   bool File::ReadFile(ntl::String& a_data) {
-    std::ifstream file(m_filepath.GetCString(), std::ios::binary | std::ios::ate);
-    if (!file)
+    std::vector<char> buffer;
+    if (!ReadFile(buffer))
       return false;
 
-    std::streamsize size = file.tellg();
-    file.seekg(0, std::ios::beg);
-
-    std::vector<char> buffer(size);
-    if (!file.read(buffer.data(), size))
+    if (std::memchr(buffer.data(), '\0', buffer.size()) != nullptr)
       return false;
 
+    buffer.push_back('\0');
     a_data.Clear();
     a_data.Append(buffer.data());
     return true;
   }
 
+  bool File::ReadFile(std::vector<char>& a_data) {
+    std::ifstream file(m_filepath.GetCString(), std::ios::binary | std::ios::ate);
+    if (!file)
+      return false;
+
+    std::streamsize size = file.tellg();
+    if (size < 0)
+      return false;
+    file.seekg(0, std::ios::beg);
+
+    a_data.resize(static_cast<size_t>(size));
+    return static_cast<bool>(file.read(a_data.data(), size));
+  }
+
   bool File::WriteFile(ntl::Array<ntl::String>& a_data) {
     std::ofstream file(m_filepath.GetCString(), std::ios::binary | std::ios::out | std::ios::app);
     if (!file)
@@ -48,4 +70,221 @@ namespace atlas {
     file.close();
     return true;
   }
+
+  LogSink::LogSink(const ntl::String& a_path, const Options& a_options)
+    : m_path{a_path}, m_options{a_options}, m_fd{-1}, m_size{0},
+      m_buffer{static_cast<char*>(std::aligned_alloc(DIRECT_ALIGNMENT, BUFFER_SIZE))}, m_buffered{0},
+      m_direct{false}, m_lock{} {
+  }
+
+  LogSink::~LogSink() {
+    Close();
+    std::free(m_buffer);
+  }
+
+  bool LogSink::Open(bool a_truncate) {
+    ntl::ScopeLock lock(&m_lock);
+    if (a_truncate) {
+      closeLocked();
+    }
+    return openLocked(a_truncate);
+  }
+
+  bool LogSink::Write(const char* a_data, ntl::Size a_size) {
+    ntl::ScopeLock lock(&m_lock);
+    if (m_fd < 0 && !openLocked(false))
+      return false;
+
+    uint64_t pending = m_size + m_buffered;
+    if (m_options.max_size > 0 && pending > 0 && pending + a_size > m_options.max_size) {
+      if (!rotateLocked())
+        return false;
+    }
+
+    while (a_size > 0) {
+      ntl::Size chunk = std::min(a_size, BUFFER_SIZE - m_buffered);
+      std::memcpy(m_buffer + m_buffered, a_data, chunk);
+      m_buffered += chunk;
+      a_data += chunk;
+      a_size -= chunk;
+
+      if (m_buffered == BUFFER_SIZE && !flushLocked(false))
+        return false;
+    }
+    return true;
+  }
+
+  bool LogSink::Write(const ntl::String& a_data) {
+    return Write(a_data.GetCString(), a_data.GetSize());
+  }
+
+  bool LogSink::Flush(bool a_complete) {
+    ntl::ScopeLock lock(&m_lock);
+    return flushLocked(a_complete);
+  }
+
+  void LogSink::Close() {
+    ntl::ScopeLock lock(&m_lock);
+    closeLocked();
+  }
+
+  void LogSink::SetOptions(const Options& a_options) {
+    ntl::ScopeLock lock(&m_lock);
+    m_options = a_options;
+  }
+
+  bool LogSink::ParseSyncPolicy(const std::string& a_name, SyncPolicy& a_policy) {
+    if (a_name == "none") {
+      a_policy = SyncPolicy::NONE;
+    } else if (a_name == "fdatasync") {
+      a_policy = SyncPolicy::DATA_SYNC;
+    } else if (a_name == "direct") {
+      a_policy = SyncPolicy::DIRECT;
+    } else {
+      return false;
+    }
+    return true;
+  }
+
+  bool LogSink::openLocked(bool a_truncate) {
+    if (m_fd >= 0)
+      return true;
+
+    std::error_code error;
+    std::filesystem::path path{m_path.GetCString()};
+    if (path.has_parent_path()) {
+      std::filesystem::create_directories(path.parent_path(), error);
+    }
+
+    // Direct mode reads the partial last block back, see below
+    int flags = (m_options.sync == SyncPolicy::DIRECT ? O_RDWR : O_WRONLY) | O_CREAT | O_APPEND | O_CLOEXEC |
+                (a_truncate ? O_TRUNC : 0);
+    m_fd = open(m_path.GetCString(), flags, 0644);
+    if (m_fd < 0)
+      return false;
+
+    struct stat status{};
+    m_size = fstat(m_fd, &status) == 0 ? static_cast<uint64_t>(status.st_size) : 0;
+    m_direct = false;
+
+#ifdef O_DIRECT
+    // Direct writes need block aligned offsets, a partial last block is loaded into the buffer and written again
+    // as a whole with the next data. Writes go to explicit offsets, so appending is turned off
+    if (m_options.sync == SyncPolicy::DIRECT && m_buffered == 0) {
+      ntl::Size tail = m_size % DIRECT_ALIGNMENT;
+      off_t offset = static_cast<off_t>(m_size - tail);
+      if (tail == 0 || pread(m_fd, m_buffer, tail, offset) == static_cast<ssize_t>(tail)) {
+        m_direct = fcntl(m_fd, F_SETFL, (fcntl(m_fd, F_GETFL) | O_DIRECT) & ~O_APPEND) == 0;
+      }
+      if (m_direct) {
+        m_size -= tail;
+        m_buffered = tail;
+      }
+    }
+#endif
+
+    return true;
+  }
+
+  bool LogSink::flushLocked(bool a_final) {
+    if (m_fd < 0 || m_buffered == 0)
+      return m_buffered == 0;
+
+#ifdef O_DIRECT
+    if (m_direct)
+      return flushDirectLocked(a_final);
+#endif
+
+    ntl::Size length = m_buffered;
+
+    ntl::Size written = 0;
+    bool success = true;
+    while (written < length) {
+      ssize_t result = write(m_fd, m_buffer + written, length - written);
+      if (result < 0) {
+        if (errno == EINTR)
+          continue;
+        success = false;
+        break;
+      }
+      written += static_cast<ntl::Size>(result);
+    }
+
+    // On failure the data is dropped, a log that cannot be written must not grow the buffer forever
+    ntl::Size consumed = success ? length : m_buffered;
+    m_size += written;
+    std::memmove(m_buffer, m_buffer + consumed, m_buffered - consumed);
+    m_buffered -= consumed;
+
+    if (success && written > 0 && m_options.sync == SyncPolicy::DATA_SYNC) {
+#ifdef __APPLE__
+      success = fsync(m_fd) == 0;
+#else
+      success = fdatasync(m_fd) == 0;
+#endif
+    }
+    return success;
+  }
+
+  bool LogSink::flushDirectLocked(bool a_final) {
+    // The partial last block is written padded to a whole block and the file cut back to its real size. It stays
+    // in the buffer, so the next flush rewrites the block together with what follows it
+    ntl::Size aligned = m_buffered - m_buffered % DIRECT_ALIGNMENT;
+    ntl::Size length = aligned + (a_final && aligned < m_buffered ? DIRECT_ALIGNMENT : 0);
+    if (length == 0)
+      return true;
+    std::memset(m_buffer + m_buffered, 0, length - std::min(length, m_buffered));
+
+    ntl::Size written = 0;
+    bool success = true;
+    while (written < length) {
+      ssize_t result = pwrite(m_fd, m_buffer + written, length - written, static_cast<off_t>(m_size + written));
+      if (result < 0) {
+        if (errno == EINTR)
+          continue;
+        success = false;
+        break;
+      }
+      written += static_cast<ntl::Size>(result);
+    }
+    if (success && length > aligned) {
+      success = ftruncate(m_fd, static_cast<off_t>(m_size + m_buffered)) == 0;
+    }
+
+    // On failure the data is dropped, a log that cannot be written must not grow the buffer forever
+    if (!success) {
+      m_buffered = 0;
+      return false;
+    }
+    m_size += aligned;
+    std::memmove(m_buffer, m_buffer + aligned, m_buffered - aligned);
+    m_buffered -= aligned;
+    return true;
+  }
+
+  void LogSink::closeLocked() {
+    if (m_fd < 0)
+      return;
+
+    // A direct partial block is in the file already, the next open reads it back
+    flushLocked(true);
+    m_buffered = 0;
+    close(m_fd);
+    m_fd = -1;
+  }
+
+  bool LogSink::rotateLocked() {
+    closeLocked();
+
+    if (m_options.max_files > 0) {
+      std::error_code error;
+      std::string base = m_path.GetCString();
+      for (ntl::Size i = m_options.max_files - 1; i > 0; --i) {
+        std::filesystem::rename(base + "." + std::to_string(i), base + "." + std::to_string(i + 1), error);
+      }
+      std::filesystem::rename(base, base + ".1", error);
+    }
+
+    return openLocked(true);
+  }
 }
@@ -8,10 +8,13 @@
 #ifndef ATLAS_FILE_HPP
 #define ATLAS_FILE_HPP
 
+#include <cstdint>
 #include <fstream>
+#include <vector>
 
 #include "data/Array.hpp"
 #include "data/String.hpp"
+#include "os/Lock.hpp"
 
 namespace atlas {
   /**
@@ -38,10 +41,19 @@ namespace atlas {
 
     /**
      * @brief Reads the data of the file to the given string.
+     *
+     * A string ends at its first NUL byte, so files containing one are rejected instead of being cut short.
+     *
      * @param a_data the string to store the data in
      * @return if reading the file was successful
      */
     bool ReadFile(ntl::String& a_data);
+    /**
+     * @brief Reads the raw bytes of the file.
+     * @param a_data the buffer to store the data in
+     * @return if reading the file was successful
+     */
+    bool ReadFile(std::vector<char>& a_data);
     /**
      * @brief Writes the data from the given array to the file.
      * @param a_data the array of strings where the data is stored
@@ -54,6 +66,136 @@ namespace atlas {
      */
     bool ResetFile();
   };
+
+  /**
+   * @brief LogSink class appending to a log file through a descriptor that stays open.
+   *
+   * Writes are collected in a user-space buffer and reach the file when it is full or on Flush(), so a stream of
+   * short lines costs neither an open/close nor a system call per line. Once the file would grow beyond the
+   * configured size it is rotated to <path>.1, <path>.2, ..., keeping the configured number of old files. A
+   * single write is never split across two files. All methods may be called from several threads.
+   */
+  class LogSink {
+  public:
+    /**
+     * @brief How hard the sink pushes written data to the disk.
+     */
+    enum class SyncPolicy {
+      NONE,      ///< Leave it to the page cache
+      DATA_SYNC, ///< fdatasync after every flush
+      DIRECT     ///< Bypass the page cache with O_DIRECT, a partial block stays buffered until close or Flush(true)
+    };
+
+    /**
+     * @struct Options
+     * @brief Rotation and durability settings.
+     */
+    struct Options {
+      uint64_t max_size;
+      ntl::Size max_files;
+      SyncPolicy sync;
+    };
+
+    static constexpr ntl::Size BUFFER_SIZE = 64 * 1024;
+    static constexpr ntl::Size DIRECT_ALIGNMENT = 4096;
+
+  private:
+    ntl::String m_path;
+    Options m_options;
+    int m_fd;
+    uint64_t m_size;
+    char* m_buffer;
+    ntl::Size m_buffered;
+    bool m_direct;
+    ntl::Lock m_lock;
+
+  public:
+    /**
+     * @brief Constructs a sink for the given file without opening it yet.
+     * @param a_path the file to append to
+     * @param a_options the rotation and durability settings, no rotation by default
+     */
+    explicit LogSink(const ntl::String& a_path, const Options& a_options = {0, 0, SyncPolicy::NONE});
+    /**
+     * @brief Destructor, flushes and closes the file.
+     */
+    ~LogSink();
+
+    LogSink(const LogSink&) = delete;
+    LogSink& operator=(const LogSink&) = delete;
+
+    /**
+     * @brief Opens the file, creating it and its directory if needed. Writing opens it on demand as well.
+     * @param a_truncate if existing content should be discarded
+     * @return if the file could be opened
+     */
+    bool Open(bool a_truncate = false);
+    /**
+     * @brief Appends data, rotating the file first if the data would exceed the size limit.
+     * @param a_data the data to append
+     * @param a_size the size of the data in bytes
+     * @return if the data was accepted
+     */
+    bool Write(const char* a_data, ntl::Size a_size);
+    /**
+     * @brief Appends a string.
+     * @param a_data the string to append
+     * @return if the string was accepted
+     */
+    bool Write(const ntl::String& a_data);
+    /**
+     * @brief Writes the buffered data to the file and applies the sync policy.
+     *
+     * Under SyncPolicy::DIRECT only whole blocks are written unless the flush is complete, which writes the
+     * partial block padded to a whole one and cuts the file back to its size. Direct mode stays on, the next
+     * flush rewrites that block.
+     *
+     * @param a_complete if the partial block has to reach the file too
+     * @return if writing was successful
+     */
+    bool Flush(bool a_complete = false);
+    /**
+     * @brief Flushes and closes the file, the next write opens it again.
+     */
+    void Close();
+    /**
+     * @brief Replaces the rotation and durability settings, the sync policy takes effect on the next open.
+     * @param a_options the new settings
+     */
+    void SetOptions(const Options& a_options);
+
+    /**
+     * @brief Parses a sync policy name as used in the configuration.
+     * @param a_name one of "none", "fdatasync" or "direct"
+     * @param a_policy receives the parsed policy
+     * @return if the name is known
+     */
+    static bool ParseSyncPolicy(const std::string& a_name, SyncPolicy& a_policy);
+
+  private:
+    /**
+     * @brief Opens the file, the lock must be held.
+     */
+    bool openLocked(bool a_truncate);
+    /**
+     * @brief Writes the buffer to the file, the lock must be held.
+     * @param a_final if a partial block may be written in direct mode
+     */
+    bool flushLocked(bool a_final);
+    /**
+     * @brief Writes the buffer to the file in direct mode, the lock must be held.
+     * @param a_final if the partial block has to be written as well
+     */
+    bool flushDirectLocked(bool a_final);
+    /**
+     * @brief Closes the file, the lock must be held.
+     */
+    void closeLocked();
+    /**
+     * @brief Shifts the old files up by one and starts a new file, the lock must be held.
+     */
+    bool rotateLocked();
+  };
 }
 
 #endif // ATLAS_FILE_HPP
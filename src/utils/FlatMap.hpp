@@ -0,0 +1,540 @@
+/**
+* @file FlatMap.hpp
+* @author Marcus Gugacs
+* @date 16.10.26
+* @copyright Copyright (c) 2026 Marcus Gugacs. All rights reserved.
+*/
+
+#ifndef ATLAS_FLAT_MAP_HPP
+#define ATLAS_FLAT_MAP_HPP
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include <data/String.hpp>
+
+namespace atlas {
+  /**
+   * @brief Returns the characters of a string key, so maps keyed by owned strings can be searched by views.
+   */
+  inline std::string_view GetKeyView(std::string_view a_key) { return a_key; }
+  inline std::string_view GetKeyView(const char* a_key) { return a_key; }
+  inline std::string_view GetKeyView(const std::string& a_key) { return a_key; }
+  inline std::string_view GetKeyView(const ntl::String& a_key) { return {a_key.GetCString(), a_key.GetSize()}; }
+
+  /**
+   * @brief Hashes a string eight bytes at a time, the final mix spreads every byte over all 64 bits.
+   *
+   * The last word overlaps the previous one instead of being assembled byte by byte, which keeps the number of
+   * branches low for the short keys the maps hold.
+   *
+   * @param a_string String to hash
+   * @return The hash
+   */
+  inline uint64_t HashString(std::string_view a_string) {
+    constexpr uint64_t MULTIPLIER = 0x9e3779b97f4a7c15ull;
+    const char* data = a_string.data();
+    size_t size = a_string.size();
+    uint64_t hash = size * MULTIPLIER;
+
+    auto mix = [&hash](uint64_t a_word) {
+      hash = (hash ^ a_word) * MULTIPLIER;
+      hash ^= hash >> 32;
+    };
+    auto load64 = [](const char* a_data) {
+      uint64_t word;
+      std::memcpy(&word, a_data, sizeof(word));
+      return word;
+    };
+    auto load32 = [](const char* a_data) {
+      uint32_t word;
+      std::memcpy(&word, a_data, sizeof(word));
+      return static_cast<uint64_t>(word);
+    };
+
+    if (size >= 8) {
+      for (; size > 8; data += 8, size -= 8) {
+        mix(load64(data));
+      }
+      mix(load64(data + size - 8));
+    } else if (size >= 4) {
+      mix(load32(data) << 32 | load32(data + size - 4));
+    } else if (size > 0) {
+      auto byte = [data](size_t a_index) { return static_cast<uint64_t>(static_cast<unsigned char>(data[a_index])); };
+      mix(byte(0) << 16 | byte(size / 2) << 8 | byte(size - 1));
+    }
+
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdull;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ull;
+    hash ^= hash >> 33;
+    return hash;
+  }
+
+  /**
+   * @brief Open addressing hash map with string keys in the style of a Swiss table.
+   *
+   * Entries are stored in the slots themselves, next to a separate array of one control byte per slot. A
+   * control byte is empty, deleted or the low seven bits of the key's hash, so a probe compares a group of 16
+   * control bytes at once (with SSE2 where available) and only looks at entries whose bits match. The first
+   * group of control bytes is mirrored behind the table, which lets a group starting near the end be read in one
+   * go. Keys can be looked up by std::string_view without building a key, and callers that look up and then add
+   * the same key can hash it once and pass the hash to both.
+   *
+   * Iteration follows the slots, not the insertion order. Removed keys leave a tombstone until the next rehash.
+   */
+  template<typename Key, typename Value>
+  class FlatMap {
+  public:
+    using Entry = std::pair<Key, Value>;
+
+    static constexpr size_t GROUP_WIDTH = 16;
+
+  private:
+    static constexpr int8_t EMPTY = -128;
+    static constexpr int8_t DELETED = -2;
+    static constexpr size_t NONE = SIZE_MAX;
+
+    /**
+     * @brief Iterator over the occupied slots.
+     */
+    template<typename Map, typename Item>
+    class BasicIterator {
+    private:
+      Map* m_map;
+      size_t m_slot;
+
+    public:
+      BasicIterator(Map* a_map, size_t a_slot) : m_map{a_map}, m_slot{a_slot} { skip(); }
+
+      Item& operator*() const { return m_map->m_slots[m_slot]; }
+      Item* operator->() const { return &m_map->m_slots[m_slot]; }
+
+      BasicIterator& operator++() {
+        ++m_slot;
+        skip();
+        return *this;
+      }
+
+      bool operator==(const BasicIterator& a_other) const { return m_slot == a_other.m_slot; }
+      bool operator!=(const BasicIterator& a_other) const { return m_slot != a_other.m_slot; }
+
+    private:
+      void skip() {
+        while (m_slot < m_map->m_capacity && m_map->m_control[m_slot] < 0) {
+          ++m_slot;
+        }
+      }
+    };
+
+    int8_t* m_control;
+    Entry* m_slots;
+    size_t m_capacity;
+    size_t m_size;
+    size_t m_growth_left;
+
+  public:
+    using Iterator = BasicIterator<FlatMap, Entry>;
+    using ConstIterator = BasicIterator<const FlatMap, const Entry>;
+
+    /**
+     * @brief Default Constructor, creates an empty map without allocating.
+     */
+    FlatMap() : m_control{nullptr}, m_slots{nullptr}, m_capacity{0}, m_size{0}, m_growth_left{0} {}
+
+    FlatMap(const FlatMap&) = delete;
+    FlatMap& operator=(const FlatMap&) = delete;
+
+    /**
+     * @brief Move Constructor.
+     * @param a_other the map to take the entries from
+     */
+    FlatMap(FlatMap&& a_other) noexcept : FlatMap{} { swap(a_other); }
+
+    /**
+     * @brief Move Assignment.
+     * @param a_other the map to take the entries from
+     * @return this map
+     */
+    FlatMap& operator=(FlatMap&& a_other) noexcept {
+      FlatMap other{std::move(a_other)};
+      swap(other);
+      return *this;
+    }
+
+    /**
+     * @brief Destructor.
+     */
+    ~FlatMap() { release(); }
+
+    /**
+     * @brief Hashes a key the way the map does.
+     * @param a_key the key
+     * @return the hash to pass to Find and Insert
+     */
+    static uint64_t Hash(std::string_view a_key) { return HashString(a_key); }
+
+    /**
+     * @brief Looks up a key.
+     * @param a_key the key, any string type GetKeyView accepts
+     * @return the value or nullptr if the key is not in the map
+     */
+    template<typename Lookup>
+    Value* Find(const Lookup& a_key) {
+      std::string_view key = GetKeyView(a_key);
+      return Find(key, Hash(key));
+    }
+
+    template<typename Lookup>
+    const Value* Find(const Lookup& a_key) const {
+      std::string_view key = GetKeyView(a_key);
+      return Find(key, Hash(key));
+    }
+
+    /**
+     * @brief Looks up a key with a hash computed by Hash.
+     * @param a_key the key
+     * @param a_hash the hash of the key
+     * @return the value or nullptr if the key is not in the map
+     */
+    Value* Find(std::string_view a_key, uint64_t a_hash) {
+      size_t slot = findSlot(a_key, a_hash);
+      return slot == NONE ? nullptr : &m_slots[slot].second;
+    }
+
+    const Value* Find(std::string_view a_key, uint64_t a_hash) const {
+      size_t slot = findSlot(a_key, a_hash);
+      return slot == NONE ? nullptr : &m_slots[slot].second;
+    }
+
+    /**
+     * @brief Checks whether a key is in the map.
+     * @param a_key the key, any string type GetKeyView accepts
+     * @return if the key is in the map
+     */
+    template<typename Lookup>
+    bool Contains(const Lookup& a_key) const { return Find(a_key) != nullptr; }
+
+    /**
+     * @brief Adds a key unless it is already in the map.
+     * @param a_key the key
+     * @param a_value the value to add
+     * @return the value in the map and whether it was added
+     */
+    std::pair<Value*, bool> Insert(Key a_key, Value a_value) {
+      uint64_t hash = Hash(GetKeyView(a_key));
+      return Insert(std::move(a_key), std::move(a_value), hash);
+    }
+
+    /**
+     * @brief Adds a key with a hash computed by Hash unless it is already in the map.
+     * @param a_key the key
+     * @param a_value the value to add
+     * @param a_hash the hash of the key
+     * @return the value in the map and whether it was added
+     */
+    std::pair<Value*, bool> Insert(Key a_key, Value a_value, uint64_t a_hash) {
+      size_t slot = findSlot(GetKeyView(a_key), a_hash);
+      if (slot != NONE)
+        return {&m_slots[slot].second, false};
+      return {&add(std::move(a_key), std::move(a_value), a_hash), true};
+    }
+
+    /**
+     * @brief Returns the value of a key, adding a default constructed value if it is not in the map.
+     * @param a_key the key
+     * @return the value
+     */
+    Value& operator[](const Key& a_key) {
+      uint64_t hash = Hash(GetKeyView(a_key));
+      if (Value* value = Find(GetKeyView(a_key), hash))
+        return *value;
+      return add(a_key, Value{}, hash);
+    }
+
+    /**
+     * @brief Removes a key.
+     * @param a_key the key, any string type GetKeyView accepts
+     * @return if the key was in the map
+     */
+    template<typename Lookup>
+    bool Remove(const Lookup& a_key) {
+      std::string_view key = GetKeyView(a_key);
+      size_t slot = findSlot(key, Hash(key));
+      if (slot == NONE)
+        return false;
+
+      std::destroy_at(&m_slots[slot]);
+      setControl(slot, DELETED);
+      --m_size;
+      return true;
+    }
+
+    /**
+     * @brief Makes room for the given number of entries without growing again.
+     * @param a_count the number of entries
+     */
+    void Reserve(size_t a_count) {
+      if (a_count > m_size + m_growth_left)
+        rehash(capacityFor(a_count));
+    }
+
+    /**
+     * @brief Removes every entry, keeping the memory for the next ones.
+     */
+    void Clear() {
+      if (m_capacity == 0)
+        return;
+
+      for (size_t slot = 0; slot < m_capacity; ++slot) {
+        if (m_control[slot] >= 0)
+          std::destroy_at(&m_slots[slot]);
+      }
+      std::fill(m_control, m_control + m_capacity + GROUP_WIDTH, EMPTY);
+      m_size = 0;
+      m_growth_left = maxLoad(m_capacity);
+    }
+
+    /**
+     * @brief Returns the number of entries.
+     * @return the size of the map
+     */
+    size_t GetSize() const { return m_size; }
+
+    /**
+     * @brief Checks whether the map has no entries.
+     * @return if the map is empty
+     */
+    bool IsEmpty() const { return m_size == 0; }
+
+    /**
+     * @brief Returns the number of bytes the map occupies, not counting memory owned by keys and values.
+     * @return the size of the slots and control bytes
+     */
+    size_t GetMemoryUsage() const {
+      return m_capacity == 0 ? 0 : m_capacity * (sizeof(Entry) + 1) + GROUP_WIDTH;
+    }
+
+    Iterator begin() { return {this, 0}; }
+    Iterator end() { return {this, m_capacity}; }
+    ConstIterator begin() const { return {this, 0}; }
+    ConstIterator end() const { return {this, m_capacity}; }
+
+  private:
+    /**
+     * @brief Returns the slots of a group whose control byte equals the given one.
+     * @param a_group the first control byte of the group
+     * @param a_byte the byte to look for
+     * @return a mask with bit i set if slot i of the group matches
+     */
+    static uint32_t match(const int8_t* a_group, int8_t a_byte) {
+#ifdef __SSE2__
+      __m128i group = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a_group));
+      return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(a_byte))));
+#else
+      uint32_t mask = 0;
+      for (size_t i = 0; i < GROUP_WIDTH; ++i) {
+        mask |= static_cast<uint32_t>(a_group[i] == a_byte) << i;
+      }
+      return mask;
+#endif
+    }
+
+    /**
+     * @brief Returns the slots of a group that are empty or deleted, both have the sign bit set.
+     * @param a_group the first control byte of the group
+     * @return a mask with bit i set if slot i of the group is free
+     */
+    static uint32_t matchFree(const int8_t* a_group) {
+#ifdef __SSE2__
+      return static_cast<uint32_t>(_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a_group))));
+#else
+      uint32_t mask = 0;
+      for (size_t i = 0; i < GROUP_WIDTH; ++i) {
+        mask |= static_cast<uint32_t>(a_group[i] < 0) << i;
+      }
+      return mask;
+#endif
+    }
+
+    /**
+     * @brief Returns the control byte of a hash, the bits not used for the position.
+     * @param a_hash the hash
+     * @return the control byte
+     */
+    static int8_t tag(uint64_t a_hash) { return static_cast<int8_t>(a_hash & 0x7f); }
+
+    /**
+     * @brief Returns how many entries a table can take before it grows, keeping the load at 7/8.
+     * @param a_capacity the number of slots
+     * @return the maximum number of entries
+     */
+    static size_t maxLoad(size_t a_capacity) { return a_capacity - a_capacity / 8; }
+
+    /**
+     * @brief Returns the smallest capacity holding the given number of entries.
+     * @param a_count the number of entries
+     * @return a power of two of at least GROUP_WIDTH
+     */
+    static size_t capacityFor(size_t a_count) {
+      size_t capacity = GROUP_WIDTH;
+      while (maxLoad(capacity) < a_count) {
+        capacity *= 2;
+      }
+      return capacity;
+    }
+
+    /**
+     * @brief Looks up the slot of a key.
+     * @param a_key the key
+     * @param a_hash the hash of the key
+     * @return the slot or NONE
+     */
+    size_t findSlot(std::string_view a_key, uint64_t a_hash) const {
+      if (m_capacity == 0)
+        return NONE;
+
+      // Probing moves by whole groups with growing steps, which visits every group of a power of two table
+      size_t mask = m_capacity - 1;
+      size_t position = (a_hash >> 7) & mask;
+      int8_t byte = tag(a_hash);
+      for (size_t step = GROUP_WIDTH;; step += GROUP_WIDTH) {
+        const int8_t* group = m_control + position;
+        for (uint32_t matches = match(group, byte); matches != 0; matches &= matches - 1) {
+          size_t slot = (position + std::countr_zero(matches)) & mask;
+          if (GetKeyView(m_slots[slot].first) == a_key)
+            return slot;
+        }
+        if (match(group, EMPTY) != 0)
+          return NONE;
+        position = (position + step) & mask;
+      }
+    }
+
+    /**
+     * @brief Returns the first free slot in the probe sequence of a hash.
+     * @param a_hash the hash
+     * @return the slot
+     */
+    size_t findFree(uint64_t a_hash) const {
+      size_t mask = m_capacity - 1;
+      size_t position = (a_hash >> 7) & mask;
+      for (size_t step = GROUP_WIDTH;; step += GROUP_WIDTH) {
+        if (uint32_t free = matchFree(m_control + position))
+          return (position + std::countr_zero(free)) & mask;
+        position = (position + step) & mask;
+      }
+    }
+
+    /**
+     * @brief Sets the control byte of a slot and its mirror.
+     * @param a_slot the slot
+     * @param a_byte the control byte
+     */
+    void setControl(size_t a_slot, int8_t a_byte) {
+      m_control[a_slot] = a_byte;
+      if (a_slot < GROUP_WIDTH)
+        m_control[m_capacity + a_slot] = a_byte;
+    }
+
+    /**
+     * @brief Adds an entry for a key that is not in the map, growing the table first if it is full.
+     * @param a_key the key
+     * @param a_value the value
+     * @param a_hash the hash of the key
+     * @return the added value
+     */
+    Value& add(Key a_key, Value a_value, uint64_t a_hash) {
+      size_t slot = m_capacity == 0 ? NONE : findFree(a_hash);
+      if (slot == NONE || (m_growth_left == 0 && m_control[slot] == EMPTY)) {
+        // Tombstones are dropped by rehashing, the table only grows if the live entries need it
+        rehash(capacityFor(m_size + 1));
+        slot = findFree(a_hash);
+      }
+
+      if (m_control[slot] == EMPTY)
+        --m_growth_left;
+      std::construct_at(&m_slots[slot], std::move(a_key), std::move(a_value));
+      setControl(slot, tag(a_hash));
+      ++m_size;
+      return m_slots[slot].second;
+    }
+
+    /**
+     * @brief Moves every entry into a new table with the given capacity.
+     * @param a_capacity the number of slots, a power of two of at least GROUP_WIDTH
+     */
+    void rehash(size_t a_capacity) {
+      int8_t* control = m_control;
+      Entry* slots = m_slots;
+      size_t capacity = m_capacity;
+
+      m_capacity = std::max(a_capacity, capacityFor(m_size));
+      m_control = new int8_t[m_capacity + GROUP_WIDTH];
+      m_slots = std::allocator<Entry>().allocate(m_capacity);
+      std::fill(m_control, m_control + m_capacity + GROUP_WIDTH, EMPTY);
+      m_growth_left = maxLoad(m_capacity) - m_size;
+
+      for (size_t i = 0; i < capacity; ++i) {
+        if (control[i] < 0)
+          continue;
+
+        uint64_t hash = Hash(GetKeyView(slots[i].first));
+        size_t slot = findFree(hash);
+        std::construct_at(&m_slots[slot], std::move(slots[i]));
+        std::destroy_at(&slots[i]);
+        setControl(slot, tag(hash));
+      }
+
+      if (capacity != 0) {
+        delete[] control;
+        std::allocator<Entry>().deallocate(slots, capacity);
+      }
+    }
+
+    /**
+     * @brief Destroys every entry and frees the table.
+     */
+    void release() {
+      if (m_capacity == 0)
+        return;
+
+      for (size_t slot = 0; slot < m_capacity; ++slot) {
+        if (m_control[slot] >= 0)
+          std::destroy_at(&m_slots[slot]);
+      }
+      delete[] m_control;
+      std::allocator<Entry>().deallocate(m_slots, m_capacity);
+      m_control = nullptr;
+      m_slots = nullptr;
+      m_capacity = 0;
+      m_size = 0;
+      m_growth_left = 0;
+    }
+
+    /**
+     * @brief Exchanges the contents with another map.
+     * @param a_other the other map
+     */
+    void swap(FlatMap& a_other) noexcept {
+      std::swap(m_control, a_other.m_control);
+      std::swap(m_slots, a_other.m_slots);
+      std::swap(m_capacity, a_other.m_capacity);
+      std::swap(m_size, a_other.m_size);
+      std::swap(m_growth_left, a_other.m_growth_left);
+    }
+  };
+}
+
+#endif // ATLAS_FLAT_MAP_HPP
@@ -0,0 +1,156 @@
+/**
+* @file Job.hpp
+* @author Marcus Gugacs
+* @date 16.10.26
+* @copyright Copyright (c) 2026 Marcus Gugacs. All rights reserved.
+*/
+
+#ifndef ATLAS_JOB_HPP
+#define ATLAS_JOB_HPP
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace atlas {
+  /**
+   * @brief Job class holding a move-only callable without a return value.
+   *
+   * Callables up to INLINE_SIZE bytes are stored inside the job itself, which covers the usual lambda capturing
+   * a pointer and a few values. Larger callables are moved to the heap. Unlike std::function the callable is
+   * never copied.
+   */
+  class Job {
+  public:
+    static constexpr size_t INLINE_SIZE = 56;
+
+  private:
+    /**
+     * @struct Operations
+     * @brief Type erased operations of the stored callable.
+     */
+    struct Operations {
+      void (*invoke)(void*);
+      void (*move)(void*, void*);
+      void (*destroy)(void*);
+    };
+
+    template<typename Function>
+    static constexpr bool STORED_INLINE = sizeof(Function) <= INLINE_SIZE &&
+                                          alignof(Function) <= alignof(std::max_align_t) &&
+                                          std::is_nothrow_move_constructible_v<Function>;
+
+    template<typename Function>
+    struct InlineOperations {
+      static void invoke(void* a_storage) { (*static_cast<Function*>(a_storage))(); }
+
+      static void move(void* a_target, void* a_source) {
+        new (a_target) Function(std::move(*static_cast<Function*>(a_source)));
+        static_cast<Function*>(a_source)->~Function();
+      }
+
+      static void destroy(void* a_storage) { static_cast<Function*>(a_storage)->~Function(); }
+
+      static constexpr Operations OPERATIONS{invoke, move, destroy};
+    };
+
+    template<typename Function>
+    struct HeapOperations {
+      static void invoke(void* a_storage) { (**static_cast<Function**>(a_storage))(); }
+
+      static void move(void* a_target, void* a_source) {
+        *static_cast<Function**>(a_target) = *static_cast<Function**>(a_source);
+      }
+
+      static void destroy(void* a_storage) { delete *static_cast<Function**>(a_storage); }
+
+      static constexpr Operations OPERATIONS{invoke, move, destroy};
+    };
+
+    alignas(std::max_align_t) unsigned char m_storage[INLINE_SIZE];
+    const Operations* m_operations;
+
+  public:
+    /**
+     * @brief Default Constructor, creating an empty job.
+     */
+    Job() : m_storage{}, m_operations{nullptr} {}
+
+    /**
+     * @brief Constructor taking ownership of a callable.
+     * @param a_function the callable to run
+     */
+    template<typename Function, typename = std::enable_if_t<!std::is_same_v<std::decay_t<Function>, Job>>>
+    Job(Function&& a_function) : m_operations{nullptr} {
+      using Stored = std::decay_t<Function>;
+      if constexpr (STORED_INLINE<Stored>) {
+        new (m_storage) Stored(std::forward<Function>(a_function));
+        m_operations = &InlineOperations<Stored>::OPERATIONS;
+      } else {
+        *reinterpret_cast<Stored**>(m_storage) = new Stored(std::forward<Function>(a_function));
+        m_operations = &HeapOperations<Stored>::OPERATIONS;
+      }
+    }
+
+    Job(const Job&) = delete;
+    Job& operator=(const Job&) = delete;
+
+    /**
+     * @brief Move Constructor.
+     * @param a_other the job to take the callable from
+     */
+    Job(Job&& a_other) noexcept : m_operations{a_other.m_operations} {
+      if (m_operations) {
+        m_operations->move(m_storage, a_other.m_storage);
+        a_other.m_operations = nullptr;
+      }
+    }
+
+    /**
+     * @brief Move Assignment.
+     * @param a_other the job to take the callable from
+     * @return this job
+     */
+    Job& operator=(Job&& a_other) noexcept {
+      if (this != &a_other) {
+        reset();
+        m_operations = a_other.m_operations;
+        if (m_operations) {
+          m_operations->move(m_storage, a_other.m_storage);
+          a_other.m_operations = nullptr;
+        }
+      }
+      return *this;
+    }
+
+    /**
+     * @brief Destructor.
+     */
+    ~Job() { reset(); }
+
+    /**
+     * @brief Runs the callable.
+     */
+    void operator()() { m_operations->invoke(m_storage); }
+
+    /**
+     * @brief Checks whether the job holds a callable.
+     * @return if the job can be run
+     */
+    explicit operator bool() const { return m_operations != nullptr; }
+
+  private:
+    /**
+     * @brief Destroys the stored callable.
+     */
+    void reset() {
+      if (m_operations) {
+        m_operations->destroy(m_storage);
+        m_operations = nullptr;
+      }
+    }
+  };
+}
+
+#endif // ATLAS_JOB_HPP
@@ -0,0 +1,105 @@
+/**
+* @file JobPool.hpp
+* @author Marcus Gugacs
+* @date 16.10.26
+* @copyright Copyright (c) 2026 Marcus Gugacs. All rights reserved.
+*/
+
+#ifndef ATLAS_JOB_POOL_HPP
+#define ATLAS_JOB_POOL_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "Job.hpp"
+
+namespace atlas {
+  /**
+   * @brief Pool of job slots, so that queued jobs are not allocated one by one.
+   *
+   * Only one thread at a time acquires slots, which come from a private free list. Slots are released by
+   * whichever thread ran the job onto a lock-free stack, and the acquiring side takes the whole stack at once
+   * when its free list runs dry. Slots are allocated in chunks and only freed with the pool.
+   */
+  class JobPool {
+  public:
+    /**
+     * @struct Slot
+     * @brief A job and the pool it is returned to.
+     */
+    struct Slot {
+      Job job;
+      Slot* next;
+      JobPool* pool;
+    };
+
+  private:
+    static constexpr size_t CHUNK_SIZE = 256;
+
+    Slot* m_free;
+    std::atomic<Slot*> m_released;
+    std::vector<std::unique_ptr<Slot[]>> m_chunks;
+
+  public:
+    /**
+     * @brief Default Constructor.
+     */
+    JobPool() : m_free{nullptr}, m_released{nullptr}, m_chunks{} {}
+
+    JobPool(const JobPool&) = delete;
+    JobPool& operator=(const JobPool&) = delete;
+
+    /**
+     * @brief Moves a job into a free slot, only called by one thread at a time.
+     * @param a_job the job to store
+     * @return the slot holding the job
+     */
+    Slot* Acquire(Job&& a_job) {
+      if (!m_free) {
+        m_free = m_released.exchange(nullptr, std::memory_order_acquire);
+      }
+      if (!m_free) {
+        allocate();
+      }
+
+      Slot* slot = m_free;
+      m_free = slot->next;
+      slot->job = std::move(a_job);
+      return slot;
+    }
+
+    /**
+     * @brief Destroys the job of a slot and returns the slot to its pool, may be called by any thread.
+     * @param a_slot the slot to release
+     */
+    static void Release(Slot* a_slot) {
+      a_slot->job = Job{};
+
+      JobPool* pool = a_slot->pool;
+      Slot* head = pool->m_released.load(std::memory_order_relaxed);
+      do {
+        a_slot->next = head;
+      } while (!pool->m_released.compare_exchange_weak(head, a_slot, std::memory_order_release,
+                                                       std::memory_order_relaxed));
+    }
+
+  private:
+    /**
+     * @brief Adds a chunk of slots to the free list.
+     */
+    void allocate() {
+      m_chunks.emplace_back(new Slot[CHUNK_SIZE]);
+      Slot* chunk = m_chunks.back().get();
+      for (size_t i = 0; i < CHUNK_SIZE; ++i) {
+        chunk[i].next = i + 1 < CHUNK_SIZE ? &chunk[i + 1] : nullptr;
+        chunk[i].pool = this;
+      }
+      m_free = chunk;
+    }
+  };
+}
+
+#endif // ATLAS_JOB_POOL_HPP
@@ -7,82 +7,208 @@
 
 #include "JobSystem.hpp"
 
+#include <algorithm>
+
 #include "core/Assert.hpp"
 #include "os/ScopeLock.hpp"
 
 using namespace ntl;
 
 namespace atlas {
+  namespace {
+    constexpr Size NO_WORKER = static_cast<Size>(-1);
+
+    // Index of the worker running on this thread, jobs added from a worker go to its own deque
+    thread_local Size t_worker_index = NO_WORKER;
+  }
+
   void JobSystem::Initialize(ntl::Size a_thread_count) {
-    m_thread_count = a_thread_count;
-    m_running_jobs = 0;
+    if (m_initialized)
+      return;
+
+    m_thread_count = std::max<Size>(a_thread_count, 1);
+    m_queued_jobs = 0;
+    m_unfinished_jobs = 0;
+    m_running = true;
+
+    // All workers exist before the first thread starts, since threads steal from each other right away
+    for (Size i = 0; i < m_thread_count; ++i) {
+      m_workers.push_back(std::make_unique<Worker>());
+    }
+
     m_initialized = true;
 
-    initThreadPool();
+    for (Size i = 0; i < m_thread_count; ++i) {
+      m_workers[i]->thread = std::thread([this, i]() {
+        run(i);
+      });
+    }
   }
 
   void JobSystem::Shutdown() {
+    if (!m_initialized)
+      return;
+
+    VERIFY(t_worker_index == NO_WORKER && "JobSystem cannot be shut down from one of its jobs")
+
+    m_running = false;
+    for (auto& worker : m_workers) {
+      ScopeLock lock(&worker->sleep_lock);
+      worker->signaled = true;
+      worker->wake.Broadcast();
+    }
+
+    // Workers drain the remaining jobs before they exit
+    for (auto& worker : m_workers) {
+      worker->thread.join();
+    }
+
+    m_workers.clear();
+    m_idle.clear();
+    m_idle_count = 0;
     m_initialized = false;
   }
 
-  void JobSystem::initThreadPool() {
+  void JobSystem::AddJob(Job a_job) {
     VERIFY(m_initialized && "JobSystem must be initialized prior to use")
 
-    for(unsigned int i = 0; i < m_thread_count; ++i) {
-      std::thread worker{
-        [this]() {
-          while(true) {
-            auto job = JobSystem::Instance().GetJobOrWait();
-            job();
-            --m_running_jobs;
-            m_jobs_changed.Broadcast();
-          }
-        }
-      };
-      worker.detach();
+    ++m_unfinished_jobs;
+    ++m_queued_jobs;
+
+    if (t_worker_index != NO_WORKER) {
+      Worker& worker = *m_workers[t_worker_index];
+      worker.deque.Push(worker.pool.Acquire(std::move(a_job)));
+    } else {
+      // The lock also makes the injection pool's free list single threaded
+      ScopeLock lock(&m_injected_lock);
+      m_injected.Put(m_injected_pool.Acquire(std::move(a_job)));
+      ++m_injected_count;
     }
+
+    // Pairs with the fence in sleep(), either the sleeper sees the job or we see the sleeper
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    wakeOne();
   }
 
-  void JobSystem::AddJob(const std::function<void()>& a_job) {
+  void JobSystem::WaitForJobsToFinish() {
     VERIFY(m_initialized && "JobSystem must be initialized prior to use")
+    VERIFY(t_worker_index == NO_WORKER && "JobSystem cannot be waited on from one of its jobs")
+
+    m_finished_lock.Acquire();
 
-    ScopeLock lock(&m_jobs_lock);
-    m_jobs.Put(a_job);
-    m_jobs_changed.Broadcast();
+    while (m_unfinished_jobs > 0)
+      m_finished.Wait();
+
+    m_finished_lock.Release();
   }
 
-  std::function<void()> JobSystem::GetJobOrWait() {
-    VERIFY(m_initialized && "JobSystem must be initialized prior to use")
+  void JobSystem::run(ntl::Size a_index) {
+    t_worker_index = a_index;
 
-    m_jobs_lock.Acquire();
+    while (true) {
+      JobPool::Slot* job = findJob(a_index);
+      if (!job) {
+        job = sleep(a_index);
+      }
 
-    while(m_jobs.IsEmpty())
-      m_jobs_changed.Wait();
+      if (job) {
+        execute(job);
+        continue;
+      }
 
-    ++m_running_jobs;
-    auto job = m_jobs.Get();
+      if (!m_running && m_queued_jobs == 0)
+        break;
+    }
+
+    t_worker_index = NO_WORKER;
+  }
+
+  JobPool::Slot* JobSystem::findJob(ntl::Size a_index) {
+    if (JobPool::Slot* job = m_workers[a_index]->deque.Pop())
+      return job;
+
+    if (m_injected_count > 0) {
+      ScopeLock lock(&m_injected_lock);
+      if (!m_injected.IsEmpty()) {
+        --m_injected_count;
+        return m_injected.Get();
+      }
+    }
 
-    m_jobs_changed.Broadcast();
-    m_jobs_lock.Release();
+    for (Size i = 1; i < m_thread_count; ++i) {
+      if (JobPool::Slot* job = m_workers[(a_index + i) % m_thread_count]->deque.Steal())
+        return job;
+    }
 
-    return job;
+    return nullptr;
   }
 
-  void JobSystem::WaitForJobsToFinish() {
-    VERIFY(m_initialized && "JobSystem must be initialized prior to use")
+  void JobSystem::execute(JobPool::Slot* a_slot) {
+    // More work is waiting, hand it to another worker instead of leaving it to the one that queued it
+    if (--m_queued_jobs > 0) {
+      wakeOne();
+    }
 
-    m_jobs_lock.Acquire();
+    a_slot->job();
+    JobPool::Release(a_slot);
 
-    while(!m_jobs.IsEmpty() || (m_running_jobs > 0))
-      m_jobs_changed.Wait();
+    if (--m_unfinished_jobs == 0) {
+      ScopeLock lock(&m_finished_lock);
+      m_finished.Broadcast();
+    }
+  }
 
-    m_jobs_lock.Release();
+  void JobSystem::wakeOne() {
+    if (m_idle_count == 0)
+      return;
+
+    Size index;
+    {
+      ScopeLock lock(&m_idle_lock);
+      if (m_idle.empty())
+        return;
+      index = m_idle.back();
+      m_idle.pop_back();
+      --m_idle_count;
+    }
+
+    Worker& worker = *m_workers[index];
+    ScopeLock lock(&worker.sleep_lock);
+    worker.signaled = true;
+    worker.wake.Broadcast();
   }
 
-  Size JobSystem::GetPendingJobCount() {
-    m_jobs_lock.Acquire();
-    Size temp_count = m_jobs.GetSize();
-    m_jobs_lock.Release();
-    return temp_count;
+  JobPool::Slot* JobSystem::sleep(ntl::Size a_index) {
+    auto leaveIdle = [this, a_index]() {
+      ScopeLock lock(&m_idle_lock);
+      auto entry = std::find(m_idle.begin(), m_idle.end(), a_index);
+      if (entry != m_idle.end()) {
+        m_idle.erase(entry);
+        --m_idle_count;
+      }
+    };
+
+    {
+      ScopeLock lock(&m_idle_lock);
+      m_idle.push_back(a_index);
+      ++m_idle_count;
+    }
+
+    // A job added before we registered would not wake us, so look once more
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (JobPool::Slot* job = findJob(a_index)) {
+      leaveIdle();
+      return job;
+    }
+
+    Worker& worker = *m_workers[a_index];
+    worker.sleep_lock.Acquire();
+    while (!worker.signaled && m_running)
+      worker.wake.Wait();
+    worker.signaled = false;
+    worker.sleep_lock.Release();
+
+    leaveIdle();
+    return nullptr;
   }
 }
@@ -8,31 +8,65 @@
 #ifndef ATLAS_JOB_SYSTEM_HPP
 #define ATLAS_JOB_SYSTEM_HPP
 
-#include <functional>
+#include <atomic>
+#include <memory>
 #include <thread>
+#include <vector>
 
-#include "data/Array.hpp"
 #include "data/Bool.hpp"
 #include "data/Queue.hpp"
 #include "data/Singleton.hpp"
 #include "os/Lock.hpp"
 #include "os/Condition.hpp"
 
+#include "Job.hpp"
+#include "JobPool.hpp"
+#include "WorkStealingDeque.hpp"
+
 namespace atlas {
   /**
    * @brief JobSystem class used to distribute jobs in a pool of threads.
+   *
+   * Every worker owns a work stealing deque. Jobs added from a worker go to its own deque and run in LIFO order
+   * on that worker, jobs added from any other thread go to a shared injection queue. Idle workers take from the
+   * injection queue and steal from the other deques before going to sleep, and adding a job wakes exactly one
+   * sleeping worker. Jobs are kept in pooled slots owned by the adding worker, or by the injection queue, and
+   * only pointers to them move through the queues.
    */
   class JobSystem : public ntl::Singleton<JobSystem> {
     SINGLETON_IMPL(JobSystem)
 
   private:
+    /**
+     * @struct Worker
+     * @brief State of one thread of the pool.
+     */
+    struct Worker {
+      WorkStealingDeque<JobPool::Slot> deque;
+      JobPool pool;
+      std::thread thread;
+      ntl::Lock sleep_lock;
+      ntl::Condition wake;
+      ntl::Bool signaled;
+
+      Worker() : deque{}, pool{}, thread{}, sleep_lock{}, wake{&sleep_lock}, signaled{false} {}
+    };
+
     ntl::Size m_thread_count;
-    ntl::Array<std::thread> m_workers;
-    ntl::Queue<std::function<void()>> m_jobs;
-    ntl::Lock m_jobs_lock;
-    ntl::Condition m_jobs_changed;
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    ntl::Queue<JobPool::Slot*> m_injected;
+    JobPool m_injected_pool;
+    ntl::Lock m_injected_lock;
+    std::atomic<ntl::Size> m_injected_count;
+    std::vector<ntl::Size> m_idle;
+    ntl::Lock m_idle_lock;
+    std::atomic<ntl::Size> m_idle_count;
+    ntl::Lock m_finished_lock;
+    ntl::Condition m_finished;
+    std::atomic<ntl::Size> m_queued_jobs;
+    std::atomic<ntl::Size> m_unfinished_jobs;
     std::atomic<ntl::Bool> m_initialized;
-    std::atomic<int> m_running_jobs;
+    std::atomic<ntl::Bool> m_running;
 
   public:
     /**
@@ -40,7 +74,7 @@ namespace atlas {
      */
     void Initialize(ntl::Size a_thread_count = std::thread::hardware_concurrency());
     /**
-     * @brief Shuts down the job system (singleton).
+     * @brief Shuts down the job system (singleton), running the jobs still queued and joining all workers.
      */
     void Shutdown();
 
@@ -48,37 +82,75 @@ namespace atlas {
      * @brief Adds the given job to the job queue.
      * @param a_job the job to add to the queu
      */
-    void AddJob(const std::function<void()>& a_job);
+    void AddJob(Job a_job);
 
     /**
-     * @brief Gets the next job or waits until a job becomes available.
-     * @return the next job from the queue
+     * @brief Waits for all jobs to finish, must not be called from a job.
      */
-    std::function<void()> GetJobOrWait();
+    void WaitForJobsToFinish();
+
     /**
-     * @brief Waits for all jobs to finish.
+     * @brief Returns the number of jobs that have been added but not started yet.
+     * @return the number of queued jobs
      */
-    void WaitForJobsToFinish();
+    ntl::Size GetPendingJobCount() const { return m_queued_jobs; }
+
+    /**
+     * @brief Returns the number of worker threads.
+     * @return the size of the pool
+     */
+    ntl::Size GetThreadCount() const { return m_thread_count; }
 
-    ntl::Size GetPendingJobCount();
+    /**
+     * @brief Checks whether the thread pool has been initialized.
+     * @return if the job system is ready to accept jobs
+     */
+    ntl::Bool IsInitialized() const { return m_initialized; }
 
   private:
     /**
      * @brief Default Constructor.
      */
     JobSystem()
-      : Singleton{}, m_thread_count{0}, m_workers{}, m_jobs{}, m_jobs_lock{}, m_jobs_changed{&m_jobs_lock},
-        m_initialized{false} {}
+      : Singleton{}, m_thread_count{0}, m_workers{}, m_injected{}, m_injected_pool{}, m_injected_lock{}, m_injected_count{0},
+        m_idle{}, m_idle_lock{}, m_idle_count{0}, m_finished_lock{}, m_finished{&m_finished_lock},
+        m_queued_jobs{0}, m_unfinished_jobs{0}, m_initialized{false}, m_running{false} {}
 
     /**
      * @brief Default Destructor.
      */
-    ~JobSystem() {}
+    ~JobSystem() { Shutdown(); }
+
+    /**
+     * @brief Runs jobs on a worker until the job system shuts down.
+     * @param a_index the index of the worker
+     */
+    void run(ntl::Size a_index);
+
+    /**
+     * @brief Takes the next job for a worker from its own deque, the injection queue or another worker.
+     * @param a_index the index of the worker
+     * @return the slot of the job or nullptr if none was found
+     */
+    JobPool::Slot* findJob(ntl::Size a_index);
+
+    /**
+     * @brief Runs a job and updates the bookkeeping.
+     * @param a_slot the slot of the job to run, released afterwards
+     */
+    void execute(JobPool::Slot* a_slot);
+
+    /**
+     * @brief Wakes one sleeping worker, if any.
+     */
+    void wakeOne();
 
     /**
-     * @brief Initializes the thread pool.
+     * @brief Puts a worker to sleep until it is woken or no more jobs can arrive.
+     * @param a_index the index of the worker
+     * @return the slot of the job found while registering as idle, or nullptr once woken
      */
-    void initThreadPool();
+    JobPool::Slot* sleep(ntl::Size a_index);
   };
 }
 
@@ -0,0 +1,421 @@
+/**
+* @file JsonReader.cpp
+* @author Marcus Gugacs
+* @date 16.10.26
+* @copyright Copyright (c) 2026 Marcus Gugacs. All rights reserved.
+*/
+
+#include "JsonReader.hpp"
+
+#include <charconv>
+#include <cstdlib>
+
+namespace atlas {
+  namespace {
+    bool isDigit(int a_char) {
+      return a_char >= '0' && a_char <= '9';
+    }
+
+    void appendUtf8(std::string& a_string, uint32_t a_code) {
+      if (a_code < 0x80) {
+        a_string.push_back(static_cast<char>(a_code));
+      } else if (a_code < 0x800) {
+        a_string.push_back(static_cast<char>(0xc0 | (a_code >> 6)));
+        a_string.push_back(static_cast<char>(0x80 | (a_code & 0x3f)));
+      } else if (a_code < 0x10000) {
+        a_string.push_back(static_cast<char>(0xe0 | (a_code >> 12)));
+        a_string.push_back(static_cast<char>(0x80 | ((a_code >> 6) & 0x3f)));
+        a_string.push_back(static_cast<char>(0x80 | (a_code & 0x3f)));
+      } else {
+        a_string.push_back(static_cast<char>(0xf0 | (a_code >> 18)));
+        a_string.push_back(static_cast<char>(0x80 | ((a_code >> 12) & 0x3f)));
+        a_string.push_back(static_cast<char>(0x80 | ((a_code >> 6) & 0x3f)));
+        a_string.push_back(static_cast<char>(0x80 | (a_code & 0x3f)));
+      }
+    }
+  }
+
+  JsonReader::JsonReader(std::istream& a_stream)
+    : m_stream(a_stream), m_buffer(std::make_unique<char[]>(BUFFER_SIZE)), m_position(m_buffer.get()),
+      m_end(m_buffer.get()), m_offset(0), m_state(State::Value), m_token(Token::End), m_stack(), m_string(),
+      m_bool(false), m_error() {
+  }
+
+  JsonReader::Token JsonReader::Next() {
+    while (true) {
+      switch (m_state) {
+        case State::Failed:
+          return m_token = Token::Error;
+
+        case State::Done:
+          if (peek() != -1)
+            return fail("Unexpected data after the document");
+          return m_token = Token::End;
+
+        case State::Value:
+          return m_token = readValue();
+
+        case State::ValueOrEnd:
+          if (peek() == ']') {
+            ++m_position;
+            return m_token = close(Token::ArrayEnd);
+          }
+          return m_token = readValue();
+
+        case State::KeyOrEnd:
+          if (peek() == '}') {
+            ++m_position;
+            return m_token = close(Token::ObjectEnd);
+          }
+          [[fallthrough]];
+
+        case State::Key:
+          if (peek() != '"')
+            return fail("Expected a key");
+          ++m_position;
+          if (!readString())
+            return m_token;
+          if (peek() != ':')
+            return fail("Expected ':' after a key");
+          ++m_position;
+          m_state = State::Value;
+          return m_token = Token::Key;
+
+        case State::CommaOrEnd: {
+          int next = peek();
+          bool object = m_stack.back() == '{';
+          if (next == ',') {
+            ++m_position;
+            m_state = object ? State::Key : State::Value;
+            continue;
+          }
+          if (next == (object ? '}' : ']')) {
+            ++m_position;
+            return m_token = close(object ? Token::ObjectEnd : Token::ArrayEnd);
+          }
+          return fail(object ? "Expected ',' or '}'" : "Expected ',' or ']'");
+        }
+      }
+    }
+  }
+
+  bool JsonReader::Skip() {
+    if (m_token == Token::Key)
+      Next();
+
+    if (m_token == Token::ObjectBegin || m_token == Token::ArrayBegin) {
+      // The container's own end token pops it from the stack
+      size_t depth = m_stack.size();
+      while (m_stack.size() >= depth) {
+        if (Next() == Token::Error)
+          return false;
+      }
+    }
+    return m_token != Token::Error;
+  }
+
+  bool JsonReader::ReadValue(Json::Value& a_value) {
+    if (m_token == Token::Key)
+      Next();
+    return readCurrent(a_value);
+  }
+
+  bool JsonReader::fill() {
+    m_offset += static_cast<uint64_t>(m_end - m_buffer.get());
+    m_stream.read(m_buffer.get(), static_cast<std::streamsize>(BUFFER_SIZE));
+    m_position = m_buffer.get();
+    m_end = m_position + m_stream.gcount();
+    return m_position != m_end;
+  }
+
+  int JsonReader::current() {
+    if (m_position == m_end && !fill())
+      return -1;
+    return static_cast<unsigned char>(*m_position);
+  }
+
+  int JsonReader::peek() {
+    while (true) {
+      while (m_position != m_end) {
+        char next = *m_position;
+        if (next != ' ' && next != '\n' && next != '\r' && next != '\t')
+          return static_cast<unsigned char>(next);
+        ++m_position;
+      }
+      if (!fill())
+        return -1;
+    }
+  }
+
+  JsonReader::Token JsonReader::readValue() {
+    int next = peek();
+    switch (next) {
+      case '{':
+        ++m_position;
+        return open('{', Token::ObjectBegin);
+      case '[':
+        ++m_position;
+        return open('[', Token::ArrayBegin);
+      case '"':
+        ++m_position;
+        return readString() ? completeValue(Token::String) : Token::Error;
+      case 't':
+        m_bool = true;
+        return readLiteral("true") ? completeValue(Token::Boolean) : fail("Invalid literal");
+      case 'f':
+        m_bool = false;
+        return readLiteral("false") ? completeValue(Token::Boolean) : fail("Invalid literal");
+      case 'n':
+        return readLiteral("null") ? completeValue(Token::Null) : fail("Invalid literal");
+      case -1:
+        return fail("Unexpected end of the document");
+      default:
+        if (next != '-' && !isDigit(next))
+          return fail("Unexpected character");
+        return readNumber() ? completeValue(Token::Number) : Token::Error;
+    }
+  }
+
+  bool JsonReader::readString() {
+    m_string.clear();
+    while (true) {
+      if (m_position == m_end && !fill()) {
+        fail("Unterminated string");
+        return false;
+      }
+
+      // Copy plain runs in one go, only quotes, escapes and control characters need a closer look
+      const char* start = m_position;
+      while (m_position != m_end) {
+        auto next = static_cast<unsigned char>(*m_position);
+        if (next == '"' || next == '\\' || next < 0x20)
+          break;
+        ++m_position;
+      }
+      m_string.append(start, m_position);
+      if (m_position == m_end)
+        continue;
+
+      char next = *m_position++;
+      if (next == '"')
+        return true;
+      if (next != '\\') {
+        fail("Control character in string");
+        return false;
+      }
+
+      int escape = current();
+      if (escape == -1) {
+        fail("Unterminated string");
+        return false;
+      }
+      ++m_position;
+      switch (escape) {
+        case '"': m_string.push_back('"'); break;
+        case '\\': m_string.push_back('\\'); break;
+        case '/': m_string.push_back('/'); break;
+        case 'b': m_string.push_back('\b'); break;
+        case 'f': m_string.push_back('\f'); break;
+        case 'n': m_string.push_back('\n'); break;
+        case 'r': m_string.push_back('\r'); break;
+        case 't': m_string.push_back('\t'); break;
+        case 'u':
+          if (!readUnicodeEscape())
+            return false;
+          break;
+        default:
+          fail("Invalid escape sequence");
+          return false;
+      }
+    }
+  }
+
+  bool JsonReader::readUnicodeEscape() {
+    uint32_t code = 0;
+    if (!readHex(code))
+      return false;
+
+    if (code >= 0xdc00 && code <= 0xdfff) {
+      fail("Unpaired surrogate in unicode escape");
+      return false;
+    }
+
+    // Characters outside the basic plane are escaped as a pair of surrogates
+    if (code >= 0xd800 && code <= 0xdbff) {
+      uint32_t low = 0;
+      for (char expected : {'\\', 'u'}) {
+        if (current() != expected) {
+          fail("Unpaired surrogate in unicode escape");
+          return false;
+        }
+        ++m_position;
+      }
+      if (!readHex(low))
+        return false;
+      if (low < 0xdc00 || low > 0xdfff) {
+        fail("Unpaired surrogate in unicode escape");
+        return false;
+      }
+      code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+    }
+
+    appendUtf8(m_string, code);
+    return true;
+  }
+
+  bool JsonReader::readHex(uint32_t& a_code) {
+    a_code = 0;
+    for (int i = 0; i < 4; ++i) {
+      int next = current();
+      uint32_t digit;
+      if (isDigit(next)) {
+        digit = static_cast<uint32_t>(next - '0');
+      } else if (next >= 'a' && next <= 'f') {
+        digit = static_cast<uint32_t>(next - 'a' + 10);
+      } else if (next >= 'A' && next <= 'F') {
+        digit = static_cast<uint32_t>(next - 'A' + 10);
+      } else {
+        fail("Invalid unicode escape");
+        return false;
+      }
+      ++m_position;
+      a_code = (a_code << 4) | digit;
+    }
+    return true;
+  }
+
+  bool JsonReader::readNumber() {
+    m_string.clear();
+    auto take = [this]() {
+      m_string.push_back(*m_position++);
+    };
+    auto digits = [this, &take]() {
+      size_t count = 0;
+      while (isDigit(current())) {
+        take();
+        ++count;
+      }
+      return count;
+    };
+
+    if (current() == '-')
+      take();
+
+    if (current() == '0') {
+      take();
+    } else if (digits() == 0) {
+      fail("Invalid number");
+      return false;
+    }
+
+    if (current() == '.') {
+      take();
+      if (digits() == 0) {
+        fail("Invalid number");
+        return false;
+      }
+    }
+
+    int next = current();
+    if (next == 'e' || next == 'E') {
+      take();
+      next = current();
+      if (next == '+' || next == '-')
+        take();
+      if (digits() == 0) {
+        fail("Invalid number");
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool JsonReader::readLiteral(std::string_view a_literal) {
+    for (char expected : a_literal) {
+      if (current() != expected)
+        return false;
+      ++m_position;
+    }
+    return true;
+  }
+
+  JsonReader::Token JsonReader::open(char a_bracket, Token a_token) {
+    if (m_stack.size() >= MAX_DEPTH)
+      return fail("Document nests too deep");
+
+    m_stack.push_back(a_bracket);
+    m_state = a_bracket == '{' ? State::KeyOrEnd : State::ValueOrEnd;
+    return a_token;
+  }
+
+  JsonReader::Token JsonReader::close(Token a_token) {
+    m_stack.pop_back();
+    return completeValue(a_token);
+  }
+
+  JsonReader::Token JsonReader::completeValue(Token a_token) {
+    m_state = m_stack.empty() ? State::Done : State::CommaOrEnd;
+    return a_token;
+  }
+
+  JsonReader::Token JsonReader::fail(const char* a_message) {
+    uint64_t offset = m_offset + static_cast<uint64_t>(m_position - m_buffer.get());
+    m_error = std::string(a_message) + " at byte " + std::to_string(offset);
+    m_state = State::Failed;
+    return m_token = Token::Error;
+  }
+
+  bool JsonReader::readCurrent(Json::Value& a_value) {
+    switch (m_token) {
+      case Token::ObjectBegin:
+        a_value = Json::Value(Json::objectValue);
+        while (Next() == Token::Key) {
+          std::string key(m_string);
+          Next();
+          if (!readCurrent(a_value[key]))
+            return false;
+        }
+        return m_token == Token::ObjectEnd;
+
+      case Token::ArrayBegin:
+        a_value = Json::Value(Json::arrayValue);
+        while (Next() != Token::ArrayEnd) {
+          if (!readCurrent(a_value.append(Json::Value())))
+            return false;
+        }
+        return true;
+
+      case Token::String:
+        a_value = Json::Value(m_string.data(), m_string.data() + m_string.size());
+        return true;
+
+      case Token::Number: {
+        // Integers keep their exact value, everything else becomes a double like in the DOM parser
+        const char* first = m_string.data();
+        const char* last = first + m_string.size();
+        Json::Int64 integer = 0;
+        Json::UInt64 unsigned_integer = 0;
+        if (auto [end, error] = std::from_chars(first, last, integer); error == std::errc() && end == last) {
+          a_value = integer;
+        } else if (auto [u_end, u_error] = std::from_chars(first, last, unsigned_integer);
+                   u_error == std::errc() && u_end == last) {
+          a_value = unsigned_integer;
+        } else {
+          a_value = std::strtod(m_string.c_str(), nullptr);
+        }
+        return true;
+      }
+
+      case Token::Boolean:
+        a_value = m_bool;
+        return true;
+
+      case Token::Null:
+        a_value = Json::Value();
+        return true;
+
+      default:
+        return false;
+    }
+  }
+}
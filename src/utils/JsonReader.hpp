@@ -0,0 +1,244 @@
+/**
+* @file JsonReader.hpp
+* @author Marcus Gugacs
+* @date 16.10.26
+* @copyright Copyright (c) 2026 Marcus Gugacs. All rights reserved.
+*/
+
+#ifndef ATLAS_JSON_READER_HPP
+#define ATLAS_JSON_READER_HPP
+
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <json/json.h>
+
+namespace atlas {
+  /**
+   * @class JsonReader
+   * @brief Pull parser reading a JSON document token by token from a stream.
+   *
+   * The stream is read through a fixed-size buffer and only the current string is kept, so the memory needed
+   * does not depend on the size of the document. Callers walk the document with Next(), skip values they are
+   * not interested in and may materialize small parts of it as Json::Value. The document is validated while
+   * it is read; once an error was found every further call returns Token::Error.
+   */
+  class JsonReader {
+  public:
+    static constexpr size_t BUFFER_SIZE = 64 * 1024;
+    static constexpr size_t MAX_DEPTH = 256;
+
+    enum class Token {
+      ObjectBegin,
+      ObjectEnd,
+      ArrayBegin,
+      ArrayEnd,
+      Key,
+      String,
+      Number,
+      Boolean,
+      Null,
+      End,
+      Error
+    };
+
+  private:
+    enum class State {
+      Value,
+      KeyOrEnd,
+      Key,
+      ValueOrEnd,
+      CommaOrEnd,
+      Done,
+      Failed
+    };
+
+    std::istream& m_stream;
+    std::unique_ptr<char[]> m_buffer;
+    const char* m_position;
+    const char* m_end;
+    uint64_t m_offset;
+    State m_state;
+    Token m_token;
+    std::vector<char> m_stack;
+    std::string m_string;
+    bool m_bool;
+    std::string m_error;
+
+  public:
+    /**
+     * @brief Constructs a reader of a stream, nothing is read before the first call to Next().
+     *
+     * @param a_stream Stream holding the document, must outlive the reader
+     */
+    explicit JsonReader(std::istream& a_stream);
+
+    JsonReader(const JsonReader&) = delete;
+    JsonReader& operator=(const JsonReader&) = delete;
+
+    /**
+     * @brief Reads the next token.
+     *
+     * @return The token, Token::End after the document and Token::Error if it is malformed
+     */
+    Token Next();
+
+    /**
+     * @brief Skips the value starting at the current token, or the value of the current key.
+     *
+     * After an ObjectBegin or ArrayBegin the reader is left on the matching end token.
+     *
+     * @return True if the value was skipped, false if the document is malformed
+     */
+    bool Skip();
+
+    /**
+     * @brief Materializes the value starting at the current token, or the value of the current key.
+     *
+     * @param a_value Receives the value
+     * @return True if the value was read, false if the document is malformed
+     */
+    bool ReadValue(Json::Value& a_value);
+
+    /**
+     * @brief Returns the current token.
+     *
+     * @return The token last returned by Next()
+     */
+    Token GetToken() const { return m_token; }
+
+    /**
+     * @brief Returns the unescaped text of the current key or string, or the literal text of a number.
+     *
+     * @return The text, valid until the next call to Next()
+     */
+    const std::string& GetString() const { return m_string; }
+
+    /**
+     * @brief Returns the value of the current boolean.
+     *
+     * @return The boolean value
+     */
+    bool GetBool() const { return m_bool; }
+
+    /**
+     * @brief Returns a description of the error that stopped the reader.
+     *
+     * @return The error message, including the byte offset it was found at
+     */
+    const std::string& GetError() const { return m_error; }
+
+  private:
+    /**
+     * @brief Reads the next chunk of the stream into the buffer.
+     *
+     * @return True if at least one byte was read, false at the end of the stream
+     */
+    bool fill();
+
+    /**
+     * @brief Returns the next character without consuming it.
+     *
+     * @return The character, or -1 at the end of the stream
+     */
+    int current();
+
+    /**
+     * @brief Skips whitespace and returns the next character without consuming it.
+     *
+     * @return The character, or -1 at the end of the stream
+     */
+    int peek();
+
+    /**
+     * @brief Parses the value starting at the next character.
+     *
+     * @return The first token of the value
+     */
+    Token readValue();
+
+    /**
+     * @brief Parses a string after its opening quote into m_string.
+     *
+     * @return True if the string is valid, false otherwise
+     */
+    bool readString();
+
+    /**
+     * @brief Parses a \\u escape sequence after the u and appends it to m_string as UTF-8.
+     *
+     * @return True if the escape is valid, false otherwise
+     */
+    bool readUnicodeEscape();
+
+    /**
+     * @brief Reads the four hex digits of a \\u escape sequence.
+     *
+     * @param a_code Receives the code unit
+     * @return True if four hex digits were read, false otherwise
+     */
+    bool readHex(uint32_t& a_code);
+
+    /**
+     * @brief Parses a number into m_string.
+     *
+     * @return True if the number is valid, false otherwise
+     */
+    bool readNumber();
+
+    /**
+     * @brief Consumes the rest of a literal such as true, false or null.
+     *
+     * @param a_literal The expected literal
+     * @return True if the literal matched, false otherwise
+     */
+    bool readLiteral(std::string_view a_literal);
+
+    /**
+     * @brief Enters an object or array.
+     *
+     * @param a_bracket Opening bracket of the container
+     * @param a_token Token to return
+     * @return The token, or Token::Error if the document nests too deep
+     */
+    Token open(char a_bracket, Token a_token);
+
+    /**
+     * @brief Leaves the innermost object or array.
+     *
+     * @param a_token Token to return
+     * @return The token
+     */
+    Token close(Token a_token);
+
+    /**
+     * @brief Moves on after a complete value.
+     *
+     * @param a_token Token of the value
+     * @return The token
+     */
+    Token completeValue(Token a_token);
+
+    /**
+     * @brief Stops the reader with an error.
+     *
+     * @param a_message Description of the error
+     * @return Token::Error
+     */
+    Token fail(const char* a_message);
+
+    /**
+     * @brief Materializes the value starting at the current token.
+     *
+     * @param a_value Receives the value
+     * @return True if the value was read, false if the document is malformed
+     */
+    bool readCurrent(Json::Value& a_value);
+  };
+}
+
+#endif // ATLAS_JSON_READER_HPP
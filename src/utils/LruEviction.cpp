@@ -0,0 +1,59 @@
+/**
+* @file LruEviction.cpp
+* @author Marcus Gugacs
+* @date 16.10.26
+* @copyright Copyright (c) 2026 Marcus Gugacs. All rights reserved.
+*/
+
+#include "LruEviction.hpp"
+
+#include <algorithm>
+#include <vector>
+
+namespace atlas {
+  void LruEviction::Touch(const fs::path& a_entry) {
+    std::error_code error;
+    fs::last_write_time(a_entry, fs::file_time_type::clock::now(), error);
+  }
+
+  void LruEviction::Evict(const fs::path& a_root, uint64_t a_max_size, const fs::path& a_skip) {
+    struct Entry {
+      fs::path path;
+      fs::file_time_type last_used;
+      uint64_t size;
+    };
+
+    std::error_code error;
+    std::vector<Entry> entries;
+    uint64_t total_size = 0;
+    for (auto it = fs::recursive_directory_iterator(a_root, error);
+         !error && it != fs::recursive_directory_iterator(); it.increment(error)) {
+      if (it.depth() == 0 && !a_skip.empty() && it->path().filename() == a_skip) {
+        it.disable_recursion_pending();
+        continue;
+      }
+      if (!it->is_regular_file(error))
+        continue;
+
+      Entry entry{it->path(), it->last_write_time(error), it->file_size(error)};
+      total_size += entry.size;
+      entries.push_back(std::move(entry));
+    }
+
+    if (total_size <= a_max_size)
+      return;
+
+    std::sort(entries.begin(), entries.end(), [](const Entry& a_lhs, const Entry& a_rhs) {
+      return a_lhs.last_used < a_rhs.last_used;
+    });
+
+    for (const Entry& entry : entries) {
+      if (total_size <= a_max_size)
+        break;
+
+      if (fs::remove(entry.path, error)) {
+        total_size -= entry.size;
+      }
+    }
+  }
+}
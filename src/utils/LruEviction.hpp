@@ -0,0 +1,46 @@
+/**
+* @file LruEviction.hpp
+* @author Marcus Gugacs
+* @date 16.10.26
+* @copyright Copyright (c) 2026 Marcus Gugacs. All rights reserved.
+*/
+
+#ifndef ATLAS_LRU_EVICTION_HPP
+#define ATLAS_LRU_EVICTION_HPP
+
+#include <cstdint>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+namespace atlas {
+  /**
+   * @class LruEviction
+   * @brief Least recently used eviction for file based stores.
+   *
+   * The last modification time of an entry serves as its last use, so the state survives between runs without
+   * an index of its own. Callers serialize eviction of a store themselves.
+   */
+  class LruEviction {
+  public:
+    LruEviction() = delete;
+
+    /**
+     * @brief Marks an entry as recently used.
+     *
+     * @param a_entry Path of the entry
+     */
+    static void Touch(const fs::path& a_entry);
+
+    /**
+     * @brief Removes the least recently used files below a directory until their total size fits a limit.
+     *
+     * @param a_root Directory holding the entries, searched recursively
+     * @param a_max_size Size limit in bytes
+     * @param a_skip Name of a directory directly below the root that holds no entries, empty for none
+     */
+    static void Evict(const fs::path& a_root, uint64_t a_max_size, const fs::path& a_skip = {});
+  };
+}
+
+#endif // ATLAS_LRU_EVICTION_HPP
@@ -10,10 +10,13 @@
 
 #include <iostream>
 #include <fstream>
+#include <string>
 
 #include <data/String.hpp>
 
 #include "core/Logger.hpp"
+#include "utils/File.hpp"
+#include "utils/ProcessRunner.hpp"
 
 namespace atlas {
   extern const char* RED;
@@ -24,43 +27,47 @@ namespace atlas {
   extern const char* CYAN;
   extern const char* RESET;
 
-  /**
-   * Logs output to a file.
-   *
-   * @param a_output The content to log.
-   * @param a_filename The filename where the output will be stored.
-   */
-  static void LogOutputToFile(const ntl::String& a_output,
-                              const ntl::String& a_filename) {
-    std::ofstream file(a_filename.GetCString(), std::ios::app);
-    file << a_output;
-    file.close();
-  }
-
   /**
    * Executes an external command and logs the output.
    *
+   * The command runs on the process runner, which has to be initialized. stdout and stderr are streamed to the
+   * log as they arrive.
+   *
    * @param a_command The command to execute, e.g. "git status".
-   * @param a_path The path where the output will be stored (in a log file).
+   * @param a_log The log the output is appended to, nullptr to discard it.
    * @param a_verbose Whether to enable verbose logging.
+   * @param a_limits The timeout and resource limits of the command.
+   * @param a_result Receives the details of the run, may be nullptr.
    *
-   * @return The exit code of the executed command.
+   * @return The exit code of the executed command, 127 if it could not be started.
    */
-  static int ProcessCommand(const ntl::String& a_command, const ntl::String& a_path, bool a_verbose) {
-    FILE* pipe = popen(a_command.GetCString(), "r");
-    ntl::String output{};
-    int exitCode = -1;
-    if (pipe) {
-      char buffer[128];
-      while (fgets(buffer, sizeof(buffer), pipe) != NULL) {
-        LOG_DEBUG(ntl::String{buffer});
-        output.Append(buffer);
+  static int ProcessCommand(const ntl::String& a_command, LogSink* a_log, bool a_verbose,
+                            const ProcessRunner::Limits& a_limits = {0, 0, 0},
+                            ProcessRunner::Result* a_result = nullptr) {
+    bool debug = a_verbose || Logger::Instance().GetMinVerbosity() <= Verbosity::DEBUG;
+
+    auto on_output = [a_log, debug](const char* a_data, size_t a_size, bool) {
+      if (a_log) {
+        a_log->Write(a_data, a_size);
       }
-      exitCode = pclose(pipe);
+      if (debug) {
+        LOG_DEBUG(ntl::String{std::string(a_data, a_size).c_str()});
+      }
+    };
+    ProcessRunner::Request request{a_command, a_limits, on_output};
+    ProcessRunner::Result result = ProcessRunner::Instance().Run(std::move(request));
+
+    if (a_log) {
+      if (!result.error.IsEmpty()) {
+        a_log->Write(result.error + "\n");
+      }
+      a_log->Flush();
     }
-    LogOutputToFile(output, a_path);
-    return exitCode;
-}
+    if (a_result) {
+      *a_result = result;
+    }
+    return result.exit_code;
+  }
 }
 
 #endif //ATLAS_MISC_HPP
@@ -0,0 +1,480 @@
+/**
+* @file ProcessRunner.cpp
+* @author Marcus Gugacs
+* @date 16.10.26
+* @copyright Copyright (c) 2026 Marcus Gugacs. All rights reserved.
+*/
+
+#include "ProcessRunner.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <csignal>
+#include <cstring>
+#include <string>
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/syscall.h>
+#else
+#include <poll.h>
+#endif
+
+#include "core/Assert.hpp"
+#include "os/ScopeLock.hpp"
+
+extern char** environ;
+
+using namespace ntl;
+
+namespace atlas {
+  namespace {
+    // Time a command gets to react to SIGTERM after a timeout before it is killed
+    constexpr auto KILL_GRACE = std::chrono::seconds(5);
+    // Time background processes may keep the pipes open after the command itself exited
+    constexpr auto OUTPUT_GRACE = std::chrono::seconds(2);
+    // Reads per pipe and wakeup, so one chatty command cannot starve the others
+    constexpr int READS_PER_EVENT = 4;
+
+    // Write end of the wake pipe for the SIGCHLD handler, -1 while the runner is shut down
+    std::atomic<int> g_child_wake_fd{-1};
+
+    /**
+     * @brief Wakes the event loop up once a child exited, only async-signal-safe calls.
+     */
+    void onChildSignal(int) {
+      int saved = errno;
+      int fd = g_child_wake_fd.load();
+      if (fd >= 0) {
+        char byte = 0;
+        write(fd, &byte, 1);
+      }
+      errno = saved;
+    }
+
+    /**
+     * @brief Creates a pipe whose read end is non-blocking, both ends are closed on exec.
+     */
+    bool createPipe(int a_fds[2]) {
+      if (pipe(a_fds) != 0)
+        return false;
+
+      fcntl(a_fds[0], F_SETFD, FD_CLOEXEC);
+      fcntl(a_fds[1], F_SETFD, FD_CLOEXEC);
+      fcntl(a_fds[0], F_SETFL, fcntl(a_fds[0], F_GETFL) | O_NONBLOCK);
+      return true;
+    }
+
+    /**
+     * @brief Prefixes a command with the ulimit calls applying its limits.
+     *
+     * The shell sets the limits on itself before it runs anything, so the command and everything it starts
+     * inherits them. A limit that cannot be set fails the command rather than running it unlimited.
+     */
+    std::string applyLimits(const char* a_command, const ProcessRunner::Limits& a_limits) {
+      std::string script;
+      if (a_limits.max_memory_bytes > 0) {
+        uint64_t kilobytes = std::max<uint64_t>(a_limits.max_memory_bytes / 1024, 1);
+        script += "ulimit -v " + std::to_string(kilobytes) + " || exit 126\n";
+      }
+      if (a_limits.max_cpu_seconds > 0) {
+        // The soft limit sends SIGXCPU, the hard limit a few seconds later SIGKILL
+        script += "ulimit -S -t " + std::to_string(a_limits.max_cpu_seconds) + " && ulimit -H -t " +
+                  std::to_string(a_limits.max_cpu_seconds + 5) + " || exit 126\n";
+      }
+      return script + a_command;
+    }
+
+    /**
+     * @brief Converts a wait status to the exit code a shell would report.
+     */
+    int toExitCode(int a_status) {
+      if (WIFEXITED(a_status))
+        return WEXITSTATUS(a_status);
+      if (WIFSIGNALED(a_status))
+        return 128 + WTERMSIG(a_status);
+      return -1;
+    }
+  }
+
+  void ProcessRunner::Initialize() {
+    if (m_initialized)
+      return;
+
+#ifdef __linux__
+    m_poll_fd = epoll_create1(EPOLL_CLOEXEC);
+#endif
+    createPipe(m_wake_fds);
+    fcntl(m_wake_fds[1], F_SETFL, fcntl(m_wake_fds[1], F_GETFL) | O_NONBLOCK);
+#ifndef __linux__
+    watchChildSignal();
+#endif
+
+    m_running = true;
+    m_initialized = true;
+    m_loop = std::thread(&ProcessRunner::run, this);
+  }
+
+  void ProcessRunner::Shutdown() {
+    if (!m_initialized)
+      return;
+
+    m_running = false;
+    char byte = 0;
+    write(m_wake_fds[1], &byte, 1);
+    if (m_loop.joinable()) {
+      m_loop.join();
+    }
+
+    if (m_child_signal) {
+      sigaction(SIGCHLD, &m_previous_child_action, nullptr);
+      g_child_wake_fd = -1;
+      m_child_signal = false;
+    }
+
+    // The loop closed the read end already, a second close could hit a descriptor reused by another thread
+    for (int& fd : m_wake_fds) {
+      if (fd >= 0) {
+        close(fd);
+        fd = -1;
+      }
+    }
+    if (m_poll_fd >= 0) {
+      close(m_poll_fd);
+      m_poll_fd = -1;
+    }
+    m_initialized = false;
+  }
+
+  std::shared_future<ProcessRunner::Result> ProcessRunner::Submit(Request a_request) {
+    VERIFY(m_initialized && "ProcessRunner must be initialized prior to use")
+
+    auto* process = new Process{std::move(a_request), -1, -1, -1, -1, {}, {}, {}, false, false, 0,
+                                {false, -1, false, 0, 0, ""}, {}};
+    std::shared_future<Result> result = process->promise.get_future().share();
+
+    {
+      ScopeLock lock(&m_pending_lock);
+      m_pending.push_back(process);
+    }
+    char byte = 0;
+    write(m_wake_fds[1], &byte, 1);
+
+    return result;
+  }
+
+  ProcessRunner::Result ProcessRunner::Run(Request a_request) {
+    return Submit(std::move(a_request)).get();
+  }
+
+  void ProcessRunner::run() {
+    watch(m_wake_fds[0], nullptr);
+
+    std::vector<int> ready;
+    while (m_running) {
+      startPending();
+
+      waitForEvents(getTimeout(), ready);
+      for (int fd : ready) {
+        if (fd == m_wake_fds[0]) {
+          char bytes[64];
+          while (read(m_wake_fds[0], bytes, sizeof(bytes)) > 0) {}
+          continue;
+        }
+
+        // The command exited, it is reaped below
+        auto entry = m_by_fd.find(fd);
+        if (entry != m_by_fd.end() && fd == entry->second->exit_fd) {
+          unwatch(entry->second->exit_fd);
+          continue;
+        }
+        drain(fd);
+      }
+
+      updateProcesses();
+    }
+
+    // Shutting down, take every command and whatever it started down with it
+    startPending();
+    for (Process* process : m_processes) {
+      kill(-process->pid, SIGKILL);
+      waitpid(process->pid, &process->status, 0);
+      process->exited = true;
+      process->result.error = "Aborted by shutdown";
+    }
+    while (!m_processes.empty()) {
+      finish(m_processes.back());
+    }
+
+    unwatch(m_wake_fds[0]);
+  }
+
+  void ProcessRunner::startPending() {
+    std::vector<Process*> pending;
+    {
+      ScopeLock lock(&m_pending_lock);
+      pending.swap(m_pending);
+    }
+
+    for (Process* process : pending) {
+      if (!spawn(process)) {
+        process->result.exit_code = 127;
+        process->promise.set_value(process->result);
+        delete process;
+        continue;
+      }
+
+      m_processes.push_back(process);
+      watch(process->stdout_fd, process);
+      watch(process->stderr_fd, process);
+      watchExit(process);
+    }
+  }
+
+  void ProcessRunner::watchChildSignal() {
+    if (m_child_signal)
+      return;
+
+    g_child_wake_fd = m_wake_fds[1];
+    struct sigaction action{};
+    action.sa_handler = onChildSignal;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART | SA_NOCLDSTOP;
+    sigaction(SIGCHLD, &action, &m_previous_child_action);
+    m_child_signal = true;
+  }
+
+  void ProcessRunner::watchExit(Process* a_process) {
+#if defined(__linux__) && defined(SYS_pidfd_open)
+    // A zombie's pidfd is readable as well, so an exit before this point is not missed
+    int fd = static_cast<int>(syscall(SYS_pidfd_open, a_process->pid, 0));
+    if (fd >= 0) {
+      fcntl(fd, F_SETFD, FD_CLOEXEC);
+      a_process->exit_fd = fd;
+      watch(fd, a_process);
+      return;
+    }
+#endif
+
+    // No pidfd for this command, the handler only reports exits from now on so look once right away
+    watchChildSignal();
+    char byte = 0;
+    write(m_wake_fds[1], &byte, 1);
+  }
+
+  int ProcessRunner::getTimeout() const {
+    Clock::time_point next = Clock::time_point::max();
+    for (const Process* process : m_processes) {
+      if (process->exited) {
+        if (process->stdout_fd >= 0 || process->stderr_fd >= 0) {
+          next = std::min(next, process->exited_at + OUTPUT_GRACE);
+        }
+      } else if (process->terminated) {
+        next = std::min(next, process->kill_deadline);
+      } else if (process->deadline != Clock::time_point{}) {
+        next = std::min(next, process->deadline);
+      }
+    }
+
+    if (next == Clock::time_point::max())
+      return -1;
+
+    auto remaining = std::chrono::ceil<std::chrono::milliseconds>(next - Clock::now()).count();
+    return static_cast<int>(std::clamp<decltype(remaining)>(remaining, 0, INT_MAX));
+  }
+
+  bool ProcessRunner::spawn(Process* a_process) {
+    int stdout_pipe[2];
+    int stderr_pipe[2];
+    if (!createPipe(stdout_pipe)) {
+      a_process->result.error = ntl::String{"Failed to create pipe: "} + std::strerror(errno);
+      return false;
+    }
+    if (!createPipe(stderr_pipe)) {
+      a_process->result.error = ntl::String{"Failed to create pipe: "} + std::strerror(errno);
+      close(stdout_pipe[0]);
+      close(stdout_pipe[1]);
+      return false;
+    }
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, STDIN_FILENO, "/dev/null", O_RDONLY, 0);
+    posix_spawn_file_actions_adddup2(&actions, stdout_pipe[1], STDOUT_FILENO);
+    posix_spawn_file_actions_adddup2(&actions, stderr_pipe[1], STDERR_FILENO);
+
+    // Own process group so a timeout reaches the whole tree, default signal handling regardless of ours
+    posix_spawnattr_t attributes;
+    posix_spawnattr_init(&attributes);
+    sigset_t signals;
+    sigemptyset(&signals);
+    posix_spawnattr_setsigmask(&attributes, &signals);
+    sigaddset(&signals, SIGPIPE);
+    posix_spawnattr_setsigdefault(&attributes, &signals);
+    posix_spawnattr_setpgroup(&attributes, 0);
+    posix_spawnattr_setflags(&attributes, POSIX_SPAWN_SETPGROUP | POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF);
+
+    std::string script = applyLimits(a_process->request.command.GetCString(), a_process->request.limits);
+    const char* argv[] = {"sh", "-c", script.c_str(), nullptr};
+    int error = posix_spawn(&a_process->pid, "/bin/sh", &actions, &attributes, const_cast<char* const*>(argv),
+                            environ);
+
+    posix_spawn_file_actions_destroy(&actions);
+    posix_spawnattr_destroy(&attributes);
+    close(stdout_pipe[1]);
+    close(stderr_pipe[1]);
+
+    if (error != 0) {
+      a_process->result.error = ntl::String{"Failed to start command: "} + std::strerror(error);
+      close(stdout_pipe[0]);
+      close(stderr_pipe[0]);
+      return false;
+    }
+
+    a_process->stdout_fd = stdout_pipe[0];
+    a_process->stderr_fd = stderr_pipe[0];
+    a_process->result.started = true;
+    if (a_process->request.limits.timeout_seconds > 0) {
+      a_process->deadline = Clock::now() + std::chrono::seconds(a_process->request.limits.timeout_seconds);
+    }
+    return true;
+  }
+
+  void ProcessRunner::waitForEvents(int a_timeout_ms, std::vector<int>& a_ready) {
+    a_ready.clear();
+
+#ifdef __linux__
+    epoll_event events[64];
+    int count = epoll_wait(m_poll_fd, events, 64, a_timeout_ms);
+    for (int i = 0; i < count; ++i) {
+      a_ready.push_back(events[i].data.fd);
+    }
+#else
+    std::vector<pollfd> fds;
+    for (const auto& [fd, process] : m_by_fd) {
+      fds.push_back({fd, POLLIN, 0});
+    }
+    int count = poll(fds.data(), fds.size(), a_timeout_ms);
+    for (size_t i = 0; count > 0 && i < fds.size(); ++i) {
+      if (fds[i].revents != 0) {
+        a_ready.push_back(fds[i].fd);
+      }
+    }
+#endif
+  }
+
+  void ProcessRunner::watch(int a_fd, Process* a_process) {
+    m_by_fd[a_fd] = a_process;
+
+#ifdef __linux__
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = a_fd;
+    epoll_ctl(m_poll_fd, EPOLL_CTL_ADD, a_fd, &event);
+#endif
+  }
+
+  void ProcessRunner::unwatch(int& a_fd) {
+    if (a_fd < 0)
+      return;
+
+#ifdef __linux__
+    epoll_ctl(m_poll_fd, EPOLL_CTL_DEL, a_fd, nullptr);
+#endif
+    m_by_fd.erase(a_fd);
+    close(a_fd);
+    a_fd = -1;
+  }
+
+  void ProcessRunner::drain(int a_fd) {
+    auto entry = m_by_fd.find(a_fd);
+    if (entry == m_by_fd.end())
+      return;
+
+    Process* process = entry->second;
+    bool is_stderr = a_fd == process->stderr_fd;
+
+    for (int i = 0; i < READS_PER_EVENT; ++i) {
+      ssize_t count = read(a_fd, m_buffer.data(), m_buffer.size());
+      if (count > 0) {
+        (is_stderr ? process->result.stderr_bytes : process->result.stdout_bytes) += static_cast<uint64_t>(count);
+        if (process->request.on_output) {
+          process->request.on_output(m_buffer.data(), static_cast<size_t>(count), is_stderr);
+        }
+        continue;
+      }
+
+      if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))
+        return;
+
+      // End of file or a broken pipe, the command closed its side
+      unwatch(is_stderr ? process->stderr_fd : process->stdout_fd);
+      return;
+    }
+  }
+
+  void ProcessRunner::updateProcesses() {
+    Clock::time_point now = Clock::now();
+
+    for (size_t i = 0; i < m_processes.size();) {
+      Process* process = m_processes[i];
+
+      if (!process->exited && waitpid(process->pid, &process->status, WNOHANG) == process->pid) {
+        process->exited = true;
+        process->exited_at = now;
+        unwatch(process->exit_fd);
+      }
+
+      if (!process->exited && process->deadline != Clock::time_point{}) {
+        if (!process->terminated && now >= process->deadline) {
+          process->terminated = true;
+          process->result.timed_out = true;
+          process->kill_deadline = now + KILL_GRACE;
+          kill(-process->pid, SIGTERM);
+        } else if (process->terminated && now >= process->kill_deadline) {
+          // Killed, nothing is left to wait for but the exit
+          process->kill_deadline = Clock::time_point::max();
+          kill(-process->pid, SIGKILL);
+        }
+      }
+
+      // Background processes may hold the pipes open forever, give them a moment and then stop listening
+      if (process->exited && (process->stdout_fd >= 0 || process->stderr_fd >= 0) &&
+          now - process->exited_at >= OUTPUT_GRACE) {
+        drain(process->stdout_fd);
+        drain(process->stderr_fd);
+        unwatch(process->stdout_fd);
+        unwatch(process->stderr_fd);
+      }
+
+      if (process->exited && process->stdout_fd < 0 && process->stderr_fd < 0) {
+        finish(process);
+        continue;
+      }
+      ++i;
+    }
+  }
+
+  void ProcessRunner::finish(Process* a_process) {
+    unwatch(a_process->stdout_fd);
+    unwatch(a_process->stderr_fd);
+    unwatch(a_process->exit_fd);
+
+    auto entry = std::find(m_processes.begin(), m_processes.end(), a_process);
+    if (entry != m_processes.end()) {
+      m_processes.erase(entry);
+    }
+
+    a_process->result.exit_code = toExitCode(a_process->status);
+    if (a_process->result.timed_out) {
+      a_process->result.error = "Command timed out";
+    }
+    a_process->promise.set_value(a_process->result);
+    delete a_process;
+  }
+}
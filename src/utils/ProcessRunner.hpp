@@ -0,0 +1,238 @@
+/**
+* @file ProcessRunner.hpp
+* @author Marcus Gugacs
+* @date 16.10.26
+* @copyright Copyright (c) 2026 Marcus Gugacs. All rights reserved.
+*/
+
+#ifndef ATLAS_PROCESS_RUNNER_HPP
+#define ATLAS_PROCESS_RUNNER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <map>
+#include <signal.h>
+#include <sys/types.h>
+#include <thread>
+#include <vector>
+
+#include "data/Bool.hpp"
+#include "data/Singleton.hpp"
+#include "data/String.hpp"
+#include "os/Lock.hpp"
+
+namespace atlas {
+  /**
+   * @brief ProcessRunner class running shell commands and streaming their output from a single thread.
+   *
+   * Commands are started with posix_spawn through /bin/sh, with stdout and stderr connected to non-blocking
+   * pipes. One event loop waits on the pipes of all running commands, hands every chunk it reads to the
+   * command's output callback and reaps the processes, so a command never occupies a thread for its I/O. Each
+   * command runs in its own process group, which lets a timeout take down everything it started.
+   *
+   * The loop only wakes up for output, exited commands and the nearest deadline. Exits are watched through a
+   * pidfd per command on Linux and through a SIGCHLD handler writing to the wake pipe elsewhere.
+   */
+  class ProcessRunner : public ntl::Singleton<ProcessRunner> {
+    SINGLETON_IMPL(ProcessRunner)
+
+  public:
+    /**
+     * @struct Limits
+     * @brief Limits of a single command, 0 disables a limit.
+     */
+    struct Limits {
+      int timeout_seconds;
+      uint64_t max_memory_bytes;
+      uint64_t max_cpu_seconds;
+    };
+
+    /**
+     * @struct Result
+     * @brief Outcome of a single command.
+     */
+    struct Result {
+      bool started;
+      int exit_code;
+      bool timed_out;
+      uint64_t stdout_bytes;
+      uint64_t stderr_bytes;
+      ntl::String error;
+    };
+
+    /**
+     * @struct Request
+     * @brief Description of a single command.
+     *
+     * The output callback runs on the event loop thread and must not block. It receives the data, its size and
+     * whether it was written to stderr.
+     */
+    struct Request {
+      ntl::String command;
+      Limits limits;
+      std::function<void(const char*, size_t, bool)> on_output;
+    };
+
+  private:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @struct Process
+     * @brief State of a running command owned by the event loop.
+     */
+    struct Process {
+      Request request;
+      pid_t pid;
+      int stdout_fd;
+      int stderr_fd;
+      int exit_fd;
+      Clock::time_point deadline;
+      Clock::time_point kill_deadline;
+      Clock::time_point exited_at;
+      bool exited;
+      bool terminated;
+      int status;
+      Result result;
+      std::promise<Result> promise;
+    };
+
+    static constexpr size_t READ_BUFFER_SIZE = 64 * 1024;
+
+    std::thread m_loop;
+    int m_poll_fd;
+    int m_wake_fds[2];
+    std::vector<Process*> m_processes;
+    std::map<int, Process*> m_by_fd;
+    std::vector<Process*> m_pending;
+    ntl::Lock m_pending_lock;
+    std::vector<char> m_buffer;
+    bool m_child_signal;
+    struct sigaction m_previous_child_action;
+    std::atomic<ntl::Bool> m_initialized;
+    std::atomic<ntl::Bool> m_running;
+
+  public:
+    /**
+     * @brief Initializes the process runner and starts its event loop.
+     */
+    void Initialize();
+
+    /**
+     * @brief Stops the event loop, killing all commands that are still running.
+     */
+    void Shutdown();
+
+    /**
+     * @brief Starts a command.
+     * @param a_request the command to run
+     * @return a future receiving the result once the command exited and its output was read
+     */
+    std::shared_future<Result> Submit(Request a_request);
+
+    /**
+     * @brief Runs a command and waits for it to finish.
+     * @param a_request the command to run
+     * @return the result of the command
+     */
+    Result Run(Request a_request);
+
+    /**
+     * @brief Checks whether the event loop has been started.
+     * @return if the process runner is ready to accept commands
+     */
+    ntl::Bool IsInitialized() const { return m_initialized; }
+
+  private:
+    /**
+     * @brief Default Constructor.
+     */
+    ProcessRunner()
+      : Singleton{}, m_loop{}, m_poll_fd{-1}, m_wake_fds{-1, -1}, m_processes{}, m_by_fd{}, m_pending{},
+        m_pending_lock{}, m_buffer(READ_BUFFER_SIZE), m_child_signal{false}, m_previous_child_action{},
+        m_initialized{false}, m_running{false} {}
+
+    /**
+     * @brief Default Destructor.
+     */
+    ~ProcessRunner() {}
+
+    /**
+     * @brief Runs the event loop until the process runner is shut down.
+     */
+    void run();
+
+    /**
+     * @brief Spawns the queued commands and registers their pipes.
+     */
+    void startPending();
+
+    /**
+     * @brief Spawns a command.
+     * @param a_process the command to spawn
+     * @return if the command was started
+     */
+    bool spawn(Process* a_process);
+
+    /**
+     * @brief Starts watching for exits of the commands.
+     *
+     * Installs a SIGCHLD handler writing to the wake pipe, used where a command's exit cannot be watched through
+     * a pidfd.
+     */
+    void watchChildSignal();
+
+    /**
+     * @brief Starts watching for the exit of a command.
+     * @param a_process the spawned command
+     */
+    void watchExit(Process* a_process);
+
+    /**
+     * @brief Computes how long the loop may wait until the nearest deadline of a command.
+     * @return the time in milliseconds, -1 if no command has a deadline
+     */
+    int getTimeout() const;
+
+    /**
+     * @brief Waits for readable pipes.
+     * @param a_timeout_ms the maximum time to wait, -1 to wait until something happens
+     * @param a_ready receives the readable descriptors
+     */
+    void waitForEvents(int a_timeout_ms, std::vector<int>& a_ready);
+
+    /**
+     * @brief Starts watching a pipe.
+     * @param a_fd the read end of the pipe
+     * @param a_process the command writing to it
+     */
+    void watch(int a_fd, Process* a_process);
+
+    /**
+     * @brief Stops watching a pipe and closes it.
+     * @param a_fd the read end of the pipe
+     */
+    void unwatch(int& a_fd);
+
+    /**
+     * @brief Reads everything currently available from a pipe.
+     * @param a_fd the read end of the pipe
+     */
+    void drain(int a_fd);
+
+    /**
+     * @brief Reaps exited commands, enforces timeouts and completes finished commands.
+     */
+    void updateProcesses();
+
+    /**
+     * @brief Completes a finished command and releases its resources.
+     * @param a_process the finished command
+     */
+    void finish(Process* a_process);
+  };
+}
+
+#endif // ATLAS_PROCESS_RUNNER_HPP
@@ -0,0 +1,153 @@
+/**
+* @file Sha256.cpp
+* @author Marcus Gugacs
+* @date 16.10.26
+* @copyright Copyright (c) 2026 Marcus Gugacs. All rights reserved.
+*/
+
+#include "Sha256.hpp"
+
+#include <cstring>
+#include <algorithm>
+#include <fstream>
+#include <vector>
+
+namespace atlas {
+  namespace {
+    constexpr uint32_t ROUND_CONSTANTS[64] = {
+      0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+      0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+      0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+      0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+      0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+      0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+      0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+      0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+    };
+
+    constexpr size_t FILE_BUFFER_SIZE = 1 << 16;
+
+    inline uint32_t rotateRight(uint32_t a_value, uint32_t a_count) {
+      return (a_value >> a_count) | (a_value << (32 - a_count));
+    }
+  }
+
+  Sha256::Sha256()
+    : m_state{0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19},
+      m_block{}, m_block_size(0), m_total_size(0) {
+  }
+
+  void Sha256::Update(const void* a_data, size_t a_size) {
+    const auto* data = static_cast<const uint8_t*>(a_data);
+    m_total_size += a_size;
+
+    if (m_block_size > 0) {
+      size_t count = std::min(a_size, sizeof(m_block) - m_block_size);
+      std::memcpy(m_block + m_block_size, data, count);
+      m_block_size += count;
+      data += count;
+      a_size -= count;
+
+      if (m_block_size < sizeof(m_block))
+        return;
+
+      transform(m_block);
+      m_block_size = 0;
+    }
+
+    while (a_size >= sizeof(m_block)) {
+      transform(data);
+      data += sizeof(m_block);
+      a_size -= sizeof(m_block);
+    }
+
+    std::memcpy(m_block, data, a_size);
+    m_block_size = a_size;
+  }
+
+  ntl::String Sha256::Finalize() {
+    uint64_t bit_size = m_total_size * 8;
+
+    uint8_t padding[72] = {0x80};
+    size_t padding_size = (m_block_size < 56 ? 56 : 120) - m_block_size;
+    for (int i = 0; i < 8; ++i) {
+      padding[padding_size + i] = static_cast<uint8_t>(bit_size >> (56 - 8 * i));
+    }
+    Update(padding, padding_size + 8);
+
+    static constexpr char HEX[] = "0123456789abcdef";
+    char digest[DIGEST_SIZE * 2 + 1];
+    for (size_t i = 0; i < 8; ++i) {
+      for (size_t j = 0; j < 4; ++j) {
+        auto byte = static_cast<uint8_t>(m_state[i] >> (24 - 8 * j));
+        digest[(i * 4 + j) * 2] = HEX[byte >> 4];
+        digest[(i * 4 + j) * 2 + 1] = HEX[byte & 0x0f];
+      }
+    }
+    digest[DIGEST_SIZE * 2] = '\0';
+
+    return digest;
+  }
+
+  bool Sha256::HashFile(const fs::path& a_path, ntl::String& a_digest) {
+    std::ifstream file(a_path, std::ios::binary);
+    if (!file)
+      return false;
+
+    Sha256 hash;
+    std::vector<char> buffer(FILE_BUFFER_SIZE);
+    while (file) {
+      file.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+      hash.Update(buffer.data(), static_cast<size_t>(file.gcount()));
+    }
+
+    if (file.bad())
+      return false;
+
+    a_digest = hash.Finalize();
+    return true;
+  }
+
+  void Sha256::transform(const uint8_t* a_block) {
+    uint32_t words[64];
+    for (size_t i = 0; i < 16; ++i) {
+      words[i] = (static_cast<uint32_t>(a_block[i * 4]) << 24) | (static_cast<uint32_t>(a_block[i * 4 + 1]) << 16) |
+                 (static_cast<uint32_t>(a_block[i * 4 + 2]) << 8) | static_cast<uint32_t>(a_block[i * 4 + 3]);
+    }
+    for (size_t i = 16; i < 64; ++i) {
+      uint32_t s0 = rotateRight(words[i - 15], 7) ^ rotateRight(words[i - 15], 18) ^ (words[i - 15] >> 3);
+      uint32_t s1 = rotateRight(words[i - 2], 17) ^ rotateRight(words[i - 2], 19) ^ (words[i - 2] >> 10);
+      words[i] = words[i - 16] + s0 + words[i - 7] + s1;
+    }
+
+    uint32_t a = m_state[0], b = m_state[1], c = m_state[2], d = m_state[3];
+    uint32_t e = m_state[4], f = m_state[5], g = m_state[6], h = m_state[7];
+
+    for (size_t i = 0; i < 64; ++i) {
+      uint32_t s1 = rotateRight(e, 6) ^ rotateRight(e, 11) ^ rotateRight(e, 25);
+      uint32_t choice = (e & f) ^ (~e & g);
+      uint32_t temp1 = h + s1 + choice + ROUND_CONSTANTS[i] + words[i];
+      uint32_t s0 = rotateRight(a, 2) ^ rotateRight(a, 13) ^ rotateRight(a, 22);
+      uint32_t majority = (a & b) ^ (a & c) ^ (b & c);
+      uint32_t temp2 = s0 + majority;
+
+      h = g;
+      g = f;
+      f = e;
+      e = d + temp1;
+      d = c;
+      c = b;
+      b = a;
+      a = temp1 + temp2;
+    }
+
+    m_state[0] += a;
+    m_state[1] += b;
+    m_state[2] += c;
+    m_state[3] += d;
+    m_state[4] += e;
+    m_state[5] += f;
+    m_state[6] += g;
+    m_state[7] += h;
+  }
+}
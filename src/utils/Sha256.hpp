@@ -0,0 +1,69 @@
+/**
+* @file Sha256.hpp
+* @author Marcus Gugacs
+* @date 16.10.26
+* @copyright Copyright (c) 2026 Marcus Gugacs. All rights reserved.
+*/
+
+#ifndef ATLAS_SHA256_HPP
+#define ATLAS_SHA256_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+#include "data/String.hpp"
+
+namespace fs = std::filesystem;
+
+namespace atlas {
+  /**
+   * @brief Sha256 class computing SHA-256 digests incrementally.
+   */
+  class Sha256 {
+  public:
+    static constexpr size_t DIGEST_SIZE = 32;
+
+  private:
+    uint32_t m_state[8];
+    uint8_t m_block[64];
+    size_t m_block_size;
+    uint64_t m_total_size;
+
+  public:
+    /**
+     * @brief Constructs a new digest in its initial state.
+     */
+    Sha256();
+
+    /**
+     * @brief Feeds data into the digest.
+     * @param a_data the data to hash
+     * @param a_size the number of bytes
+     */
+    void Update(const void* a_data, size_t a_size);
+
+    /**
+     * @brief Finishes the digest and returns it as a lowercase hex string.
+     * @return the hex encoded digest
+     */
+    ntl::String Finalize();
+
+    /**
+     * @brief Hashes the contents of a file.
+     * @param a_path the file to hash
+     * @param a_digest the string to store the hex encoded digest in
+     * @return if the file could be read
+     */
+    static bool HashFile(const fs::path& a_path, ntl::String& a_digest);
+
+  private:
+    /**
+     * @brief Processes one full 64 byte block.
+     * @param a_block the block to process
+     */
+    void transform(const uint8_t* a_block);
+  };
+}
+
+#endif // ATLAS_SHA256_HPP
@@ -0,0 +1,96 @@
+/**
+* @file StringPool.cpp
+* @author Marcus Gugacs
+* @date 16.10.26
+* @copyright Copyright (c) 2026 Marcus Gugacs. All rights reserved.
+*/
+
+#include "StringPool.hpp"
+
+#include <cstring>
+
+namespace atlas {
+  StringPool::StringPool()
+    : m_blocks(), m_large(), m_large_size(0), m_cursor(nullptr), m_remaining(0), m_strings(), m_lengths(),
+      m_interned() {
+    Clear();
+  }
+
+  uint32_t StringPool::Intern(std::string_view a_string) {
+    // Looking up and adding a missing string share one hash
+    uint64_t hash = HashString(a_string);
+    if (const uint32_t* id = m_interned.Find(a_string, hash))
+      return *id;
+
+    uint32_t id = store(a_string);
+    m_interned.Insert(GetView(id), id, hash);
+    return id;
+  }
+
+  uint32_t StringPool::Add(std::string_view a_string) {
+    return a_string.empty() ? 0 : store(a_string);
+  }
+
+  bool StringPool::Find(std::string_view a_string, uint32_t& a_id) const {
+    const uint32_t* id = m_interned.Find(a_string);
+    if (!id)
+      return false;
+
+    a_id = *id;
+    return true;
+  }
+
+  size_t StringPool::GetMemoryUsage() const {
+    return m_blocks.size() * BLOCK_SIZE + m_large_size + m_strings.capacity() * sizeof(const char*) +
+           m_lengths.capacity() * sizeof(uint32_t) + m_interned.GetMemoryUsage();
+  }
+
+  void StringPool::Reserve(size_t a_count) {
+    m_interned.Reserve(a_count);
+  }
+
+  void StringPool::Clear() {
+    // The first block is kept, loading the index again fills it right away
+    if (m_blocks.size() > 1)
+      m_blocks.resize(1);
+    m_large.clear();
+    m_large_size = 0;
+    m_cursor = nullptr;
+    m_remaining = 0;
+    m_strings.clear();
+    m_lengths.clear();
+    m_interned.Clear();
+
+    if (!m_blocks.empty()) {
+      m_cursor = m_blocks[0].get();
+      m_remaining = BLOCK_SIZE;
+    }
+    Intern("");
+  }
+
+  uint32_t StringPool::store(std::string_view a_string) {
+    size_t size = a_string.size() + 1;
+    char* string = nullptr;
+    if (size > BLOCK_SIZE / 4) {
+      // Oversized strings get an allocation of their own so the current block keeps filling up
+      string = m_large.emplace_back(new char[size]).get();
+      m_large_size += size;
+    } else {
+      if (size > m_remaining) {
+        m_blocks.emplace_back(new char[BLOCK_SIZE]);
+        m_cursor = m_blocks.back().get();
+        m_remaining = BLOCK_SIZE;
+      }
+      string = m_cursor;
+      m_cursor += size;
+      m_remaining -= size;
+    }
+
+    std::memcpy(string, a_string.data(), a_string.size());
+    string[a_string.size()] = '\0';
+
+    m_strings.push_back(string);
+    m_lengths.push_back(static_cast<uint32_t>(a_string.size()));
+    return static_cast<uint32_t>(m_strings.size() - 1);
+  }
+}
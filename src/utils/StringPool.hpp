@@ -0,0 +1,129 @@
+/**
+* @file StringPool.hpp
+* @author Marcus Gugacs
+* @date 16.10.26
+* @copyright Copyright (c) 2026 Marcus Gugacs. All rights reserved.
+*/
+
+#ifndef ATLAS_STRING_POOL_HPP
+#define ATLAS_STRING_POOL_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include "utils/FlatMap.hpp"
+
+namespace atlas {
+  /**
+   * @class StringPool
+   * @brief Arena of null-terminated strings addressed by 32-bit ids.
+   *
+   * Strings are copied into large blocks that are never moved or freed before the pool is cleared, so a string
+   * stays valid as long as the pool does. Interned strings are stored once and always map to the same id, which
+   * makes comparing them a matter of comparing ids. Strings that rarely repeat can be added without the lookup.
+   * Id 0 is the empty string.
+   */
+  class StringPool {
+  public:
+    static constexpr size_t BLOCK_SIZE = 64 * 1024;
+
+  private:
+    std::vector<std::unique_ptr<char[]>> m_blocks;
+    std::vector<std::unique_ptr<char[]>> m_large;
+    size_t m_large_size;
+    char* m_cursor;
+    size_t m_remaining;
+    std::vector<const char*> m_strings;
+    std::vector<uint32_t> m_lengths;
+    FlatMap<std::string_view, uint32_t> m_interned;
+
+  public:
+    /**
+     * @brief Default constructor, creates a pool holding only the empty string.
+     */
+    StringPool();
+
+    StringPool(const StringPool&) = delete;
+    StringPool& operator=(const StringPool&) = delete;
+
+    /**
+     * @brief Returns the id of a string, storing it if it was not interned before.
+     *
+     * @param a_string String to intern
+     * @return The id of the string
+     */
+    uint32_t Intern(std::string_view a_string);
+
+    /**
+     * @brief Stores a string without looking for an equal one.
+     *
+     * @param a_string String to store
+     * @return The id of the new copy
+     */
+    uint32_t Add(std::string_view a_string);
+
+    /**
+     * @brief Returns the id of an interned string without storing it.
+     *
+     * @param a_string String to look up
+     * @param a_id Receives the id
+     * @return True if the string was interned, false otherwise
+     */
+    bool Find(std::string_view a_string, uint32_t& a_id) const;
+
+    /**
+     * @brief Returns a stored string.
+     *
+     * @param a_id Id of the string
+     * @return The null-terminated string
+     */
+    const char* Get(uint32_t a_id) const { return m_strings[a_id]; }
+
+    /**
+     * @brief Returns a stored string together with its length.
+     *
+     * @param a_id Id of the string
+     * @return View of the string
+     */
+    std::string_view GetView(uint32_t a_id) const { return {m_strings[a_id], m_lengths[a_id]}; }
+
+    /**
+     * @brief Returns the number of stored strings.
+     *
+     * @return The string count, including the empty string
+     */
+    size_t GetCount() const { return m_strings.size(); }
+
+    /**
+     * @brief Returns the approximate number of bytes the pool occupies.
+     *
+     * @return The size of the blocks, the id tables and the lookup of interned strings
+     */
+    size_t GetMemoryUsage() const;
+
+    /**
+     * @brief Makes room for the given number of interned strings.
+     *
+     * @param a_count Expected number of interned strings
+     */
+    void Reserve(size_t a_count);
+
+    /**
+     * @brief Frees every string except the empty one.
+     */
+    void Clear();
+
+  private:
+    /**
+     * @brief Copies a string into the arena.
+     *
+     * @param a_string String to copy
+     * @return The id of the copy
+     */
+    uint32_t store(std::string_view a_string);
+  };
+}
+
+#endif // ATLAS_STRING_POOL_HPP
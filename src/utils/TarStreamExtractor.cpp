@@ -0,0 +1,388 @@
+/**
+* @file TarStreamExtractor.cpp
+* @author Marcus Gugacs
+* @date 16.10.26
+* @copyright Copyright (c) 2026 Marcus Gugacs. All rights reserved.
+*/
+
+#include "TarStreamExtractor.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace atlas {
+  namespace {
+    constexpr size_t NAME_OFFSET = 0;
+    constexpr size_t NAME_SIZE = 100;
+    constexpr size_t MODE_OFFSET = 100;
+    constexpr size_t SIZE_OFFSET = 124;
+    constexpr size_t MTIME_OFFSET = 136;
+    constexpr size_t CHECKSUM_OFFSET = 148;
+    constexpr size_t CHECKSUM_SIZE = 8;
+    constexpr size_t TYPE_OFFSET = 156;
+    constexpr size_t LINK_OFFSET = 157;
+    constexpr size_t MAGIC_OFFSET = 257;
+    constexpr size_t PREFIX_OFFSET = 345;
+    constexpr size_t PREFIX_SIZE = 155;
+
+    /**
+     * @brief Reads a numeric header field, either octal or GNU base-256.
+     */
+    uint64_t readNumber(const unsigned char* a_field, size_t a_size) {
+      uint64_t value = 0;
+      if (a_field[0] & 0x80) {
+        for (size_t i = 1; i < a_size; ++i) {
+          value = (value << 8) | a_field[i];
+        }
+        return value;
+      }
+
+      size_t i = 0;
+      while (i < a_size && a_field[i] == ' ') {
+        ++i;
+      }
+      for (; i < a_size && a_field[i] >= '0' && a_field[i] <= '7'; ++i) {
+        value = (value << 3) | static_cast<uint64_t>(a_field[i] - '0');
+      }
+      return value;
+    }
+
+    /**
+     * @brief Reads a string header field, which is only terminated if it is shorter than the field.
+     */
+    std::string readString(const unsigned char* a_field, size_t a_size) {
+      const auto* begin = reinterpret_cast<const char*>(a_field);
+      return {begin, strnlen(begin, a_size)};
+    }
+  }
+
+  TarStreamExtractor::TarStreamExtractor(const fs::path& a_target)
+    : m_target(a_target), m_state(State::Header), m_entry(), m_header(), m_header_size(0), m_zero_blocks(0),
+      m_metadata(), m_long_name(), m_long_link(), m_file(-1), m_links(), m_files(), m_manifest_path(), m_manifest(),
+      m_hashing(false), m_hash(), m_digests(), m_error() {
+  }
+
+  TarStreamExtractor::~TarStreamExtractor() {
+    if (m_file >= 0) {
+      close(m_file);
+    }
+  }
+
+  void TarStreamExtractor::SetManifest(const fs::path& a_name) {
+    m_manifest_path = a_name.lexically_normal();
+  }
+
+  bool TarStreamExtractor::Feed(const void* a_data, size_t a_size) {
+    const auto* data = static_cast<const unsigned char*>(a_data);
+    while (a_size > 0) {
+      size_t count = 0;
+      switch (m_state) {
+        case State::Failed:
+          return false;
+
+        case State::Done:
+          // Archives are often padded to a full record after the end marker
+          return true;
+
+        case State::Header:
+          count = std::min(a_size, BLOCK_SIZE - m_header_size);
+          std::memcpy(m_header + m_header_size, data, count);
+          m_header_size += count;
+          if (m_header_size == BLOCK_SIZE) {
+            m_header_size = 0;
+            if (!parseHeader())
+              return false;
+          }
+          break;
+
+        case State::EntryData:
+          count = static_cast<size_t>(std::min<uint64_t>(a_size, m_entry.remaining));
+          if (m_entry.manifest) {
+            m_manifest.append(reinterpret_cast<const char*>(data), count);
+          } else if (m_hashing && m_file >= 0) {
+            m_hash.Update(data, count);
+          }
+          for (size_t written = 0; m_file >= 0 && written < count;) {
+            ssize_t result = write(m_file, data + written, count - written);
+            if (result < 0) {
+              if (errno == EINTR)
+                continue;
+              return fail(ntl::String{"Failed to write "} + m_entry.path.c_str() + ": " + std::strerror(errno));
+            }
+            written += static_cast<size_t>(result);
+          }
+          m_entry.remaining -= count;
+          if (m_entry.remaining == 0) {
+            if (!finishFile())
+              return false;
+            m_state = m_entry.padding ? State::Padding : State::Header;
+          }
+          break;
+
+        case State::Metadata:
+          count = static_cast<size_t>(std::min<uint64_t>(a_size, m_entry.remaining));
+          m_metadata.append(reinterpret_cast<const char*>(data), count);
+          m_entry.remaining -= count;
+          if (m_entry.remaining == 0) {
+            finishMetadata();
+            m_state = m_entry.padding ? State::Padding : State::Header;
+          }
+          break;
+
+        case State::Padding:
+          count = static_cast<size_t>(std::min<uint64_t>(a_size, m_entry.padding));
+          m_entry.padding -= count;
+          if (m_entry.padding == 0) {
+            m_state = State::Header;
+          }
+          break;
+      }
+      data += count;
+      a_size -= count;
+    }
+    return m_state != State::Failed;
+  }
+
+  bool TarStreamExtractor::Finish() {
+    if (m_state == State::Failed)
+      return false;
+
+    // Some writers omit the second zero block
+    if (m_state != State::Done && !(m_state == State::Header && m_header_size == 0 && m_zero_blocks == 1))
+      return fail("Unexpected end of archive");
+    return true;
+  }
+
+  bool TarStreamExtractor::parseHeader() {
+    if (std::all_of(m_header, m_header + BLOCK_SIZE, [](unsigned char a_byte) { return a_byte == 0; })) {
+      if (++m_zero_blocks == 2) {
+        m_state = State::Done;
+      }
+      return true;
+    }
+    m_zero_blocks = 0;
+
+    // The checksum covers the header with its own field counted as spaces
+    uint64_t checksum = 0;
+    for (size_t i = 0; i < BLOCK_SIZE; ++i) {
+      bool in_field = i >= CHECKSUM_OFFSET && i < CHECKSUM_OFFSET + CHECKSUM_SIZE;
+      checksum += in_field ? ' ' : m_header[i];
+    }
+    if (checksum != readNumber(m_header + CHECKSUM_OFFSET, CHECKSUM_SIZE))
+      return fail("Invalid tar header checksum");
+
+    uint64_t size = readNumber(m_header + SIZE_OFFSET, 12);
+    m_entry.type = static_cast<char>(m_header[TYPE_OFFSET]);
+    m_entry.mode = static_cast<uint32_t>(readNumber(m_header + MODE_OFFSET, 8) & 07777);
+    m_entry.mtime = static_cast<int64_t>(readNumber(m_header + MTIME_OFFSET, 12));
+    m_entry.remaining = size;
+    m_entry.padding = (BLOCK_SIZE - size % BLOCK_SIZE) % BLOCK_SIZE;
+
+    // Long names and pax records describe the header that follows them
+    if (m_entry.type == 'L' || m_entry.type == 'K' || m_entry.type == 'x') {
+      if (size > MAX_METADATA_SIZE)
+        return fail("Oversized tar metadata entry");
+      m_metadata.clear();
+      m_state = State::Metadata;
+      if (size == 0) {
+        finishMetadata();
+        m_state = m_entry.padding ? State::Padding : State::Header;
+      }
+      return true;
+    }
+
+    std::string name = m_long_name;
+    if (name.empty()) {
+      name = readString(m_header + NAME_OFFSET, NAME_SIZE);
+      std::string prefix = readString(m_header + PREFIX_OFFSET, PREFIX_SIZE);
+      if (std::memcmp(m_header + MAGIC_OFFSET, "ustar", 5) == 0 && !prefix.empty()) {
+        name = prefix + "/" + name;
+      }
+    }
+    std::string link = m_long_link.empty() ? readString(m_header + LINK_OFFSET, NAME_SIZE) : m_long_link;
+    m_long_name.clear();
+    m_long_link.clear();
+
+    return startEntry(name, link);
+  }
+
+  bool TarStreamExtractor::startEntry(const std::string& a_name, const std::string& a_link) {
+    m_file = -1;
+    m_entry.manifest = false;
+    m_state = m_entry.remaining ? State::EntryData : (m_entry.padding ? State::Padding : State::Header);
+
+    char type = m_entry.type;
+    bool regular = type == '0' || type == '\0' || type == '7';
+    if (!regular && type != '1' && type != '2' && type != '5')
+      return true;
+
+    if (!resolvePath(a_name, m_entry.path))
+      return fail(ntl::String{"Unsafe path in archive: "} + a_name.c_str());
+    const fs::path& relative = m_entry.path;
+    if (relative.empty()) {
+      // The archive root itself, e.g. "./"
+      return type == '5' || fail(ntl::String{"Invalid entry in archive: "} + a_name.c_str());
+    }
+
+    if (regular && !m_manifest_path.empty() && relative == m_manifest_path) {
+      if (m_entry.remaining > MAX_MANIFEST_SIZE)
+        return fail("Oversized manifest in archive");
+      m_entry.manifest = true;
+      m_manifest.clear();
+      return true;
+    }
+
+    fs::path path = m_target / relative;
+    std::error_code error;
+    fs::create_directories(path.parent_path(), error);
+    if (error)
+      return fail(ntl::String{"Failed to create "} + path.parent_path().c_str() + ": " + error.message().c_str());
+
+    if (type == '5') {
+      // A link in its place is replaced, creating or changing the mode through it would reach outside the target
+      struct stat info{};
+      if (lstat(path.c_str(), &info) == 0 && !S_ISDIR(info.st_mode) && unlink(path.c_str()) != 0)
+        return fail(ntl::String{"Failed to replace "} + path.c_str() + ": " + std::strerror(errno));
+      m_links.erase(relative);
+
+      if (mkdir(path.c_str(), S_IRWXU) != 0 && errno != EEXIST)
+        return fail(ntl::String{"Failed to create "} + path.c_str() + ": " + std::strerror(errno));
+      int directory = open(path.c_str(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+      if (directory < 0)
+        return fail(ntl::String{"Failed to open "} + path.c_str() + ": " + std::strerror(errno));
+      fchmod(directory, m_entry.mode | S_IRWXU);
+      close(directory);
+      m_files.push_back(relative);
+      return true;
+    }
+
+    // Replace whatever is there, writing through an existing file could modify a hard linked copy elsewhere
+    if (unlink(path.c_str()) != 0 && errno != ENOENT) {
+      if (errno == EISDIR || errno == EPERM) {
+        fs::remove_all(path, error);
+      }
+    }
+    m_links.erase(relative);
+
+    if (type == '2') {
+      if (symlink(a_link.c_str(), path.c_str()) != 0)
+        return fail(ntl::String{"Failed to create link "} + path.c_str() + ": " + std::strerror(errno));
+      m_links.insert(relative);
+      m_files.push_back(relative);
+      return true;
+    }
+
+    if (type == '1') {
+      fs::path target;
+      if (!resolvePath(a_link, target) || target.empty())
+        return fail(ntl::String{"Unsafe link in archive: "} + a_link.c_str());
+      if (link((m_target / target).c_str(), path.c_str()) != 0)
+        return fail(ntl::String{"Failed to create link "} + path.c_str() + ": " + std::strerror(errno));
+      auto digest = m_digests.find(target);
+      if (digest != m_digests.end()) {
+        m_digests[relative] = digest->second;
+      }
+      m_files.push_back(relative);
+      return true;
+    }
+
+    m_file = open(path.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_NOFOLLOW | O_CLOEXEC, S_IRUSR | S_IWUSR);
+    if (m_file < 0)
+      return fail(ntl::String{"Failed to create "} + path.c_str() + ": " + std::strerror(errno));
+    m_files.push_back(relative);
+    if (m_hashing) {
+      m_hash = Sha256();
+    }
+
+    if (m_entry.remaining == 0)
+      return finishFile();
+    return true;
+  }
+
+  void TarStreamExtractor::finishMetadata() {
+    if (m_entry.type == 'L' || m_entry.type == 'K') {
+      std::string& target = m_entry.type == 'L' ? m_long_name : m_long_link;
+      target.assign(m_metadata.c_str());
+      return;
+    }
+
+    // Pax records are "<length> <key>=<value>\n", only the paths matter here
+    size_t offset = 0;
+    while (offset < m_metadata.size()) {
+      size_t space = m_metadata.find(' ', offset);
+      if (space == std::string::npos)
+        break;
+      size_t length = std::strtoul(m_metadata.c_str() + offset, nullptr, 10);
+      if (length == 0 || offset + length > m_metadata.size())
+        break;
+
+      std::string record = m_metadata.substr(space + 1, offset + length - space - 2);
+      size_t equals = record.find('=');
+      if (equals != std::string::npos) {
+        std::string key = record.substr(0, equals);
+        if (key == "path") {
+          m_long_name = record.substr(equals + 1);
+        } else if (key == "linkpath") {
+          m_long_link = record.substr(equals + 1);
+        }
+      }
+      offset += length;
+    }
+  }
+
+  bool TarStreamExtractor::finishFile() {
+    if (m_file < 0)
+      return true;
+
+    timespec times[2] = {{m_entry.mtime, 0}, {m_entry.mtime, 0}};
+    bool success = fchmod(m_file, m_entry.mode) == 0 && futimens(m_file, times) == 0;
+    success = close(m_file) == 0 && success;
+    m_file = -1;
+    if (!success)
+      return fail(ntl::String{"Failed to finish "} + m_entry.path.c_str() + ": " + std::strerror(errno));
+
+    if (m_hashing) {
+      m_digests[m_entry.path] = m_hash.Finalize();
+    }
+    return true;
+  }
+
+  bool TarStreamExtractor::resolvePath(const std::string& a_name, fs::path& a_path) const {
+    fs::path path = fs::path(a_name).lexically_normal();
+    if (path.is_absolute())
+      return false;
+
+    fs::path relative;
+    for (const auto& component : path) {
+      if (component == "..")
+        return false;
+      if (component.empty() || component == ".")
+        continue;
+
+      // Links from the archive could point anywhere, nothing is extracted through them
+      if (!relative.empty() && m_links.count(relative))
+        return false;
+      relative /= component;
+    }
+
+    a_path = relative;
+    return true;
+  }
+
+  bool TarStreamExtractor::fail(const ntl::String& a_error) {
+    if (m_state != State::Failed) {
+      m_error = a_error;
+      m_state = State::Failed;
+    }
+    if (m_file >= 0) {
+      close(m_file);
+      m_file = -1;
+    }
+    return false;
+  }
+}
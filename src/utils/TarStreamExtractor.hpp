@@ -0,0 +1,216 @@
+/**
+* @file TarStreamExtractor.hpp
+* @author Marcus Gugacs
+* @date 16.10.26
+* @copyright Copyright (c) 2026 Marcus Gugacs. All rights reserved.
+*/
+
+#ifndef ATLAS_TAR_STREAM_EXTRACTOR_HPP
+#define ATLAS_TAR_STREAM_EXTRACTOR_HPP
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <data/String.hpp>
+
+#include "utils/Sha256.hpp"
+
+namespace fs = std::filesystem;
+
+namespace atlas {
+  /**
+   * @class TarStreamExtractor
+   * @brief Extracts a tar archive while it is still being received or decompressed.
+   *
+   * The archive is consumed front to back, so no seeking and no temporary copy of it is needed. Regular files,
+   * directories, symbolic and hard links are extracted; ustar, GNU long names and pax path records are understood.
+   * Entries leaving the target directory, directly or through a link extracted earlier, are rejected. Existing
+   * files are replaced instead of written through, so files hard linked elsewhere stay untouched.
+   */
+  class TarStreamExtractor {
+  public:
+    static constexpr size_t BLOCK_SIZE = 512;
+    static constexpr size_t MAX_METADATA_SIZE = 1 << 20;
+    static constexpr size_t MAX_MANIFEST_SIZE = 64 << 20;
+
+  private:
+    enum class State {
+      Header,
+      EntryData,
+      Metadata,
+      Padding,
+      Done,
+      Failed
+    };
+
+    /**
+     * @struct Entry
+     * @brief State of the entry currently being extracted.
+     */
+    struct Entry {
+      fs::path path;
+      char type;
+      uint32_t mode;
+      int64_t mtime;
+      uint64_t remaining;
+      uint64_t padding;
+      bool manifest;
+    };
+
+    fs::path m_target;
+    State m_state;
+    Entry m_entry;
+    unsigned char m_header[BLOCK_SIZE];
+    size_t m_header_size;
+    size_t m_zero_blocks;
+    std::string m_metadata;
+    std::string m_long_name;
+    std::string m_long_link;
+    int m_file;
+    std::set<fs::path> m_links;
+    std::vector<fs::path> m_files;
+    fs::path m_manifest_path;
+    std::string m_manifest;
+    bool m_hashing;
+    Sha256 m_hash;
+    std::map<fs::path, ntl::String> m_digests;
+    ntl::String m_error;
+
+  public:
+    /**
+     * @brief Constructor.
+     *
+     * @param a_target Directory to extract to, created if missing
+     */
+    explicit TarStreamExtractor(const fs::path& a_target);
+
+    /**
+     * @brief Destructor, closes a partially written file.
+     */
+    ~TarStreamExtractor();
+
+    TarStreamExtractor(const TarStreamExtractor&) = delete;
+    TarStreamExtractor& operator=(const TarStreamExtractor&) = delete;
+
+    /**
+     * @brief Reads the regular file with the given name into memory instead of extracting it.
+     *
+     * Must be called before the first Feed().
+     *
+     * @param a_name Name of the entry, relative to the archive root
+     */
+    void SetManifest(const fs::path& a_name);
+
+    /**
+     * @brief Enables computing the SHA-256 digest of every regular file while it is written.
+     *
+     * Must be called before the first Feed().
+     *
+     * @param a_enabled True to compute digests
+     */
+    void SetHashing(bool a_enabled) { m_hashing = a_enabled; }
+
+    /**
+     * @brief Consumes the next bytes of the archive.
+     *
+     * @param a_data Received bytes
+     * @param a_size Number of bytes
+     * @return True if the archive is valid so far, false otherwise
+     */
+    bool Feed(const void* a_data, size_t a_size);
+
+    /**
+     * @brief Checks whether the whole archive was extracted.
+     *
+     * @return True if the end of archive marker was reached without errors, false otherwise
+     */
+    bool Finish();
+
+    /**
+     * @brief Returns the number of entries extracted.
+     *
+     * @return The number of files, directories and links written
+     */
+    size_t GetFileCount() const { return m_files.size(); }
+
+    /**
+     * @brief Returns the entries extracted, relative to the target directory, in archive order.
+     *
+     * @return The extracted paths
+     */
+    const std::vector<fs::path>& GetFiles() const { return m_files; }
+
+    /**
+     * @brief Returns the contents of the entry selected with SetManifest().
+     *
+     * @return The contents, empty if the archive held no such entry
+     */
+    const std::string& GetManifest() const { return m_manifest; }
+
+    /**
+     * @brief Returns the lower case hex SHA-256 digests of the extracted regular files and hard links.
+     *
+     * @return The digests by path relative to the target directory, empty unless SetHashing() was enabled
+     */
+    const std::map<fs::path, ntl::String>& GetDigests() const { return m_digests; }
+
+    /**
+     * @brief Returns a description of the first error.
+     *
+     * @return The error, empty if there was none
+     */
+    const ntl::String& GetError() const { return m_error; }
+
+  private:
+    /**
+     * @brief Parses a complete header block and starts its entry.
+     *
+     * @return True if the header is valid, false otherwise
+     */
+    bool parseHeader();
+
+    /**
+     * @brief Creates the directory, link or file of the current entry.
+     *
+     * @param a_name Name of the entry
+     * @param a_link Target of a link entry
+     * @return True if successful, false otherwise
+     */
+    bool startEntry(const std::string& a_name, const std::string& a_link);
+
+    /**
+     * @brief Applies a completed long name or pax entry to the next header.
+     */
+    void finishMetadata();
+
+    /**
+     * @brief Closes the current file and restores its modification time.
+     *
+     * @return True if successful, false otherwise
+     */
+    bool finishFile();
+
+    /**
+     * @brief Resolves an entry name to its path relative to the target directory.
+     *
+     * @param a_name Name stored in the archive
+     * @param a_path Relative path to fill
+     * @return True if the entry lies inside the target directory, false otherwise
+     */
+    bool resolvePath(const std::string& a_name, fs::path& a_path) const;
+
+    /**
+     * @brief Records an error and stops the extraction.
+     *
+     * @param a_error Description of the error
+     * @return Always false
+     */
+    bool fail(const ntl::String& a_error);
+  };
+}
+
+#endif // ATLAS_TAR_STREAM_EXTRACTOR_HPP
@@ -0,0 +1,239 @@
+/**
+* @file TarWriter.cpp
+* @author Marcus Gugacs
+* @date 16.10.26
+* @copyright Copyright (c) 2026 Marcus Gugacs. All rights reserved.
+*/
+
+#include "TarWriter.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace atlas {
+  namespace {
+    constexpr size_t NAME_SIZE = 100;
+    constexpr size_t PREFIX_SIZE = 155;
+    constexpr size_t COPY_BUFFER_SIZE = 1 << 16;
+    constexpr char LONG_NAME_ENTRY[] = "././@LongLink";
+
+    /**
+     * @struct Header
+     * @brief On-disk layout of a ustar header block.
+     */
+    struct Header {
+      char name[100];
+      char mode[8];
+      char uid[8];
+      char gid[8];
+      char size[12];
+      char mtime[12];
+      char checksum[8];
+      char type;
+      char link[100];
+      char magic[6];
+      char version[2];
+      char user[32];
+      char group[32];
+      char device_major[8];
+      char device_minor[8];
+      char prefix[155];
+      char padding[12];
+    };
+    static_assert(sizeof(Header) == TarWriter::BLOCK_SIZE);
+
+    /**
+     * @brief Stores a number as zero padded octal, or base-256 if it does not fit.
+     */
+    void writeNumber(char* a_field, size_t a_size, uint64_t a_value) {
+      int digits = static_cast<int>(a_size - 1);
+      if (digits >= 22 || a_value < (uint64_t{1} << (3 * digits))) {
+        std::snprintf(a_field, a_size, "%0*llo", digits, static_cast<unsigned long long>(a_value));
+        return;
+      }
+
+      // GNU extension for sizes beyond 8 GiB: a set high bit followed by the big endian value
+      std::memset(a_field, 0, a_size);
+      for (size_t i = a_size - 1; i > 0 && a_value; --i, a_value >>= 8) {
+        a_field[i] = static_cast<char>(a_value & 0xff);
+      }
+      a_field[0] = static_cast<char>(0x80);
+    }
+
+    /**
+     * @brief Splits a name into the ustar prefix and name fields.
+     *
+     * @return True if the name fits, false if it needs a long name entry
+     */
+    bool splitName(const std::string& a_name, Header& a_header) {
+      if (a_name.size() <= NAME_SIZE) {
+        std::memcpy(a_header.name, a_name.data(), a_name.size());
+        return true;
+      }
+
+      for (size_t slash = a_name.find('/'); slash != std::string::npos; slash = a_name.find('/', slash + 1)) {
+        if (slash > PREFIX_SIZE)
+          break;
+        if (a_name.size() - slash - 1 <= NAME_SIZE && slash + 1 < a_name.size()) {
+          std::memcpy(a_header.prefix, a_name.data(), slash);
+          std::memcpy(a_header.name, a_name.data() + slash + 1, a_name.size() - slash - 1);
+          return true;
+        }
+      }
+      return false;
+    }
+  }
+
+  TarWriter::TarWriter(Sink a_sink)
+    : m_sink(std::move(a_sink)), m_buffer(COPY_BUFFER_SIZE), m_failed(false), m_error() {
+  }
+
+  bool TarWriter::Add(const fs::path& a_path, const std::string& a_name) {
+    if (m_failed)
+      return false;
+
+    struct stat info{};
+    if (lstat(a_path.c_str(), &info) != 0)
+      return fail(ntl::String{"Failed to read "} + a_path.c_str());
+
+    uint32_t mode = info.st_mode & 07777;
+    if (S_ISDIR(info.st_mode)) {
+      std::string name = a_name.empty() || a_name.back() == '/' ? a_name : a_name + "/";
+      return writeHeader(name, '5', mode, 0, info.st_mtime, "");
+    }
+
+    if (S_ISLNK(info.st_mode)) {
+      std::error_code error;
+      fs::path target = fs::read_symlink(a_path, error);
+      if (error)
+        return fail(ntl::String{"Failed to read link "} + a_path.c_str());
+      return writeHeader(a_name, '2', mode, 0, info.st_mtime, target.string());
+    }
+
+    if (!S_ISREG(info.st_mode))
+      return true;
+
+    auto size = static_cast<uint64_t>(info.st_size);
+    return writeHeader(a_name, '0', mode, size, info.st_mtime, "") && writeData(a_path, size);
+  }
+
+  bool TarWriter::AddData(const std::string& a_name, const std::string& a_data, uint32_t a_mode) {
+    if (m_failed)
+      return false;
+
+    if (!writeHeader(a_name, '0', a_mode, a_data.size(), std::time(nullptr), "") ||
+        !write(a_data.data(), a_data.size()))
+      return false;
+
+    char padding[BLOCK_SIZE] = {};
+    return write(padding, (BLOCK_SIZE - a_data.size() % BLOCK_SIZE) % BLOCK_SIZE);
+  }
+
+  bool TarWriter::Finish() {
+    if (m_failed)
+      return false;
+
+    char end[BLOCK_SIZE * 2] = {};
+    return write(end, sizeof(end));
+  }
+
+  bool TarWriter::writeHeader(const std::string& a_name, char a_type, uint32_t a_mode, uint64_t a_size,
+                              int64_t a_mtime, const std::string& a_link) {
+    Header header{};
+    if (!splitName(a_name, header)) {
+      if (!writeLongName('L', a_name))
+        return false;
+      std::memcpy(header.name, a_name.data(), NAME_SIZE);
+    }
+
+    if (a_link.size() > sizeof(header.link)) {
+      if (!writeLongName('K', a_link))
+        return false;
+      std::memcpy(header.link, a_link.data(), sizeof(header.link));
+    } else {
+      std::memcpy(header.link, a_link.data(), a_link.size());
+    }
+
+    writeNumber(header.mode, sizeof(header.mode), a_mode);
+    writeNumber(header.uid, sizeof(header.uid), 0);
+    writeNumber(header.gid, sizeof(header.gid), 0);
+    writeNumber(header.size, sizeof(header.size), a_size);
+    writeNumber(header.mtime, sizeof(header.mtime), static_cast<uint64_t>(std::max<int64_t>(a_mtime, 0)));
+    header.type = a_type;
+    std::memcpy(header.magic, "ustar", 6);
+    std::memcpy(header.version, "00", 2);
+
+    // The checksum is computed with its own field filled with spaces
+    std::memset(header.checksum, ' ', sizeof(header.checksum));
+    uint32_t checksum = 0;
+    for (size_t i = 0; i < BLOCK_SIZE; ++i) {
+      checksum += reinterpret_cast<const unsigned char*>(&header)[i];
+    }
+    std::snprintf(header.checksum, sizeof(header.checksum), "%06o", checksum);
+    header.checksum[7] = ' ';
+
+    return write(&header, sizeof(header));
+  }
+
+  bool TarWriter::writeLongName(char a_type, const std::string& a_name) {
+    // The name is stored as the data of a pseudo entry, including its terminator
+    size_t size = a_name.size() + 1;
+    if (!writeHeader(LONG_NAME_ENTRY, a_type, 0644, size, 0, "") || !write(a_name.c_str(), size))
+      return false;
+
+    char padding[BLOCK_SIZE] = {};
+    return write(padding, (BLOCK_SIZE - size % BLOCK_SIZE) % BLOCK_SIZE);
+  }
+
+  bool TarWriter::writeData(const fs::path& a_path, uint64_t a_size) {
+    int fd = open(a_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+      return fail(ntl::String{"Failed to open "} + a_path.c_str());
+
+    // The header already announced the size, a file that changed meanwhile is cut or padded to it
+    uint64_t remaining = a_size;
+    while (remaining > 0) {
+      size_t chunk = static_cast<size_t>(std::min<uint64_t>(remaining, m_buffer.size()));
+      ssize_t count = read(fd, m_buffer.data(), chunk);
+      if (count < 0) {
+        close(fd);
+        return fail(ntl::String{"Failed to read "} + a_path.c_str());
+      }
+      if (count == 0) {
+        std::memset(m_buffer.data(), 0, chunk);
+        count = static_cast<ssize_t>(chunk);
+      }
+      if (!write(m_buffer.data(), static_cast<size_t>(count))) {
+        close(fd);
+        return false;
+      }
+      remaining -= static_cast<uint64_t>(count);
+    }
+    close(fd);
+
+    char padding[BLOCK_SIZE] = {};
+    return write(padding, (BLOCK_SIZE - a_size % BLOCK_SIZE) % BLOCK_SIZE);
+  }
+
+  bool TarWriter::write(const void* a_data, size_t a_size) {
+    if (a_size == 0)
+      return true;
+    if (!m_sink(a_data, a_size))
+      return fail("Failed to write the archive");
+    return true;
+  }
+
+  bool TarWriter::fail(const ntl::String& a_error) {
+    if (!m_failed) {
+      m_error = a_error;
+      m_failed = true;
+    }
+    return false;
+  }
+}
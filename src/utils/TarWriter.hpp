@@ -0,0 +1,139 @@
+/**
+* @file TarWriter.hpp
+* @author Marcus Gugacs
+* @date 16.10.26
+* @copyright Copyright (c) 2026 Marcus Gugacs. All rights reserved.
+*/
+
+#ifndef ATLAS_TAR_WRITER_HPP
+#define ATLAS_TAR_WRITER_HPP
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <data/String.hpp>
+
+namespace fs = std::filesystem;
+
+namespace atlas {
+  /**
+   * @class TarWriter
+   * @brief Writes files, directories and symbolic links as a ustar archive.
+   *
+   * The archive is handed to a sink block by block, so it can be compressed or sent on without being kept in
+   * memory. Names longer than the ustar fields allow are stored with GNU long name entries.
+   */
+  class TarWriter {
+  public:
+    using Sink = std::function<bool(const void*, size_t)>;
+
+    static constexpr size_t BLOCK_SIZE = 512;
+
+  private:
+    Sink m_sink;
+    std::vector<char> m_buffer;
+    bool m_failed;
+    ntl::String m_error;
+
+  public:
+    /**
+     * @brief Constructor.
+     *
+     * @param a_sink Receives the archive, returns false to stop writing
+     */
+    explicit TarWriter(Sink a_sink);
+
+    TarWriter(const TarWriter&) = delete;
+    TarWriter& operator=(const TarWriter&) = delete;
+
+    /**
+     * @brief Adds a file, directory or symbolic link, links are stored as links and not followed.
+     *
+     * Other file types are skipped.
+     *
+     * @param a_path Path of the file on disk
+     * @param a_name Name to store in the archive, relative and using '/' as separator
+     * @return True if successful, false otherwise
+     */
+    bool Add(const fs::path& a_path, const std::string& a_name);
+
+    /**
+     * @brief Adds a regular file with the given contents, without a file on disk.
+     *
+     * @param a_name Name to store in the archive, relative and using '/' as separator
+     * @param a_data Contents of the file
+     * @param a_mode Permission bits
+     * @return True if successful, false otherwise
+     */
+    bool AddData(const std::string& a_name, const std::string& a_data, uint32_t a_mode);
+
+    /**
+     * @brief Writes the end of archive marker.
+     *
+     * @return True if the whole archive was written, false otherwise
+     */
+    bool Finish();
+
+    /**
+     * @brief Returns a description of the first error.
+     *
+     * @return The error, empty if there was none
+     */
+    const ntl::String& GetError() const { return m_error; }
+
+  private:
+    /**
+     * @brief Writes the header of an entry, preceded by long name entries if needed.
+     *
+     * @param a_name Name of the entry
+     * @param a_type Type flag
+     * @param a_mode Permission bits
+     * @param a_size Size of the data following the header
+     * @param a_mtime Modification time in seconds since the epoch
+     * @param a_link Target of a link entry
+     * @return True if successful, false otherwise
+     */
+    bool writeHeader(const std::string& a_name, char a_type, uint32_t a_mode, uint64_t a_size, int64_t a_mtime,
+                     const std::string& a_link);
+
+    /**
+     * @brief Writes a GNU long name entry holding a name that does not fit its header field.
+     *
+     * @param a_type 'L' for an entry name, 'K' for a link target
+     * @param a_name The name
+     * @return True if successful, false otherwise
+     */
+    bool writeLongName(char a_type, const std::string& a_name);
+
+    /**
+     * @brief Copies a file's contents into the archive and pads them to a full block.
+     *
+     * @param a_path Path of the file
+     * @param a_size Size the header announced
+     * @return True if successful, false otherwise
+     */
+    bool writeData(const fs::path& a_path, uint64_t a_size);
+
+    /**
+     * @brief Hands bytes to the sink.
+     *
+     * @param a_data Bytes to write
+     * @param a_size Number of bytes
+     * @return True if the sink accepted them, false otherwise
+     */
+    bool write(const void* a_data, size_t a_size);
+
+    /**
+     * @brief Records an error and stops writing.
+     *
+     * @param a_error Description of the error
+     * @return Always false
+     */
+    bool fail(const ntl::String& a_error);
+  };
+}
+
+#endif // ATLAS_TAR_WRITER_HPP
@@ -0,0 +1,178 @@
+/**
+* @file TaskGraph.cpp
+* @author Marcus Gugacs
+* @date 16.10.26
+* @copyright Copyright (c) 2026 Marcus Gugacs. All rights reserved.
+*/
+
+#include "TaskGraph.hpp"
+
+#include <algorithm>
+
+#include "JobSystem.hpp"
+#include "core/Assert.hpp"
+#include "os/ScopeLock.hpp"
+
+using namespace ntl;
+
+namespace atlas {
+  TaskGraph::TaskGraph()
+    : m_nodes{}, m_lock{}, m_finished_changed{&m_lock}, m_finished{0}, m_start{} {
+  }
+
+  size_t TaskGraph::AddTask(const ntl::String& a_name, Task a_task) {
+    m_nodes.push_back(Node{a_name, std::move(a_task), {}, {}, 0, Status::Pending, {}, {}, NONE});
+    return m_nodes.size() - 1;
+  }
+
+  void TaskGraph::AddDependency(size_t a_task, size_t a_dependency) {
+    VERIFY(a_task < m_nodes.size() && a_dependency < m_nodes.size() && "TaskGraph task id out of range")
+
+    auto& dependencies = m_nodes[a_task].dependencies;
+    if (a_task == a_dependency || std::find(dependencies.begin(), dependencies.end(), a_dependency) != dependencies.end())
+      return;
+
+    dependencies.push_back(a_dependency);
+    m_nodes[a_dependency].dependents.push_back(a_task);
+  }
+
+  bool TaskGraph::Validate(ntl::String& a_cycle) const {
+    std::vector<size_t> remaining(m_nodes.size());
+    std::vector<size_t> ready;
+    for (size_t i = 0; i < m_nodes.size(); ++i) {
+      remaining[i] = m_nodes[i].dependencies.size();
+      if (remaining[i] == 0) {
+        ready.push_back(i);
+      }
+    }
+
+    size_t visited = 0;
+    while (!ready.empty()) {
+      size_t node = ready.back();
+      ready.pop_back();
+      ++visited;
+      for (size_t dependent : m_nodes[node].dependents) {
+        if (--remaining[dependent] == 0) {
+          ready.push_back(dependent);
+        }
+      }
+    }
+
+    if (visited == m_nodes.size())
+      return true;
+
+    a_cycle = "";
+    for (size_t i = 0; i < m_nodes.size(); ++i) {
+      if (remaining[i] > 0) {
+        a_cycle += (a_cycle.IsEmpty() ? "" : ", ") + m_nodes[i].name;
+      }
+    }
+    return false;
+  }
+
+  bool TaskGraph::Run() {
+    VERIFY(JobSystem::Instance().IsInitialized() && "JobSystem must be initialized prior to use")
+
+    ntl::String cycle;
+    VERIFY(Validate(cycle) && "TaskGraph must be acyclic")
+
+    m_lock.Acquire();
+    m_start = Clock::now();
+    m_finished = 0;
+    std::vector<size_t> ready;
+    for (size_t i = 0; i < m_nodes.size(); ++i) {
+      m_nodes[i].remaining = m_nodes[i].dependencies.size();
+      m_nodes[i].status = Status::Pending;
+      m_nodes[i].gate = NONE;
+      if (m_nodes[i].remaining == 0) {
+        ready.push_back(i);
+      }
+    }
+    for (size_t node : ready) {
+      schedule(node);
+    }
+
+    while (m_finished < m_nodes.size())
+      m_finished_changed.Wait();
+    m_lock.Release();
+
+    return std::all_of(m_nodes.begin(), m_nodes.end(), [](const Node& a_node) {
+      return a_node.status == Status::Succeeded;
+    });
+  }
+
+  std::chrono::duration<double> TaskGraph::GetDuration(size_t a_task) const {
+    const Node& node = m_nodes[a_task];
+    if (node.status != Status::Succeeded && node.status != Status::Failed)
+      return std::chrono::duration<double>::zero();
+    return node.finish - node.start;
+  }
+
+  std::vector<size_t> TaskGraph::GetCriticalPath() const {
+    size_t last = NONE;
+    for (size_t i = 0; i < m_nodes.size(); ++i) {
+      if (m_nodes[i].status != Status::Succeeded && m_nodes[i].status != Status::Failed)
+        continue;
+      if (last == NONE || m_nodes[i].finish > m_nodes[last].finish) {
+        last = i;
+      }
+    }
+
+    std::vector<size_t> path;
+    for (size_t node = last; node != NONE; node = m_nodes[node].gate) {
+      path.push_back(node);
+    }
+    std::reverse(path.begin(), path.end());
+    return path;
+  }
+
+  void TaskGraph::schedule(size_t a_task) {
+    m_nodes[a_task].status = Status::Running;
+    JobSystem::Instance().AddJob([this, a_task]() {
+      Node& node = m_nodes[a_task];
+      node.start = Clock::now();
+      bool success = node.task();
+      node.finish = Clock::now();
+      complete(a_task, success);
+    });
+  }
+
+  void TaskGraph::complete(size_t a_task, bool a_success) {
+    ScopeLock lock(&m_lock);
+
+    Node& node = m_nodes[a_task];
+    node.status = a_success ? Status::Succeeded : Status::Failed;
+    ++m_finished;
+
+    for (size_t dependent : node.dependents) {
+      Node& next = m_nodes[dependent];
+      if (next.status != Status::Pending)
+        continue;
+
+      if (!a_success) {
+        skip(dependent);
+        continue;
+      }
+
+      // The dependency finishing last is the one that held this task back
+      next.gate = a_task;
+      if (--next.remaining == 0) {
+        schedule(dependent);
+      }
+    }
+
+    m_finished_changed.Broadcast();
+  }
+
+  void TaskGraph::skip(size_t a_task) {
+    Node& node = m_nodes[a_task];
+    if (node.status != Status::Pending)
+      return;
+
+    node.status = Status::Skipped;
+    ++m_finished;
+    for (size_t dependent : node.dependents) {
+      skip(dependent);
+    }
+  }
+}
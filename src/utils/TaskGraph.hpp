@@ -0,0 +1,168 @@
+/**
+* @file TaskGraph.hpp
+* @author Marcus Gugacs
+* @date 16.10.26
+* @copyright Copyright (c) 2026 Marcus Gugacs. All rights reserved.
+*/
+
+#ifndef ATLAS_TASK_GRAPH_HPP
+#define ATLAS_TASK_GRAPH_HPP
+
+#include <chrono>
+#include <functional>
+#include <vector>
+
+#include "data/String.hpp"
+#include "os/Condition.hpp"
+#include "os/Lock.hpp"
+
+namespace atlas {
+  /**
+   * @brief TaskGraph class running a DAG of tasks on the job system.
+   *
+   * A task is handed to the job system as soon as the last of its dependencies succeeded, so independent
+   * branches run in parallel and the total time is bounded by the longest chain rather than the number of
+   * tasks. A failing task only takes down the tasks that (transitively) depend on it.
+   */
+  class TaskGraph {
+  public:
+    using Task = std::function<bool()>;
+
+    /**
+     * @brief State of a task.
+     */
+    enum class Status {
+      Pending,
+      Running,
+      Succeeded,
+      Failed,
+      Skipped
+    };
+
+  private:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @struct Node
+     * @brief A task and its edges.
+     */
+    struct Node {
+      ntl::String name;
+      Task task;
+      std::vector<size_t> dependencies;
+      std::vector<size_t> dependents;
+      size_t remaining;
+      Status status;
+      Clock::time_point start;
+      Clock::time_point finish;
+      size_t gate;
+    };
+
+    std::vector<Node> m_nodes;
+    ntl::Lock m_lock;
+    ntl::Condition m_finished_changed;
+    size_t m_finished;
+    Clock::time_point m_start;
+
+  public:
+    static constexpr size_t NONE = static_cast<size_t>(-1);
+
+    /**
+     * @brief Default Constructor.
+     */
+    TaskGraph();
+
+    TaskGraph(const TaskGraph&) = delete;
+    TaskGraph& operator=(const TaskGraph&) = delete;
+
+    /**
+     * @brief Adds a task.
+     * @param a_name the name used in reports
+     * @param a_task the work to do, returning whether it succeeded
+     * @return the id of the task
+     */
+    size_t AddTask(const ntl::String& a_name, Task a_task);
+
+    /**
+     * @brief Makes a task wait for another one to succeed.
+     * @param a_task the id of the dependent task
+     * @param a_dependency the id of the task it depends on
+     */
+    void AddDependency(size_t a_task, size_t a_dependency);
+
+    /**
+     * @brief Checks that the dependencies do not form a cycle.
+     * @param a_cycle receives the names of the tasks on a cycle, if any
+     * @return if the graph can be run
+     */
+    bool Validate(ntl::String& a_cycle) const;
+
+    /**
+     * @brief Runs all tasks on the job system and waits for them to finish.
+     *
+     * Must not be called from a job system worker. The graph has to be acyclic, see Validate().
+     *
+     * @return if every task succeeded
+     */
+    bool Run();
+
+    /**
+     * @brief Returns the number of tasks.
+     * @return the number of tasks
+     */
+    size_t GetTaskCount() const { return m_nodes.size(); }
+
+    /**
+     * @brief Returns the name of a task.
+     * @param a_task the id of the task
+     * @return the name of the task
+     */
+    const ntl::String& GetName(size_t a_task) const { return m_nodes[a_task].name; }
+
+    /**
+     * @brief Returns the state of a task.
+     * @param a_task the id of the task
+     * @return the state of the task
+     */
+    Status GetStatus(size_t a_task) const { return m_nodes[a_task].status; }
+
+    /**
+     * @brief Returns how long a task ran.
+     * @param a_task the id of the task
+     * @return the duration of the task, zero if it did not run
+     */
+    std::chrono::duration<double> GetDuration(size_t a_task) const;
+
+    /**
+     * @brief Returns the chain of tasks that determined the total run time.
+     *
+     * Starts at the task that finished last and follows, for every task, the dependency that finished last
+     * and therefore released it.
+     *
+     * @return the ids of the tasks on the critical path, in execution order
+     */
+    std::vector<size_t> GetCriticalPath() const;
+
+  private:
+    /**
+     * @brief Hands a ready task to the job system.
+     * @param a_task the id of the task
+     */
+    void schedule(size_t a_task);
+
+    /**
+     * @brief Records the outcome of a task and releases or skips its dependents.
+     * @param a_task the id of the task
+     * @param a_success if the task succeeded
+     */
+    void complete(size_t a_task, bool a_success);
+
+    /**
+     * @brief Marks a task and everything depending on it as skipped.
+     * @param a_task the id of the task
+     */
+    void skip(size_t a_task);
+  };
+}
+
+#endif // ATLAS_TASK_GRAPH_HPP
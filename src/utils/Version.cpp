@@ -0,0 +1,166 @@
+/**
+* @file Version.cpp
+* @author Marcus Gugacs
+* @date 16.10.26
+* @copyright Copyright (c) 2026 Marcus Gugacs. All rights reserved.
+*/
+
+#include "Version.hpp"
+
+#include <algorithm>
+#include <string_view>
+
+namespace atlas {
+  namespace {
+    constexpr std::string_view OPERATOR_CHARACTERS = "<>=!";
+    constexpr std::string_view WHITESPACE = " \t";
+
+    std::string_view trim(std::string_view a_text) {
+      size_t begin = a_text.find_first_not_of(WHITESPACE);
+      if (begin == std::string_view::npos)
+        return {};
+      size_t end = a_text.find_last_not_of(WHITESPACE);
+      return a_text.substr(begin, end - begin + 1);
+    }
+
+    /**
+     * @brief Compares dot separated components, missing trailing components count as 0.
+     */
+    int compareComponents(std::string_view a_lhs, std::string_view a_rhs) {
+      while (!a_lhs.empty() || !a_rhs.empty()) {
+        size_t lhs_end = std::min(a_lhs.find('.'), a_lhs.size());
+        size_t rhs_end = std::min(a_rhs.find('.'), a_rhs.size());
+        std::string_view lhs = a_lhs.substr(0, lhs_end);
+        std::string_view rhs = a_rhs.substr(0, rhs_end);
+        a_lhs.remove_prefix(std::min(lhs_end + 1, a_lhs.size()));
+        a_rhs.remove_prefix(std::min(rhs_end + 1, a_rhs.size()));
+
+        bool lhs_numeric = !lhs.empty() && lhs.find_first_not_of("0123456789") == std::string_view::npos;
+        bool rhs_numeric = !rhs.empty() && rhs.find_first_not_of("0123456789") == std::string_view::npos;
+
+        if ((lhs_numeric || lhs.empty()) && (rhs_numeric || rhs.empty())) {
+          // Compare without converting so arbitrarily long numbers work, leading zeros are not significant
+          while (lhs.size() > 1 && lhs.front() == '0') lhs.remove_prefix(1);
+          while (rhs.size() > 1 && rhs.front() == '0') rhs.remove_prefix(1);
+          if (lhs.empty()) lhs = "0";
+          if (rhs.empty()) rhs = "0";
+          if (lhs.size() != rhs.size())
+            return lhs.size() < rhs.size() ? -1 : 1;
+        } else if (lhs_numeric != rhs_numeric) {
+          // Numbers sort before words, e.g. 1.0.1 < 1.0.beta
+          return lhs_numeric ? -1 : 1;
+        }
+
+        if (int result = lhs.compare(rhs); result != 0)
+          return result < 0 ? -1 : 1;
+      }
+      return 0;
+    }
+  }
+
+  int Version::Compare(const ntl::String& a_lhs, const ntl::String& a_rhs) {
+    std::string_view lhs = trim(a_lhs.GetCString());
+    std::string_view rhs = trim(a_rhs.GetCString());
+
+    lhs = lhs.substr(0, lhs.find('+'));
+    rhs = rhs.substr(0, rhs.find('+'));
+    if (!lhs.empty() && (lhs.front() == 'v' || lhs.front() == 'V')) lhs.remove_prefix(1);
+    if (!rhs.empty() && (rhs.front() == 'v' || rhs.front() == 'V')) rhs.remove_prefix(1);
+
+    size_t lhs_dash = lhs.find('-');
+    size_t rhs_dash = rhs.find('-');
+    if (int result = compareComponents(lhs.substr(0, lhs_dash), rhs.substr(0, rhs_dash)); result != 0)
+      return result;
+
+    // A pre-release precedes the release it leads up to
+    bool lhs_pre = lhs_dash != std::string_view::npos;
+    bool rhs_pre = rhs_dash != std::string_view::npos;
+    if (lhs_pre != rhs_pre)
+      return lhs_pre ? -1 : 1;
+    if (!lhs_pre)
+      return 0;
+
+    return compareComponents(lhs.substr(lhs_dash + 1), rhs.substr(rhs_dash + 1));
+  }
+
+  bool VersionRequirement::Parse(const ntl::String& a_spec, VersionRequirement& a_requirement) {
+    std::string_view spec = trim(a_spec.GetCString());
+    size_t name_end = std::min(spec.find_first_of(OPERATOR_CHARACTERS), spec.size());
+    std::string_view name = trim(spec.substr(0, name_end));
+    if (name.empty() || name.find_first_of(WHITESPACE) != std::string_view::npos)
+      return false;
+
+    a_requirement.m_name = std::string(name).c_str();
+    a_requirement.m_constraints.clear();
+
+    std::string_view rest = spec.substr(name_end);
+    while (!rest.empty()) {
+      size_t clause_end = std::min(rest.find(','), rest.size());
+      std::string_view clause = trim(rest.substr(0, clause_end));
+      rest.remove_prefix(std::min(clause_end + 1, rest.size()));
+
+      Operator op;
+      if (clause.starts_with(">=")) {
+        op = Operator::GreaterEqual;
+      } else if (clause.starts_with("<=")) {
+        op = Operator::LessEqual;
+      } else if (clause.starts_with("==")) {
+        op = Operator::Equal;
+      } else if (clause.starts_with("!=")) {
+        op = Operator::NotEqual;
+      } else if (clause.starts_with(">")) {
+        op = Operator::Greater;
+      } else if (clause.starts_with("<")) {
+        op = Operator::Less;
+      } else if (clause.starts_with("=")) {
+        op = Operator::Equal;
+      } else {
+        return false;
+      }
+
+      size_t version_begin = std::min(clause.find_first_not_of(OPERATOR_CHARACTERS), clause.size());
+      std::string_view version = trim(clause.substr(version_begin));
+      if (version.empty() || version.find_first_of(OPERATOR_CHARACTERS) != std::string_view::npos)
+        return false;
+
+      a_requirement.m_constraints.push_back({op, std::string(version).c_str()});
+    }
+
+    return true;
+  }
+
+  bool VersionRequirement::Matches(const ntl::String& a_version) const {
+    for (const auto& constraint : m_constraints) {
+      int result = Version::Compare(a_version, constraint.version);
+      bool matches = false;
+      switch (constraint.op) {
+        case Operator::Equal:
+          matches = result == 0;
+          break;
+        case Operator::NotEqual:
+          matches = result != 0;
+          break;
+        case Operator::Less:
+          matches = result < 0;
+          break;
+        case Operator::LessEqual:
+          matches = result <= 0;
+          break;
+        case Operator::Greater:
+          matches = result > 0;
+          break;
+        case Operator::GreaterEqual:
+          matches = result >= 0;
+          break;
+      }
+      if (!matches)
+        return false;
+    }
+    return true;
+  }
+
+  ntl::String VersionRequirement::GetName(const ntl::String& a_spec) {
+    std::string_view spec = trim(a_spec.GetCString());
+    return std::string(trim(spec.substr(0, std::min(spec.find_first_of(OPERATOR_CHARACTERS), spec.size())))).c_str();
+  }
+}
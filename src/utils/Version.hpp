@@ -0,0 +1,102 @@
+/**
+* @file Version.hpp
+* @author Marcus Gugacs
+* @date 16.10.26
+* @copyright Copyright (c) 2026 Marcus Gugacs. All rights reserved.
+*/
+
+#ifndef ATLAS_VERSION_HPP
+#define ATLAS_VERSION_HPP
+
+#include <string>
+#include <vector>
+
+#include <data/String.hpp>
+
+namespace atlas {
+  /**
+   * @class Version
+   * @brief Ordering of package version strings.
+   *
+   * Versions are compared component by component, numerically where both components are numbers. A pre-release
+   * suffix after '-' sorts before the plain version and build metadata after '+' is ignored, so
+   * 1.2 == 1.2.0 < 1.10.0-rc1 < 1.10.0.
+   */
+  class Version {
+  public:
+    /**
+     * @brief Compares two versions.
+     *
+     * @param a_lhs First version
+     * @param a_rhs Second version
+     * @return Negative if a_lhs is older, positive if it is newer, 0 if both are equal
+     */
+    static int Compare(const ntl::String& a_lhs, const ntl::String& a_rhs);
+  };
+
+  /**
+   * @class VersionRequirement
+   * @brief A package name with an optional set of version constraints, e.g. "openssl >=1.1, <3".
+   *
+   * Supported operators are =, ==, !=, <, <=, > and >=, multiple constraints are separated by commas and must
+   * all hold. A bare name accepts every version.
+   */
+  class VersionRequirement {
+  private:
+    enum class Operator {
+      Equal,
+      NotEqual,
+      Less,
+      LessEqual,
+      Greater,
+      GreaterEqual
+    };
+
+    /**
+     * @struct Constraint
+     * @brief A single operator and the version it compares against.
+     */
+    struct Constraint {
+      Operator op;
+      ntl::String version;
+    };
+
+    ntl::String m_name;
+    std::vector<Constraint> m_constraints;
+
+  public:
+    /**
+     * @brief Parses a requirement.
+     *
+     * @param a_spec Requirement as written in a package manifest
+     * @param a_requirement Requirement to fill
+     * @return True if the requirement is well-formed, false otherwise
+     */
+    static bool Parse(const ntl::String& a_spec, VersionRequirement& a_requirement);
+
+    /**
+     * @brief Returns the name of the required package.
+     *
+     * @return The package name
+     */
+    const ntl::String& GetName() const { return m_name; }
+
+    /**
+     * @brief Checks whether a version satisfies all constraints.
+     *
+     * @param a_version Version to check
+     * @return True if the version is accepted, false otherwise
+     */
+    bool Matches(const ntl::String& a_version) const;
+
+    /**
+     * @brief Extracts the package name of a requirement without validating the constraints.
+     *
+     * @param a_spec Requirement as written in a package manifest
+     * @return The package name
+     */
+    static ntl::String GetName(const ntl::String& a_spec);
+  };
+}
+
+#endif // ATLAS_VERSION_HPP
@@ -0,0 +1,150 @@
+/**
+* @file WorkStealingDeque.hpp
+* @author Marcus Gugacs
+* @date 16.10.26
+* @copyright Copyright (c) 2026 Marcus Gugacs. All rights reserved.
+*/
+
+#ifndef ATLAS_WORK_STEALING_DEQUE_HPP
+#define ATLAS_WORK_STEALING_DEQUE_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace atlas {
+  /**
+   * @brief Chase-Lev work stealing deque of pointers.
+   *
+   * The owning thread pushes and pops at the bottom without locking, any other thread steals from the top. The
+   * buffer grows when full, replaced buffers are kept until the deque is destroyed since a thief may still be
+   * reading from them.
+   */
+  template<typename T>
+  class WorkStealingDeque {
+  private:
+    /**
+     * @struct Buffer
+     * @brief Circular array with a power of two capacity.
+     */
+    struct Buffer {
+      int64_t capacity;
+      std::unique_ptr<std::atomic<T*>[]> slots;
+
+      explicit Buffer(int64_t a_capacity) : capacity{a_capacity}, slots{new std::atomic<T*>[a_capacity]} {}
+
+      T* Get(int64_t a_index) const { return slots[a_index & (capacity - 1)].load(std::memory_order_relaxed); }
+
+      void Put(int64_t a_index, T* a_item) { slots[a_index & (capacity - 1)].store(a_item, std::memory_order_relaxed); }
+    };
+
+    alignas(64) std::atomic<int64_t> m_top;
+    alignas(64) std::atomic<int64_t> m_bottom;
+    std::atomic<Buffer*> m_buffer;
+    std::vector<std::unique_ptr<Buffer>> m_buffers;
+
+  public:
+    /**
+     * @brief Constructor.
+     * @param a_capacity the initial capacity, must be a power of two
+     */
+    explicit WorkStealingDeque(int64_t a_capacity = 256) : m_top{0}, m_bottom{0}, m_buffer{nullptr}, m_buffers{} {
+      m_buffers.emplace_back(new Buffer(a_capacity));
+      m_buffer.store(m_buffers.back().get(), std::memory_order_relaxed);
+    }
+
+    WorkStealingDeque(const WorkStealingDeque&) = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+    /**
+     * @brief Adds an item at the bottom, only called by the owning thread.
+     * @param a_item the item to add
+     */
+    void Push(T* a_item) {
+      int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+      int64_t top = m_top.load(std::memory_order_acquire);
+      Buffer* buffer = m_buffer.load(std::memory_order_relaxed);
+
+      if (bottom - top > buffer->capacity - 1) {
+        buffer = grow(buffer, top, bottom);
+      }
+
+      buffer->Put(bottom, a_item);
+      std::atomic_thread_fence(std::memory_order_release);
+      m_bottom.store(bottom + 1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Removes the most recently pushed item, only called by the owning thread.
+     * @return the item or nullptr if the deque is empty
+     */
+    T* Pop() {
+      int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+      Buffer* buffer = m_buffer.load(std::memory_order_relaxed);
+      m_bottom.store(bottom, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      int64_t top = m_top.load(std::memory_order_relaxed);
+
+      if (top > bottom) {
+        m_bottom.store(bottom + 1, std::memory_order_relaxed);
+        return nullptr;
+      }
+
+      T* item = buffer->Get(bottom);
+      if (top == bottom) {
+        // Last item, race the thieves for it
+        if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+          item = nullptr;
+        }
+        m_bottom.store(bottom + 1, std::memory_order_relaxed);
+      }
+      return item;
+    }
+
+    /**
+     * @brief Removes the oldest item, may be called by any thread.
+     * @return the item or nullptr if the deque is empty or another thread won the race for it
+     */
+    T* Steal() {
+      int64_t top = m_top.load(std::memory_order_acquire);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      int64_t bottom = m_bottom.load(std::memory_order_acquire);
+
+      if (top >= bottom)
+        return nullptr;
+
+      T* item = m_buffer.load(std::memory_order_acquire)->Get(top);
+      if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        return nullptr;
+      return item;
+    }
+
+    /**
+     * @brief Checks whether the deque looks empty, the answer may be outdated as soon as it is returned.
+     * @return if no items were visible
+     */
+    bool IsEmpty() const {
+      return m_bottom.load(std::memory_order_relaxed) <= m_top.load(std::memory_order_relaxed);
+    }
+
+  private:
+    /**
+     * @brief Replaces the buffer with one of twice the capacity, only called by the owning thread.
+     * @return the new buffer
+     */
+    Buffer* grow(Buffer* a_buffer, int64_t a_top, int64_t a_bottom) {
+      auto bigger = std::make_unique<Buffer>(a_buffer->capacity * 2);
+      for (int64_t i = a_top; i < a_bottom; ++i) {
+        bigger->Put(i, a_buffer->Get(i));
+      }
+
+      Buffer* result = bigger.get();
+      m_buffers.push_back(std::move(bigger));
+      m_buffer.store(result, std::memory_order_release);
+      return result;
+    }
+  };
+}
+
+#endif // ATLAS_WORK_STEALING_DEQUE_HPP
@@ -0,0 +1,334 @@
+/**
+* @file ZipStreamExtractor.cpp
+* @author Marcus Gugacs
+* @date 16.10.26
+* @copyright Copyright (c) 2026 Marcus Gugacs. All rights reserved.
+*/
+
+#include "ZipStreamExtractor.hpp"
+
+#include <algorithm>
+#include <string>
+
+namespace atlas {
+  namespace {
+    constexpr uint32_t LOCAL_HEADER_SIGNATURE = 0x04034b50;
+    constexpr uint32_t CENTRAL_HEADER_SIGNATURE = 0x02014b50;
+    constexpr uint32_t END_OF_CENTRAL_DIRECTORY_SIGNATURE = 0x06054b50;
+    constexpr uint32_t DATA_DESCRIPTOR_SIGNATURE = 0x08074b50;
+
+    constexpr size_t LOCAL_HEADER_SIZE = 30;
+    constexpr uint16_t ZIP64_EXTRA_ID = 0x0001;
+    constexpr uint32_t ZIP64_MARKER = 0xffffffff;
+
+    constexpr uint16_t FLAG_ENCRYPTED = 1 << 0;
+    constexpr uint16_t FLAG_DATA_DESCRIPTOR = 1 << 3;
+
+    constexpr uint16_t METHOD_STORED = 0;
+    constexpr uint16_t METHOD_DEFLATED = 8;
+
+    constexpr size_t OUTPUT_BUFFER_SIZE = 1 << 16;
+
+    inline uint16_t read16(const unsigned char* a_data) {
+      return static_cast<uint16_t>(a_data[0] | (a_data[1] << 8));
+    }
+
+    inline uint32_t read32(const unsigned char* a_data) {
+      return static_cast<uint32_t>(read16(a_data)) | (static_cast<uint32_t>(read16(a_data + 2)) << 16);
+    }
+
+    inline uint64_t read64(const unsigned char* a_data) {
+      return static_cast<uint64_t>(read32(a_data)) | (static_cast<uint64_t>(read32(a_data + 4)) << 32);
+    }
+  }
+
+  ZipStreamExtractor::ZipStreamExtractor(const fs::path& a_target, size_t a_strip_components, Filter a_filter)
+    : m_target(a_target), m_strip_components(a_strip_components), m_filter(std::move(a_filter)),
+      m_state(State::LocalHeader), m_entry(), m_buffer(), m_offset(0), m_output(OUTPUT_BUFFER_SIZE), m_stream(),
+      m_stream_initialized(false), m_file(nullptr), m_file_count(0), m_error() {
+  }
+
+  ZipStreamExtractor::~ZipStreamExtractor() {
+    if (m_file) {
+      fclose(m_file);
+    }
+    if (m_stream_initialized) {
+      inflateEnd(&m_stream);
+    }
+  }
+
+  bool ZipStreamExtractor::Feed(const void* a_data, size_t a_size) {
+    if (m_state == State::Failed)
+      return false;
+    if (m_state == State::Done)
+      return true;
+
+    // Drop consumed bytes before growing the buffer so it stays around the size of one network read
+    if (m_offset > 0) {
+      m_buffer.erase(m_buffer.begin(), m_buffer.begin() + static_cast<std::ptrdiff_t>(m_offset));
+      m_offset = 0;
+    }
+    const auto* data = static_cast<const unsigned char*>(a_data);
+    m_buffer.insert(m_buffer.end(), data, data + a_size);
+
+    bool progress = true;
+    while (progress) {
+      switch (m_state) {
+        case State::LocalHeader:
+          progress = parseLocalHeader();
+          break;
+        case State::EntryData:
+          progress = processEntryData();
+          break;
+        case State::DataDescriptor:
+          progress = parseDataDescriptor();
+          break;
+        case State::Done:
+        case State::Failed:
+          progress = false;
+          break;
+      }
+    }
+
+    return m_state != State::Failed;
+  }
+
+  bool ZipStreamExtractor::Finish() {
+    if (m_state != State::Done && m_state != State::Failed) {
+      fail("Unexpected end of archive");
+    }
+    return m_state == State::Done;
+  }
+
+  bool ZipStreamExtractor::parseLocalHeader() {
+    size_t available = m_buffer.size() - m_offset;
+    if (available < 4)
+      return false;
+
+    const unsigned char* header = m_buffer.data() + m_offset;
+    uint32_t signature = read32(header);
+    if (signature == CENTRAL_HEADER_SIGNATURE || signature == END_OF_CENTRAL_DIRECTORY_SIGNATURE) {
+      // Everything after the last entry only repeats what the local headers already said
+      m_state = State::Done;
+      return false;
+    }
+    if (signature != LOCAL_HEADER_SIGNATURE)
+      return fail("Invalid local file header");
+
+    if (available < LOCAL_HEADER_SIZE)
+      return false;
+
+    uint16_t name_size = read16(header + 26);
+    uint16_t extra_size = read16(header + 28);
+    if (available < LOCAL_HEADER_SIZE + name_size + extra_size)
+      return false;
+
+    Entry entry{};
+    entry.flags = read16(header + 6);
+    entry.method = read16(header + 8);
+    entry.crc = read32(header + 14);
+    entry.compressed_size = read32(header + 18);
+    uint32_t size = read32(header + 22);
+
+    const unsigned char* extra = header + LOCAL_HEADER_SIZE + name_size;
+    for (size_t i = 0; i + 4 <= extra_size;) {
+      uint16_t id = read16(extra + i);
+      uint16_t field_size = read16(extra + i + 2);
+      if (id == ZIP64_EXTRA_ID) {
+        entry.zip64 = true;
+        // The original size comes first and each value is only present if its header field is saturated
+        size_t field = i + 4;
+        if (size == ZIP64_MARKER)
+          field += 8;
+        if (entry.compressed_size == ZIP64_MARKER && field + 8 <= i + 4 + field_size && field + 8 <= extra_size)
+          entry.compressed_size = read64(extra + field);
+      }
+      i += 4 + field_size;
+    }
+
+    if (entry.flags & FLAG_ENCRYPTED)
+      return fail("Encrypted archives are not supported");
+    if (entry.method != METHOD_STORED && entry.method != METHOD_DEFLATED)
+      return fail(ntl::String{"Unsupported compression method "} + static_cast<int>(entry.method));
+
+    bool known_size = !(entry.flags & FLAG_DATA_DESCRIPTOR) || entry.compressed_size != 0;
+    if (entry.method == METHOD_STORED && !known_size)
+      return fail("Stored entries of unknown size are not supported");
+
+    std::string name(reinterpret_cast<const char*>(header + LOCAL_HEADER_SIZE), name_size);
+    m_offset += LOCAL_HEADER_SIZE + name_size + extra_size;
+
+    bool directory = !name.empty() && name.back() == '/';
+    entry.write = !directory && resolvePath(name, entry.path) && (!m_filter || m_filter(entry.path));
+    entry.actual_crc = static_cast<uint32_t>(crc32(0, nullptr, 0));
+    m_entry = std::move(entry);
+
+    if (m_entry.write) {
+      fs::path path = m_target / m_entry.path;
+      std::error_code error;
+      fs::create_directories(path.parent_path(), error);
+      m_file = fopen(path.c_str(), "wb");
+      if (!m_file)
+        return fail(ntl::String{"Failed to create "} + path.c_str());
+    }
+
+    if (m_entry.method == METHOD_DEFLATED) {
+      int result = m_stream_initialized ? inflateReset(&m_stream) : inflateInit2(&m_stream, -MAX_WBITS);
+      if (result != Z_OK)
+        return fail("Failed to initialize inflate");
+      m_stream_initialized = true;
+    }
+
+    m_state = State::EntryData;
+    return true;
+  }
+
+  bool ZipStreamExtractor::processEntryData() {
+    size_t available = m_buffer.size() - m_offset;
+    bool known_size = !(m_entry.flags & FLAG_DATA_DESCRIPTOR) || m_entry.compressed_size != 0;
+    if (known_size) {
+      available = static_cast<size_t>(std::min<uint64_t>(available, m_entry.compressed_size - m_entry.consumed));
+    }
+
+    const unsigned char* data = m_buffer.data() + m_offset;
+
+    // Entries nobody wants are skipped without inflating them whenever their size is known
+    if (m_entry.method == METHOD_STORED || (!m_entry.write && known_size)) {
+      if (available == 0 && m_entry.consumed < m_entry.compressed_size)
+        return false;
+
+      if (!writeOutput(data, available))
+        return false;
+      m_offset += available;
+      m_entry.consumed += available;
+      if (m_entry.consumed < m_entry.compressed_size)
+        return available > 0;
+    } else {
+      if (available == 0)
+        return false;
+
+      m_stream.next_in = const_cast<Bytef*>(data);
+      m_stream.avail_in = static_cast<uInt>(std::min<size_t>(available, UINT32_MAX));
+
+      bool ended = false;
+      for (;;) {
+        m_stream.next_out = m_output.data();
+        m_stream.avail_out = static_cast<uInt>(m_output.size());
+
+        int result = inflate(&m_stream, Z_NO_FLUSH);
+        if (result != Z_OK && result != Z_STREAM_END && result != Z_BUF_ERROR)
+          return fail("Corrupt compressed data");
+
+        size_t produced = m_output.size() - m_stream.avail_out;
+        if (!writeOutput(m_output.data(), produced))
+          return false;
+
+        if (result == Z_STREAM_END) {
+          ended = true;
+          break;
+        }
+        if (m_stream.avail_out != 0 || (result == Z_BUF_ERROR && produced == 0))
+          break;
+      }
+
+      size_t consumed = available - m_stream.avail_in;
+      m_offset += consumed;
+      m_entry.consumed += consumed;
+
+      if (!ended) {
+        if (known_size && m_entry.consumed == m_entry.compressed_size)
+          return fail("Truncated compressed data");
+        return consumed > 0;
+      }
+    }
+
+    if (m_entry.flags & FLAG_DATA_DESCRIPTOR) {
+      m_state = State::DataDescriptor;
+      return true;
+    }
+
+    if (!finishEntry(m_entry.crc))
+      return false;
+    m_state = State::LocalHeader;
+    return true;
+  }
+
+  bool ZipStreamExtractor::parseDataDescriptor() {
+    size_t available = m_buffer.size() - m_offset;
+    if (available < 4)
+      return false;
+
+    const unsigned char* data = m_buffer.data() + m_offset;
+    size_t signature_size = read32(data) == DATA_DESCRIPTOR_SIGNATURE ? 4 : 0;
+    size_t size = signature_size + 4 + (m_entry.zip64 ? 16 : 8);
+    if (available < size)
+      return false;
+
+    uint32_t crc = read32(data + signature_size);
+    m_offset += size;
+
+    if (!finishEntry(crc))
+      return false;
+    m_state = State::LocalHeader;
+    return true;
+  }
+
+  bool ZipStreamExtractor::finishEntry(uint32_t a_crc) {
+    if (m_file) {
+      bool closed = fclose(m_file) == 0;
+      m_file = nullptr;
+      if (!closed)
+        return fail(ntl::String{"Failed to write "} + (m_target / m_entry.path).c_str());
+      ++m_file_count;
+    }
+
+    if (m_entry.write && m_entry.actual_crc != a_crc)
+      return fail(ntl::String{"CRC mismatch in "} + m_entry.path.c_str());
+
+    return true;
+  }
+
+  bool ZipStreamExtractor::writeOutput(const unsigned char* a_data, size_t a_size) {
+    if (!m_file || a_size == 0)
+      return true;
+
+    m_entry.actual_crc = static_cast<uint32_t>(crc32(m_entry.actual_crc, a_data, static_cast<uInt>(a_size)));
+    if (fwrite(a_data, 1, a_size, m_file) != a_size)
+      return fail(ntl::String{"Failed to write "} + (m_target / m_entry.path).c_str());
+    return true;
+  }
+
+  bool ZipStreamExtractor::resolvePath(const std::string& a_name, fs::path& a_path) const {
+    fs::path path = fs::path(a_name).lexically_normal();
+    if (path.is_absolute())
+      return false;
+
+    fs::path relative;
+    size_t index = 0;
+    for (const auto& component : path) {
+      if (component == "..")
+        return false;
+      if (index++ >= m_strip_components) {
+        relative /= component;
+      }
+    }
+
+    if (relative.empty())
+      return false;
+
+    a_path = relative;
+    return true;
+  }
+
+  bool ZipStreamExtractor::fail(const ntl::String& a_error) {
+    if (m_state != State::Failed) {
+      m_error = a_error;
+      m_state = State::Failed;
+    }
+    if (m_file) {
+      fclose(m_file);
+      m_file = nullptr;
+    }
+    return false;
+  }
+}
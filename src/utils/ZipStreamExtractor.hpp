@@ -0,0 +1,182 @@
+/**
+* @file ZipStreamExtractor.hpp
+* @author Marcus Gugacs
+* @date 16.10.26
+* @copyright Copyright (c) 2026 Marcus Gugacs. All rights reserved.
+*/
+
+#ifndef ATLAS_ZIP_STREAM_EXTRACTOR_HPP
+#define ATLAS_ZIP_STREAM_EXTRACTOR_HPP
+
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <functional>
+#include <vector>
+
+#include <zlib.h>
+
+#include <data/String.hpp>
+
+namespace fs = std::filesystem;
+
+namespace atlas {
+  /**
+   * @class ZipStreamExtractor
+   * @brief Extracts a zip archive while it is still being received.
+   *
+   * The archive is consumed front to back through its local file headers, so no seeking and no temporary copy
+   * of the archive is needed. Entries are inflated as their bytes arrive, leading path components are stripped
+   * and only entries accepted by the filter are written. Stored and deflated entries are supported, including
+   * entries followed by a data descriptor as long as their size is known or they are deflated.
+   */
+  class ZipStreamExtractor {
+  public:
+    using Filter = std::function<bool(const fs::path&)>;
+
+  private:
+    enum class State {
+      LocalHeader,
+      EntryData,
+      DataDescriptor,
+      Done,
+      Failed
+    };
+
+    /**
+     * @struct Entry
+     * @brief State of the entry currently being extracted.
+     */
+    struct Entry {
+      fs::path path;
+      bool write;
+      bool zip64;
+      uint16_t flags;
+      uint16_t method;
+      uint32_t crc;
+      uint64_t compressed_size;
+      uint64_t consumed;
+      uint32_t actual_crc;
+    };
+
+    fs::path m_target;
+    size_t m_strip_components;
+    Filter m_filter;
+    State m_state;
+    Entry m_entry;
+    std::vector<unsigned char> m_buffer;
+    size_t m_offset;
+    std::vector<unsigned char> m_output;
+    z_stream m_stream;
+    bool m_stream_initialized;
+    FILE* m_file;
+    size_t m_file_count;
+    ntl::String m_error;
+
+  public:
+    /**
+     * @brief Constructor.
+     *
+     * @param a_target Directory to extract to
+     * @param a_strip_components Number of leading path components to remove from every entry
+     * @param a_filter Decides which of the stripped paths are written, all files if empty
+     */
+    ZipStreamExtractor(const fs::path& a_target, size_t a_strip_components, Filter a_filter);
+
+    /**
+     * @brief Destructor, closes a partially written file.
+     */
+    ~ZipStreamExtractor();
+
+    ZipStreamExtractor(const ZipStreamExtractor&) = delete;
+    ZipStreamExtractor& operator=(const ZipStreamExtractor&) = delete;
+
+    /**
+     * @brief Consumes the next bytes of the archive.
+     *
+     * @param a_data Received bytes
+     * @param a_size Number of bytes
+     * @return True if the archive is valid so far, false otherwise
+     */
+    bool Feed(const void* a_data, size_t a_size);
+
+    /**
+     * @brief Checks whether the whole archive was extracted.
+     *
+     * @return True if the central directory was reached without errors, false otherwise
+     */
+    bool Finish();
+
+    /**
+     * @brief Returns the number of files written.
+     *
+     * @return The number of files written
+     */
+    size_t GetFileCount() const { return m_file_count; }
+
+    /**
+     * @brief Returns a description of the first error.
+     *
+     * @return The error, empty if there was none
+     */
+    const ntl::String& GetError() const { return m_error; }
+
+  private:
+    /**
+     * @brief Parses the next local file header once it is complete.
+     *
+     * @return True if progress was made, false if more data is needed or the archive is invalid
+     */
+    bool parseLocalHeader();
+
+    /**
+     * @brief Extracts as much of the current entry's data as is available.
+     *
+     * @return True if progress was made, false if more data is needed or the archive is invalid
+     */
+    bool processEntryData();
+
+    /**
+     * @brief Parses the data descriptor following the current entry once it is complete.
+     *
+     * @return True if progress was made, false if more data is needed or the archive is invalid
+     */
+    bool parseDataDescriptor();
+
+    /**
+     * @brief Verifies and closes the current entry.
+     *
+     * @param a_crc CRC-32 the entry must have
+     * @return True if the entry is intact, false otherwise
+     */
+    bool finishEntry(uint32_t a_crc);
+
+    /**
+     * @brief Writes decompressed data of the current entry.
+     *
+     * @param a_data Decompressed bytes
+     * @param a_size Number of bytes
+     * @return True if successful, false otherwise
+     */
+    bool writeOutput(const unsigned char* a_data, size_t a_size);
+
+    /**
+     * @brief Resolves an entry name to its path relative to the target directory.
+     *
+     * @param a_name Name stored in the archive
+     * @param a_path Relative path to fill
+     * @return True if the entry lies inside the target directory after stripping, false otherwise
+     */
+    bool resolvePath(const std::string& a_name, fs::path& a_path) const;
+
+    /**
+     * @brief Records an error and stops the extraction.
+     *
+     * @param a_error Description of the error
+     * @return Always false
+     */
+    bool fail(const ntl::String& a_error);
+  };
+}
+
+#endif // ATLAS_ZIP_STREAM_EXTRACTOR_HPP